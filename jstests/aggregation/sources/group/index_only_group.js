@@ -0,0 +1,63 @@
+/**
+ * Tests that a pipeline whose dependencies are covered by an index reads them from the index keys
+ * without fetching any documents, and that a $group on the distinct values of an indexed field
+ * uses a DISTINCT_SCAN. Both must return the same results as when the index is hinted away.
+ */
+load("jstests/libs/analyze_plan.js");  // For getAggPlanStage.
+
+(function() {
+    "use strict";
+    const coll = db.index_only_group;
+
+    coll.drop();
+    assert.commandWorked(coll.createIndex({a: 1, b: 1}));
+
+    const bulk = coll.initializeUnorderedBulkOp();
+    for (let i = 0; i < 300; ++i) {
+        bulk.insert({a: i % 17, b: i % 5, c: i});
+    }
+    bulk.insert({b: 1, c: -1});
+    bulk.insert({a: null, b: 2, c: -2});
+    bulk.insert({a: "str", c: -3});
+    bulk.insert({a: {x: 1}, b: 3, c: -4});
+    assert.writeOK(bulk.execute());
+
+    const pipelines = [
+        [{$match: {a: {$gte: 3}}}, {$group: {_id: "$a", n: {$sum: 1}, b: {$sum: "$b"}}}],
+        [{$match: {a: {$lt: 10}}}, {$project: {_id: 0, a: 1, b: 1}}],
+        [{$group: {_id: "$a"}}],
+        [{$match: {a: {$in: [1, 2, "str"]}}}, {$group: {_id: "$a"}}],
+    ];
+
+    pipelines.forEach(function(pipeline) {
+        const sortedPipeline = pipeline.concat([{$sort: {_id: 1, a: 1, b: 1}}]);
+        const expected = coll.aggregate(sortedPipeline, {hint: {$natural: 1}}).toArray();
+        const actual = coll.aggregate(sortedPipeline).toArray();
+        assert.eq(expected, actual, tojson(pipeline));
+
+        // On an unsharded collection, the plan never fetches a document.
+        const explain = coll.explain().aggregate(pipeline);
+        if (explain.hasOwnProperty("stages")) {
+            assert.eq(null, getAggPlanStage(explain, "FETCH"), tojson(explain));
+            assert.eq(null, getAggPlanStage(explain, "COLLSCAN"), tojson(explain));
+        }
+    });
+
+    // A $group on the distinct values of 'a' skips through the index.
+    let explain = coll.explain().aggregate([{$group: {_id: "$a"}}]);
+    if (explain.hasOwnProperty("stages")) {
+        assert.neq(null, getAggPlanStage(explain, "DISTINCT_SCAN"), tojson(explain));
+    }
+
+    // Accumulators depend on every document, so they prevent a DISTINCT_SCAN.
+    explain = coll.explain().aggregate([{$group: {_id: "$a", n: {$sum: 1}}}]);
+    assert.eq(null, getAggPlanStage(explain, "DISTINCT_SCAN"), tojson(explain));
+
+    // Once the index is multikey on 'a', its keys are no longer the values $group sees.
+    assert.writeOK(coll.insert({a: [1, 2], b: 1, c: -5}));
+    explain = coll.explain().aggregate([{$group: {_id: "$a"}}]);
+    assert.eq(null, getAggPlanStage(explain, "DISTINCT_SCAN"), tojson(explain));
+    assert.eq(coll.aggregate([{$group: {_id: "$a"}}, {$sort: {_id: 1}}]).toArray(),
+              coll.aggregate([{$group: {_id: "$a"}}, {$sort: {_id: 1}}], {hint: {$natural: 1}})
+                  .toArray());
+}());
@@ -0,0 +1,49 @@
+/**
+ * Tests that a $group whose input is sorted on its _id fields streams its groups, and returns the
+ * same groups as a $group over unsorted input, including for null, missing and array values.
+ */
+(function() {
+    "use strict";
+    const coll = db.streaming_group;
+
+    coll.drop();
+    assert.commandWorked(coll.createIndex({a: 1, b: 1}));
+
+    const bulk = coll.initializeUnorderedBulkOp();
+    for (let i = 0; i < 300; ++i) {
+        bulk.insert({a: i % 17, b: i % 3, v: i});
+    }
+    bulk.insert({b: 1, v: 1});
+    bulk.insert({a: null, b: 1, v: 2});
+    bulk.insert({a: undefined, b: 1, v: 3});
+    bulk.insert({a: [1, 2], b: 1, v: 4});
+    bulk.insert({a: {c: 1}, v: 5});
+    assert.writeOK(bulk.execute());
+
+    const groups = [
+        {_id: "$a", n: {$sum: 1}, v: {$sum: "$v"}},
+        {_id: {x: "$a", y: "$b"}, n: {$sum: 1}, v: {$sum: "$v"}},
+        {_id: {y: "$b", x: "$a"}, first: {$first: "$v"}},
+    ];
+
+    groups.forEach(function(group) {
+        const sortedOnId = group._id === "$a" ? {a: 1} : {a: 1, b: 1};
+        const expected = coll.aggregate([{$group: group}, {$sort: {_id: 1}}]).toArray();
+
+        const pipeline = [{$sort: sortedOnId}, {$group: group}];
+        const actual = coll.aggregate(pipeline.concat([{$sort: {_id: 1}}])).toArray();
+        if (group.first) {
+            // $first depends on the input order, so only compare the groups themselves.
+            assert.eq(expected.map(doc => doc._id), actual.map(doc => doc._id), tojson(group));
+        } else {
+            assert.eq(expected, actual, tojson(group));
+        }
+
+        // An unsharded collection reports the streaming $group in explain.
+        const explain = coll.explain().aggregate(pipeline);
+        if (explain.hasOwnProperty("stages")) {
+            assert(explain.stages.some(stage => stage.hasOwnProperty("$streamingGroup")),
+                   tojson(explain));
+        }
+    });
+}());
@@ -0,0 +1,102 @@
+// Tests that the analyze command builds and persists statistics of a collection's indexed fields,
+// and that the query planner uses them to prune candidate plans which can't win before trying them.
+(function() {
+    'use strict';
+
+    var conn = MongoRunner.runMongod({});
+    assert.neq(null, conn, "mongod was unable to start up");
+
+    var testDB = conn.getDB("test");
+    var coll = testDB.analyze_statistics;
+    coll.drop();
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 5000; ++i) {
+        bulk.insert({a: i, b: i % 2, c: i % 3});
+    }
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(coll.createIndex({a: 1}));
+    assert.commandWorked(coll.createIndex({b: 1}));
+    assert.commandWorked(coll.createIndex({c: 1}));
+
+    var query = {a: 5, b: 1, c: 2};
+    var numRejectedPlans = function() {
+        var explain = coll.find(query).explain();
+        assert.eq("IXSCAN", explain.queryPlanner.winningPlan.inputStage.stage, tojson(explain));
+        assert.eq({a: 1}, explain.queryPlanner.winningPlan.inputStage.keyPattern, tojson(explain));
+        return explain.queryPlanner.rejectedPlans.length;
+    };
+
+    // Without statistics, every candidate plan is tried.
+    assert.gte(numRejectedPlans(), 2);
+
+    // Invalid arguments are rejected.
+    assert.commandFailed(testDB.runCommand({analyze: coll.getName(), sampleSize: 0}));
+    assert.commandFailed(testDB.runCommand({analyze: coll.getName(), buckets: -1}));
+    assert.commandFailed(testDB.runCommand({analyze: coll.getName(), fields: "a"}));
+    assert.commandFailedWithCode(testDB.runCommand({analyze: "does_not_exist"}),
+                                 ErrorCodes.NamespaceNotFound);
+
+    var res = assert.commandWorked(testDB.runCommand({analyze: coll.getName(), buckets: 16}));
+    assert(res.persisted, tojson(res));
+    assert.eq(5000, res.numRecords, tojson(res));
+    assert.eq(5000, res.sampleSize, tojson(res));
+    assert.eq(["_id", "a", "b", "c"], res.fields.map(field => field.path), tojson(res));
+
+    var b = res.fields[2];
+    assert.eq(2, b.distinctValues, tojson(b));
+    assert.eq(2, b.histogram.length, tojson(b));
+    var a = res.fields[1];
+    assert.lte(a.histogram.length, 16, tojson(a));
+    assert.eq(5000, a.distinctValues, tojson(a));
+
+    // The statistics are persisted under the name of the collection.
+    var persisted = testDB.system.statistics.findOne({_id: coll.getName()});
+    assert.neq(null, persisted);
+    assert.eq(res.fields, persisted.fields);
+
+    // The scans of 'b' and 'c' examine far more keys than the scan of 'a', so they're pruned.
+    assert.eq(0, numRejectedPlans());
+
+    // Pruning can be turned off.
+    assert.commandWorked(
+        testDB.adminCommand({setParameter: 1, internalQueryPlannerPruneByStatistics: false}));
+    assert.gte(numRejectedPlans(), 2);
+    assert.commandWorked(
+        testDB.adminCommand({setParameter: 1, internalQueryPlannerPruneByStatistics: true}));
+
+    // A smaller sample of the requested fields can be taken, and the statistics are loaded from
+    // system.statistics after a restart.
+    res = assert.commandWorked(
+        testDB.runCommand({analyze: coll.getName(), sampleSize: 1000, fields: ["a", "b", "c"]}));
+    assert.eq(1000, res.sampleSize, tojson(res));
+
+    MongoRunner.stopMongod(conn);
+    conn = MongoRunner.runMongod({dbpath: conn.dbpath, noCleanData: true});
+    assert.neq(null, conn, "mongod was unable to restart");
+    testDB = conn.getDB("test");
+    coll = testDB.analyze_statistics;
+    assert.eq(0, numRejectedPlans());
+
+    // Removing the persisted statistics, as replicating the removal would, stops the planner from
+    // using them.
+    assert.writeOK(testDB.system.statistics.remove({_id: coll.getName()}));
+    assert.gte(numRejectedPlans(), 2);
+
+    // Statistics don't survive dropping the collection.
+    assert.commandWorked(testDB.runCommand({analyze: coll.getName()}));
+    assert.eq(0, numRejectedPlans());
+    assert(coll.drop());
+    assert.eq(null, testDB.system.statistics.findOne({_id: coll.getName()}));
+    bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 5000; ++i) {
+        bulk.insert({a: i, b: i % 2, c: i % 3});
+    }
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(coll.createIndex({a: 1}));
+    assert.commandWorked(coll.createIndex({b: 1}));
+    assert.commandWorked(coll.createIndex({c: 1}));
+    assert.gte(numRejectedPlans(), 2);
+
+    MongoRunner.stopMongod(conn);
+})();
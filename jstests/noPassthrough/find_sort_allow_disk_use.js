@@ -0,0 +1,101 @@
+// Tests that a blocking sort in the find command can spill to disk when 'allowDiskUse' is set,
+// and that the spills are reported in explain.
+(function() {
+    'use strict';
+
+    var conn = MongoRunner.runMongod({setParameter: "internalQueryExecMaxBlockingSortBytes=65536"});
+    assert.neq(null, conn, "mongod was unable to start up");
+
+    var testDB = conn.getDB("test");
+    var coll = testDB.find_sort_allow_disk_use;
+    coll.drop();
+
+    var pad = new Array(1024).join("x");
+    var bulk = coll.initializeUnorderedBulkOp();
+    var numDocs = 1000;
+    for (var i = 0; i < numDocs; ++i) {
+        bulk.insert({_id: i, a: (i * 7919) % numDocs, pad: pad});
+    }
+    assert.writeOK(bulk.execute());
+
+    // Without allowDiskUse the sort exceeds its memory limit and fails.
+    assert.commandFailed(testDB.runCommand({find: coll.getName(), sort: {a: 1}}));
+
+    // With allowDiskUse the results come back complete and in order.
+    var res = testDB.runCommand(
+        {find: coll.getName(), sort: {a: 1}, projection: {pad: 0}, allowDiskUse: true});
+    assert.commandWorked(res);
+    var docs = new DBCommandCursor(conn, res).toArray();
+    assert.eq(numDocs, docs.length);
+    for (var i = 0; i < numDocs; ++i) {
+        assert.eq(i, docs[i].a, tojson(docs[i]));
+    }
+
+    // A descending sort with a skip and a limit.
+    res = testDB.runCommand({
+        find: coll.getName(),
+        sort: {a: -1},
+        projection: {pad: 0},
+        skip: 10,
+        limit: 300,
+        allowDiskUse: true
+    });
+    assert.commandWorked(res);
+    docs = new DBCommandCursor(conn, res).toArray();
+    assert.eq(300, docs.length);
+    for (var i = 0; i < docs.length; ++i) {
+        assert.eq(numDocs - 11 - i, docs[i].a, tojson(docs[i]));
+    }
+
+    // A small limit is satisfied by the in-memory top-k path, even without allowDiskUse.
+    res = testDB.runCommand({find: coll.getName(), sort: {a: 1}, limit: 5});
+    assert.commandWorked(res);
+    assert.eq([0, 1, 2, 3, 4], res.cursor.firstBatch.map(function(doc) {
+        return doc.a;
+    }));
+
+    // Spills are reported in executionStats.
+    var explain = testDB.runCommand({
+        explain: {find: coll.getName(), sort: {a: 1}, allowDiskUse: true},
+        verbosity: "executionStats"
+    });
+    assert.commandWorked(explain);
+    var stages = [explain.executionStats.executionStages];
+    var sortStage = null;
+    while (stages.length > 0) {
+        var stage = stages.pop();
+        if (stage.stage === "SORT") {
+            sortStage = stage;
+            break;
+        }
+        if (stage.inputStage) {
+            stages.push(stage.inputStage);
+        }
+    }
+    assert.neq(null, sortStage, tojson(explain));
+    assert.eq(true, sortStage.usedDisk, tojson(sortStage));
+    assert.gt(sortStage.spills, 0, tojson(sortStage));
+    assert.gt(sortStage.spilledBytes, numDocs * pad.length, tojson(sortStage));
+    assert.eq(numDocs, explain.executionStats.nReturned);
+
+    // A covered sort keeps its results as index keys, which cannot be spilled, so it fails cleanly
+    // rather than spilling.
+    assert.commandWorked(coll.createIndex({pad: 1, a: 1}));
+    assert.commandFailedWithCode(testDB.runCommand({
+        find: coll.getName(),
+        filter: {pad: pad},
+        sort: {a: 1},
+        projection: {_id: 0, a: 1, pad: 1},
+        hint: {pad: 1, a: 1},
+        allowDiskUse: true
+    }),
+                                 ErrorCodes.OperationFailed);
+    assert.commandWorked(coll.dropIndex({pad: 1, a: 1}));
+
+    // allowDiskUse must be a boolean.
+    assert.commandFailedWithCode(
+        testDB.runCommand({find: coll.getName(), sort: {a: 1}, allowDiskUse: 1}),
+        ErrorCodes.FailedToParse);
+
+    MongoRunner.stopMongod(conn);
+})();
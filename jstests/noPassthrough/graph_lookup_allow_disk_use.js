@@ -0,0 +1,59 @@
+// Tests that $graphLookup spills the documents it discovers to disk when 'allowDiskUse' is set,
+// rather than failing once they exceed its memory limit.
+(function() {
+    'use strict';
+
+    var conn = MongoRunner.runMongod(
+        {setParameter: "internalDocumentSourceGraphLookupMaxMemoryBytes=65536"});
+    assert.neq(null, conn, "mongod was unable to start up");
+
+    var testDB = conn.getDB("test");
+    var local = testDB.graph_lookup_allow_disk_use_local;
+    var foreign = testDB.graph_lookup_allow_disk_use_foreign;
+    local.drop();
+    foreign.drop();
+
+    var pad = new Array(1024).join("x");
+    var numNodes = 500;
+    var bulk = foreign.initializeUnorderedBulkOp();
+    for (var i = 0; i < numNodes; ++i) {
+        bulk.insert({_id: i, neighbors: [i + 1, i + 2], pad: pad});
+    }
+    assert.writeOK(bulk.execute());
+    assert.writeOK(local.insert({_id: 0, start: 0}));
+
+    var graphLookup = {
+        $graphLookup: {
+            from: foreign.getName(),
+            startWith: "$start",
+            connectFromField: "neighbors",
+            connectToField: "_id",
+            as: "results",
+            depthField: "depth"
+        }
+    };
+
+    // Without allowDiskUse the search exceeds its memory limit and fails.
+    assert.commandFailedWithCode(
+        testDB.runCommand({aggregate: local.getName(), pipeline: [graphLookup], cursor: {}}),
+        40099);
+
+    // With allowDiskUse every node is found exactly once, whether or not $unwind is absorbed.
+    var pipelines = [
+        [graphLookup, {$unwind: "$results"}, {$project: {id: "$results._id"}}],
+        [graphLookup, {$project: {id: "$results._id"}}, {$unwind: "$id"}],
+    ];
+    pipelines.forEach(function(pipeline) {
+        var ids = local.aggregate(pipeline.concat([{$sort: {id: 1}}]), {allowDiskUse: true})
+                      .toArray()
+                      .map(function(doc) {
+                          return doc.id;
+                      });
+        assert.eq(numNodes, ids.length, tojson(pipeline));
+        for (var i = 0; i < numNodes; ++i) {
+            assert.eq(i, ids[i], tojson(pipeline));
+        }
+    });
+
+    MongoRunner.stopMongod(conn);
+})();
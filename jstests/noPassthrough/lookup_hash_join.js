@@ -0,0 +1,78 @@
+// Tests that $lookup returns the same results whether it queries the foreign collection for each
+// input document or joins against a hash table of the foreign collection.
+(function() {
+    'use strict';
+
+    var conn = MongoRunner.runMongod({});
+    assert.neq(null, conn, "mongod was unable to start up");
+
+    var testDB = conn.getDB("test");
+    var local = testDB.lookup_hash_join_local;
+    var foreign = testDB.lookup_hash_join_foreign;
+    local.drop();
+    foreign.drop();
+
+    var bulk = foreign.initializeUnorderedBulkOp();
+    for (var i = 0; i < 200; ++i) {
+        bulk.insert({_id: i, key: i % 20, nested: {key: [i % 7, i % 11]}});
+    }
+    bulk.insert({_id: "null", key: null});
+    bulk.insert({_id: "missing"});
+    bulk.insert({_id: "array", key: [1, [2, 3]]});
+    assert.writeOK(bulk.execute());
+
+    bulk = local.initializeUnorderedBulkOp();
+    for (var i = 0; i < 500; ++i) {
+        bulk.insert({_id: i, key: i % 25});
+    }
+    bulk.insert({_id: "null", key: null});
+    bulk.insert({_id: "missing"});
+    bulk.insert({_id: "array", key: [1, 2, [2, 3]]});
+    assert.writeOK(bulk.execute());
+
+    var pipelines = [
+        [
+          {$lookup: {from: foreign.getName(), localField: "key", foreignField: "key", as: "m"}},
+        ],
+        [
+          {
+            $lookup:
+                {from: foreign.getName(), localField: "key", foreignField: "nested.key", as: "m"}
+          },
+        ],
+        [
+          {$lookup: {from: foreign.getName(), localField: "key", foreignField: "key", as: "m"}},
+          {$unwind: {path: "$m", includeArrayIndex: "index"}},
+          {$match: {"m._id": {$lt: 100}}},
+        ],
+    ];
+
+    var setMaxMemoryBytes = function(value) {
+        assert.commandWorked(testDB.adminCommand(
+            {setParameter: 1, internalDocumentSourceLookupHashJoinMaxMemoryBytes: value}));
+    };
+
+    pipelines.forEach(function(pipeline) {
+        var fullPipeline = pipeline.concat([{$sort: {_id: 1, index: 1}}]);
+
+        setMaxMemoryBytes(0);
+        var expected = local.aggregate(fullPipeline).toArray();
+
+        setMaxMemoryBytes(100 * 1024 * 1024);
+        var actual = local.aggregate(fullPipeline).toArray();
+
+        assert.eq(expected.length, actual.length, tojson(pipeline));
+        for (var i = 0; i < expected.length; ++i) {
+            assert.docEq(expected[i], actual[i], tojson(pipeline));
+        }
+    });
+
+    // Before running, explain reports that the strategy has not been chosen yet.
+    var explain = local.explain().aggregate(pipelines[0]);
+    var lookupStage = explain.stages.filter(function(stage) {
+        return stage.hasOwnProperty("$lookup");
+    })[0];
+    assert.eq("adaptive", lookupStage.$lookup.strategy, tojson(explain));
+
+    MongoRunner.stopMongod(conn);
+})();
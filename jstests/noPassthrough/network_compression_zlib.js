@@ -0,0 +1,43 @@
+// Tests that a client and server which both enable the zlib network message compressor negotiate
+// it, and that the server reports how much data it compressed and how long that took.
+(function() {
+    'use strict';
+
+    var conn = MongoRunner.runMongod(
+        {networkMessageCompressors: "zlib,snappy", zlibNetworkCompressionLevel: 9});
+    assert.neq(null, conn, "mongod was unable to start up");
+
+    var insertAndRead = function() {
+        var coll = db.getSiblingDB("test").network_compression_zlib;
+        for (var i = 0; i < 100; ++i) {
+            assert.writeOK(coll.insert({_id: i, s: "x".repeat(1024)}));
+        }
+        assert.eq(100, coll.find().itcount());
+    };
+
+    var exitCode = runMongoProgram("mongo",
+                                   "--port",
+                                   conn.port,
+                                   "--networkMessageCompressors",
+                                   "zlib",
+                                   "--eval",
+                                   "(" + insertAndRead.toString() + ")();");
+    assert.eq(0, exitCode);
+
+    var compression = conn.getDB("admin").serverStatus().network.compression;
+    assert.neq(undefined, compression, "expected compression statistics in serverStatus");
+    assert.gt(compression.zlib.decompressed.bytesOut, 100 * 1024, tojson(compression));
+    assert.gt(compression.zlib.compressed.bytesIn, 100 * 1024, tojson(compression));
+    assert.lt(compression.zlib.compressed.bytesOut,
+              compression.zlib.compressed.bytesIn / 10,
+              tojson(compression));
+    assert.gte(compression.zlib.compressed.micros, 0, tojson(compression));
+    assert.eq(0, compression.snappy.compressed.bytesIn, tojson(compression));
+
+    MongoRunner.stopMongod(conn);
+
+    // Compression levels outside of zlib's range are rejected at startup.
+    conn = MongoRunner.runMongod(
+        {networkMessageCompressors: "zlib", zlibNetworkCompressionLevel: 10});
+    assert.eq(null, conn, "mongod started with an invalid zlib compression level");
+})();
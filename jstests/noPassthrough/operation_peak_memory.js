@@ -0,0 +1,49 @@
+// Tests that the memory held by blocking sorts and $group is reported as peakMemoryBytes in
+// profiler entries.
+(function() {
+    'use strict';
+
+    var conn = MongoRunner.runMongod({});
+    assert.neq(null, conn, "mongod was unable to start up");
+
+    var testDB = conn.getDB("test");
+    var coll = testDB.operation_peak_memory;
+    coll.drop();
+
+    var pad = new Array(256).join("x");
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 1000; ++i) {
+        bulk.insert({_id: i, a: (i * 7919) % 1000, b: i % 100, pad: pad});
+    }
+    assert.writeOK(bulk.execute());
+
+    assert.commandWorked(testDB.setProfilingLevel(2));
+
+    var sorted = coll.find({}, {pad: 0}).sort({a: 1}).comment("peak_memory_sort").toArray();
+    assert.eq(1000, sorted.length);
+
+    var grouped = coll.aggregate([{$group: {_id: "$b", pads: {$push: "$pad"}}}]).toArray();
+    assert.eq(100, grouped.length);
+
+    // An operation without blocking stages does not report any memory.
+    assert.eq(1000, coll.find().comment("peak_memory_none").itcount());
+
+    assert.commandWorked(testDB.setProfilingLevel(0));
+
+    var profileEntry = function(filter) {
+        var entry = testDB.system.profile.findOne(filter);
+        assert.neq(null, entry, tojson(filter));
+        return entry;
+    };
+
+    var entry = profileEntry({"query.comment": "peak_memory_sort"});
+    assert.gt(entry.peakMemoryBytes, 1000 * pad.length, tojson(entry));
+
+    entry = profileEntry({"command.aggregate": coll.getName()});
+    assert.gt(entry.peakMemoryBytes, 1000 * pad.length, tojson(entry));
+
+    entry = profileEntry({"query.comment": "peak_memory_none"});
+    assert(!entry.hasOwnProperty("peakMemoryBytes"), tojson(entry));
+
+    MongoRunner.stopMongod(conn);
+})();
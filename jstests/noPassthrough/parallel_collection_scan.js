@@ -0,0 +1,87 @@
+// Tests that a collection scan split across worker threads returns the same documents as a
+// single-threaded scan, including when the query yields while the workers run.
+(function() {
+    'use strict';
+
+    var conn = MongoRunner.runMongod({
+        setParameter: {
+            internalQueryExecParallelCollectionScanThreads: 4,
+            internalQueryExecYieldIterations: 10
+        }
+    });
+    assert.neq(null, conn, "mongod was unable to start up");
+
+    var testDB = conn.getDB("test");
+    if (testDB.serverStatus().storageEngine.name !== "wiredTiger") {
+        // Parallel collection scans need a storage engine with document-level locking.
+        jsTest.log("skipping test since the storage engine cannot split collection scans");
+        MongoRunner.stopMongod(conn);
+        return;
+    }
+
+    var coll = testDB.parallel_collection_scan;
+    coll.drop();
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    var numDocs = 10000;
+    for (var i = 0; i < numDocs; ++i) {
+        bulk.insert({_id: i, a: i % 100});
+    }
+    assert.writeOK(bulk.execute());
+
+    // Delete a block of documents so that the ranges the workers scan hold uneven numbers of them.
+    assert.writeOK(coll.remove({_id: {$gte: 1000, $lt: 4000}}));
+
+    var getStage = function(explain, stageName) {
+        var stages = [explain.queryPlanner.winningPlan];
+        while (stages.length > 0) {
+            var stage = stages.pop();
+            if (stage.stage === stageName) {
+                return stage;
+            }
+            if (stage.inputStage) {
+                stages.push(stage.inputStage);
+            }
+        }
+        return null;
+    };
+
+    var explain = coll.find({a: {$lt: 10}}).explain("executionStats");
+    var parallelScan = getStage(explain, "PARALLEL_COLLSCAN");
+    assert.neq(null, parallelScan, tojson(explain));
+    assert.eq(4, parallelScan.workers, tojson(explain));
+    assert.eq(numDocs - 3000, explain.executionStats.totalDocsExamined, tojson(explain));
+
+    // The results may be in any order, so compare them sorted.
+    var expected = coll.find({a: {$lt: 10}}).hint({$natural: 1}).toArray();
+    var actual = coll.find({a: {$lt: 10}}).toArray();
+    assert.eq(700, expected.length);
+    var byId = function(x, y) {
+        return x._id - y._id;
+    };
+    assert.eq(expected, actual.sort(byId));
+
+    // Small batches make the query yield between getMores as well as within them, and stop the
+    // workers while the cursor waits for each getMore.
+    assert.eq(numDocs - 3000, coll.find().batchSize(7).itcount());
+    assert.eq(numDocs - 3000, coll.aggregate([{$match: {}}], {cursor: {batchSize: 7}}).itcount());
+
+    // A $group over the whole collection sees every document once.
+    var groups = coll.aggregate([{$group: {_id: "$a", n: {$sum: 1}}}]).toArray();
+    assert.eq(100, groups.length);
+    groups.forEach(function(group) {
+        assert.eq(70, group.n, tojson(group));
+    });
+
+    // Requesting natural order uses a single-threaded scan.
+    explain = coll.find().sort({$natural: 1}).explain();
+    assert.eq(null, getStage(explain, "PARALLEL_COLLSCAN"), tojson(explain));
+    assert.neq(null, getStage(explain, "COLLSCAN"), tojson(explain));
+
+    // The number of workers is bounded.
+    assert.commandFailedWithCode(
+        testDB.adminCommand({setParameter: 1, internalQueryExecParallelCollectionScanThreads: 65}),
+        ErrorCodes.BadValue);
+
+    MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,55 @@
+// Tests that foreground index builds which generate and sort keys on several worker threads
+// produce complete, valid indexes.
+(function() {
+    'use strict';
+
+    var conn = MongoRunner.runMongod({setParameter: "indexBuildWorkerThreads=4"});
+    assert.neq(null, conn, "mongod was unable to start up");
+
+    var testDB = conn.getDB("test");
+    var coll = testDB.parallel_index_build;
+    coll.drop();
+
+    var numDocs = 20000;
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < numDocs; ++i) {
+        bulk.insert({_id: i, a: (i * 7919) % 1000, b: (i % 10 === 0) ? [i, -i - 1] : i, c: i});
+    }
+    assert.writeOK(bulk.execute());
+
+    // A compound multikey index.
+    assert.commandWorked(coll.createIndex({a: 1, b: -1}));
+    var res = assert.commandWorked(coll.validate(true));
+    assert(res.valid, tojson(res));
+    assert.eq(numDocs, coll.find({a: {$gte: 0}}).hint({a: 1, b: -1}).itcount());
+    assert.eq(numDocs / 10, coll.find({b: {$lt: 0}}).hint({a: 1, b: -1}).itcount());
+
+    // Results read through the index come back in index order.
+    var prev = null;
+    coll.find({}, {_id: 0, a: 1}).hint({a: 1, b: -1}).forEach(function(doc) {
+        if (prev !== null) {
+            assert.lte(prev, doc.a);
+        }
+        prev = doc.a;
+    });
+
+    // A partial index only holds the documents matching its filter.
+    assert.commandWorked(coll.createIndex({c: 1}, {partialFilterExpression: {a: {$lt: 100}}}));
+    assert.eq(coll.find({a: {$lt: 100}}).itcount(),
+              coll.find({a: {$lt: 100}, c: {$gte: 0}}).hint({c: 1}).itcount());
+
+    // A unique index build fails when duplicates are handed to different workers.
+    assert.commandFailedWithCode(coll.createIndex({a: 1}, {unique: true}),
+                                 ErrorCodes.DuplicateKey);
+    assert.commandWorked(coll.createIndex({c: 1, a: 1}, {unique: true}));
+
+    res = assert.commandWorked(coll.validate(true));
+    assert(res.valid, tojson(res));
+
+    // The number of workers is bounded.
+    assert.commandFailed(testDB.adminCommand({setParameter: 1, indexBuildWorkerThreads: 0}));
+    assert.commandFailed(testDB.adminCommand({setParameter: 1, indexBuildWorkerThreads: 65}));
+    assert.commandWorked(testDB.adminCommand({setParameter: 1, indexBuildWorkerThreads: 1}));
+
+    MongoRunner.stopMongod(conn);
+})();
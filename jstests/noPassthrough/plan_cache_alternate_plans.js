@@ -0,0 +1,72 @@
+// Tests that a query shape whose parameter values favor different indexes keeps the plan it
+// replaced when replanning as an alternate, switches back to it without replanning, and reports
+// both plans and its runtime statistics in planCacheListPlans.
+(function() {
+    'use strict';
+
+    var conn = MongoRunner.runMongod({});
+    assert.neq(null, conn, "mongod was unable to start up");
+
+    var testDB = conn.getDB("test");
+    var coll = testDB.plan_cache_alternate_plans;
+    coll.drop();
+
+    // Half of the documents share a value of 'a', and the other half share a value of 'b'.
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 2000; ++i) {
+        bulk.insert({a: i < 1000 ? 0 : i, b: i >= 1000 ? 0 : i});
+    }
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(coll.createIndex({a: 1}));
+    assert.commandWorked(coll.createIndex({b: 1}));
+
+    var selectiveOnA = {a: 1500, b: 0};
+    var selectiveOnB = {a: 0, b: 500};
+
+    var listPlans = function() {
+        var res = coll.runCommand("planCacheListPlans", {query: selectiveOnA});
+        assert.commandWorked(res);
+        return res;
+    };
+
+    // The first query caches the plan using the index on 'a'.
+    assert.eq(1, coll.find(selectiveOnA).itcount());
+    var res = listPlans();
+    assert.eq(0, res.alternatePlans.length, tojson(res));
+    assert(res.plans[0].details.solution.indexOf("a_1") >= 0, tojson(res));
+
+    // The cached plan takes too long for the second query, which replans and caches the plan
+    // using the index on 'b', keeping the plan using the index on 'a' as an alternate.
+    assert.eq(1, coll.find(selectiveOnB).itcount());
+    res = listPlans();
+    assert(res.plans[0].details.solution.indexOf("b_1") >= 0, tojson(res));
+    assert.eq(1, res.alternatePlans.length, tojson(res));
+    assert(res.alternatePlans[0].details.solution.indexOf("a_1") >= 0, tojson(res));
+    assert.gt(res.alternatePlans[0].works, 0, tojson(res));
+
+    // Running the first query again switches back to the alternate without replanning.
+    assert.commandWorked(testDB.setProfilingLevel(2));
+    assert.eq(1, coll.find(selectiveOnA).itcount());
+    assert.commandWorked(testDB.setProfilingLevel(0));
+    var profileEntry = testDB.system.profile.findOne({ns: coll.getFullName(), op: "query"});
+    assert.neq(null, profileEntry);
+    assert(!profileEntry.replanned, tojson(profileEntry));
+
+    res = listPlans();
+    assert(res.plans[0].details.solution.indexOf("a_1") >= 0, tojson(res));
+    assert.eq(1, res.alternatePlans.length, tojson(res));
+    assert(res.alternatePlans[0].details.solution.indexOf("b_1") >= 0, tojson(res));
+
+    // Every execution of the shape is counted in its runtime statistics.
+    assert.eq(3, res.runtimeStats.executions, tojson(res));
+    var sumCounts = function(histogram) {
+        return histogram.reduce(function(sum, bucket) {
+            return sum + bucket.count;
+        }, 0);
+    };
+    assert.eq(3, sumCounts(res.runtimeStats.keysExamined), tojson(res));
+    assert.eq(3, sumCounts(res.runtimeStats.docsExamined), tojson(res));
+    assert.eq(3, sumCounts(res.runtimeStats.latencyMicros), tojson(res));
+
+    MongoRunner.stopMongod(conn);
+})();
@@ -0,0 +1,43 @@
+// Verifies that mongod can run all of its connections on the fixedThreadPool service executor, and
+// that the executor's statistics are reported in serverStatus.
+(function() {
+    'use strict';
+
+    var conn = MongoRunner.runMongod({setParameter: {serviceExecutor: "fixedThreadPool"}});
+    assert.neq(null, conn, "mongod failed to start with the fixedThreadPool service executor");
+
+    var testDB = conn.getDB("test");
+    var bulk = testDB.coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < 1000; i++) {
+        bulk.insert({_id: i});
+    }
+    assert.writeOK(bulk.execute());
+
+    // Exhaust cursors reply several times to a single request.
+    var exhaustCount =
+        testDB.coll.find().batchSize(10).addOption(DBQuery.Option.exhaust).itcount();
+    assert.eq(1000, exhaustCount);
+
+    // Many more connections than worker threads must all make progress.
+    var others = [];
+    for (var i = 0; i < 50; i++) {
+        var other = new Mongo(conn.host);
+        assert.eq(1000, other.getDB("test").coll.count());
+        others.push(other);
+    }
+
+    var stats = assert.commandWorked(testDB.serverStatus()).network.serviceExecutorTaskStats;
+    assert(stats, "serverStatus is missing serviceExecutorTaskStats");
+    assert.eq("fixedThreadPool", stats.executor, tojson(stats));
+    assert.gt(stats.threadsRunning, 0, tojson(stats));
+    assert.lte(stats.threadsRunning, stats.threadsMax, tojson(stats));
+    assert.gte(stats.totalExecuted, 50, tojson(stats));
+
+    others.forEach(function(other) {
+        other.close();
+    });
+    MongoRunner.stopMongod(conn);
+
+    // Unknown executors are rejected at startup.
+    assert.eq(null, MongoRunner.runMongod({setParameter: {serviceExecutor: "bogus"}}));
+}());
@@ -0,0 +1,97 @@
+// Tests that external sorts spill to the directory named by 'sorterSpillDirectory' with the codec
+// selected by 'sorterSpillCompressor', that serverStatus reports the bytes spilled and read, and
+// that spill files left in that directory are removed at startup.
+(function() {
+    'use strict';
+
+    var spillDir = MongoRunner.dataPath + "sorter_spill_options_tmp";
+    resetDbpath(spillDir);
+
+    var conn = MongoRunner.runMongod({
+        setParameter: {
+            internalQueryExecMaxBlockingSortBytes: 65536,
+            sorterSpillDirectory: spillDir,
+            sorterSpillCompressor: "zlib",
+            sorterSpillAvoidPageCache: true,
+        }
+    });
+    assert.neq(null, conn, "mongod was unable to start up");
+
+    var testDB = conn.getDB("test");
+    var coll = testDB.sorter_spill_options;
+    coll.drop();
+
+    var pad = new Array(1024).join("x");
+    var bulk = coll.initializeUnorderedBulkOp();
+    var numDocs = 1000;
+    for (var i = 0; i < numDocs; ++i) {
+        bulk.insert({_id: i, a: (i * 7919) % numDocs, pad: pad});
+    }
+    assert.writeOK(bulk.execute());
+
+    var getSpillMetrics = function() {
+        return testDB.serverStatus().metrics.sorter.spill;
+    };
+
+    var sortAndCheck = function() {
+        var res = testDB.runCommand(
+            {find: coll.getName(), sort: {a: 1}, projection: {pad: 0}, allowDiskUse: true});
+        assert.commandWorked(res);
+        var docs = new DBCommandCursor(conn, res).toArray();
+        assert.eq(numDocs, docs.length);
+        for (var i = 0; i < numDocs; ++i) {
+            assert.eq(i, docs[i].a, tojson(docs[i]));
+        }
+    };
+
+    var before = getSpillMetrics();
+    sortAndCheck();
+    var after = getSpillMetrics();
+
+    // The padding compresses well, so zlib should have shrunk the spilled blocks.
+    var written = after.bytesWritten - before.bytesWritten;
+    var uncompressed = after.uncompressedBytesWritten - before.uncompressedBytesWritten;
+    assert.gt(written, 0, tojson(after));
+    assert.lt(written, uncompressed / 2, tojson(after));
+    assert.eq(written, after.bytesRead - before.bytesRead, tojson(after));
+    assert.eq(0, after.checksumFailures, tojson(after));
+
+    // The spill directory was created outside of the dbpath, and the files were cleaned up.
+    assert(listFiles(MongoRunner.dataPath).some(function(file) {
+        return file.isDirectory && file.baseName === "sorter_spill_options_tmp";
+    }));
+    assert.eq(0, listFiles(spillDir).length);
+
+    // The codec can be changed at runtime.
+    assert.commandWorked(testDB.adminCommand({setParameter: 1, sorterSpillCompressor: "none"}));
+    assert.eq(
+        "none",
+        assert.commandWorked(testDB.adminCommand({getParameter: 1, sorterSpillCompressor: 1}))
+            .sorterSpillCompressor);
+    before = getSpillMetrics();
+    sortAndCheck();
+    after = getSpillMetrics();
+    assert.gt(after.bytesWritten - before.bytesWritten,
+              after.uncompressedBytesWritten - before.uncompressedBytesWritten,
+              tojson(after));
+
+    assert.commandFailed(testDB.adminCommand({setParameter: 1, sorterSpillCompressor: "zstd"}));
+    assert.commandFailed(testDB.adminCommand({setParameter: 1, sorterSpillCompressor: 1}));
+
+    MongoRunner.stopMongod(conn);
+
+    // Spill files left in the spill directory are removed at startup, and other files are kept.
+    writeFile(spillDir + "/extsort.0", "left over");
+    writeFile(spillDir + "/other", "not a spill file");
+    conn = MongoRunner.runMongod({
+        dbpath: conn.dbpath,
+        noCleanData: true,
+        setParameter: {sorterSpillDirectory: spillDir},
+    });
+    assert.neq(null, conn, "mongod was unable to restart");
+    assert.eq(["other"], listFiles(spillDir).map(function(file) {
+        return file.baseName;
+    }));
+
+    MongoRunner.stopMongod(conn);
+})();
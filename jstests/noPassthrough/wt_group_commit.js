@@ -0,0 +1,52 @@
+// Tests that concurrent journaled inserts share WiredTiger journal flushes, and that serverStatus
+// reports the group commits.
+(function() {
+    'use strict';
+
+    var conn = MongoRunner.runMongod({setParameter: "wiredTigerGroupCommitMaxWaitMicros=20000"});
+    assert.neq(null, conn, "mongod was unable to start up");
+
+    var testDB = conn.getDB("test");
+    if (!testDB.serverStatus().wiredTiger || !testDB.serverStatus().storageEngine.persistent) {
+        jsTestLog("Skipping test because the storage engine is not a persistent WiredTiger");
+        MongoRunner.stopMongod(conn);
+        return;
+    }
+
+    var before = testDB.serverStatus().wiredTiger.groupCommit;
+    assert.eq(20000, before.maxWaitMicros, tojson(before));
+
+    var numClients = 8;
+    var numInserts = 50;
+    var clients = [];
+    for (var i = 0; i < numClients; ++i) {
+        clients.push(startParallelShell(
+            "for (var i = 0; i < " + numInserts + "; ++i) {" +
+                "    assert.writeOK(db.getSiblingDB('test').wt_group_commit.insert(" +
+                "        {client: " + i + ", i: i}, {writeConcern: {w: 1, j: true}}));" +
+                "}",
+            conn.port));
+    }
+    clients.forEach(function(awaitShell) {
+        awaitShell();
+    });
+    assert.eq(numClients * numInserts, testDB.wt_group_commit.count());
+
+    var after = testDB.serverStatus().wiredTiger.groupCommit;
+    var commits = after.commits - before.commits;
+    var flushes = after.flushes - before.flushes;
+    assert.gte(commits, numClients * numInserts, tojson(after));
+    assert.lt(flushes, commits, tojson(after));
+    assert(after.groupSizes.some(function(bucket) {
+        return bucket.size > 1;
+    }),
+           tojson(after));
+    assert.gt(after.flushLatencies.length, 0, tojson(after));
+
+    assert.commandFailed(
+        testDB.adminCommand({setParameter: 1, wiredTigerGroupCommitMaxWaitMicros: -1}));
+    assert.commandWorked(
+        testDB.adminCommand({setParameter: 1, wiredTigerGroupCommitMaxWaitMicros: 0}));
+
+    MongoRunner.stopMongod(conn);
+})();
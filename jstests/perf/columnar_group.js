@@ -0,0 +1,70 @@
+/**
+ * Measures $group throughput over a collection scan with columnar batch input enabled and disabled
+ * (internalDocumentSourceGroupColumnarBatchSize=0), and checks that both produce the same groups.
+ */
+(function() {
+    'use strict';
+
+    var kNumDocs = 500000;
+    if (db.adminCommand("buildInfo").debug) {
+        kNumDocs = 50000;
+    }
+
+    var coll = db.columnar_group;
+    coll.drop();
+
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < kNumDocs; i++) {
+        bulk.insert({
+            k: i % 100,
+            v: i,
+            d: i / 7,
+            nested: {k: i % 10, s: "s" + (i % 1000)},
+            pad: "xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx"
+        });
+    }
+    assert.writeOK(bulk.execute());
+
+    var groups = {
+        count: {_id: null, n: {$sum: 1}},
+        sumByKey: {_id: "$k", total: {$sum: "$v"}},
+        avgByNestedKey: {_id: "$nested.k", avg: {$avg: "$d"}, total: {$sum: "$v"}},
+        minMaxByCompoundKey:
+            {_id: {k: "$k", n: "$nested.k"}, min: {$min: "$v"}, max: {$max: "$nested.s"}},
+    };
+
+    function setBatchSize(size) {
+        var res = assert.commandWorked(
+            db.adminCommand({setParameter: 1, internalDocumentSourceGroupColumnarBatchSize: size}));
+        return res.was;
+    }
+
+    function runGroup(spec) {
+        var results;
+        var millis = Date.timeFunc(function() {
+            results = coll.aggregate([{$group: spec}]).toArray();
+        });
+        results.sort(function(a, b) {
+            return bsonWoCompare({_: a._id}, {_: b._id});
+        });
+        return {millis: millis, results: results};
+    }
+
+    var defaultBatchSize = setBatchSize(0);
+    assert.gt(defaultBatchSize, 0);
+
+    Object.keys(groups).forEach(function(name) {
+        setBatchSize(0);
+        var rowAtATime = runGroup(groups[name]);
+        setBatchSize(defaultBatchSize);
+        var columnar = runGroup(groups[name]);
+
+        assert.eq(rowAtATime.results, columnar.results, name);
+        print(name + ": document-at-a-time " +
+              (rowAtATime.millis * 1000 / kNumDocs).toFixed(3) + " us/doc, columnar " +
+              (columnar.millis * 1000 / kNumDocs).toFixed(3) + " us/doc");
+    });
+
+    setBatchSize(defaultBatchSize);
+    coll.drop();
+})();
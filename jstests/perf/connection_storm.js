@@ -0,0 +1,70 @@
+/**
+ * Connection storm benchmark: opens a large number of client connections against a mongod and
+ * drives a small amount of work through all of them, once with a thread per connection and once
+ * with the fixedThreadPool service executor. Reports connect and request throughput together with
+ * the server's thread and memory usage for each mode.
+ */
+(function() {
+    'use strict';
+
+    var kNumConnections = 1000;
+    var kRequestsPerConnection = 10;
+    if (db.adminCommand("buildInfo").debug) {
+        kNumConnections = 200;
+    }
+
+    function runStorm(serviceExecutor) {
+        var conn = MongoRunner.runMongod(
+            {maxConns: kNumConnections + 100, setParameter: {serviceExecutor: serviceExecutor}});
+        assert.neq(null, conn, "mongod failed to start with serviceExecutor=" + serviceExecutor);
+        var host = conn.host;
+
+        var clients = [];
+        var connectMillis = Date.timeFunc(function() {
+            for (var i = 0; i < kNumConnections; i++) {
+                clients.push(new Mongo(host));
+            }
+        });
+
+        var requestMillis = Date.timeFunc(function() {
+            for (var r = 0; r < kRequestsPerConnection; r++) {
+                clients.forEach(function(client, i) {
+                    assert.writeOK(client.getDB("test").storm.insert({_id: r * kNumConnections + i}));
+                });
+            }
+        });
+
+        var status = assert.commandWorked(conn.adminCommand({serverStatus: 1}));
+        assert.gte(status.connections.current, kNumConnections);
+
+        var result = {
+            serviceExecutor: serviceExecutor,
+            connections: status.connections.current,
+            connectsPerSec: Math.round(kNumConnections * 1000 / Math.max(connectMillis, 1)),
+            requestsPerSec: Math.round(kNumConnections * kRequestsPerConnection * 1000 /
+                                       Math.max(requestMillis, 1)),
+            residentMB: status.mem.resident,
+        };
+
+        var taskStats = status.network.serviceExecutorTaskStats;
+        if (serviceExecutor === "fixedThreadPool") {
+            assert(taskStats, "missing serviceExecutorTaskStats: " + tojson(status.network));
+            // The number of workers must not grow with the number of connections.
+            assert.lt(taskStats.threadsRunning, kNumConnections, tojson(taskStats));
+            assert.gte(taskStats.totalExecuted, kNumConnections * kRequestsPerConnection);
+            result.taskStats = taskStats;
+        } else {
+            assert.eq(undefined, taskStats, tojson(status.network));
+        }
+
+        clients.forEach(function(client) {
+            client.close();
+        });
+        MongoRunner.stopMongod(conn);
+        return result;
+    }
+
+    var synchronous = runStorm("synchronous");
+    var fixed = runStorm("fixedThreadPool");
+    print("connection storm results: " + tojson({synchronous: synchronous, fixed: fixed}));
+}());
@@ -0,0 +1,56 @@
+/**
+ * Tests that a secondary with replPrefetchNextBatch enabled pages in upcoming batches while it
+ * applies the current one when running MMAPv1, and still applies every op.
+ */
+(function() {
+    'use strict';
+
+    var rst = new ReplSetTest({
+        name: "prefetch_next_batch",
+        nodes: [{}, {rsConfig: {priority: 0}, setParameter: {replPrefetchNextBatch: true}}]
+    });
+    rst.startSet();
+    rst.initiate();
+
+    var primary = rst.getPrimary();
+    var secondary = rst.getSecondary();
+    var testDB = primary.getDB("test");
+    assert.commandWorked(testDB.prefetch_next_batch.createIndex({a: 1}));
+
+    var numDocs = 5000;
+    var bulk = testDB.prefetch_next_batch.initializeUnorderedBulkOp();
+    for (var i = 0; i < numDocs; ++i) {
+        bulk.insert({_id: i, a: i});
+    }
+    assert.writeOK(bulk.execute({w: 2}));
+
+    // Updates look up the documents they modify, which the prefetcher pages in ahead of time.
+    bulk = testDB.prefetch_next_batch.initializeUnorderedBulkOp();
+    for (var i = 0; i < numDocs; ++i) {
+        bulk.find({_id: i}).updateOne({$inc: {a: numDocs}});
+    }
+    assert.writeOK(bulk.execute({w: 2}));
+
+    var secondaryColl = secondary.getDB("test").prefetch_next_batch;
+    assert.eq(numDocs, secondaryColl.find({a: {$gte: numDocs}}).itcount());
+
+    var stages = secondary.getDB("admin").serverStatus().metrics.repl.apply.stages;
+    printjson(stages);
+    assert.gt(stages.partition.num, 0, tojson(stages));
+    assert.gt(stages.oplogWrite.num, 0, tojson(stages));
+
+    // Only MMAPv1 prefetches.
+    var storageEngine = secondary.getDB("admin").serverStatus().storageEngine.name;
+    if (storageEngine === "mmapv1") {
+        assert.gt(stages.prefetch.num, 0, tojson(stages));
+    } else {
+        assert.eq(0, stages.prefetch.num, tojson(stages));
+    }
+
+    // The parameter can be turned off at runtime.
+    assert.commandWorked(secondary.adminCommand({setParameter: 1, replPrefetchNextBatch: false}));
+    assert.writeOK(testDB.prefetch_next_batch.insert({_id: numDocs}, {writeConcern: {w: 2}}));
+    assert.eq(numDocs + 1, secondaryColl.find().itcount());
+
+    rst.stopSet();
+})();
@@ -27,6 +27,10 @@ function testSecondaryMetrics(secondary, opCount, offset) {
 
     assert(ss.metrics.repl.apply.batches.num > 0, "no batches");
     assert(ss.metrics.repl.apply.batches.totalMillis >= 0, "missing batch time");
+    assert(ss.metrics.repl.apply.stages.waitForBatch.num > 0, "no waits for batches");
+    assert(ss.metrics.repl.apply.stages.partition.num > 0, "no batches partitioned");
+    assert(ss.metrics.repl.apply.stages.oplogWrite.num > 0, "no batches written to the oplog");
+    assert(ss.metrics.repl.apply.stages.prefetch.num >= 0, "prefetch stage missing");
     assert.eq(ss.metrics.repl.apply.ops, opCount + offset, "wrong number of applied ops");
 }
 
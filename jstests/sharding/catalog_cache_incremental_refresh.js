@@ -0,0 +1,52 @@
+// Tests that mongos refreshes the routing table of a collection incrementally after a chunk
+// change, rebuilding only the part of the table which the changed chunks touch, and that
+// serverStatus reports the refreshes.
+(function() {
+    'use strict';
+
+    var st = new ShardingTest({shards: 2, mongos: 2, other: {enableBalancer: false}});
+
+    var mongos = st.s0;
+    var otherMongos = st.s1;
+    var ns = "test.catalog_cache_incremental_refresh";
+
+    assert.commandWorked(mongos.adminCommand({enableSharding: "test"}));
+    st.ensurePrimaryShard("test", st.shard0.shardName);
+    assert.commandWorked(mongos.adminCommand({shardCollection: ns, key: {x: 1}}));
+
+    var numChunks = 1000;
+    for (var i = 1; i < numChunks; ++i) {
+        assert.commandWorked(mongos.adminCommand({split: ns, middle: {x: i}}));
+    }
+
+    var getMetrics = function(conn) {
+        return conn.getDB("admin").serverStatus().metrics.catalogCache;
+    };
+
+    // The other mongos has not loaded the collection yet, so it builds the whole routing table
+    var before = getMetrics(otherMongos);
+    assert.eq(0, otherMongos.getCollection(ns).find({x: 500}).itcount());
+    var after = getMetrics(otherMongos);
+    assert.eq(1, after.fullRefreshes - before.fullRefreshes, tojson(after));
+    assert.gte(after.chunksRefreshed - before.chunksRefreshed, numChunks, tojson(after));
+    assert.eq(0, after.chunkMapSegmentsShared - before.chunkMapSegmentsShared, tojson(after));
+
+    // A migration only changes two chunks, so most of the routing table is shared
+    assert.commandWorked(mongos.adminCommand(
+        {moveChunk: ns, find: {x: 500}, to: st.shard1.shardName, _waitForDelete: true}));
+
+    // The other mongos finds out about the migration through a stale shard version error
+    before = getMetrics(otherMongos);
+    assert.writeOK(otherMongos.getCollection(ns).insert({x: 500}));
+    assert.eq(1, otherMongos.getCollection(ns).find({x: 500}).itcount());
+    after = getMetrics(otherMongos);
+    assert.eq(0, after.fullRefreshes - before.fullRefreshes, tojson(after));
+    assert.gte(after.incrementalRefreshes - before.incrementalRefreshes, 1, tojson(after));
+    assert.lt(after.chunksRefreshed - before.chunksRefreshed, 10, tojson(after));
+    assert.gt(after.chunkMapSegmentsShared - before.chunkMapSegmentsShared,
+              after.chunkMapSegmentsRebuilt - before.chunkMapSegmentsRebuilt,
+              tojson(after));
+    assert.gt(after.refreshMicros, before.refreshMicros, tojson(after));
+
+    st.stop();
+})();
@@ -0,0 +1,65 @@
+// Tests that a sharded $group computes the same $avg and $stdDev results as an unsharded one when
+// the shards send the partial results of those accumulators in their binary form.
+(function() {
+    'use strict';
+
+    var st = new ShardingTest({shards: 2, other: {enableBalancer: false}});
+
+    var mongos = st.s0;
+    var testDB = mongos.getDB("test");
+    var sharded = testDB.group_binary_partial_states;
+    var unsharded = testDB.group_binary_partial_states_unsharded;
+
+    assert.commandWorked(mongos.adminCommand({enableSharding: "test"}));
+    st.ensurePrimaryShard("test", st.shard0.shardName);
+    assert.commandWorked(
+        mongos.adminCommand({shardCollection: sharded.getFullName(), key: {_id: 1}}));
+    assert.commandWorked(mongos.adminCommand({split: sharded.getFullName(), middle: {_id: 500}}));
+    assert.commandWorked(mongos.adminCommand(
+        {moveChunk: sharded.getFullName(), find: {_id: 500}, to: st.shard1.shardName}));
+
+    var bulkSharded = sharded.initializeUnorderedBulkOp();
+    var bulkUnsharded = unsharded.initializeUnorderedBulkOp();
+    for (var i = 0; i < 1000; ++i) {
+        var doc = {_id: i, k: i % 7, d: i * 1.5, n: NumberDecimal(i + ".25")};
+        bulkSharded.insert(doc);
+        bulkUnsharded.insert(doc);
+    }
+    assert.writeOK(bulkSharded.execute());
+    assert.writeOK(bulkUnsharded.execute());
+
+    var pipeline = [
+        {
+          $group: {
+              _id: "$k",
+              avgDouble: {$avg: "$d"},
+              avgDecimal: {$avg: "$n"},
+              stdDevPop: {$stdDevPop: "$d"},
+              stdDevSamp: {$stdDevSamp: "$_id"}
+          }
+        },
+        {$sort: {_id: 1}}
+    ];
+
+    // The shards are asked for the binary form of the partial results.
+    var explain = sharded.explain().aggregate(pipeline);
+    assert(explain.splitPipeline, tojson(explain));
+    var shardGroup = explain.splitPipeline.shardsPart[0].$group;
+    assert.eq(true, shardGroup.$binaryPartialStates, tojson(explain));
+
+    var shardedResults = sharded.aggregate(pipeline).toArray();
+    var unshardedResults = unsharded.aggregate(pipeline).toArray();
+    assert.eq(7, shardedResults.length);
+    assert.eq(unshardedResults.length, shardedResults.length);
+    for (var j = 0; j < shardedResults.length; ++j) {
+        var s = shardedResults[j];
+        var u = unshardedResults[j];
+        assert.eq(u._id, s._id);
+        assert.close(u.avgDouble, s.avgDouble, tojson(s));
+        assert.eq(u.avgDecimal, s.avgDecimal, tojson(s));
+        assert.close(u.stdDevPop, s.stdDevPop, tojson(s));
+        assert.close(u.stdDevSamp, s.stdDevSamp, tojson(s));
+    }
+
+    st.stop();
+})();
@@ -0,0 +1,53 @@
+// Tests that the recipient of a migration clones the chunk with several batches in flight, and
+// records the time spent in each phase of the clone in the changelog.
+(function() {
+    'use strict';
+
+    var st = new ShardingTest({shards: 2, mongos: 1, other: {enableBalancer: false}});
+
+    var mongos = st.s0;
+    var dbName = "test";
+    var ns = dbName + ".migration_clone_pipelined";
+    var coll = mongos.getCollection(ns);
+
+    assert.commandWorked(mongos.adminCommand({enableSharding: dbName}));
+    st.ensurePrimaryShard(dbName, st.shard0.shardName);
+    assert.commandWorked(mongos.adminCommand({shardCollection: ns, key: {x: 1}}));
+    assert.commandWorked(coll.createIndex({a: 1}));
+    assert.commandWorked(coll.createIndex({x: 1, u: 1}, {unique: true}));
+
+    assert.commandWorked(
+        st.shard1.adminCommand({setParameter: 1, migrateCloneBatchesInFlight: 4}));
+
+    // The documents take up several _migrateClone batches
+    var pad = new Array(16 * 1024).join("x");
+    var numDocs = 2000;
+    var bulk = coll.initializeUnorderedBulkOp();
+    for (var i = 0; i < numDocs; ++i) {
+        bulk.insert({x: i, u: i, a: i % 10, pad: pad});
+    }
+    assert.writeOK(bulk.execute());
+
+    assert.commandWorked(mongos.adminCommand(
+        {moveChunk: ns, find: {x: 0}, to: st.shard1.shardName, _waitForDelete: true}));
+
+    var recipientColl = st.shard1.getCollection(ns);
+    assert.eq(numDocs, recipientColl.find().itcount());
+    assert.eq(numDocs / 10, recipientColl.find({a: 3}).hint({a: 1}).itcount());
+
+    var indexNames = recipientColl.getIndexes().map(function(index) {
+        return index.name;
+    });
+    assert.contains("a_1", indexNames, tojson(indexNames));
+    assert.contains("x_1_u_1", indexNames, tojson(indexNames));
+
+    var changelog =
+        mongos.getDB("config").changelog.find({what: "moveChunk.to", ns: ns}).toArray();
+    assert.eq(1, changelog.length, tojson(changelog));
+    var phases = changelog[0].details.phases;
+    assert(phases, tojson(changelog[0]));
+    assert(phases.hasOwnProperty("cloneFetchWait"), tojson(phases));
+    assert(phases.hasOwnProperty("cloneInsert"), tojson(phases));
+
+    st.stop();
+})();
@@ -43,6 +43,7 @@
 #include "mongo/db/introspect.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/lasterror.h"
+#include "mongo/db/operation_memory_usage.h"
 #include "mongo/db/ops/write_ops_exec.h"
 #include "mongo/db/ops/write_ops_parsers.h"
 #include "mongo/db/query/find.h"
@@ -612,6 +613,7 @@ void assembleResponse(OperationContext* opCtx,
     currentOp.ensureStarted();
     currentOp.done();
     debug.executionTimeMicros = currentOp.totalTimeMicros();
+    debug.peakMemoryBytes = OperationMemoryUsage::get(opCtx).peakBytes();
 
     logThresholdMs += currentOp.getExpectedLatencyMs();
     Top::get(opCtx->getServiceContext())
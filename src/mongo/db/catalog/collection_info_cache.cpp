@@ -33,8 +33,11 @@
 #include "mongo/db/catalog/collection_info_cache.h"
 
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/database.h"
+#include "mongo/db/catalog/database_holder.h"
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/fts/fts_spec.h"
+#include "mongo/db/index/index_access_method.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/index_legacy.h"
 #include "mongo/db/query/plan_cache.h"
@@ -158,6 +161,87 @@ void CollectionInfoCache::clearQueryCache() {
     }
 }
 
+std::shared_ptr<const CollectionStatistics> CollectionInfoCache::getStatistics(
+    OperationContext* opCtx) {
+    uint64_t version;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_statisticsMutex);
+        if (_statisticsLoaded) {
+            return _statistics;
+        }
+        version = _statisticsVersion;
+    }
+
+    // Read the statistics without holding '_statisticsMutex', since this takes a lock and may go
+    // to disk.
+    std::shared_ptr<const CollectionStatistics> statistics;
+    const NamespaceString statisticsNss(_ns.db(), CollectionStatistics::kCollectionName);
+    Database* db = dbHolder().get(opCtx, _ns.db());
+    Lock::CollectionLock statisticsLock(opCtx->lockState(), statisticsNss.ns(), MODE_IS);
+    Collection* statisticsCollection = db ? db->getCollection(opCtx, statisticsNss) : nullptr;
+    const IndexDescriptor* idIndex = statisticsCollection
+        ? statisticsCollection->getIndexCatalog()->findIdIndex(opCtx)
+        : nullptr;
+
+    Snapshotted<BSONObj> doc;
+    if (idIndex) {
+        const RecordId recordId =
+            statisticsCollection->getIndexCatalog()->getIndex(idIndex)->findSingle(
+                opCtx, BSON("_id" << _ns.coll()));
+        if (!recordId.isNull() && statisticsCollection->findDoc(opCtx, recordId, &doc)) {
+            auto parsed = CollectionStatistics::parse(doc.value());
+            if (parsed.isOK()) {
+                statistics =
+                    std::make_shared<const CollectionStatistics>(std::move(parsed.getValue()));
+            } else {
+                warning() << "Ignoring invalid statistics of " << _ns << ": "
+                          << parsed.getStatus();
+            }
+        }
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(_statisticsMutex);
+    if (_statisticsVersion == version) {
+        _statistics = statistics;
+        _statisticsLoaded = true;
+    }
+    return statistics;
+}
+
+void CollectionInfoCache::setStatistics(std::shared_ptr<const CollectionStatistics> statistics) {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_statisticsMutex);
+        _statistics = std::move(statistics);
+        _statisticsLoaded = true;
+        ++_statisticsVersion;
+    }
+    clearQueryCache();
+}
+
+void CollectionInfoCache::invalidateStatistics() {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_statisticsMutex);
+        _statistics.reset();
+        _statisticsLoaded = false;
+        ++_statisticsVersion;
+    }
+    clearQueryCache();
+}
+
+void CollectionInfoCache::onStatisticsChange(OperationContext* opCtx,
+                                             const NamespaceString& statisticsNss) {
+    dassert(opCtx->lockState()->isDbLockedForMode(statisticsNss.db(), MODE_IX));
+    Database* db = dbHolder().get(opCtx, statisticsNss.db());
+
+    if (db) {
+        opCtx->recoveryUnit()->onCommit([db]() {
+            for (auto&& collection : *db) {
+                collection->infoCache()->invalidateStatistics();
+            }
+        });
+    }
+}
+
 PlanCache* CollectionInfoCache::getPlanCache() const {
     return _planCache.get();
 }
@@ -28,10 +28,14 @@
 
 #pragma once
 
+#include <memory>
+
 #include "mongo/db/collection_index_usage_tracker.h"
+#include "mongo/db/query/collection_statistics.h"
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/query_settings.h"
 #include "mongo/db/update_index_data.h"
+#include "mongo/stdx/mutex.h"
 
 namespace mongo {
 
@@ -73,6 +77,36 @@ public:
      */
     CollectionIndexUsageMap getIndexUsageStats() const;
 
+    /**
+     * Returns the statistics which the 'analyze' command built for this collection, reading them
+     * from the database's system.statistics collection the first time after they were set or
+     * invalidated. Returns nullptr if the collection has not been analyzed.
+     *
+     * Must be called under at least a shared collection lock.
+     */
+    std::shared_ptr<const CollectionStatistics> getStatistics(OperationContext* opCtx);
+
+    /**
+     * Replaces the statistics returned by getStatistics(), and removes all cached query plans,
+     * since they were chosen without the new statistics.
+     */
+    void setStatistics(std::shared_ptr<const CollectionStatistics> statistics);
+
+    /**
+     * Forgets the statistics returned by getStatistics(), so that they are read from storage again
+     * when next needed, and removes all cached query plans.
+     */
+    void invalidateStatistics();
+
+    /**
+     * Called when the system.statistics collection 'statisticsNss' is written to, dropped or
+     * renamed, including by replication. Once the write commits, invalidates the statistics of
+     * all the collections in its database.
+     *
+     * Must be called under at least an intent exclusive lock on the database.
+     */
+    static void onStatisticsChange(OperationContext* opCtx, const NamespaceString& statisticsNss);
+
     /**
      * Builds internal cache state based on the current state of the Collection's IndexCatalog
      */
@@ -133,6 +167,15 @@ private:
     CollectionIndexUsageTracker _indexUsageTracker;
 
     bool _hasTTLIndex = false;
+
+    // Statistics built by the 'analyze' command. They are only read from storage when first
+    // needed, since most collections have none. '_statisticsMutex' is never held while reading
+    // them, so '_statisticsVersion' is bumped on every change, and a read which raced with one is
+    // not cached.
+    stdx::mutex _statisticsMutex;
+    bool _statisticsLoaded = false;
+    uint64_t _statisticsVersion = 0;
+    std::shared_ptr<const CollectionStatistics> _statistics;
 };
 
 }  // namespace mongo
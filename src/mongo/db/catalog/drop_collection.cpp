@@ -40,7 +40,9 @@
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/db_raii.h"
+#include "mongo/db/index/index_access_method.h"
 #include "mongo/db/index_builder.h"
+#include "mongo/db/query/collection_statistics.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/server_options.h"
 #include "mongo/db/service_context.h"
@@ -49,6 +51,40 @@
 
 namespace mongo {
 
+namespace {
+
+/**
+ * Removes the statistics which the 'analyze' command built for 'collectionName', so that a
+ * collection created later under the same name doesn't use them. Secondaries remove them when
+ * they replicate the deletion, rather than when they replicate the drop.
+ */
+void dropStatistics(OperationContext* opCtx,
+                    Database* db,
+                    const NamespaceString& collectionName) {
+    if (!opCtx->writesAreReplicated()) {
+        return;
+    }
+
+    const NamespaceString statisticsNss(collectionName.db(),
+                                        CollectionStatistics::kCollectionName);
+    Collection* statisticsCollection = db->getCollection(opCtx, statisticsNss);
+    const IndexDescriptor* idIndex = statisticsCollection
+        ? statisticsCollection->getIndexCatalog()->findIdIndex(opCtx)
+        : nullptr;
+    if (!idIndex) {
+        return;
+    }
+
+    const RecordId recordId =
+        statisticsCollection->getIndexCatalog()->getIndex(idIndex)->findSingle(
+            opCtx, BSON("_id" << collectionName.coll()));
+    if (!recordId.isNull()) {
+        statisticsCollection->deleteDocument(opCtx, recordId, nullptr);
+    }
+}
+
+}  // namespace
+
 Status dropCollection(OperationContext* opCtx,
                       const NamespaceString& collectionName,
                       BSONObjBuilder& result) {
@@ -90,6 +126,7 @@ Status dropCollection(OperationContext* opCtx,
 
             BackgroundOperation::assertNoBgOpInProgForNs(collectionName.ns());
 
+            dropStatistics(opCtx, db, collectionName);
             Status s = db->dropCollection(opCtx, collectionName.ns());
 
             if (!s.isOK()) {
@@ -34,6 +34,9 @@
 
 #include "mongo/db/catalog/index_create.h"
 
+#include <algorithm>
+#include <deque>
+
 #include "mongo/base/error_codes.h"
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/db/audit.h"
@@ -48,7 +51,11 @@
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/memory.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/util/concurrency/thread_name.h"
 #include "mongo/util/fail_point.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
@@ -89,6 +96,220 @@ public:
 
 } exportedMaxIndexBuildMemoryUsageParameter;
 
+AtomicInt32 indexBuildWorkerThreads(1);
+
+class ExportedIndexBuildWorkerThreadsParameter
+    : public ExportedServerParameter<std::int32_t, ServerParameterType::kStartupAndRuntime> {
+public:
+    ExportedIndexBuildWorkerThreadsParameter()
+        : ExportedServerParameter<std::int32_t, ServerParameterType::kStartupAndRuntime>(
+              ServerParameterSet::getGlobal(),
+              "indexBuildWorkerThreads",
+              &indexBuildWorkerThreads) {}
+
+    virtual Status validate(const std::int32_t& potentialNewValue) {
+        if (potentialNewValue < 1 || potentialNewValue > 64) {
+            return Status(ErrorCodes::BadValue,
+                          "indexBuildWorkerThreads must be between 1 and 64");
+        }
+
+        return Status::OK();
+    }
+
+} exportedIndexBuildWorkerThreadsParameter;
+
+namespace {
+
+// A parallel index build hands documents to its workers in batches of up to this many documents
+// or bytes.
+const size_t kKeyGenerationBatchDocs = 1000;
+const size_t kKeyGenerationBatchBytes = 1024 * 1024;
+
+// The number of batches per worker which may wait to be processed before the scan blocks.
+const size_t kMaxQueuedBatchesPerWorker = 2;
+
+}  // namespace
+
+/**
+ * Generates and sorts the keys of the documents scanned by a foreground index build on a set of
+ * worker threads. The scanning thread hands documents to add(), which queues them in batches.
+ * Each batch is processed by one worker, into that worker's own BulkBuilder for every index.
+ * finish() waits for each worker to sort its keys, leaving the sorted runs of every index to be
+ * merged by IndexAccessMethod::commitBulk().
+ */
+class MultiIndexBlock::KeyGenerationWorkers {
+    MONGO_DISALLOW_COPYING(KeyGenerationWorkers);
+
+public:
+    KeyGenerationWorkers(std::vector<IndexToBuild>* indexes,
+                         size_t numWorkers,
+                         size_t eachIndexBuildMaxMemoryUsageBytes)
+        : _indexes(indexes), _maxQueuedBatches(numWorkers * kMaxQueuedBatchesPerWorker) {
+        for (auto&& index : *_indexes) {
+            // The workers' BulkBuilders replace the one created by init() and share its budget.
+            index.bulk.reset();
+            for (size_t i = 0; i < numWorkers; i++) {
+                index.workerBulks.push_back(
+                    index.real->initiateBulk(eachIndexBuildMaxMemoryUsageBytes / numWorkers));
+            }
+        }
+
+        for (size_t i = 0; i < numWorkers; i++) {
+            _workers.emplace_back([this, i] { run(i); });
+        }
+    }
+
+    ~KeyGenerationWorkers() {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _aborted = true;
+        }
+        _workAvailable.notify_all();
+        join();
+    }
+
+    /**
+     * Queues 'doc' to have its keys generated. Returns an error if a worker has failed.
+     */
+    Status add(const BSONObj& doc, const RecordId& loc) {
+        _batchBytes += doc.objsize();
+        _batch.emplace_back(doc.getOwned(), loc);
+        if (_batch.size() < kKeyGenerationBatchDocs && _batchBytes < kKeyGenerationBatchBytes) {
+            return Status::OK();
+        }
+        return flush();
+    }
+
+    /**
+     * Waits for the keys of all the added documents to be generated and sorted. Returns an error
+     * if a worker has failed.
+     */
+    Status finish() {
+        Status status = flush();
+        if (!status.isOK()) {
+            return status;
+        }
+
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _noMoreInput = true;
+        }
+        _workAvailable.notify_all();
+        join();
+
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _status;
+    }
+
+private:
+    using Batch = std::vector<std::pair<BSONObj, RecordId>>;
+
+    Status flush() {
+        if (_batch.empty()) {
+            return Status::OK();
+        }
+
+        {
+            stdx::unique_lock<stdx::mutex> lk(_mutex);
+            _spaceAvailable.wait(
+                lk, [this] { return !_status.isOK() || _queue.size() < _maxQueuedBatches; });
+            if (!_status.isOK()) {
+                return _status;
+            }
+            _queue.push_back(std::move(_batch));
+        }
+        _workAvailable.notify_one();
+
+        _batch = Batch();
+        _batchBytes = 0;
+        return Status::OK();
+    }
+
+    void join() {
+        for (auto&& worker : _workers) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+    }
+
+    void run(size_t worker) {
+        setThreadName(str::stream() << "indexBuildWorker-" << worker);
+
+        try {
+            while (true) {
+                Batch batch;
+                {
+                    stdx::unique_lock<stdx::mutex> lk(_mutex);
+                    _workAvailable.wait(lk, [this] {
+                        return _aborted || !_status.isOK() || !_queue.empty() || _noMoreInput;
+                    });
+                    if (_aborted || !_status.isOK()) {
+                        return;
+                    }
+                    if (_queue.empty()) {
+                        break;
+                    }
+                    batch = std::move(_queue.front());
+                    _queue.pop_front();
+                }
+                _spaceAvailable.notify_one();
+
+                for (auto&& entry : batch) {
+                    insert(worker, entry.first, entry.second);
+                }
+            }
+
+            for (auto&& index : *_indexes) {
+                index.workerBulks[worker]->sort();
+            }
+        } catch (...) {
+            Status status = exceptionToStatus();
+            {
+                stdx::lock_guard<stdx::mutex> lk(_mutex);
+                if (_status.isOK()) {
+                    _status = status;
+                }
+            }
+            _workAvailable.notify_all();
+            _spaceAvailable.notify_all();
+        }
+    }
+
+    void insert(size_t worker, const BSONObj& doc, const RecordId& loc) {
+        for (auto&& index : *_indexes) {
+            if (index.filterExpression && !index.filterExpression->matchesBSON(doc)) {
+                continue;
+            }
+
+            // BulkBuilder::insert() doesn't use the OperationContext, which belongs to the
+            // scanning thread.
+            int64_t unused;
+            uassertStatusOK(
+                index.workerBulks[worker]->insert(nullptr, doc, loc, index.options, &unused));
+        }
+    }
+
+    std::vector<IndexToBuild>* const _indexes;
+    const size_t _maxQueuedBatches;
+
+    // The batch being filled by the scanning thread.
+    Batch _batch;
+    size_t _batchBytes = 0;
+
+    std::vector<stdx::thread> _workers;
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _workAvailable;
+    stdx::condition_variable _spaceAvailable;
+
+    // Everything below is protected by '_mutex'.
+    std::deque<Batch> _queue;
+    bool _noMoreInput = false;
+    bool _aborted = false;
+    Status _status = Status::OK();
+};
+
 
 /**
  * On rollback sets MultiIndexBlock::_needToCleanup to true.
@@ -210,9 +431,8 @@ StatusWith<std::vector<BSONObj>> MultiIndexBlock::init(const std::vector<BSONObj
 
     std::vector<BSONObj> indexInfoObjs;
     indexInfoObjs.reserve(indexSpecs.size());
-    std::size_t eachIndexBuildMaxMemoryUsageBytes = 0;
     if (!indexSpecs.empty()) {
-        eachIndexBuildMaxMemoryUsageBytes =
+        _eachIndexBuildMaxMemoryUsageBytes =
             static_cast<std::size_t>(maxIndexBuildMemoryUsageMegabytes.load()) * 1024 * 1024 /
             indexSpecs.size();
     }
@@ -241,7 +461,7 @@ StatusWith<std::vector<BSONObj>> MultiIndexBlock::init(const std::vector<BSONObj
         if (!_buildInBackground) {
             // Bulk build process requires foreground building as it assumes nothing is changing
             // under it.
-            index.bulk = index.real->initiateBulk(eachIndexBuildMaxMemoryUsageBytes);
+            index.bulk = index.real->initiateBulk(_eachIndexBuildMaxMemoryUsageBytes);
         }
 
         const IndexDescriptor* descriptor = index.block->getEntry()->descriptor();
@@ -255,7 +475,7 @@ StatusWith<std::vector<BSONObj>> MultiIndexBlock::init(const std::vector<BSONObj
         log() << "build index on: " << ns << " properties: " << descriptor->toString();
         if (index.bulk)
             log() << "\t building index using bulk method; build may temporarily use up to "
-                  << eachIndexBuildMaxMemoryUsageBytes / 1024 / 1024 << " megabytes of RAM";
+                  << _eachIndexBuildMaxMemoryUsageBytes / 1024 / 1024 << " megabytes of RAM";
 
         index.filterExpression = index.block->getEntry()->getFilterExpression();
 
@@ -295,6 +515,21 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(std::set<RecordId>* dupsO
 
     unsigned long long n = 0;
 
+    const size_t numWorkers = numKeyGenerationWorkers(numRecords);
+    std::unique_ptr<KeyGenerationWorkers> workers;
+    if (numWorkers) {
+        log() << "\t generating and sorting index keys on " << numWorkers << " worker threads";
+        workers = stdx::make_unique<KeyGenerationWorkers>(
+            &_indexes, numWorkers, _eachIndexBuildMaxMemoryUsageBytes);
+    }
+
+    const auto reportPhaseTimings = [this, numWorkers](BSONObj timings) {
+        stdx::lock_guard<Client> lk(*_opCtx->getClient());
+        CurOp::get(_opCtx)->setProgressDetails_inlock(BSON(
+            "indexBuild" << BSON("workerThreads" << static_cast<int>(numWorkers) << "phaseMillis"
+                                                 << timings)));
+    };
+
     PlanExecutor::YieldPolicy yieldPolicy;
     if (_buildInBackground) {
         invariant(_allowInterruption);
@@ -327,7 +562,8 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(std::set<RecordId>* dupsO
             progress->setTotalWhileRunning(_collection->numRecords(_opCtx));
 
             WriteUnitOfWork wunit(_opCtx);
-            Status ret = insert(objToIndex.value(), loc);
+            Status ret =
+                workers ? workers->add(objToIndex.value(), loc) : insert(objToIndex.value(), loc);
             if (_buildInBackground)
                 exec->saveState();
             if (ret.isOK()) {
@@ -393,15 +629,56 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(std::set<RecordId>* dupsO
 
     progress->finished();
 
+    const long long scanMillis = t.millis();
+    reportPhaseTimings(BSON("scan" << scanMillis));
+
+    long long sortMillis = 0;
+    if (workers) {
+        {
+            stdx::lock_guard<Client> lk(*_opCtx->getClient());
+            _opCtx->setMessage_inlock("Index Build: sorting keys");
+        }
+
+        Timer sortTimer;
+        Status status = workers->finish();
+        if (!status.isOK())
+            return status;
+        sortMillis = sortTimer.millis();
+        reportPhaseTimings(BSON("scan" << scanMillis << "sort" << sortMillis));
+    }
+
+    Timer bulkLoadTimer;
     Status ret = doneInserting(dupsOut);
     if (!ret.isOK())
         return ret;
+    const long long bulkLoadMillis = bulkLoadTimer.millis();
+    reportPhaseTimings(
+        BSON("scan" << scanMillis << "sort" << sortMillis << "bulkLoad" << bulkLoadMillis));
 
-    log() << "build index done.  scanned " << n << " total records. " << t.seconds() << " secs";
+    log() << "build index done.  scanned " << n << " total records. " << t.seconds() << " secs"
+          << " (scan: " << scanMillis << "ms, sort: " << sortMillis
+          << "ms, bulk load: " << bulkLoadMillis << "ms)";
 
     return Status::OK();
 }
 
+size_t MultiIndexBlock::numKeyGenerationWorkers(long long numRecords) const {
+    if (_buildInBackground) {
+        return 0;
+    }
+    for (auto&& index : _indexes) {
+        if (!index.bulk) {
+            return 0;
+        }
+    }
+
+    // Don't start more workers than there are batches of documents to give them.
+    const long long maxUsefulWorkers = numRecords / static_cast<long long>(kKeyGenerationBatchDocs);
+    const long long numWorkers =
+        std::min(static_cast<long long>(indexBuildWorkerThreads.load()), maxUsefulWorkers);
+    return numWorkers > 1 ? static_cast<size_t>(numWorkers) : 0;
+}
+
 Status MultiIndexBlock::insert(const BSONObj& doc, const RecordId& loc) {
     for (size_t i = 0; i < _indexes.size(); i++) {
         if (_indexes[i].filterExpression && !_indexes[i].filterExpression->matchesBSON(doc)) {
@@ -424,15 +701,21 @@ Status MultiIndexBlock::insert(const BSONObj& doc, const RecordId& loc) {
 
 Status MultiIndexBlock::doneInserting(std::set<RecordId>* dupsOut) {
     for (size_t i = 0; i < _indexes.size(); i++) {
-        if (_indexes[i].bulk == NULL)
+        if (_indexes[i].bulk == NULL && _indexes[i].workerBulks.empty())
             continue;
         LOG(1) << "\t bulk commit starting for index: "
                << _indexes[i].block->getEntry()->descriptor()->indexName();
-        Status status = _indexes[i].real->commitBulk(_opCtx,
-                                                     std::move(_indexes[i].bulk),
-                                                     _allowInterruption,
-                                                     _indexes[i].options.dupsAllowed,
-                                                     dupsOut);
+        Status status = _indexes[i].bulk
+            ? _indexes[i].real->commitBulk(_opCtx,
+                                           std::move(_indexes[i].bulk),
+                                           _allowInterruption,
+                                           _indexes[i].options.dupsAllowed,
+                                           dupsOut)
+            : _indexes[i].real->commitBulk(_opCtx,
+                                           std::move(_indexes[i].workerBulks),
+                                           _allowInterruption,
+                                           _indexes[i].options.dupsAllowed,
+                                           dupsOut);
         if (!status.isOK()) {
             return status;
         }
@@ -39,9 +39,13 @@
 #include "mongo/base/status.h"
 #include "mongo/db/index/index_access_method.h"
 #include "mongo/db/record_id.h"
+#include "mongo/platform/atomic_word.h"
 
 namespace mongo {
 
+// The number of threads a foreground index build may use to generate and sort index keys.
+extern AtomicInt32 indexBuildWorkerThreads;
+
 class BackgroundOperation;
 class BSONObj;
 class Collection;
@@ -189,6 +193,7 @@ public:
 private:
     class SetNeedToCleanupOnRollback;
     class CleanupIndexesVectorOnRollback;
+    class KeyGenerationWorkers;
 
     struct IndexToBuild {
         std::unique_ptr<IndexCatalog::IndexBuildBlock> block;
@@ -197,11 +202,23 @@ private:
         const MatchExpression* filterExpression;  // might be NULL, owned elsewhere
         std::unique_ptr<IndexAccessMethod::BulkBuilder> bulk;
 
+        // Used instead of 'bulk' by a parallel build, with one BulkBuilder per worker thread.
+        std::vector<std::unique_ptr<IndexAccessMethod::BulkBuilder>> workerBulks;
+
         InsertDeleteOptions options;
     };
 
+    /**
+     * Returns the number of worker threads insertAllDocumentsInCollection() should use to generate
+     * and sort keys, or 0 if it should insert each document from the scanning thread.
+     */
+    size_t numKeyGenerationWorkers(long long numRecords) const;
+
     std::vector<IndexToBuild> _indexes;
 
+    // The memory budget of each index's bulk build.
+    std::size_t _eachIndexBuildMaxMemoryUsageBytes = 0;
+
     std::unique_ptr<BackgroundOperation> _backgroundOperation;
 
     // Pointers not owned here and must outlive 'this'
@@ -0,0 +1,302 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kQuery
+
+#include "mongo/platform/basic.h"
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "mongo/bson/util/bson_extract.h"
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/authorization_session.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/collection_info_cache.h"
+#include "mongo/db/catalog/database.h"
+#include "mongo/db/catalog/index_catalog.h"
+#include "mongo/db/client.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/concurrency/d_concurrency.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/dbhelpers.h"
+#include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/index_names.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/query/collection_statistics.h"
+#include "mongo/db/query/internal_plans.h"
+#include "mongo/db/repl/replication_coordinator_global.h"
+#include "mongo/util/log.h"
+
+namespace mongo {
+
+using std::string;
+using std::stringstream;
+
+namespace {
+
+const long long kDefaultSampleSize = 10000;
+const long long kMaxSampleSize = 1000 * 1000;
+const long long kDefaultBuckets = 64;
+const long long kMaxBuckets = 1000;
+
+/**
+ * Returns the fields of the key patterns of the collection's btree indexes, which are the fields
+ * the query planner can make use of statistics for.
+ */
+std::set<string> getIndexedFields(OperationContext* opCtx, Collection* collection) {
+    std::set<string> fields;
+    IndexCatalog::IndexIterator it =
+        collection->getIndexCatalog()->getIndexIterator(opCtx, false);
+    while (it.more()) {
+        const IndexDescriptor* desc = it.next();
+        if (IndexNames::findPluginName(desc->keyPattern()) != IndexNames::BTREE) {
+            continue;
+        }
+        for (auto&& elem : desc->keyPattern()) {
+            fields.insert(elem.fieldName());
+        }
+    }
+    return fields;
+}
+
+/**
+ * Returns about 'sampleSize' documents chosen at random from 'collection', or all of its
+ * documents if it doesn't have more than that. The sample is drawn from the record store's random
+ * cursor when it has one, and otherwise by reservoir sampling a scan of the whole collection,
+ * which yields. Returns an error if the operation is interrupted, or the collection is dropped
+ * while the scan yields.
+ */
+StatusWith<std::vector<BSONObj>> sampleCollection(OperationContext* opCtx,
+                                                  const NamespaceString& nss,
+                                                  Collection* collection,
+                                                  long long sampleSize) {
+    std::vector<BSONObj> sample;
+    const long long numRecords = collection->numRecords(opCtx);
+    if (numRecords > sampleSize) {
+        if (auto cursor = collection->getRecordStore()->getRandomCursor(opCtx)) {
+            while (static_cast<long long>(sample.size()) < sampleSize) {
+                Status interruptStatus = opCtx->checkForInterruptNoAssert();
+                if (!interruptStatus.isOK()) {
+                    return interruptStatus;
+                }
+                auto record = cursor->next();
+                if (!record) {
+                    break;
+                }
+                sample.push_back(record->data.toBson().getOwned());
+            }
+            return {std::move(sample)};
+        }
+    }
+
+    PseudoRandom& prng = opCtx->getClient()->getPrng();
+    auto exec =
+        InternalPlanner::collectionScan(opCtx, nss.ns(), collection, PlanExecutor::YIELD_AUTO);
+    long long seen = 0;
+    BSONObj obj;
+    PlanExecutor::ExecState state;
+    while (PlanExecutor::ADVANCED == (state = exec->getNext(&obj, nullptr))) {
+        ++seen;
+        if (static_cast<long long>(sample.size()) < sampleSize) {
+            sample.push_back(obj.getOwned());
+        } else {
+            const long long replace = prng.nextInt64(seen);
+            if (replace < sampleSize) {
+                sample[replace] = obj.getOwned();
+            }
+        }
+    }
+    if (PlanExecutor::IS_EOF != state) {
+        return Status(ErrorCodes::OperationFailed,
+                      str::stream() << "Executor error while sampling " << nss.ns() << ": "
+                                    << WorkingSetCommon::toStatusString(obj));
+    }
+    return {std::move(sample)};
+}
+
+/**
+ * Writes 'stats' to the database's system.statistics collection, under the name of the analyzed
+ * collection. Returns false without writing anything if this node can't accept writes.
+ */
+bool persistStatistics(OperationContext* opCtx,
+                       const NamespaceString& nss,
+                       const CollectionStatistics& stats) {
+    const NamespaceString statisticsNss(nss.db(), CollectionStatistics::kCollectionName);
+
+    BSONObjBuilder doc;
+    doc.append("_id", nss.coll());
+    stats.appendTo(&doc);
+    const BSONObj obj = doc.obj();
+
+    MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
+        Lock::DBLock dbLock(opCtx, nss.db(), MODE_X);
+        if (!repl::getGlobalReplicationCoordinator()->canAcceptWritesFor(opCtx, statisticsNss)) {
+            return false;
+        }
+        Helpers::upsert(opCtx, statisticsNss.ns(), obj);
+    }
+    MONGO_WRITE_CONFLICT_RETRY_LOOP_END(opCtx, "analyze", statisticsNss.ns());
+    return true;
+}
+
+}  // namespace
+
+/**
+ * Builds statistics of the values of a collection's fields from a random sample of its documents,
+ * which the query planner uses to estimate the cost of candidate plans.
+ */
+class AnalyzeCmd : public Command {
+public:
+    AnalyzeCmd() : Command("analyze") {}
+
+    virtual bool supportsWriteConcern(const BSONObj& cmd) const override {
+        return true;
+    }
+    virtual bool slaveOk() const {
+        return true;
+    }
+    virtual void help(stringstream& help) const {
+        help << "build statistics of a collection's field values for the query planner\n"
+                "{ analyze : <collection_name>, [sampleSize : <n>], [buckets : <n>],"
+                " [fields : [<path>, ...]] }\n"
+                " fields defaults to the fields of the collection's btree indexes\n";
+    }
+    virtual Status checkAuthForCommand(Client* client,
+                                       const std::string& dbname,
+                                       const BSONObj& cmdObj) {
+        AuthorizationSession* authzSession = AuthorizationSession::get(client);
+        ResourcePattern pattern = parseResourcePattern(dbname, cmdObj);
+
+        if (authzSession->isAuthorizedForActionsOnResource(pattern, ActionType::planCacheWrite)) {
+            return Status::OK();
+        }
+
+        return Status(ErrorCodes::Unauthorized, "unauthorized");
+    }
+
+    virtual bool run(OperationContext* opCtx,
+                     const string& dbname,
+                     BSONObj& cmdObj,
+                     string& errmsg,
+                     BSONObjBuilder& result) {
+        const NamespaceString nss = parseNsCollectionRequired(dbname, cmdObj);
+        if (!nss.isNormal()) {
+            errmsg = "bad namespace name";
+            return false;
+        }
+
+        long long sampleSize;
+        Status status = bsonExtractIntegerFieldWithDefault(
+            cmdObj, "sampleSize", kDefaultSampleSize, &sampleSize);
+        if (status.isOK() && (sampleSize <= 0 || sampleSize > kMaxSampleSize)) {
+            status = Status(ErrorCodes::BadValue,
+                            str::stream() << "sampleSize must be between 1 and " << kMaxSampleSize);
+        }
+        if (!status.isOK()) {
+            return appendCommandStatus(result, status);
+        }
+
+        long long buckets;
+        status = bsonExtractIntegerFieldWithDefault(cmdObj, "buckets", kDefaultBuckets, &buckets);
+        if (status.isOK() && (buckets <= 0 || buckets > kMaxBuckets)) {
+            status = Status(ErrorCodes::BadValue,
+                            str::stream() << "buckets must be between 1 and " << kMaxBuckets);
+        }
+        if (!status.isOK()) {
+            return appendCommandStatus(result, status);
+        }
+
+        std::set<string> fields;
+        if (BSONElement fieldsElt = cmdObj["fields"]) {
+            if (fieldsElt.type() != Array) {
+                return appendCommandStatus(
+                    result, Status(ErrorCodes::TypeMismatch, "fields must be an array"));
+            }
+            for (auto&& elem : fieldsElt.Obj()) {
+                if (elem.type() != String || elem.valueStringData().empty()) {
+                    return appendCommandStatus(
+                        result,
+                        Status(ErrorCodes::BadValue, "fields must be non-empty field paths"));
+                }
+                fields.insert(elem.str());
+            }
+        }
+
+        CollectionStatistics stats;
+        {
+            AutoGetCollectionForReadCommand ctx(opCtx, nss);
+            Collection* collection = ctx.getCollection();
+            if (!collection) {
+                return appendCommandStatus(
+                    result, Status(ErrorCodes::NamespaceNotFound, "collection not found"));
+            }
+
+            if (fields.empty()) {
+                fields = getIndexedFields(opCtx, collection);
+            }
+
+            auto swSample = sampleCollection(opCtx, nss, collection, sampleSize);
+            if (!swSample.isOK()) {
+                return appendCommandStatus(result, swSample.getStatus());
+            }
+            const std::vector<BSONObj>& sample = swSample.getValue();
+            stats.numRecords = collection->numRecords(opCtx);
+            stats.sampleSize = sample.size();
+            stats.analyzedAt = Date_t::now();
+            for (auto&& field : fields) {
+                stats.fields.emplace(
+                    field, FieldStatistics::build(field, sample, stats.numRecords, buckets));
+            }
+        }
+
+        const bool persisted = persistStatistics(opCtx, nss, stats);
+
+        {
+            AutoGetCollectionForReadCommand ctx(opCtx, nss);
+            if (Collection* collection = ctx.getCollection()) {
+                collection->infoCache()->setStatistics(
+                    std::make_shared<const CollectionStatistics>(stats));
+            }
+        }
+
+        LOG(1) << "Analyzed " << stats.fields.size() << " fields of " << nss << " from "
+               << stats.sampleSize << " sampled documents";
+
+        stats.appendTo(&result);
+        result.append("persisted", persisted);
+        return true;
+    }
+} analyzeCmd;
+
+}  // namespace mongo
@@ -44,6 +44,7 @@
 #include "mongo/db/matcher/matcher.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/operation_memory_usage.h"
 #include "mongo/db/stats/fill_locker_info.h"
 #include "mongo/rpc/metadata/client_metadata.h"
 #include "mongo/rpc/metadata/client_metadata_ismaster.h"
@@ -162,6 +163,11 @@ public:
 
                 CurOp::get(opCtx)->reportState(&infoBuilder);
 
+                const long long peakMemoryBytes = OperationMemoryUsage::get(opCtx).peakBytes();
+                if (peakMemoryBytes > 0) {
+                    infoBuilder.append("peakMemoryBytes", peakMemoryBytes);
+                }
+
                 // LockState
                 Locker::LockerInfo lockerInfo;
                 opCtx->lockState()->getLockerInfo(&lockerInfo);
@@ -228,6 +228,15 @@ Status PlanCacheListQueryShapes::runPlanCacheCommand(OperationContext* opCtx,
     // This is a read lock. The query cache is owned by the collection.
     AutoGetCollectionForReadCommand ctx(opCtx, NamespaceString(ns));
 
+    bool includeStats = false;
+    BSONElement statsElt = cmdObj.getField("stats");
+    if (!statsElt.eoo()) {
+        if (!statsElt.isBoolean()) {
+            return Status(ErrorCodes::BadValue, "stats must be a boolean");
+        }
+        includeStats = statsElt.boolean();
+    }
+
     PlanCache* planCache;
     Status status = getPlanCache(opCtx, ctx.getCollection(), ns, &planCache);
     if (!status.isOK()) {
@@ -236,11 +245,47 @@ Status PlanCacheListQueryShapes::runPlanCacheCommand(OperationContext* opCtx,
         arrayBuilder.doneFast();
         return Status::OK();
     }
-    return list(*planCache, bob);
+    return list(*planCache, bob, includeStats);
+}
+
+namespace {
+
+void appendPlanCacheStats(const PlanCacheStats& stats, BSONObjBuilder* bob) {
+    bob->appendNumber("hits", stats.hits);
+    bob->appendNumber("misses", stats.misses);
+    bob->appendNumber("evictions", stats.evictions);
+}
+
+/**
+ * Appends the non-empty buckets of 'histogram' to 'bob' as an array of {lowerBound, count}.
+ */
+void appendHistogram(const PlanCacheRuntimeStats::Histogram& histogram,
+                     StringData fieldName,
+                     BSONObjBuilder* bob) {
+    BSONArrayBuilder bucketsBuilder(bob->subarrayStart(fieldName));
+    for (size_t i = 0; i < histogram.size(); ++i) {
+        if (histogram[i] == 0) {
+            continue;
+        }
+        BSONObjBuilder bucketBuilder(bucketsBuilder.subobjStart());
+        bucketBuilder.appendNumber("lowerBound", (1LL << i) - 1);
+        bucketBuilder.appendNumber("count", histogram[i]);
+    }
 }
 
+void appendRuntimeStats(const PlanCacheRuntimeStats& stats, BSONObjBuilder* bob) {
+    bob->appendNumber("executions", stats.executions);
+    appendHistogram(stats.keysExamined, "keysExamined", bob);
+    appendHistogram(stats.docsExamined, "docsExamined", bob);
+    appendHistogram(stats.latencyMicros, "latencyMicros", bob);
+}
+
+}  // namespace
+
 // static
-Status PlanCacheListQueryShapes::list(const PlanCache& planCache, BSONObjBuilder* bob) {
+Status PlanCacheListQueryShapes::list(const PlanCache& planCache,
+                                      BSONObjBuilder* bob,
+                                      bool includeStats) {
     invariant(bob);
 
     // Fetch all cached solutions from plan cache.
@@ -258,6 +303,11 @@ Status PlanCacheListQueryShapes::list(const PlanCache& planCache, BSONObjBuilder
         if (!entry->collation.isEmpty()) {
             shapeBuilder.append("collation", entry->collation);
         }
+        if (includeStats) {
+            BSONObjBuilder statsBuilder(shapeBuilder.subobjStart("stats"));
+            appendPlanCacheStats(entry->shapeStats, &statsBuilder);
+            statsBuilder.doneFast();
+        }
         shapeBuilder.doneFast();
 
         // Release resources for cached solution after extracting query shape.
@@ -265,6 +315,13 @@ Status PlanCacheListQueryShapes::list(const PlanCache& planCache, BSONObjBuilder
     }
     arrayBuilder.doneFast();
 
+    if (includeStats) {
+        BSONObjBuilder statsBuilder(bob->subobjStart("stats"));
+        appendPlanCacheStats(planCache.getStats(), &statsBuilder);
+        statsBuilder.appendNumber("entries", static_cast<long long>(planCache.size()));
+        statsBuilder.doneFast();
+    }
+
     return Status::OK();
 }
 
@@ -439,6 +496,25 @@ Status PlanCacheListPlans::list(OperationContext* opCtx,
     }
     plansBuilder.doneFast();
 
+    // The winning plans which were cached for this query shape before being replaced, and which
+    // are tried before replanning from scratch.
+    BSONArrayBuilder alternatesBuilder(bob->subarrayStart("alternatePlans"));
+    for (auto&& alternate : entry->alternates) {
+        BSONObjBuilder alternateBob(alternatesBuilder.subobjStart());
+        SolutionCacheData* scd = alternate->plannerData[0];
+        BSONObjBuilder detailsBob(alternateBob.subobjStart("details"));
+        detailsBob.append("solution", scd->toString());
+        detailsBob.doneFast();
+        alternateBob.appendNumber(
+            "works", static_cast<long long>(alternate->decision->stats[0]->common.works));
+        alternateBob.append("filterSet", scd->indexFilterApplied);
+    }
+    alternatesBuilder.doneFast();
+
+    BSONObjBuilder runtimeStatsBob(bob->subobjStart("runtimeStats"));
+    appendRuntimeStats(entry->runtimeStats, &runtimeStatsBob);
+    runtimeStatsBob.doneFast();
+
     return Status::OK();
 }
 
@@ -105,8 +105,10 @@ private:
 /**
  * planCacheListQueryShapes
  *
- * { planCacheListQueryShapes: <collection> }
+ * { planCacheListQueryShapes: <collection>, stats: <bool> }
  *
+ * When 'stats' is true, each shape and the result as a whole report plan cache hits, misses and
+ * evictions.
  */
 class PlanCacheListQueryShapes : public PlanCacheCommand {
 public:
@@ -118,9 +120,10 @@ public:
 
     /**
      * Looks up cache keys for collection's plan cache.
-     * Inserts keys for query into BSON builder.
+     * Inserts keys for query into BSON builder. If 'includeStats' is true, also appends the
+     * lookup statistics of each query shape and of the cache as a whole.
      */
-    static Status list(const PlanCache& planCache, BSONObjBuilder* bob);
+    static Status list(const PlanCache& planCache, BSONObjBuilder* bob, bool includeStats = false);
 };
 
 /**
@@ -163,6 +163,45 @@ TEST(PlanCacheCommandsTest, planCacheListQueryShapesOneKey) {
     ASSERT_BSONOBJ_EQ(shapes[0].getObjectField("collation"), cq->getCollator()->getSpec().toBSON());
 }
 
+TEST(PlanCacheCommandsTest, planCacheListQueryShapesWithStats) {
+    QueryTestServiceContext serviceContext;
+    auto opCtx = serviceContext.makeOperationContext();
+
+    // Create a canonical query
+    auto qr = stdx::make_unique<QueryRequest>(nss);
+    qr->setFilter(fromjson("{a: 1}"));
+    auto statusWithCQ = CanonicalQuery::canonicalize(
+        opCtx.get(), std::move(qr), ExtensionsCallbackDisallowExtensions());
+    ASSERT_OK(statusWithCQ.getStatus());
+    unique_ptr<CanonicalQuery> cq = std::move(statusWithCQ.getValue());
+
+    // Plan cache with one entry, looked up twice.
+    PlanCache planCache;
+    QuerySolution qs;
+    qs.cacheData.reset(createSolutionCacheData());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+    planCache.add(*cq, solns, createDecision(1U));
+    for (int i = 0; i < 2; ++i) {
+        CachedSolution* cachedSolution;
+        ASSERT_OK(planCache.get(*cq, &cachedSolution));
+        delete cachedSolution;
+    }
+
+    // Statistics are only reported when asked for.
+    ASSERT_FALSE(getShapes(planCache)[0].hasField("stats"));
+
+    BSONObjBuilder bob;
+    ASSERT_OK(PlanCacheListQueryShapes::list(planCache, &bob, true));
+    BSONObj resultObj = bob.obj();
+    vector<BSONElement> shapes = resultObj.getField("shapes").Array();
+    ASSERT_EQUALS(shapes.size(), 1U);
+    ASSERT_BSONOBJ_EQ(shapes[0].Obj().getObjectField("stats"),
+                      BSON("hits" << 2 << "misses" << 0 << "evictions" << 0));
+    ASSERT_BSONOBJ_EQ(resultObj.getObjectField("stats"),
+                      BSON("hits" << 2 << "misses" << 0 << "evictions" << 0 << "entries" << 1));
+}
+
 /**
  * Tests for planCacheClear
  */
@@ -55,7 +55,7 @@
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/plan_summary_stats.h"
 #include "mongo/db/service_context.h"
-#include "mongo/db/storage/storage_options.h"
+#include "mongo/db/sorter/sorter_spill.h"
 #include "mongo/db/views/view.h"
 #include "mongo/db/views/view_catalog.h"
 #include "mongo/db/views/view_sharding_check.h"
@@ -361,7 +361,7 @@ Status runAggregate(OperationContext* opCtx,
                                   request,
                                   std::move(collatorToUse),
                                   uassertStatusOK(resolveInvolvedNamespaces(opCtx, request))));
-        expCtx->tempDir = storageGlobalParams.dbpath + "/_tmp";
+        expCtx->tempDir = sorter::getSpillDirectory();
 
         // Parse the pipeline.
         auto statusWithPipeline = Pipeline::parse(request.getPipeline(), expCtx);
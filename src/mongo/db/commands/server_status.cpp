@@ -48,6 +48,7 @@
 #include "mongo/db/stats/counters.h"
 #include "mongo/platform/process_id.h"
 #include "mongo/transport/message_compressor_registry.h"
+#include "mongo/transport/service_executor.h"
 #include "mongo/transport/transport_layer.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/hostname_canonicalization.h"
@@ -281,6 +282,9 @@ public:
         BSONObjBuilder b;
         networkCounter.append(b);
         appendMessageCompressionStats(&b);
+        if (auto executor = opCtx->getServiceContext()->getServiceExecutor()) {
+            executor->appendStats(&b);
+        }
         return b.obj();
     }
 
@@ -314,7 +314,7 @@ LockResult LockerImpl<IsForMMAPV1>::lockGlobalBegin(LockMode mode) {
         auto holder = ticketHolders[mode];
         if (holder) {
             _clientState.store(reader ? kQueuedReader : kQueuedWriter);
-            holder->waitForTicket();
+            holder->waitForTicket(_admissionPriority);
         }
         _clientState.store(reader ? kActiveReader : kActiveWriter);
         _modeForTicket = mode;
@@ -642,7 +642,16 @@ void LockerImpl<IsForMMAPV1>::restoreLockState(const Locker::LockSnapshot& state
         it++;
     }
 
+    // An operation which has yielded is likely to run for a while longer, so it waits for a ticket
+    // behind operations which are just starting. The ticket holder bounds how many of them it lets
+    // go first, so a steady stream of new operations cannot starve it.
+    const auto admissionPriority = _admissionPriority;
+    if (admissionPriority == AdmissionPriority::kNormal) {
+        _admissionPriority = AdmissionPriority::kLow;
+    }
     invariant(LOCK_OK == lockGlobal(state.globalMode));
+    _admissionPriority = admissionPriority;
+
     for (; it != state.locks.end(); it++) {
         // This is a sanity check that lockGlobal restored the MMAP V1 flush lock in the
         // expected mode.
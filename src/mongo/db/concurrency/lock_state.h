@@ -95,6 +95,10 @@ public:
 
     virtual ClientState getClientState() const;
 
+    virtual void setAdmissionPriority(AdmissionPriority priority) {
+        _admissionPriority = priority;
+    }
+
     virtual LockerId getId() const {
         return _id;
     }
@@ -225,6 +229,9 @@ private:
     // Indicates whether the client is active reader/writer or is queued.
     AtomicWord<ClientState> _clientState{kInactive};
 
+    // The priority with which to queue for a ticket.
+    AdmissionPriority _admissionPriority = AdmissionPriority::kNormal;
+
     // Track the thread who owns the lock for debugging purposes
     stdx::thread::id _threadId;
 
@@ -34,6 +34,7 @@
 #include "mongo/db/concurrency/lock_manager.h"
 #include "mongo/db/concurrency/lock_stats.h"
 #include "mongo/stdx/thread.h"
+#include "mongo/util/concurrency/ticketholder.h"
 
 namespace mongo {
 
@@ -81,6 +82,13 @@ public:
      */
     virtual ClientState getClientState() const = 0;
 
+    /**
+     * Sets the priority with which this locker queues for a ticket when acquiring the global lock.
+     * Operations of normal priority queue at low priority when restoring their locks after a
+     * yield.
+     */
+    virtual void setAdmissionPriority(AdmissionPriority priority) = 0;
+
     virtual LockerId getId() const = 0;
 
     /**
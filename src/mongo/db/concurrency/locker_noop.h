@@ -49,6 +49,8 @@ public:
         invariant(false);
     }
 
+    virtual void setAdmissionPriority(AdmissionPriority priority) {}
+
     virtual LockerId getId() const {
         invariant(false);
     }
@@ -416,6 +416,10 @@ void CurOp::reportState(BSONObjBuilder* builder) {
         }
     }
 
+    if (!_progressDetails.isEmpty()) {
+        builder->append("progressDetails", _progressDetails);
+    }
+
     builder->append("numYields", _numYields);
 }
 
@@ -539,6 +543,10 @@ string OpDebug::report(Client* client,
         s << " writeConflicts:" << writeConflicts;
     }
 
+    if (peakMemoryBytes > 0) {
+        s << " peakMemoryBytes:" << peakMemoryBytes;
+    }
+
     if (!exceptionInfo.empty()) {
         s << " exception: " << redact(exceptionInfo.msg);
         if (exceptionInfo.code)
@@ -650,6 +658,10 @@ void OpDebug::append(const CurOp& curop,
         b.appendNumber("writeConflicts", writeConflicts);
     }
 
+    if (peakMemoryBytes > 0) {
+        b.appendNumber("peakMemoryBytes", peakMemoryBytes);
+    }
+
     b.appendNumber("numYield", curop.numYields());
 
     {
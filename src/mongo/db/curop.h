@@ -103,6 +103,10 @@ public:
     // True if a replan was triggered during the execution of this operation.
     bool replanned{false};
 
+    // The plan cache key of the query, if it is eligible for the plan cache. Set when its
+    // executor is built, so that its execution is recorded without computing the key again.
+    std::string planCacheKey;
+
     long long nMatched{-1};   // number of records that match the query
     long long nModified{-1};  // number of records written (no no-ops)
     long long ninserted{-1};
@@ -119,6 +123,10 @@ public:
     long long keysDeleted{0};   // Number of index keys removed.
     long long writeConflicts{0};
 
+    // The most memory the operation's query execution structures held at any one time, as
+    // accounted for by OperationMemoryUsage.
+    long long peakMemoryBytes{0};
+
     BSONObj execStats;  // Owned here.
 
     // error handling
@@ -423,6 +431,13 @@ public:
         _planSummary = std::move(summary);
     }
 
+    /**
+     * Sets operation-specific progress details, reported by currentOp as 'progressDetails'.
+     */
+    void setProgressDetails_inlock(BSONObj details) {
+        _progressDetails = details.getOwned();
+    }
+
 private:
     class CurOpStack;
 
@@ -460,6 +475,7 @@ private:
     long long _expectedLatencyMs{0};
 
     std::string _planSummary;
+    BSONObj _progressDetails;
 };
 
 /**
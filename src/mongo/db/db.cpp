@@ -100,6 +100,7 @@
 #include "mongo/db/service_context.h"
 #include "mongo/db/service_context_d.h"
 #include "mongo/db/service_entry_point_mongod.h"
+#include "mongo/db/sorter/sorter_spill.h"
 #include "mongo/db/startup_warnings_mongod.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/db/stats/snapshots.h"
@@ -121,6 +122,7 @@
 #include "mongo/stdx/future.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/thread.h"
+#include "mongo/transport/service_executor_fixed.h"
 #include "mongo/transport/transport_layer_legacy.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/cmdline_utils/censor_cmdline.h"
@@ -482,6 +484,17 @@ ExitCode _initAndListen(int listenPort) {
 
     getGlobalServiceContext()->setServiceEntryPoint(std::move(sep));
 
+    if (transport::isServiceExecutorFixedEnabled()) {
+        auto executor = stdx::make_unique<transport::ServiceExecutorFixed>(
+            transport::serviceExecutorFixedOptionsFromParameters());
+        auto res = executor->start();
+        if (!res.isOK()) {
+            error() << "Failed to start the service executor: " << res;
+            return EXIT_NET_ERROR;
+        }
+        getGlobalServiceContext()->setServiceExecutor(std::move(executor));
+    }
+
     // Create, start, and attach the TL
     auto transportLayer = stdx::make_unique<transport::TransportLayerLegacy>(options, sepPtr);
     auto res = transportLayer->setup();
@@ -571,6 +584,7 @@ ExitCode _initAndListen(int listenPort) {
 
     if (!storageGlobalParams.readOnly) {
         boost::filesystem::remove_all(storageGlobalParams.dbpath + "/_tmp/");
+        sorter::removeLeftoverSpillFiles();
     }
 
     if (mmapv1GlobalOptions.journalOptions & MMAPV1Options::JournalRecoverOnly)
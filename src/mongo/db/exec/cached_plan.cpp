@@ -77,10 +77,86 @@ Status CachedPlanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
     // make sense.
     ScopedTimer timer(getClock(), &_commonStats.executionTimeMillis);
 
+    auto trialResult = runTrialPeriod(yieldPolicy, _decisionWorks);
+    if (!trialResult.isOK()) {
+        return trialResult.getStatus();
+    }
+
+    if (TrialResult::kSucceeded == trialResult.getValue()) {
+        // The cached plan performed as expected. Update cache with stats from this run.
+        updatePlanCache();
+        return Status::OK();
+    }
+
+    if (TrialResult::kFailed == trialResult.getValue()) {
+        // On failure, fall back to replanning the whole query. We neither evict the
+        // existing cache entry nor cache the result of replanning.
+        const bool shouldCache = false;
+        return replan(yieldPolicy, shouldCache);
+    }
+
+    // If we're here, the trial period took more than its budget of work cycles. Before
+    // replanning from scratch, try the plans which were previously cached for this query shape,
+    // each within the budget of the works it originally took to be chosen. They were chosen for
+    // parameters of different selectivity, so one of them may suit this query. They are only
+    // looked up now, so that queries whose cached plan performs as expected don't copy them.
+    // If the shape has been evicted in the meantime, there are none to try.
+    std::vector<std::unique_ptr<CachedSolution>> alternates;
+    PlanCache* cache = _collection->infoCache()->getPlanCache();
+    cache->getAlternates(*_canonicalQuery, &alternates);
+
+    size_t failedDecisionWorks = _decisionWorks;
+    for (auto&& alternate : alternates) {
+        LOG(1) << "Execution of cached plan required more than "
+               << internalQueryCacheEvictionRatio * failedDecisionWorks
+               << " works, but was originally cached with only " << failedDecisionWorks
+               << " works. Trying alternate plan cached with " << alternate->decisionWorks
+               << " works for query: " << redact(_canonicalQuery->toStringShort())
+               << " plan summary before switching: "
+               << redact(Explain::getPlanSummary(child().get()));
+
+        Status switchStatus = switchToAlternatePlan(*alternate);
+        if (!switchStatus.isOK()) {
+            LOG(1) << "Could not build alternate cached plan: " << redact(switchStatus);
+            continue;
+        }
+
+        trialResult = runTrialPeriod(yieldPolicy, alternate->decisionWorks);
+        if (!trialResult.isOK()) {
+            return trialResult.getStatus();
+        }
+
+        if (TrialResult::kSucceeded == trialResult.getValue()) {
+            cache->promoteAlternate(*_canonicalQuery, *alternate);
+            _decisionWorks = alternate->decisionWorks;
+            updatePlanCache();
+            return Status::OK();
+        }
+
+        if (TrialResult::kFailed == trialResult.getValue()) {
+            const bool shouldCache = false;
+            return replan(yieldPolicy, shouldCache);
+        }
+        failedDecisionWorks = alternate->decisionWorks;
+    }
+
+    LOG(1) << "Execution of cached plan required more than "
+           << internalQueryCacheEvictionRatio * failedDecisionWorks
+           << " works, but was originally cached with only " << failedDecisionWorks
+           << " works. Evicting cache entry and replanning query: "
+           << redact(_canonicalQuery->toStringShort())
+           << " plan summary before replan: " << redact(Explain::getPlanSummary(child().get()));
+
+    const bool shouldCache = true;
+    return replan(yieldPolicy, shouldCache);
+}
+
+StatusWith<CachedPlanStage::TrialResult> CachedPlanStage::runTrialPeriod(
+    PlanYieldPolicy* yieldPolicy, size_t decisionWorks) {
     // If we work this many times during the trial period, then we will replan the
     // query from scratch.
     size_t maxWorksBeforeReplan =
-        static_cast<size_t>(internalQueryCacheEvictionRatio * _decisionWorks);
+        static_cast<size_t>(internalQueryCacheEvictionRatio * decisionWorks);
 
     // The trial period ends without replanning if the cached plan produces this many results.
     size_t numResults = MultiPlanStage::getTrialPeriodNumToReturn(*_canonicalQuery);
@@ -103,16 +179,12 @@ Status CachedPlanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
             _results.push_back(id);
 
             if (_results.size() >= numResults) {
-                // Once a plan returns enough results, stop working. Update cache with stats
-                // from this run and return.
-                updatePlanCache();
-                return Status::OK();
+                // Once a plan returns enough results, stop working.
+                return TrialResult::kSucceeded;
             }
         } else if (PlanStage::IS_EOF == state) {
-            // Cached plan hit EOF quickly enough. No need to replan. Update cache with stats
-            // from this run and return.
-            updatePlanCache();
-            return Status::OK();
+            // Cached plan hit EOF quickly enough. No need to replan.
+            return TrialResult::kSucceeded;
         } else if (PlanStage::NEED_YIELD == state) {
             if (id == WorkingSet::INVALID_ID) {
                 if (!yieldPolicy->canAutoYield()) {
@@ -134,8 +206,6 @@ Status CachedPlanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
                 return yieldStatus;
             }
         } else if (PlanStage::FAILURE == state) {
-            // On failure, fall back to replanning the whole query. We neither evict the
-            // existing cache entry nor cache the result of replanning.
             BSONObj statusObj;
             WorkingSetCommon::getStatusMemberObject(*_ws, id, &statusObj);
 
@@ -144,8 +214,7 @@ Status CachedPlanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
                    << " planSummary: " << redact(Explain::getPlanSummary(child().get()))
                    << " status: " << redact(statusObj);
 
-            const bool shouldCache = false;
-            return replan(yieldPolicy, shouldCache);
+            return TrialResult::kFailed;
         } else if (PlanStage::DEAD == state) {
             BSONObj statusObj;
             WorkingSetCommon::getStatusMemberObject(*_ws, id, &statusObj);
@@ -161,16 +230,29 @@ Status CachedPlanStage::pickBestPlan(PlanYieldPolicy* yieldPolicy) {
         }
     }
 
-    // If we're here, the trial period took more than 'maxWorksBeforeReplan' work cycles. This
-    // plan is taking too long, so we replan from scratch.
-    LOG(1) << "Execution of cached plan required " << maxWorksBeforeReplan
-           << " works, but was originally cached with only " << _decisionWorks
-           << " works. Evicting cache entry and replanning query: "
-           << redact(_canonicalQuery->toStringShort())
-           << " plan summary before replan: " << redact(Explain::getPlanSummary(child().get()));
+    return TrialResult::kTooManyWorks;
+}
 
-    const bool shouldCache = true;
-    return replan(yieldPolicy, shouldCache);
+Status CachedPlanStage::switchToAlternatePlan(const CachedSolution& alternate) {
+    QuerySolution* rawSolution;
+    Status status =
+        QueryPlanner::planFromCache(*_canonicalQuery, _plannerParams, alternate, &rawSolution);
+    if (!status.isOK()) {
+        return status;
+    }
+    std::unique_ptr<QuerySolution> solution(rawSolution);
+
+    // Clear out info from the plan we are switching away from.
+    _results.clear();
+    _ws->clear();
+    _children.clear();
+
+    PlanStage* newRoot;
+    verify(
+        StageBuilder::build(getOpCtx(), _collection, *_canonicalQuery, *solution, _ws, &newRoot));
+    _children.emplace_back(newRoot);
+    _replannedQs = std::move(solution);
+    return Status::OK();
 }
 
 Status CachedPlanStage::tryYield(PlanYieldPolicy* yieldPolicy) {
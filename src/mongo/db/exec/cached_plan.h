@@ -35,6 +35,7 @@
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/query_planner_params.h"
 #include "mongo/db/query/query_solution.h"
 #include "mongo/db/record_id.h"
@@ -82,12 +83,39 @@ public:
      * 'yieldPolicy'.
      *
      * Feedback from the trial period is passed to the plan cache. If the performance is lower
-     * than expected, the old plan is evicted and a new plan is selected from scratch (again
-     * yielding according to 'yieldPolicy'). Otherwise, the cached plan is run.
+     * than expected, each alternate plan is run for a trial period of its own, and the first one
+     * which performs as expected replaces the cached plan. If none does, the old plan is evicted
+     * and a new plan is selected from scratch (again yielding according to 'yieldPolicy').
+     * Otherwise, the cached plan is run.
      */
     Status pickBestPlan(PlanYieldPolicy* yieldPolicy);
 
 private:
+    enum class TrialResult {
+        // The plan produced enough results or hit EOF within its works budget.
+        kSucceeded,
+
+        // The plan used up its works budget first.
+        kTooManyWorks,
+
+        // The plan failed, so the query should be replanned without updating the plan cache.
+        kFailed,
+    };
+
+    /**
+     * Runs the current plan for a trial period of at most internalQueryCacheEvictionRatio times
+     * 'decisionWorks' work cycles, buffering its results.
+     *
+     * Returns a non-OK status if the plan died or was killed during a yield.
+     */
+    StatusWith<TrialResult> runTrialPeriod(PlanYieldPolicy* yieldPolicy, size_t decisionWorks);
+
+    /**
+     * Discards the current plan and its buffered results, and replaces it with the plan built
+     * from 'alternate'.
+     */
+    Status switchToAlternatePlan(const CachedSolution& alternate);
+
     /**
      * Passes stats from the trial period run of the cached plan to the plan cache.
      *
@@ -130,8 +158,8 @@ private:
     // cached.
     size_t _decisionWorks;
 
-    // If we fall back to re-planning the query, and there is just one resulting query solution,
-    // that solution is owned here.
+    // If we switch to an alternate plan, or fall back to re-planning the query and there is just
+    // one resulting query solution, that solution is owned here.
     std::unique_ptr<QuerySolution> _replannedQs;
 
     // Any results produced during trial period execution are kept here.
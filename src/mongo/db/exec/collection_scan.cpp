@@ -30,6 +30,8 @@
 
 #include "mongo/db/exec/collection_scan.h"
 
+#include <algorithm>
+
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
@@ -38,6 +40,7 @@
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/storage/record_fetcher.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/fail_point_service.h"
@@ -66,6 +69,8 @@ CollectionScan::CollectionScan(OperationContext* opCtx,
       _wsidForFetch(_workingSet->allocate()) {
     // Explain reports the direction of the collection scan.
     _specificStats.direction = params.direction;
+    invariant((params.minRecord.isNull() && params.maxRecord.isNull()) ||
+              params.direction == CollectionScanParams::FORWARD);
 }
 
 PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
@@ -88,6 +93,10 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
         return PlanStage::IS_EOF;
     }
 
+    if (_batchPosition < _batch.size()) {
+        return returnRecord(std::move(_batch[_batchPosition++]), _batchSnapshotId, out);
+    }
+
     boost::optional<Record> record;
     const bool needToMakeCursor = !_cursor;
     try {
@@ -134,6 +143,8 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
 
         if (_lastSeenId.isNull() && !_params.start.isNull()) {
             record = _cursor->seekExact(_params.start);
+        } else if (_lastSeenId.isNull() && !_params.minRecord.isNull()) {
+            record = _cursor->seekNear(_params.minRecord);
         } else {
             // See if the record we're about to access is in memory. If not, pass a fetch
             // request up.
@@ -145,9 +156,20 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
                 return PlanStage::NEED_YIELD;
             }
 
-            record = _cursor->next();
+            const size_t batchSize = getBatchSize();
+            if (batchSize > 1) {
+                _batch.clear();
+                _batchPosition = 0;
+                _batchSnapshotId = getOpCtx()->recoveryUnit()->getSnapshotId();
+                if (_cursor->nextBatch(&_batch, batchSize) > 0) {
+                    record = std::move(_batch[_batchPosition++]);
+                }
+            } else {
+                record = _cursor->next();
+            }
         }
     } catch (const WriteConflictException& wce) {
+        // Any records that nextBatch() read before the conflict are returned before reading more.
         // Leave us in a state to try again next time.
         if (needToMakeCursor)
             _cursor.reset();
@@ -168,12 +190,38 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
         return PlanStage::IS_EOF;
     }
 
-    _lastSeenId = record->id;
+    return returnRecord(std::move(*record), getOpCtx()->recoveryUnit()->getSnapshotId(), out);
+}
+
+size_t CollectionScan::getBatchSize() const {
+    const int batchSize = internalQueryExecCollectionScanBatchSize.load();
+    if (batchSize <= 1) {
+        return 1;
+    }
+
+    // Don't read past the records that maxScan allows us to examine.
+    if (0 != _params.maxScan) {
+        return std::min(static_cast<size_t>(batchSize),
+                        _params.maxScan - static_cast<size_t>(_specificStats.docsTested));
+    }
+    return batchSize;
+}
+
+PlanStage::StageState CollectionScan::returnRecord(Record record,
+                                                   SnapshotId snapshotId,
+                                                   WorkingSetID* out) {
+    if (!_params.maxRecord.isNull() && record.id > _params.maxRecord) {
+        _batch.clear();
+        _commonStats.isEOF = true;
+        return PlanStage::IS_EOF;
+    }
+
+    _lastSeenId = record.id;
 
     WorkingSetID id = _workingSet->allocate();
     WorkingSetMember* member = _workingSet->get(id);
-    member->recordId = record->id;
-    member->obj = {getOpCtx()->recoveryUnit()->getSnapshotId(), record->data.releaseToBson()};
+    member->recordId = record.id;
+    member->obj = {snapshotId, record.data.releaseToBson()};
     _workingSet->transitionToRecordIdAndObj(id);
 
     return returnIfMatches(member, id, out);
@@ -204,7 +252,7 @@ void CollectionScan::doInvalidate(OperationContext* opCtx,
                                   const RecordId& id,
                                   InvalidationType type) {
     // We don't care about mutations since we apply any filters to the result when we (possibly)
-    // return it.
+    // return it. Records read ahead of the scan are read again in doRestoreState().
     if (INVALIDATION_DELETION != type) {
         return;
     }
@@ -216,6 +264,14 @@ void CollectionScan::doInvalidate(OperationContext* opCtx,
         _cursor->invalidate(opCtx, id);
     }
 
+    // A record that was read ahead of the scan must not be returned once it has been deleted.
+    auto deleted = std::find_if(_batch.begin() + _batchPosition,
+                                _batch.end(),
+                                [&id](const Record& record) { return record.id == id; });
+    if (deleted != _batch.end()) {
+        _batch.erase(deleted);
+    }
+
     if (_params.tailable && id == _lastSeenId) {
         // This means that deletes have caught up to the reader. We want to error in this case
         // so readers don't miss potentially important data.
@@ -235,6 +291,22 @@ void CollectionScan::doRestoreState() {
             _isDead = true;
         }
     }
+
+    // Records read ahead of the scan may have been updated or deleted while we yielded. Not every
+    // storage engine reports this through doInvalidate(), and an unchanged snapshot id doesn't
+    // prove the copy is current, so read them again in the new snapshot.
+    if (_batchPosition < _batch.size()) {
+        const RecordStore* recordStore = _params.collection->getRecordStore();
+        auto out = _batch.begin() + _batchPosition;
+        for (auto it = out; it != _batch.end(); ++it) {
+            RecordData data;
+            if (recordStore->findRecord(getOpCtx(), it->id, &data)) {
+                *out++ = {it->id, data.getOwned()};
+            }
+        }
+        _batch.erase(out, _batch.end());
+        _batchSnapshotId = getOpCtx()->recoveryUnit()->getSnapshotId();
+    }
 }
 
 void CollectionScan::doDetachFromOperationContext() {
@@ -29,11 +29,14 @@
 #pragma once
 
 #include <memory>
+#include <vector>
 
 #include "mongo/db/exec/collection_scan_common.h"
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/record_id.h"
+#include "mongo/db/storage/record_store.h"
+#include "mongo/db/storage/snapshot.h"
 
 namespace mongo {
 
@@ -80,6 +83,17 @@ private:
      */
     StageState returnIfMatches(WorkingSetMember* member, WorkingSetID memberID, WorkingSetID* out);
 
+    /**
+     * Places 'record', which was read in the snapshot 'snapshotId', in a new working set member and
+     * returns it if it passes our filter.
+     */
+    StageState returnRecord(Record record, SnapshotId snapshotId, WorkingSetID* out);
+
+    /**
+     * Returns how many records to read from '_cursor' at a time.
+     */
+    size_t getBatchSize() const;
+
     // WorkingSet is not owned by us.
     WorkingSet* _workingSet;
 
@@ -94,6 +108,12 @@ private:
 
     RecordId _lastSeenId;  // Null if nothing has been returned from _cursor yet.
 
+    // Records read from '_cursor' by nextBatch() which have not been returned yet start at
+    // '_batch[_batchPosition]'. They own their data, which is read again after yielding.
+    std::vector<Record> _batch;
+    size_t _batchPosition = 0;
+    SnapshotId _batchSnapshotId;
+
     // We allocate a working set member with this id on construction of the stage. It gets used for
     // all fetch requests. This should only be used for passing up the Fetcher for a NEED_YIELD, and
     // should remain in the INVALID state.
@@ -48,6 +48,12 @@ struct CollectionScanParams {
     // not being invalidated before the first call to work(...).
     RecordId start;
 
+    // If non-null, a forward scan begins at the first record at or after 'minRecord' and ends after
+    // the last record at or before 'maxRecord'. Setting 'minRecord' requires a storage engine that
+    // implements SeekableRecordCursor::seekNear().
+    RecordId minRecord;
+    RecordId maxRecord;
+
     Direction direction = FORWARD;
 
     // Do we want the scan to be 'tailable'?  Only meaningful if the collection is capped.
@@ -0,0 +1,382 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/exec/parallel_collection_scan.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/client.h"
+#include "mongo/db/concurrency/locker_noop.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/exec/collection_scan.h"
+#include "mongo/db/exec/working_set.h"
+#include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/stdx/memory.h"
+
+namespace mongo {
+
+using std::unique_ptr;
+using std::vector;
+using stdx::make_unique;
+
+// static
+const char* ParallelCollectionScan::kStageType = "PARALLEL_COLLSCAN";
+
+ParallelCollectionScan::ParallelCollectionScan(OperationContext* opCtx,
+                                               const CollectionScanParams& params,
+                                               WorkingSet* workingSet,
+                                               const MatchExpression* filter,
+                                               size_t numWorkers)
+    : PlanStage(kStageType, opCtx),
+      _workingSet(workingSet),
+      _filter(filter),
+      _params(params),
+      _numWorkers(numWorkers) {
+    invariant(_numWorkers > 0);
+    invariant(_params.direction == CollectionScanParams::FORWARD);
+    invariant(!_params.tailable && 0 == _params.maxScan && _params.start.isNull());
+    _specificStats.numWorkers = _numWorkers;
+}
+
+ParallelCollectionScan::~ParallelCollectionScan() {
+    stopWorkers();
+}
+
+PlanStage::StageState ParallelCollectionScan::doWork(WorkingSetID* out) {
+    if (_commonStats.isEOF) {
+        return PlanStage::IS_EOF;
+    }
+
+    if (!_started) {
+        try {
+            if (!startWorkers()) {
+                _commonStats.isEOF = true;
+                return PlanStage::IS_EOF;
+            }
+        } catch (const WriteConflictException&) {
+            *out = WorkingSet::INVALID_ID;
+            return PlanStage::NEED_YIELD;
+        }
+        return PlanStage::NEED_TIME;
+    }
+
+    if (_workers.empty()) {
+        // The workers were stopped while the stage was detached.
+        launchWorkers();
+    }
+
+    if (_pendingResultPosition == _pendingResults.size()) {
+        _pendingResults.clear();
+        _pendingResultPosition = 0;
+
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        if (!_workerStatus.isOK()) {
+            *out = WorkingSetCommon::allocateStatusMember(_workingSet, _workerStatus);
+            return PlanStage::FAILURE;
+        }
+
+        if (_results.empty()) {
+            if (0 == _numRunning) {
+                _commonStats.isEOF = true;
+                return PlanStage::IS_EOF;
+            }
+
+            // Only wait briefly, so that our caller can still yield and check for interrupts
+            // while the workers scan for matching documents.
+            _stageCV.wait_for(lk, Milliseconds(1).toSystemDuration());
+            if (_results.empty()) {
+                return PlanStage::NEED_TIME;
+            }
+        }
+
+        _pendingResults.swap(_results);
+        _workerCV.notify_all();
+    }
+
+    Result& result = _pendingResults[_pendingResultPosition++];
+    WorkingSetID id = _workingSet->allocate();
+    WorkingSetMember* member = _workingSet->get(id);
+    member->recordId = result.first;
+    member->obj = {getOpCtx()->recoveryUnit()->getSnapshotId(), std::move(result.second)};
+    _workingSet->transitionToRecordIdAndObj(id);
+
+    *out = id;
+    return PlanStage::ADVANCED;
+}
+
+bool ParallelCollectionScan::isEOF() {
+    return _commonStats.isEOF;
+}
+
+void ParallelCollectionScan::doSaveState() {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    _paused = true;
+    _interruptWorkers.store(true);
+    _workerCV.notify_all();
+
+    // Our caller may release its locks once we return, so wait until no worker is reading.
+    _stageCV.wait(lk, [this] { return _numPaused == _numRunning; });
+}
+
+void ParallelCollectionScan::doRestoreState() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _paused = false;
+    _interruptWorkers.store(_stopping);
+    _workerCV.notify_all();
+}
+
+void ParallelCollectionScan::doDetachFromOperationContext() {
+    // The stage is saved, so the workers are paused. Each publishes what it has found as it stops.
+    stopWorkers();
+}
+
+bool ParallelCollectionScan::startWorkers() {
+    _started = true;
+
+    // Split the RecordIds between the first and last records into ranges of equal width. The
+    // first and last ranges are unbounded, so that records which move past either end while we
+    // scan are still found.
+    auto first = _params.collection->getCursor(getOpCtx(), true)->next();
+    auto last = _params.collection->getCursor(getOpCtx(), false)->next();
+    if (!first || !last) {
+        return false;
+    }
+
+    const size_t numRanges = _numWorkers * kRangesPerWorker;
+    const long long min = first->id.repr();
+    const long long width = (last->id.repr() - min) / static_cast<long long>(numRanges) + 1;
+    for (size_t i = 0; i < numRanges; ++i) {
+        CollectionScanParams params = _params;
+        if (i > 0) {
+            params.minRecord = RecordId(min + static_cast<long long>(i) * width);
+        }
+        if (i + 1 < numRanges) {
+            params.maxRecord = RecordId(min + static_cast<long long>(i + 1) * width - 1);
+        }
+        _ranges.push_back(params);
+    }
+
+    launchWorkers();
+    return true;
+}
+
+void ParallelCollectionScan::launchWorkers() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (_stopping || _nextRange == _ranges.size()) {
+        return;
+    }
+    for (size_t i = 0; i < _numWorkers; ++i) {
+        _workers.emplace_back([this] { runWorker(); });
+        ++_numRunning;
+    }
+}
+
+void ParallelCollectionScan::runWorker() {
+    Client::initThread("parallelCollectionScan");
+    auto opCtx = cc().makeOperationContext();
+
+    // Workers read under the locks of the operation which owns this stage.
+    opCtx->releaseLockState();
+    opCtx->setLockState(make_unique<LockerNoop>());
+
+    Status status = Status::OK();
+    try {
+        while (true) {
+            CollectionScanParams params;
+            {
+                stdx::unique_lock<stdx::mutex> lk(_mutex);
+                if (!waitWhilePaused(lk, opCtx.get(), nullptr) || _nextRange == _ranges.size()) {
+                    break;
+                }
+                params = _ranges[_nextRange++];
+            }
+
+            if (!scanRange(opCtx.get(), params)) {
+                break;
+            }
+        }
+    } catch (const DBException& ex) {
+        status = ex.toStatus();
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (!status.isOK() && _workerStatus.isOK()) {
+        // There is no point in the other workers continuing.
+        _workerStatus = status;
+        _stopping = true;
+        _interruptWorkers.store(true);
+        _workerCV.notify_all();
+    }
+    --_numRunning;
+    _stageCV.notify_all();
+}
+
+bool ParallelCollectionScan::scanRange(OperationContext* opCtx,
+                                       const CollectionScanParams& params) {
+    WorkingSet ws;
+    CollectionScan scan(opCtx, params, &ws, _filter);
+    vector<Result> batch;
+    RecordId lastFound;
+
+    while (!scan.isEOF()) {
+        if (_interruptWorkers.load() || batch.size() >= kWorkerBatchSize) {
+            if (!publish(opCtx, &scan, &batch)) {
+                _docsTested.fetchAndAdd(
+                    static_cast<const CollectionScanStats*>(scan.getSpecificStats())->docsTested);
+
+                // Leave the rest of the range to be scanned if the workers are started again.
+                CollectionScanParams rest = params;
+                if (!lastFound.isNull()) {
+                    rest.minRecord = RecordId(lastFound.repr() + 1);
+                }
+                if (rest.maxRecord.isNull() || rest.minRecord <= rest.maxRecord) {
+                    stdx::lock_guard<stdx::mutex> lk(_mutex);
+                    _ranges.push_back(rest);
+                }
+                return false;
+            }
+        }
+
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        switch (scan.work(&id)) {
+            case PlanStage::ADVANCED: {
+                WorkingSetMember* member = ws.get(id);
+                lastFound = member->recordId;
+                batch.emplace_back(member->recordId, member->obj.value().getOwned());
+                ws.free(id);
+                break;
+            }
+            case PlanStage::NEED_YIELD:
+                // A write conflict. Carry on in a new snapshot, as PlanExecutor would.
+                scan.saveState();
+                opCtx->recoveryUnit()->abandonSnapshot();
+                scan.restoreState();
+                break;
+            case PlanStage::DEAD:
+            case PlanStage::FAILURE:
+                uassertStatusOK(WorkingSetCommon::getMemberStatus(*ws.get(id)));
+                MONGO_UNREACHABLE;
+            case PlanStage::NEED_TIME:
+            case PlanStage::IS_EOF:
+                break;
+        }
+    }
+
+    _docsTested.fetchAndAdd(
+        static_cast<const CollectionScanStats*>(scan.getSpecificStats())->docsTested);
+    return publish(opCtx, &scan, &batch);
+}
+
+bool ParallelCollectionScan::publish(OperationContext* opCtx,
+                                     CollectionScan* scan,
+                                     vector<Result>* batch) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    bool stopping = false;
+    while (true) {
+        if (!waitWhilePaused(lk, opCtx, scan)) {
+            stopping = true;
+            break;
+        }
+        if (batch->empty() || _results.size() < kMaxBufferedResults) {
+            break;
+        }
+        _workerCV.wait(lk);
+    }
+
+    std::move(batch->begin(), batch->end(), std::back_inserter(_results));
+    batch->clear();
+    _stageCV.notify_all();
+    return !stopping;
+}
+
+bool ParallelCollectionScan::waitWhilePaused(stdx::unique_lock<stdx::mutex>& lk,
+                                             OperationContext* opCtx,
+                                             CollectionScan* scan) {
+    while (_paused && !_stopping) {
+        if (scan) {
+            scan->saveState();
+        }
+        opCtx->recoveryUnit()->abandonSnapshot();
+
+        ++_numPaused;
+        _stageCV.notify_all();
+        _workerCV.wait(lk, [this] { return !_paused || _stopping; });
+        --_numPaused;
+
+        if (scan && !_stopping) {
+            // The stage may be paused again while we restore, in which case we go around again.
+            lk.unlock();
+            scan->restoreState();
+            lk.lock();
+        }
+    }
+    return !_stopping;
+}
+
+void ParallelCollectionScan::stopWorkers() {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _stopping = true;
+        _interruptWorkers.store(true);
+        _workerCV.notify_all();
+    }
+    for (auto&& worker : _workers) {
+        worker.join();
+    }
+    _workers.clear();
+
+    // A worker which hit an error has stopped the stage for good.
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _stopping = !_workerStatus.isOK();
+}
+
+unique_ptr<PlanStageStats> ParallelCollectionScan::getStats() {
+    if (_filter) {
+        BSONObjBuilder bob;
+        _filter->serialize(&bob);
+        _commonStats.filter = bob.obj();
+    }
+    _specificStats.docsTested = _docsTested.load();
+
+    unique_ptr<PlanStageStats> ret =
+        make_unique<PlanStageStats>(_commonStats, STAGE_PARALLEL_COLLSCAN);
+    ret->specific = make_unique<ParallelCollectionScanStats>(_specificStats);
+    return ret;
+}
+
+const SpecificStats* ParallelCollectionScan::getSpecificStats() const {
+    _specificStats.docsTested = _docsTested.load();
+    return &_specificStats;
+}
+
+}  // namespace mongo
@@ -0,0 +1,200 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/exec/collection_scan_common.h"
+#include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/exec/plan_stats.h"
+#include "mongo/db/matcher/expression.h"
+#include "mongo/db/record_id.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+
+namespace mongo {
+
+class CollectionScan;
+class WorkingSet;
+class OperationContext;
+
+/**
+ * Scans a collection on several worker threads and returns the documents which match the filter
+ * in no particular order. The collection is split into ranges of RecordIds, and each worker runs a
+ * CollectionScan over one range at a time, with its own RecoveryUnit.
+ *
+ * The workers read under the locks of the operation which owns this stage. They are paused while
+ * that operation yields, and each continues in a new snapshot afterwards, just as a single-threaded
+ * CollectionScan would. While the stage is detached from its operation, as a cursor is between
+ * getMores, the workers exit so that they do not hold on to their threads, Clients and storage
+ * engine sessions. They are started again when the stage is next worked, and carry on from after
+ * the last document they had found in the ranges they had not finished.
+ *
+ * This stage requires a storage engine which supports document-level locking, and so implements
+ * SeekableRecordCursor::seekNear(), and a forward scan of a collection which isn't capped.
+ */
+class ParallelCollectionScan final : public PlanStage {
+public:
+    ParallelCollectionScan(OperationContext* opCtx,
+                           const CollectionScanParams& params,
+                           WorkingSet* workingSet,
+                           const MatchExpression* filter,
+                           size_t numWorkers);
+
+    ~ParallelCollectionScan();
+
+    StageState doWork(WorkingSetID* out) final;
+    bool isEOF() final;
+
+    void doSaveState() final;
+    void doRestoreState() final;
+    void doDetachFromOperationContext() final;
+
+    StageType stageType() const final {
+        return STAGE_PARALLEL_COLLSCAN;
+    }
+
+    std::unique_ptr<PlanStageStats> getStats() final;
+
+    const SpecificStats* getSpecificStats() const final;
+
+    static const char* kStageType;
+
+    // The collection is split into this many ranges per worker, so that workers which finish their
+    // ranges early can take ranges that would otherwise have gone to slower workers.
+    static const size_t kRangesPerWorker = 8;
+
+    // Workers hand over the documents they have found in batches of up to this many.
+    static const size_t kWorkerBatchSize = 64;
+
+    // Workers wait while this many documents are waiting to be returned.
+    static const size_t kMaxBufferedResults = 1024;
+
+private:
+    using Result = std::pair<RecordId, BSONObj>;
+
+    /**
+     * Splits the collection into ranges of RecordIds and starts the workers. Returns false if the
+     * collection is empty.
+     */
+    bool startWorkers();
+
+    /**
+     * Starts '_numWorkers' workers on the ranges which have not been scanned yet.
+     */
+    void launchWorkers();
+
+    /**
+     * The body of a worker thread, which scans ranges until there are none left.
+     */
+    void runWorker();
+
+    /**
+     * Scans the range of the collection given by 'params'. Returns false if the stage is stopping,
+     * in which case the part of the range after the last document found is put back in '_ranges'.
+     */
+    bool scanRange(OperationContext* opCtx, const CollectionScanParams& params);
+
+    /**
+     * Adds the documents in 'batch' to the results, first waiting while the stage is paused or
+     * there are too many results waiting already. Returns false if the stage is stopping, after
+     * adding the documents without waiting for space.
+     */
+    bool publish(OperationContext* opCtx, CollectionScan* scan, std::vector<Result>* batch);
+
+    /**
+     * Waits until the stage is not paused. Saves 'scan', if there is one, and abandons the
+     * worker's snapshot while waiting. Returns false if the stage is stopping.
+     */
+    bool waitWhilePaused(stdx::unique_lock<stdx::mutex>& lk,
+                         OperationContext* opCtx,
+                         CollectionScan* scan);
+
+    /**
+     * Tells the workers to stop and waits for them to exit. Unless a worker hit an error, they may
+     * be started again afterwards.
+     */
+    void stopWorkers();
+
+    // WorkingSet is not owned by us.
+    WorkingSet* _workingSet;
+
+    // The filter is not owned by us.
+    const MatchExpression* _filter;
+
+    const CollectionScanParams _params;
+    const size_t _numWorkers;
+
+    bool _started = false;
+    std::vector<stdx::thread> _workers;
+
+    // Results which have been taken from '_results', and have not been returned yet, start at
+    // '_pendingResults[_pendingResultPosition]'. Only used by the thread calling work().
+    std::vector<Result> _pendingResults;
+    size_t _pendingResultPosition = 0;
+
+    // Set while the stage is paused or stopping, so that workers can check whether they should
+    // stop scanning without taking '_mutex'.
+    AtomicWord<bool> _interruptWorkers{false};
+
+    AtomicWord<long long> _docsTested{0};
+
+    // Guards the members below.
+    stdx::mutex _mutex;
+
+    // Workers wait on this for space in '_results', or for the stage to resume.
+    stdx::condition_variable _workerCV;
+
+    // The stage waits on this for results, or for workers to pause.
+    stdx::condition_variable _stageCV;
+
+    // The ranges before '_nextRange' have been taken by workers.
+    std::vector<CollectionScanParams> _ranges;
+    size_t _nextRange = 0;
+
+    std::vector<Result> _results;
+
+    size_t _numRunning = 0;
+    size_t _numPaused = 0;
+    bool _paused = false;
+    bool _stopping = false;
+
+    // The first error that a worker hit.
+    Status _workerStatus = Status::OK();
+
+    // Mutable so that getSpecificStats() can bring 'docsTested' up to date.
+    mutable ParallelCollectionScanStats _specificStats;
+};
+
+}  // namespace mongo
@@ -208,6 +208,21 @@ struct CollectionScanStats : public SpecificStats {
     int direction;
 };
 
+struct ParallelCollectionScanStats : public SpecificStats {
+    ParallelCollectionScanStats() : docsTested(0), numWorkers(0) {}
+
+    SpecificStats* clone() const final {
+        ParallelCollectionScanStats* specific = new ParallelCollectionScanStats(*this);
+        return specific;
+    }
+
+    // How many documents did the workers check against our filter?
+    size_t docsTested;
+
+    // How many worker threads scanned the collection?
+    size_t numWorkers;
+};
+
 struct CountStats : public SpecificStats {
     CountStats() : nCounted(0), nSkipped(0), recordStoreCount(false) {}
 
@@ -508,7 +523,7 @@ struct ProjectionStats : public SpecificStats {
 };
 
 struct SortStats : public SpecificStats {
-    SortStats() : forcedFetches(0), memUsage(0), memLimit(0) {}
+    SortStats() : forcedFetches(0), memUsage(0), memLimit(0), spills(0), spilledBytes(0) {}
 
     SpecificStats* clone() const final {
         SortStats* specific = new SortStats(*this);
@@ -529,6 +544,12 @@ struct SortStats : public SpecificStats {
 
     // The pattern according to which we are sorting.
     BSONObj sortPattern;
+
+    // How many sorted runs were written to disk?
+    size_t spills;
+
+    // The uncompressed size in bytes of the sort keys and documents written to disk.
+    size_t spilledBytes;
 };
 
 struct MergeSortStats : public SpecificStats {
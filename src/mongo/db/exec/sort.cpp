@@ -41,7 +41,10 @@
 #include "mongo/db/query/find_common.h"
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_planner.h"
+#include "mongo/db/sorter/sorter.h"
+#include "mongo/db/sorter/sorter_spill.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/util/bufreader.h"
 #include "mongo/util/log.h"
 
 namespace mongo {
@@ -67,6 +70,37 @@ bool SortStage::WorkingSetComparator::operator()(const SortableDataItem& lhs,
     return lhs.recordId < rhs.recordId;
 }
 
+void SortStage::SpilledRecord::serializeForSorter(BufBuilder& buf) const {
+    obj.serializeForSorter(buf);
+    recordId.serializeForSorter(buf);
+}
+
+SortStage::SpilledRecord SortStage::SpilledRecord::deserializeForSorter(
+    BufReader& buf, const SorterDeserializeSettings&) {
+    BSONObj obj = BSONObj::deserializeForSorter(buf, BSONObj::SorterDeserializeSettings());
+    RecordId recordId = RecordId::deserializeForSorter(buf, RecordId::SorterDeserializeSettings());
+    return SpilledRecord(std::move(obj), recordId);
+}
+
+int SortStage::SpilledRecord::memUsageForSorter() const {
+    return obj.memUsageForSorter() + recordId.memUsageForSorter();
+}
+
+SortStage::SpilledRecord SortStage::SpilledRecord::getOwned() const {
+    return SpilledRecord(obj.getOwned(), recordId);
+}
+
+int SortStage::SpilledRecordComparator::operator()(
+    const std::pair<BSONObj, SpilledRecord>& lhs,
+    const std::pair<BSONObj, SpilledRecord>& rhs) const {
+    // False means ignore field names.
+    int result = lhs.first.woCompare(rhs.first, pattern, false);
+    if (0 != result) {
+        return result;
+    }
+    return lhs.second.recordId.compare(rhs.second.recordId);
+}
+
 SortStage::SortStage(OperationContext* opCtx,
                      const SortStageParams& params,
                      WorkingSet* ws,
@@ -76,20 +110,15 @@ SortStage::SortStage(OperationContext* opCtx,
       _ws(ws),
       _pattern(params.pattern),
       _limit(params.limit),
+      _allowDiskUse(params.allowDiskUse),
       _sorted(false),
       _resultIterator(_data.end()),
-      _memUsage(0) {
+      _memUsage(0),
+      _memoryTracker(opCtx) {
     _children.emplace_back(child);
 
     BSONObj sortComparator = FindCommon::transformSortSpec(_pattern);
     _sortKeyComparator = stdx::make_unique<WorkingSetComparator>(sortComparator);
-
-    // If limit > 1, we need to initialize _dataSet here to maintain ordered set of data items while
-    // fetching from the child stage.
-    if (_limit > 1) {
-        const WorkingSetComparator& cmp = *_sortKeyComparator;
-        _dataSet.reset(new SortableDataItemSet(cmp));
-    }
 }
 
 SortStage::~SortStage() {}
@@ -97,18 +126,26 @@ SortStage::~SortStage() {}
 bool SortStage::isEOF() {
     // We're done when our child has no more results, we've sorted the child's results, and
     // we've returned all sorted results.
-    return child()->isEOF() && _sorted && (_data.end() == _resultIterator);
+    return child()->isEOF() && _sorted && (_data.end() == _resultIterator) &&
+        (!_spillMerger || !_spillMerger->more());
 }
 
 PlanStage::StageState SortStage::doWork(WorkingSetID* out) {
     const size_t maxBytes = static_cast<size_t>(internalQueryExecMaxBlockingSortBytes.load());
     if (_memUsage > maxBytes) {
-        mongoutils::str::stream ss;
-        ss << "Sort operation used more than the maximum " << maxBytes
-           << " bytes of RAM. Add an index, or specify a smaller limit.";
-        Status status(ErrorCodes::OperationFailed, ss);
-        *out = WorkingSetCommon::allocateStatusMember(_ws, status);
-        return PlanStage::FAILURE;
+        if (!_allowDiskUse || _hasUnspillableData) {
+            mongoutils::str::stream ss;
+            ss << "Sort operation used more than the maximum " << maxBytes
+               << " bytes of RAM. Add an index, or specify a smaller limit.";
+            if (!_allowDiskUse) {
+                ss << " Pass allowDiskUse:true to opt in to sorting on disk.";
+            }
+            Status status(ErrorCodes::OperationFailed, ss);
+            *out = WorkingSetCommon::allocateStatusMember(_ws, status);
+            return PlanStage::FAILURE;
+        }
+
+        spill();
     }
 
     if (isEOF()) {
@@ -148,13 +185,34 @@ PlanStage::StageState SortStage::doWork(WorkingSetID* out) {
                 item.recordId = member->recordId;
             }
 
+            // Only the document, its RecordId and its sort key survive a round trip through a
+            // spilled run. In particular the index keys of a covered sort would be lost.
+            if (!member->hasObj() || member->hasComputed(WSM_COMPUTED_TEXT_SCORE) ||
+                member->hasComputed(WSM_COMPUTED_GEO_DISTANCE) ||
+                member->hasComputed(WSM_INDEX_KEY) || member->hasComputed(WSM_GEO_NEAR_POINT)) {
+                _hasUnspillableData = true;
+            }
+
             addToBuffer(item);
+            _memoryTracker.set(_memUsage);
 
             return PlanStage::NEED_TIME;
         } else if (PlanStage::IS_EOF == code) {
             // TODO: We don't need the lock for this.  We could ask for a yield and do this work
             // unlocked.  Also, this is performing a lot of work for one call to work(...)
-            sortBuffer();
+            if (!_spilledRuns.empty()) {
+                // Write what is left in memory as a final run so that everything can be
+                // returned by a single merge.
+                if (!_data.empty()) {
+                    spill();
+                }
+                const SpilledRecordComparator cmp(_sortKeyComparator->pattern);
+                _spillMerger.reset(SpilledIterator::merge(
+                    _spilledRuns, SortOptions().Limit(_limit), cmp));
+                _spilledRuns.clear();
+            } else {
+                sortBuffer();
+            }
             _resultIterator = _data.begin();
             _sorted = true;
             return PlanStage::NEED_TIME;
@@ -177,11 +235,20 @@ PlanStage::StageState SortStage::doWork(WorkingSetID* out) {
         return code;
     }
 
+    verify(_sorted);
+    if (_spillMerger) {
+        *out = allocateFromSpilledRuns();
+        return PlanStage::ADVANCED;
+    }
+
     // Returning results.
     verify(_resultIterator != _data.end());
-    verify(_sorted);
     *out = _resultIterator->wsid;
     _resultIterator++;
+    if (_resultIterator == _data.end()) {
+        // Our parent now owns everything we buffered.
+        _memoryTracker.set(0);
+    }
 
     // If we're returning something, take it out of our DL -> WSID map so that future
     // calls to invalidate don't cause us to take action for a DL we're done with.
@@ -214,9 +281,21 @@ void SortStage::doInvalidate(OperationContext* opCtx, const RecordId& dl, Invali
         // Remove the RecordId from our set of active DLs.
         _wsidByRecordId.erase(it);
         ++_specificStats.forcedFetches;
+    } else if (_specificStats.spills > 0) {
+        // The document may be sitting in a spilled run, where we already hold an owned copy of
+        // it. Remember the RecordId so that we don't hand it out once the run is read back.
+        _invalidatedWhileSpilled.insert(dl);
     }
 }
 
+void SortStage::doDetachFromOperationContext() {
+    _memoryTracker.detach();
+}
+
+void SortStage::doReattachToOperationContext() {
+    _memoryTracker.attach(getOpCtx());
+}
+
 unique_ptr<PlanStageStats> SortStage::getStats() {
     _commonStats.isEOF = isEOF();
     const size_t maxBytes = static_cast<size_t>(internalQueryExecMaxBlockingSortBytes.load());
@@ -250,10 +329,12 @@ const SpecificStats* SortStage::getSpecificStats() const {
  *                     Updates memory usage if item was replaced.
  *     sortBuffer() - Does nothing.
  * limit > 1:
- *     addToBuffer() - Does not update vector. Adds item to set.
- *                     If size of set exceeds limit, remove item from set
- *                     with lowest key. Updates memory usage accordingly.
- *     sortBuffer() - Copies items from set to vectors.
+ *     addToBuffer() - Pushes item onto a max-heap kept in the vector.
+ *                     Once the heap holds 'limit' items, a new item
+ *                     replaces the top of the heap (the item with the
+ *                     highest key) if it sorts before it. Updates
+ *                     memory usage accordingly.
+ *     sortBuffer() - Turns the heap into a sorted vector in place.
  */
 void SortStage::addToBuffer(const SortableDataItem& item) {
     // Holds ID of working set member to be freed at end of this function.
@@ -282,33 +363,28 @@ void SortStage::addToBuffer(const SortableDataItem& item) {
             _memUsage = member->getMemUsage();
         }
     } else {
-        // Update data item set instead of vector
-        // Limit not reached - insert and return
-        vector<SortableDataItem>::size_type limit(_limit);
-        if (_dataSet->size() < limit) {
+        const WorkingSetComparator& cmp = *_sortKeyComparator;
+
+        // Limit not reached - push onto the heap and return.
+        if (_data.size() < _limit) {
             member->makeObjOwnedIfNeeded();
-            _dataSet->insert(item);
+            _data.push_back(item);
+            std::push_heap(_data.begin(), _data.end(), cmp);
             _memUsage += member->getMemUsage();
             return;
         }
-        // Limit will be exceeded - compare with item with lowest key
-        // If new item does not have a lower key value than last item,
-        // do nothing.
+
+        // Limit will be exceeded - compare with the item with the highest key, which is at the
+        // top of the heap. If the new item does not sort before it, do nothing.
         wsidToFree = item.wsid;
-        SortableDataItemSet::const_iterator lastItemIt = --(_dataSet->end());
-        const SortableDataItem& lastItem = *lastItemIt;
-        const WorkingSetComparator& cmp = *_sortKeyComparator;
-        if (cmp(item, lastItem)) {
-            _memUsage -= _ws->get(lastItem.wsid)->getMemUsage();
+        if (cmp(item, _data.front())) {
+            _memUsage -= _ws->get(_data.front().wsid)->getMemUsage();
             _memUsage += member->getMemUsage();
-            wsidToFree = lastItem.wsid;
-            // According to std::set iterator validity rules,
-            // it does not matter which of erase()/insert() happens first.
-            // Here, we choose to erase first to release potential resources
-            // used by the last item and to keep the scope of the iterator to a minimum.
-            _dataSet->erase(lastItemIt);
+            std::pop_heap(_data.begin(), _data.end(), cmp);
+            wsidToFree = _data.back().wsid;
             member->makeObjOwnedIfNeeded();
-            _dataSet->insert(item);
+            _data.back() = item;
+            std::push_heap(_data.begin(), _data.end(), cmp);
         }
     }
 
@@ -324,20 +400,74 @@ void SortStage::addToBuffer(const SortableDataItem& item) {
 }
 
 void SortStage::sortBuffer() {
+    const WorkingSetComparator& cmp = *_sortKeyComparator;
     if (_limit == 0) {
-        const WorkingSetComparator& cmp = *_sortKeyComparator;
         std::sort(_data.begin(), _data.end(), cmp);
     } else if (_limit == 1) {
         // Buffer contains either 0 or 1 item so it is already in a sorted state.
         return;
     } else {
-        // Set already contains items in sorted order, so we simply copy the items
-        // from the set to the vector.
-        // Release the memory for the set after the copy.
-        vector<SortableDataItem> newData(_dataSet->begin(), _dataSet->end());
-        _data.swap(newData);
-        _dataSet.reset();
+        // The buffer is a max-heap, which sort_heap() leaves in ascending order.
+        std::sort_heap(_data.begin(), _data.end(), cmp);
+    }
+}
+
+void SortStage::spill() {
+    invariant(_allowDiskUse);
+    sortBuffer();
+
+    const SortOptions opts = SortOptions().TempDir(sorter::getSpillDirectory());
+    SortedFileWriter<BSONObj, SpilledRecord> writer(opts);
+    for (auto&& item : _data) {
+        WorkingSetMember* member = _ws->get(item.wsid);
+        const BSONObj& obj = member->obj.value();
+        writer.addAlreadySorted(item.sortKey, SpilledRecord(obj, item.recordId));
+        _specificStats.spilledBytes += item.sortKey.objsize() + obj.objsize() + sizeof(int64_t);
+
+        // Once written out, the item no longer needs to be invalidated in place. See
+        // doInvalidate() for how invalidations of spilled items are handled. The RecordId is
+        // still written so that ties are broken the same way as in memory.
+        if (member->hasRecordId()) {
+            _wsidByRecordId.erase(member->recordId);
+        } else if (!item.recordId.isNull()) {
+            _invalidatedWhileSpilled.insert(item.recordId);
+        }
+        _ws->free(item.wsid);
+    }
+    _spilledRuns.emplace_back(writer.done());
+
+    _data.clear();
+    _memUsage = 0;
+    _memoryTracker.set(0);
+    ++_specificStats.spills;
+
+    LOG(1) << "Sort stage spilled run " << _specificStats.spills << " to disk, "
+           << _specificStats.spilledBytes << " bytes spilled so far";
+}
+
+WorkingSetID SortStage::allocateFromSpilledRuns() {
+    auto next = _spillMerger->next();
+
+    WorkingSetID id = _ws->allocate();
+    WorkingSetMember* member = _ws->get(id);
+
+    // The document was read from an older snapshot, so we leave the snapshot id unset. Stages
+    // that care about snapshots will treat the document as stale and re-fetch it.
+    member->obj = Snapshotted<BSONObj>(SnapshotId(), next.second.obj.getOwned());
+    const RecordId& recordId = next.second.recordId;
+    if (!recordId.isNull() && !_invalidatedWhileSpilled.count(recordId)) {
+        member->recordId = recordId;
+        _ws->transitionToRecordIdAndObj(id);
+    } else {
+        _ws->transitionToOwnedObj(id);
     }
+    member->addComputed(new SortKeyComputedData(next.first));
+    return id;
 }
 
 }  // namespace mongo
+
+#include "mongo/db/sorter/sorter.cpp"
+MONGO_CREATE_SORTER(mongo::BSONObj,
+                    mongo::SortStage::SpilledRecord,
+                    mongo::SortStage::SpilledRecordComparator);
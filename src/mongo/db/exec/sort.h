@@ -28,16 +28,19 @@
 
 #pragma once
 
-#include <set>
+#include <memory>
 #include <vector>
 
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/exec/sort_key_generator.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/operation_memory_usage.h"
 #include "mongo/db/query/index_bounds.h"
 #include "mongo/db/record_id.h"
+#include "mongo/db/sorter/sorter.h"
 #include "mongo/platform/unordered_map.h"
+#include "mongo/platform/unordered_set.h"
 
 namespace mongo {
 
@@ -46,7 +49,7 @@ class BtreeKeyGenerator;
 // Parameters that must be provided to a SortStage
 class SortStageParams {
 public:
-    SortStageParams() : collection(NULL), limit(0) {}
+    SortStageParams() : collection(NULL), limit(0), allowDiskUse(false) {}
 
     // Used for resolving RecordIds to BSON
     const Collection* collection;
@@ -56,6 +59,10 @@ public:
 
     // Equal to 0 for no limit.
     size_t limit;
+
+    // Whether we may spill sorted runs to disk once the buffered data exceeds
+    // internalQueryExecMaxBlockingSortBytes, rather than failing the query.
+    bool allowDiskUse;
 };
 
 /**
@@ -65,6 +72,11 @@ public:
  *   -- For each field in 'pattern', all inputs in the child must handle a getFieldDotted for that
  *   field.
  *   -- All WSMs produced by the child stage must have the sort key available as WSM computed data.
+ *
+ * If 'allowDiskUse' is set and the buffered data grows beyond the memory limit, the buffer is
+ * sorted and written to a temporary file under the dbpath, and the sorted runs are merged once
+ * the child is exhausted. Results produced from a spilled run are owned objects; they keep their
+ * RecordId unless it was invalidated while the run was on disk.
  */
 class SortStage final : public PlanStage {
 public:
@@ -78,6 +90,8 @@ public:
     StageState doWork(WorkingSetID* out) final;
 
     void doInvalidate(OperationContext* opCtx, const RecordId& dl, InvalidationType type) final;
+    void doDetachFromOperationContext() final;
+    void doReattachToOperationContext() final;
 
     StageType stageType() const final {
         return STAGE_SORT;
@@ -106,6 +120,9 @@ private:
     // Equal to 0 for no limit.
     size_t _limit;
 
+    // Whether we are permitted to spill sorted runs to disk.
+    bool _allowDiskUse;
+
     //
     // Data storage
     //
@@ -124,9 +141,9 @@ private:
         RecordId recordId;
     };
 
-    // Comparison object for data buffers (vector and set). Items are compared on (sortKey, loc).
-    // This is also how the items are ordered in the indices. Keys are compared using
-    // BSONObj::woCompare() with RecordId as a tie-breaker.
+    // Comparison object for the data buffer. Items are compared on (sortKey, loc). This is also
+    // how the items are ordered in the indices. Keys are compared using BSONObj::woCompare() with
+    // RecordId as a tie-breaker.
     //
     // We are comparing keys generated by the SortKeyGenerator, which are already ordered with
     // respect the collation. Therefore, we explicitly avoid comparing using a collator here.
@@ -138,38 +155,86 @@ private:
         BSONObj pattern;
     };
 
+    // The document and RecordId of a data item that has been written out to a sorted run on disk.
+    // The sort key is stored as the Sorter key.
+    struct SpilledRecord {
+        struct SorterDeserializeSettings {};
+
+        SpilledRecord() = default;
+        SpilledRecord(BSONObj o, RecordId id) : obj(std::move(o)), recordId(id) {}
+
+        void serializeForSorter(BufBuilder& buf) const;
+        static SpilledRecord deserializeForSorter(BufReader& buf,
+                                                  const SorterDeserializeSettings&);
+        int memUsageForSorter() const;
+        SpilledRecord getOwned() const;
+
+        BSONObj obj;
+        RecordId recordId;
+    };
+
+    // Orders spilled (sortKey, record) pairs the same way WorkingSetComparator orders items.
+    struct SpilledRecordComparator {
+        explicit SpilledRecordComparator(BSONObj p) : pattern(std::move(p)) {}
+
+        int operator()(const std::pair<BSONObj, SpilledRecord>& lhs,
+                       const std::pair<BSONObj, SpilledRecord>& rhs) const;
+
+        BSONObj pattern;
+    };
+
+    typedef SortIteratorInterface<BSONObj, SpilledRecord> SpilledIterator;
+
     /**
-     * Inserts one item into data buffer (vector or set).
-     * If limit is exceeded, remove item with lowest key.
+     * Inserts one item into the data buffer. If the limit is exceeded, removes the item with the
+     * highest sort key.
      */
     void addToBuffer(const SortableDataItem& item);
 
     /**
-     * Sorts data buffer.
-     * Assumes no more items will be added to buffer.
-     * If data is stored in set, copy set
-     * contents to vector and clear set.
+     * Sorts the data buffer. Assumes no more items will be added to it.
      */
     void sortBuffer();
 
+    /**
+     * Sorts the data buffer, writes it out as a sorted run in the temp directory and frees the
+     * corresponding working set members.
+     */
+    void spill();
+
+    /**
+     * Returns the next result of the merge over all spilled runs as a newly allocated working set
+     * member.
+     */
+    WorkingSetID allocateFromSpilledRuns();
+
     // Comparator for data buffer
     // Initialization follows sort key generator
     std::unique_ptr<WorkingSetComparator> _sortKeyComparator;
 
-    // The data we buffer and sort.
-    // _data will contain sorted data when all data is gathered
-    // and sorted.
-    // When _limit is greater than 1 and not all data has been gathered from child stage,
-    // _dataSet is used instead to maintain an ordered set of the incomplete data set.
-    // When the data set is complete, we copy the items from _dataSet to _data which will
-    // be used to provide the results of this stage through _resultIterator.
+    // The data we buffer and sort. _data will contain sorted data when all data is gathered and
+    // sorted.
+    // When _limit is greater than 1 and not all data has been gathered from the child stage,
+    // _data is maintained as a max-heap of at most _limit items, ordered by _sortKeyComparator,
+    // so that the item with the highest key can be replaced in logarithmic time.
     std::vector<SortableDataItem> _data;
-    typedef std::set<SortableDataItem, WorkingSetComparator> SortableDataItemSet;
-    std::unique_ptr<SortableDataItemSet> _dataSet;
 
     // Iterates through _data post-sort returning it.
     std::vector<SortableDataItem>::iterator _resultIterator;
 
+    // Sorted runs written to disk by spill(). Once the child is exhausted these are merged by
+    // _spillMerger, which then supplies the results of this stage.
+    std::vector<std::shared_ptr<SpilledIterator>> _spilledRuns;
+    std::unique_ptr<SpilledIterator> _spillMerger;
+
+    // Set if any buffered member carries computed data, such as a text score, that cannot be
+    // written to a spilled run.
+    bool _hasUnspillableData = false;
+
+    // RecordIds invalidated after the first spill. A result read back from disk whose RecordId is
+    // in this set is returned without its RecordId.
+    unordered_set<RecordId, RecordId::Hasher> _invalidatedWhileSpilled;
+
     // We buffer a lot of data and we want to look it up by RecordId quickly upon invalidation.
     typedef unordered_map<RecordId, WorkingSetID, RecordId::Hasher> DataMap;
     DataMap _wsidByRecordId;
@@ -178,6 +243,9 @@ private:
 
     // The usage in bytes of all buffered data that we're sorting.
     size_t _memUsage;
+
+    // Charges '_memUsage' to the operation we are running in.
+    OperationMemoryUsage::Tracker _memoryTracker;
 };
 
 }  // namespace mongo
@@ -35,13 +35,17 @@
 #include <boost/optional.hpp>
 
 #include "mongo/db/exec/queued_data_stage.h"
+#include "mongo/db/exec/working_set_computed_data.h"
 #include "mongo/db/json.h"
 #include "mongo/db/operation_context_noop.h"
 #include "mongo/db/query/collation/collator_factory_mock.h"
 #include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/service_context.h"
 #include "mongo/db/service_context_noop.h"
+#include "mongo/db/storage/storage_options.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/clock_source_mock.h"
 
@@ -321,4 +325,166 @@ TEST_F(SortStageTest, SortDescendingWithCollation) {
              "{input: [{a: 'ba'}, {a: 'aa'}, {a: 'ab'}]}",
              "{output: [{a: 'ab'}, {a: 'ba'}, {a: 'aa'}]}");
 }
+
+//
+// Sorting with allowDiskUse
+// Implementation should spill sorted runs to disk once the memory limit is exceeded and merge
+// them back in order.
+//
+
+class SortStageSpillTest : public SortStageTest {
+public:
+    SortStageSpillTest()
+        : _tempDir("sort_stage_spill_test"),
+          _oldDbpath(storageGlobalParams.dbpath),
+          _oldMaxBytes(internalQueryExecMaxBlockingSortBytes.load()) {
+        storageGlobalParams.dbpath = _tempDir.path();
+        internalQueryExecMaxBlockingSortBytes.store(16 * 1024);
+    }
+
+    ~SortStageSpillTest() {
+        storageGlobalParams.dbpath = _oldDbpath;
+        internalQueryExecMaxBlockingSortBytes.store(_oldMaxBytes);
+    }
+
+    /**
+     * Sorts 'numDocs' documents of the form {a: <int>, pad: <string>} on 'a' and returns the
+     * values of 'a' in the order the stage produced them. Fails the test if the sort stage does.
+     */
+    std::vector<int> runSort(int numDocs, size_t limit, bool allowDiskUse, SortStats* statsOut) {
+        WorkingSet ws;
+        auto queuedDataStage = stdx::make_unique<QueuedDataStage>(getOpCtx(), &ws);
+        const std::string pad(200, 'x');
+        for (int i = 0; i < numDocs; ++i) {
+            WorkingSetID id = ws.allocate();
+            WorkingSetMember* wsm = ws.get(id);
+            // 7919 is prime, so this visits every value in [0, numDocs) exactly once.
+            wsm->obj = Snapshotted<BSONObj>(SnapshotId(),
+                                            BSON("a" << (i * 7919) % numDocs << "pad" << pad));
+            wsm->transitionToOwnedObj();
+            queuedDataStage->pushBack(id);
+        }
+
+        SortStageParams params;
+        params.pattern = BSON("a" << 1);
+        params.limit = limit;
+        params.allowDiskUse = allowDiskUse;
+
+        auto sortKeyGen = stdx::make_unique<SortKeyGeneratorStage>(
+            getOpCtx(), queuedDataStage.release(), &ws, params.pattern, BSONObj(), nullptr);
+        SortStage sort(getOpCtx(), params, &ws, sortKeyGen.release());
+
+        std::vector<int> out;
+        WorkingSetID id = WorkingSet::INVALID_ID;
+        PlanStage::StageState state = PlanStage::NEED_TIME;
+        while (state != PlanStage::IS_EOF) {
+            state = sort.work(&id);
+            ASSERT_NOT_EQUALS(state, PlanStage::FAILURE);
+            if (state == PlanStage::ADVANCED) {
+                WorkingSetMember* member = ws.get(id);
+                ASSERT_TRUE(member->hasComputed(WSM_SORT_KEY));
+                out.push_back(member->obj.value()["a"].numberInt());
+                ws.free(id);
+            }
+        }
+
+        *statsOut = *static_cast<const SortStats*>(sort.getSpecificStats());
+        return out;
+    }
+
+private:
+    unittest::TempDir _tempDir;
+    std::string _oldDbpath;
+    int _oldMaxBytes;
+};
+
+TEST_F(SortStageSpillTest, SpillsSortedRunsAndMergesThem) {
+    SortStats stats;
+    auto out = runSort(1000, 0, true, &stats);
+
+    ASSERT_EQUALS(out.size(), 1000U);
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_EQUALS(out[i], i);
+    }
+    ASSERT_GREATER_THAN(stats.spills, 1U);
+    ASSERT_GREATER_THAN(stats.spilledBytes, 1000U * 200U);
+}
+
+TEST_F(SortStageSpillTest, SpillsWithLimit) {
+    SortStats stats;
+    auto out = runSort(1000, 100, true, &stats);
+
+    ASSERT_EQUALS(out.size(), 100U);
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_EQUALS(out[i], i);
+    }
+    ASSERT_GREATER_THAN(stats.spills, 0U);
+}
+
+TEST_F(SortStageSpillTest, TopKWithLimitStaysInMemory) {
+    SortStats stats;
+    auto out = runSort(1000, 10, false, &stats);
+
+    ASSERT_EQUALS(out.size(), 10U);
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_EQUALS(out[i], i);
+    }
+    ASSERT_EQUALS(stats.spills, 0U);
+}
+
+TEST_F(SortStageSpillTest, FailsWithoutAllowDiskUse) {
+    WorkingSet ws;
+    auto queuedDataStage = stdx::make_unique<QueuedDataStage>(getOpCtx(), &ws);
+    const std::string pad(200, 'x');
+    for (int i = 0; i < 1000; ++i) {
+        WorkingSetID id = ws.allocate();
+        WorkingSetMember* wsm = ws.get(id);
+        wsm->obj = Snapshotted<BSONObj>(SnapshotId(), BSON("a" << i << "pad" << pad));
+        wsm->transitionToOwnedObj();
+        queuedDataStage->pushBack(id);
+    }
+
+    SortStageParams params;
+    params.pattern = BSON("a" << 1);
+    auto sortKeyGen = stdx::make_unique<SortKeyGeneratorStage>(
+        getOpCtx(), queuedDataStage.release(), &ws, params.pattern, BSONObj(), nullptr);
+    SortStage sort(getOpCtx(), params, &ws, sortKeyGen.release());
+
+    WorkingSetID id = WorkingSet::INVALID_ID;
+    PlanStage::StageState state = PlanStage::NEED_TIME;
+    while (state == PlanStage::NEED_TIME) {
+        state = sort.work(&id);
+    }
+    ASSERT_EQUALS(state, PlanStage::FAILURE);
+}
+
+TEST_F(SortStageSpillTest, CoveredSortFailsInsteadOfSpilling) {
+    // The members of a covered sort only hold index keys, which a spilled run cannot preserve.
+    WorkingSet ws;
+    auto queuedDataStage = stdx::make_unique<QueuedDataStage>(getOpCtx(), &ws);
+    const BSONObj keyPattern = BSON("a" << 1 << "pad" << 1);
+    const std::string pad(200, 'x');
+    for (int i = 0; i < 1000; ++i) {
+        WorkingSetID id = ws.allocate();
+        WorkingSetMember* wsm = ws.get(id);
+        wsm->recordId = RecordId(i + 1);
+        wsm->keyData.push_back(IndexKeyDatum(keyPattern, BSON("" << i << "" << pad), nullptr));
+        ws.transitionToRecordIdAndIdx(id);
+        wsm->addComputed(new SortKeyComputedData(BSON("" << i)));
+        queuedDataStage->pushBack(id);
+    }
+
+    SortStageParams params;
+    params.pattern = BSON("a" << 1);
+    params.allowDiskUse = true;
+    SortStage sort(getOpCtx(), params, &ws, queuedDataStage.release());
+
+    WorkingSetID id = WorkingSet::INVALID_ID;
+    PlanStage::StageState state = PlanStage::NEED_TIME;
+    while (state == PlanStage::NEED_TIME) {
+        state = sort.work(&id);
+    }
+    ASSERT_EQUALS(state, PlanStage::FAILURE);
+    ASSERT_EQUALS(static_cast<const SortStats*>(sort.getSpecificStats())->spills, 0U);
+}
 }  // namespace
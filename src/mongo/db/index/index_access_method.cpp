@@ -46,7 +46,7 @@
 #include "mongo/db/operation_context.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/server_parameters.h"
-#include "mongo/db/storage/storage_options.h"
+#include "mongo/db/sorter/sorter_spill.h"
 #include "mongo/util/log.h"
 #include "mongo/util/progress_meter.h"
 
@@ -414,7 +414,7 @@ IndexAccessMethod::BulkBuilder::BulkBuilder(const IndexAccessMethod* index,
                                             size_t maxMemoryUsageBytes)
     : _sorter(Sorter::make(
           SortOptions()
-              .TempDir(storageGlobalParams.dbpath + "/_tmp")
+              .TempDir(sorter::getSpillDirectory())
               .ExtSortAllowed()
               .MaxMemoryUsageBytes(maxMemoryUsageBytes),
           BtreeExternalSortComparison(descriptor->keyPattern(), descriptor->version()))),
@@ -455,20 +455,67 @@ Status IndexAccessMethod::BulkBuilder::insert(OperationContext* opCtx,
     return Status::OK();
 }
 
+void IndexAccessMethod::BulkBuilder::sort() {
+    invariant(!_sorted);
+    _sorted.reset(_sorter->done());
+}
 
 Status IndexAccessMethod::commitBulk(OperationContext* opCtx,
                                      std::unique_ptr<BulkBuilder> bulk,
                                      bool mayInterrupt,
                                      bool dupsAllowed,
                                      set<RecordId>* dupsToDrop) {
+    std::vector<std::unique_ptr<BulkBuilder>> bulks;
+    bulks.push_back(std::move(bulk));
+    return commitBulk(opCtx, std::move(bulks), mayInterrupt, dupsAllowed, dupsToDrop);
+}
+
+Status IndexAccessMethod::commitBulk(OperationContext* opCtx,
+                                     std::vector<std::unique_ptr<BulkBuilder>> bulks,
+                                     bool mayInterrupt,
+                                     bool dupsAllowed,
+                                     set<RecordId>* dupsToDrop) {
+    invariant(!bulks.empty());
     Timer timer;
 
-    std::unique_ptr<BulkBuilder::Sorter::Iterator> i(bulk->_sorter->done());
+    int64_t keysInserted = 0;
+    bool everGeneratedMultipleKeys = false;
+    MultikeyPaths indexMultikeyPaths;
+    std::vector<std::shared_ptr<BulkBuilder::Sorter::Iterator>> sortedRuns;
+    for (auto&& bulk : bulks) {
+        invariant(bulk->_real == this);
+        if (!bulk->_sorted) {
+            bulk->sort();
+        }
+        sortedRuns.push_back(std::move(bulk->_sorted));
+
+        keysInserted += bulk->_keysInserted;
+        everGeneratedMultipleKeys = everGeneratedMultipleKeys || bulk->_everGeneratedMultipleKeys;
+        if (indexMultikeyPaths.empty()) {
+            indexMultikeyPaths = bulk->_indexMultikeyPaths;
+        } else if (!bulk->_indexMultikeyPaths.empty()) {
+            invariant(indexMultikeyPaths.size() == bulk->_indexMultikeyPaths.size());
+            for (size_t i = 0; i < indexMultikeyPaths.size(); ++i) {
+                indexMultikeyPaths[i].insert(bulk->_indexMultikeyPaths[i].begin(),
+                                             bulk->_indexMultikeyPaths[i].end());
+            }
+        }
+    }
+
+    std::shared_ptr<BulkBuilder::Sorter::Iterator> i;
+    if (sortedRuns.size() == 1) {
+        i = std::move(sortedRuns.front());
+    } else {
+        i.reset(BulkBuilder::Sorter::Iterator::merge(
+            sortedRuns,
+            SortOptions(),
+            BtreeExternalSortComparison(_descriptor->keyPattern(), _descriptor->version())));
+    }
 
     stdx::unique_lock<Client> lk(*opCtx->getClient());
     ProgressMeterHolder pm(*opCtx->setMessage_inlock("Index Bulk Build: (2/3) btree bottom up",
                                                      "Index: (2/3) BTree Bottom Up Progress",
-                                                     bulk->_keysInserted,
+                                                     keysInserted,
                                                      10));
     lk.unlock();
 
@@ -477,8 +524,8 @@ Status IndexAccessMethod::commitBulk(OperationContext* opCtx,
     MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
         WriteUnitOfWork wunit(opCtx);
 
-        if (bulk->_everGeneratedMultipleKeys || isMultikeyFromPaths(bulk->_indexMultikeyPaths)) {
-            _btreeState->setMultikey(opCtx, bulk->_indexMultikeyPaths);
+        if (everGeneratedMultipleKeys || isMultikeyFromPaths(indexMultikeyPaths)) {
+            _btreeState->setMultikey(opCtx, indexMultikeyPaths);
         }
 
         builder.reset(_newInterface->getBulkBuilder(opCtx, dupsAllowed));
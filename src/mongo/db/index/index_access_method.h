@@ -30,6 +30,7 @@
 
 #include <atomic>
 #include <memory>
+#include <vector>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/bson/simple_bsonobj_comparator.h"
@@ -207,6 +208,14 @@ public:
                       const InsertDeleteOptions& options,
                       int64_t* numInserted);
 
+        /**
+         * Sorts the keys inserted so far. No more keys may be inserted afterwards.
+         *
+         * commitBulk() sorts the keys itself if this hasn't been called. Calling it beforehand
+         * allows several BulkBuilders, each filled by its own thread, to sort concurrently.
+         */
+        void sort();
+
     private:
         friend class IndexAccessMethod;
 
@@ -217,6 +226,9 @@ public:
                     size_t maxMemoryUsageBytes);
 
         std::unique_ptr<Sorter> _sorter;
+
+        // Set by sort().
+        std::unique_ptr<Sorter::Iterator> _sorted;
         const IndexAccessMethod* _real;
         int64_t _keysInserted = 0;
 
@@ -256,6 +268,16 @@ public:
                       bool dupsAllowed,
                       std::set<RecordId>* dups);
 
+    /**
+     * Like above, but loads the keys of several BulkBuilders, all created by initiateBulk() on
+     * this index, by merging their sorted keys.
+     */
+    Status commitBulk(OperationContext* opCtx,
+                      std::vector<std::unique_ptr<BulkBuilder>> bulks,
+                      bool mayInterrupt,
+                      bool dupsAllowed,
+                      std::set<RecordId>* dups);
+
     /**
      * Specifies whether getKeys should relax the index constraints or not.
      */
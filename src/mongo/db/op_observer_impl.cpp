@@ -31,6 +31,7 @@
 #include "mongo/db/op_observer_impl.h"
 
 #include "mongo/db/auth/authorization_manager_global.h"
+#include "mongo/db/catalog/collection_info_cache.h"
 #include "mongo/db/catalog/collection_options.h"
 #include "mongo/db/commands/dbhash.h"
 #include "mongo/db/commands/feature_compatibility_version.h"
@@ -89,6 +90,9 @@ void OpObserverImpl::onInserts(OperationContext* opCtx,
     if (nss.coll() == DurableViewCatalog::viewsCollectionName()) {
         DurableViewCatalog::onExternalChange(opCtx, nss);
     }
+    if (nss.coll() == CollectionStatistics::kCollectionName) {
+        CollectionInfoCache::onStatisticsChange(opCtx, nss);
+    }
 }
 
 void OpObserverImpl::onUpdate(OperationContext* opCtx, const OplogUpdateEntryArgs& args) {
@@ -115,6 +119,10 @@ void OpObserverImpl::onUpdate(OperationContext* opCtx, const OplogUpdateEntryArg
         DurableViewCatalog::onExternalChange(opCtx, args.nss);
     }
 
+    if (args.nss.coll() == CollectionStatistics::kCollectionName) {
+        CollectionInfoCache::onStatisticsChange(opCtx, args.nss);
+    }
+
     if (args.nss.ns() == FeatureCompatibilityVersion::kCollection) {
         FeatureCompatibilityVersion::onInsertOrUpdate(args.updatedDoc);
     }
@@ -158,6 +166,9 @@ void OpObserverImpl::onDelete(OperationContext* opCtx,
     if (nss.coll() == DurableViewCatalog::viewsCollectionName()) {
         DurableViewCatalog::onExternalChange(opCtx, nss);
     }
+    if (nss.coll() == CollectionStatistics::kCollectionName) {
+        CollectionInfoCache::onStatisticsChange(opCtx, nss);
+    }
     if (nss.ns() == FeatureCompatibilityVersion::kCollection) {
         FeatureCompatibilityVersion::onDelete(deleteState.idDoc);
     }
@@ -239,6 +250,10 @@ void OpObserverImpl::onDropCollection(OperationContext* opCtx,
         DurableViewCatalog::onExternalChange(opCtx, collectionName);
     }
 
+    if (collectionName.coll() == CollectionStatistics::kCollectionName) {
+        CollectionInfoCache::onStatisticsChange(opCtx, collectionName);
+    }
+
     if (collectionName.ns() == FeatureCompatibilityVersion::kCollection) {
         FeatureCompatibilityVersion::onDropCollection();
     }
@@ -281,6 +296,13 @@ void OpObserverImpl::onRenameCollection(OperationContext* opCtx,
         DurableViewCatalog::onExternalChange(
             opCtx, NamespaceString(DurableViewCatalog::viewsCollectionName()));
     }
+    if (fromCollection.coll() == CollectionStatistics::kCollectionName ||
+        toCollection.coll() == CollectionStatistics::kCollectionName) {
+        CollectionInfoCache::onStatisticsChange(opCtx, fromCollection);
+        if (toCollection.db() != fromCollection.db()) {
+            CollectionInfoCache::onStatisticsChange(opCtx, toCollection);
+        }
+    }
 
     getGlobalAuthorizationManager()->logOp(opCtx, "c", cmdNss, cmdObj, nullptr);
     logOpForDbHash(opCtx, cmdNss);
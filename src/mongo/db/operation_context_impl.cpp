@@ -57,6 +57,10 @@ OperationContextImpl::OperationContextImpl(Client* client,
                                            boost::optional<LogicalSessionId> lsid)
     : OperationContext(client, opId, std::move(lsid)) {
     setLockState(newLocker());
+    if (client && !client->isFromUserConnection()) {
+        // Replication and other internal work is admitted ahead of user operations.
+        lockState()->setAdmissionPriority(AdmissionPriority::kHigh);
+    }
     StorageEngine* storageEngine = getServiceContext()->getGlobalStorageEngine();
     setRecoveryUnit(storageEngine->newRecoveryUnit(), kNotInUnitOfWork);
 }
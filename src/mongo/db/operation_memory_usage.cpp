@@ -0,0 +1,82 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/operation_memory_usage.h"
+
+#include "mongo/db/operation_context.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+namespace {
+const auto getOperationMemoryUsage = OperationContext::declareDecoration<OperationMemoryUsage>();
+}  // namespace
+
+OperationMemoryUsage& OperationMemoryUsage::get(OperationContext* opCtx) {
+    return getOperationMemoryUsage(opCtx);
+}
+
+const OperationMemoryUsage& OperationMemoryUsage::get(const OperationContext* opCtx) {
+    return getOperationMemoryUsage(opCtx);
+}
+
+void OperationMemoryUsage::add(long long bytes) {
+    // Only the thread running the operation updates the counters, so the peak cannot be raised
+    // concurrently.
+    const long long current = _currentBytes.addAndFetch(bytes);
+    if (current > _peakBytes.load()) {
+        _peakBytes.store(current);
+    }
+}
+
+OperationMemoryUsage::Tracker::~Tracker() {
+    detach();
+}
+
+void OperationMemoryUsage::Tracker::set(size_t bytes) {
+    if (_opCtx && bytes != _bytes) {
+        get(_opCtx).add(static_cast<long long>(bytes) - static_cast<long long>(_bytes));
+    }
+    _bytes = bytes;
+}
+
+void OperationMemoryUsage::Tracker::detach() {
+    if (_opCtx) {
+        get(_opCtx).add(-static_cast<long long>(_bytes));
+        _opCtx = nullptr;
+    }
+}
+
+void OperationMemoryUsage::Tracker::attach(OperationContext* opCtx) {
+    invariant(!_opCtx);
+    _opCtx = opCtx;
+    get(_opCtx).add(static_cast<long long>(_bytes));
+}
+
+}  // namespace mongo
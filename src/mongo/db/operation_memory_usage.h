@@ -0,0 +1,114 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+class OperationContext;
+
+/**
+ * Accounts for the transient memory held by the query execution structures of an operation, such
+ * as blocking sort buffers and in-memory $group tables, and records the most it ever held.
+ * OperationMemoryUsage is a decoration on OperationContext. Its counters may be read by threads
+ * reporting on the operation, such as currentOp, while the operation updates them.
+ */
+class OperationMemoryUsage {
+    MONGO_DISALLOW_COPYING(OperationMemoryUsage);
+
+public:
+    /**
+     * Reports the memory held by one consumer, such as a plan stage, to the operation it runs in.
+     * A consumer which outlives an operation, for example as part of a cursor, moves its memory
+     * to the next operation with detach() and attach(). The memory still held by a consumer is
+     * released from the operation when the Tracker is destroyed.
+     */
+    class Tracker {
+        MONGO_DISALLOW_COPYING(Tracker);
+
+    public:
+        /**
+         * 'opCtx' may be null, in which case nothing is reported until the Tracker is attached.
+         */
+        explicit Tracker(OperationContext* opCtx) : _opCtx(opCtx) {}
+        ~Tracker();
+
+        /**
+         * Sets the number of bytes held by the consumer.
+         */
+        void set(size_t bytes);
+
+        /**
+         * Releases the memory held by the consumer from the operation it is attached to.
+         */
+        void detach();
+
+        /**
+         * Charges the memory held by the consumer to the operation of 'opCtx'.
+         */
+        void attach(OperationContext* opCtx);
+
+        size_t bytes() const {
+            return _bytes;
+        }
+
+    private:
+        OperationContext* _opCtx;
+        size_t _bytes = 0;
+    };
+
+    OperationMemoryUsage() = default;
+
+    static OperationMemoryUsage& get(OperationContext* opCtx);
+    static const OperationMemoryUsage& get(const OperationContext* opCtx);
+
+    /**
+     * Adds 'bytes', which is negative when memory is released, to the memory held by the
+     * operation and raises the high-water mark if needed.
+     */
+    void add(long long bytes);
+
+    long long currentBytes() const {
+        return _currentBytes.load();
+    }
+
+    long long peakBytes() const {
+        return _peakBytes.load();
+    }
+
+private:
+    AtomicInt64 _currentBytes{0};
+    AtomicInt64 _peakBytes{0};
+};
+
+}  // namespace mongo
@@ -0,0 +1,94 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/client.h"
+#include "mongo/db/operation_memory_usage.h"
+#include "mongo/db/service_context_noop.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+TEST(OperationMemoryUsageTest, PeakIsHighWaterMark) {
+    OperationMemoryUsage usage;
+    usage.add(100);
+    usage.add(50);
+    usage.add(-120);
+    usage.add(20);
+    ASSERT_EQ(50, usage.currentBytes());
+    ASSERT_EQ(150, usage.peakBytes());
+}
+
+TEST(OperationMemoryUsageTest, TrackersAddUpAndReleaseOnDestruction) {
+    auto serviceCtx = stdx::make_unique<ServiceContextNoop>();
+    auto client = serviceCtx->makeClient("OperationMemoryUsageTest");
+    auto opCtx = client->makeOperationContext();
+    auto& usage = OperationMemoryUsage::get(opCtx.get());
+
+    {
+        OperationMemoryUsage::Tracker first(opCtx.get());
+        OperationMemoryUsage::Tracker second(opCtx.get());
+        first.set(1000);
+        second.set(500);
+        first.set(200);
+        ASSERT_EQ(700, usage.currentBytes());
+        ASSERT_EQ(1500, usage.peakBytes());
+    }
+
+    ASSERT_EQ(0, usage.currentBytes());
+    ASSERT_EQ(1500, usage.peakBytes());
+}
+
+TEST(OperationMemoryUsageTest, TrackerMovesMemoryBetweenOperations) {
+    auto serviceCtx = stdx::make_unique<ServiceContextNoop>();
+    auto client = serviceCtx->makeClient("OperationMemoryUsageTest");
+
+    OperationMemoryUsage::Tracker tracker(nullptr);
+    tracker.set(300);
+
+    {
+        auto opCtx = client->makeOperationContext();
+        tracker.attach(opCtx.get());
+        tracker.set(400);
+        ASSERT_EQ(400, OperationMemoryUsage::get(opCtx.get()).peakBytes());
+        tracker.detach();
+        ASSERT_EQ(0, OperationMemoryUsage::get(opCtx.get()).currentBytes());
+    }
+
+    // The next operation is charged for the memory the tracker still holds.
+    auto opCtx = client->makeOperationContext();
+    tracker.attach(opCtx.get());
+    ASSERT_EQ(400, OperationMemoryUsage::get(opCtx.get()).currentBytes());
+    tracker.detach();
+}
+
+}  // namespace
+}  // namespace mongo
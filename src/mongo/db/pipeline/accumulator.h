@@ -60,11 +60,32 @@ public:
         processInternal(input, merging);
     }
 
+    /**
+     * Processes the elements 'column[rows[0]]' to 'column[rows[n - 1]]', in that order, as if each
+     * had been passed to process() with 'merging' false. EOO elements are processed as missing
+     * values. Accumulators which don't need to build a Value for each input override this with a
+     * tighter loop.
+     */
+    virtual void processColumn(const BSONElement* column, const uint32_t* rows, size_t n) {
+        for (size_t i = 0; i < n; ++i) {
+            processInternal(Value(column[rows[i]]), false);
+        }
+    }
+
     /** Marks the end of the evaluate() phase and return accumulated result.
      *  toBeMerged should be true when the outputs will be merged by process().
      */
     virtual Value getValue(bool toBeMerged) = 0;
 
+    /**
+     * If set, getValue(true) returns the partial results which would otherwise be Documents in the
+     * compact binary format of accumulator_partial_state.h. Only meant for mergers which are known
+     * to understand that format. process() accepts both formats when merging, regardless.
+     */
+    void setBinaryPartialState(bool binaryPartialState) {
+        _binaryPartialState = binaryPartialState;
+    }
+
     /// The name of the op as used in a serialization of the pipeline.
     virtual const char* getOpName() const = 0;
 
@@ -96,6 +117,9 @@ protected:
     /// subclasses are expected to update this as necessary
     int _memUsageBytes = 0;
 
+    /// See setBinaryPartialState()
+    bool _binaryPartialState = false;
+
 private:
     boost::intrusive_ptr<ExpressionContext> _expCtx;
 };
@@ -166,6 +190,7 @@ public:
     explicit AccumulatorSum(const boost::intrusive_ptr<ExpressionContext>& expCtx);
 
     void processInternal(const Value& input, bool merging) final;
+    void processColumn(const BSONElement* column, const uint32_t* rows, size_t n) final;
     Value getValue(bool toBeMerged) final;
     const char* getOpName() const final;
     void reset() final;
@@ -254,6 +279,7 @@ public:
     explicit AccumulatorAvg(const boost::intrusive_ptr<ExpressionContext>& expCtx);
 
     void processInternal(const Value& input, bool merging) final;
+    void processColumn(const BSONElement* column, const uint32_t* rows, size_t n) final;
     Value getValue(bool toBeMerged) final;
     const char* getOpName() const final;
     void reset() final;
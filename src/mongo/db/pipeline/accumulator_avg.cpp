@@ -31,6 +31,7 @@
 #include "mongo/db/pipeline/accumulator.h"
 
 #include "mongo/db/pipeline/accumulation_statement.h"
+#include "mongo/db/pipeline/accumulator_partial_state.h"
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context.h"
@@ -55,6 +56,25 @@ const char countName[] = "count";
 }  // namespace
 
 void AccumulatorAvg::processInternal(const Value& input, bool merging) {
+    PartialStateKind kind;
+    if (merging && PartialStateReader::isPartialState(input, &kind)) {
+        PartialStateReader reader(input);
+        if (kind == PartialStateKind::kAvgDecimal) {
+            _decimalTotal = _decimalTotal.add(reader.readDecimal());
+            _isDecimal = true;
+        } else {
+            uassert(40509,
+                    "Unexpected partial state for $avg",
+                    kind == PartialStateKind::kAvgDouble);
+            const double subTotal = reader.readDouble();
+            const double subTotalError = reader.readDouble();
+            _nonDecimalTotal.addDouble(subTotal);
+            _nonDecimalTotal.addDouble(subTotalError);
+        }
+        _count += reader.readLong();
+        return;
+    }
+
     if (merging) {
         // We expect an object that contains both a subtotal and a count. Additionally there may
         // be an error value, that allows for additional precision.
@@ -92,6 +112,31 @@ void AccumulatorAvg::processInternal(const Value& input, bool merging) {
     _count++;
 }
 
+void AccumulatorAvg::processColumn(const BSONElement* column, const uint32_t* rows, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        const BSONElement& elem = column[rows[i]];
+        switch (elem.type()) {
+            case NumberDecimal:
+                _decimalTotal = _decimalTotal.add(elem._numberDecimal());
+                _isDecimal = true;
+                break;
+            case NumberLong:
+                // Avoid summation using double as that loses precision.
+                _nonDecimalTotal.addLong(elem._numberLong());
+                break;
+            case NumberInt:
+                _nonDecimalTotal.addDouble(elem._numberInt());
+                break;
+            case NumberDouble:
+                _nonDecimalTotal.addDouble(elem._numberDouble());
+                break;
+            default:
+                continue;
+        }
+        _count++;
+    }
+}
+
 intrusive_ptr<Accumulator> AccumulatorAvg::create(
     const boost::intrusive_ptr<ExpressionContext>& expCtx) {
     return new AccumulatorAvg(expCtx);
@@ -103,11 +148,25 @@ Decimal128 AccumulatorAvg::_getDecimalTotal() const {
 
 Value AccumulatorAvg::getValue(bool toBeMerged) {
     if (toBeMerged) {
-        if (_isDecimal)
+        if (_isDecimal) {
+            if (_binaryPartialState) {
+                return PartialStateWriter(PartialStateKind::kAvgDecimal)
+                    .append(_getDecimalTotal())
+                    .append(_count)
+                    .done();
+            }
             return Value(Document{{subTotalName, _getDecimalTotal()}, {countName, _count}});
+        }
 
         double total, error;
         std::tie(total, error) = _nonDecimalTotal.getDoubleDouble();
+        if (_binaryPartialState) {
+            return PartialStateWriter(PartialStateKind::kAvgDouble)
+                .append(total)
+                .append(error)
+                .append(_count)
+                .done();
+        }
         return Value(
             Document{{subTotalName, total}, {countName, _count}, {subTotalErrorName, error}});
     }
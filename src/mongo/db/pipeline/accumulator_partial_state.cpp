@@ -0,0 +1,131 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/accumulator_partial_state.h"
+
+#include "mongo/base/data_type_endian.h"
+#include "mongo/base/data_view.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+namespace {
+
+ConstDataRangeCursor makeCursor(const BSONBinData& binData) {
+    const char* begin = static_cast<const char*>(binData.data);
+    return ConstDataRangeCursor(begin, begin + binData.length);
+}
+
+}  // namespace
+
+PartialStateWriter::PartialStateWriter(PartialStateKind kind) {
+    _append(static_cast<uint8_t>(kind));
+}
+
+template <typename T>
+void PartialStateWriter::_append(const T& value) {
+    invariant(_size + sizeof(T) <= kMaxSize);
+    DataView(_buf + _size).write<LittleEndian<T>>(value);
+    _size += sizeof(T);
+}
+
+PartialStateWriter& PartialStateWriter::append(double value) {
+    _append(value);
+    return *this;
+}
+
+PartialStateWriter& PartialStateWriter::append(long long value) {
+    _append(static_cast<int64_t>(value));
+    return *this;
+}
+
+PartialStateWriter& PartialStateWriter::append(Decimal128 value) {
+    const Decimal128::Value parts = value.getValue();
+    _append(parts.low64);
+    _append(parts.high64);
+    return *this;
+}
+
+Value PartialStateWriter::done() const {
+    return Value(BSONBinData(_buf, _size, BinDataGeneral));
+}
+
+bool PartialStateReader::isPartialState(const Value& value, PartialStateKind* kind) {
+    if (value.getType() != BinData) {
+        return false;
+    }
+
+    const BSONBinData binData = value.getBinData();
+    if (binData.type != BinDataGeneral || binData.length == 0) {
+        return false;
+    }
+
+    const uint8_t tag = static_cast<const uint8_t*>(binData.data)[0];
+    if (tag < static_cast<uint8_t>(PartialStateKind::kAvgDouble) ||
+        tag > static_cast<uint8_t>(PartialStateKind::kStdDev)) {
+        return false;
+    }
+
+    *kind = static_cast<PartialStateKind>(tag);
+    return true;
+}
+
+PartialStateReader::PartialStateReader(const Value& value)
+    : _cursor(makeCursor(value.getBinData())) {
+    _read<uint8_t>();  // The kind of the state
+}
+
+template <typename T>
+T PartialStateReader::_read() {
+    auto swValue = _cursor.readAndAdvance<LittleEndian<T>>();
+    uassert(40508,
+            str::stream() << "Truncated partial aggregation state: "
+                          << swValue.getStatus().reason(),
+            swValue.isOK());
+    return swValue.getValue();
+}
+
+double PartialStateReader::readDouble() {
+    return _read<double>();
+}
+
+long long PartialStateReader::readLong() {
+    return _read<int64_t>();
+}
+
+Decimal128 PartialStateReader::readDecimal() {
+    Decimal128::Value parts;
+    parts.low64 = _read<uint64_t>();
+    parts.high64 = _read<uint64_t>();
+    return Decimal128(parts);
+}
+
+}  // namespace mongo
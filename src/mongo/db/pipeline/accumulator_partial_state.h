@@ -0,0 +1,107 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstdint>
+
+#include "mongo/base/data_range_cursor.h"
+#include "mongo/db/pipeline/value.h"
+#include "mongo/platform/decimal128.h"
+
+namespace mongo {
+
+/**
+ * The compact binary encoding of the partial results of the accumulators which would otherwise
+ * send them from the shards to the merger of a $group as Documents, such as $avg and $stdDevPop.
+ *
+ * A partial state is a BinData of subtype BinDataGeneral, whose first byte identifies the kind of
+ * state and is followed by the fields of the state, in a fixed order and in little-endian byte
+ * order. Accumulators only produce partial states when asked to with
+ * Accumulator::setBinaryPartialState(), but always accept them when merging.
+ */
+enum class PartialStateKind : uint8_t {
+    // subTotal (double), subTotalError (double), count (long long)
+    kAvgDouble = 1,
+    // subTotal (Decimal128), count (long long)
+    kAvgDecimal = 2,
+    // m2 (double), mean (double), count (long long)
+    kStdDev = 3,
+};
+
+/**
+ * Builds the BinData Value of a partial state.
+ */
+class PartialStateWriter {
+public:
+    explicit PartialStateWriter(PartialStateKind kind);
+
+    PartialStateWriter& append(double value);
+    PartialStateWriter& append(long long value);
+    PartialStateWriter& append(Decimal128 value);
+
+    Value done() const;
+
+private:
+    static const size_t kMaxSize = 1 + 3 * sizeof(Decimal128::Value);
+
+    template <typename T>
+    void _append(const T& value);
+
+    char _buf[kMaxSize];
+    size_t _size = 0;
+};
+
+/**
+ * Reads back the fields of a partial state, in the order in which they were appended. Throws if
+ * the state is shorter than the fields read from it.
+ */
+class PartialStateReader {
+public:
+    /**
+     * Returns true if 'value' is a partial state, and if so, stores its kind in 'kind'.
+     */
+    static bool isPartialState(const Value& value, PartialStateKind* kind);
+
+    /**
+     * 'value' must be a partial state, which must outlive the reader.
+     */
+    explicit PartialStateReader(const Value& value);
+
+    double readDouble();
+    long long readLong();
+    Decimal128 readDecimal();
+
+private:
+    template <typename T>
+    T _read();
+
+    ConstDataRangeCursor _cursor;
+};
+
+}  // namespace mongo
@@ -31,10 +31,12 @@
 #include "mongo/db/pipeline/accumulator.h"
 
 #include "mongo/db/pipeline/accumulation_statement.h"
+#include "mongo/db/pipeline/accumulator_partial_state.h"
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/value.h"
+#include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
 using boost::intrusive_ptr;
@@ -64,10 +66,24 @@ void AccumulatorStdDev::processInternal(const Value& input, bool merging) {
         _m2 += delta * (val - _mean);
     } else {
         // This is what getValue(true) produced below.
-        verify(input.getType() == Object);
-        const double m2 = input["m2"].getDouble();
-        const double mean = input["mean"].getDouble();
-        const long long count = input["count"].getLong();
+        double m2;
+        double mean;
+        long long count;
+        PartialStateKind kind;
+        if (PartialStateReader::isPartialState(input, &kind)) {
+            uassert(40510,
+                    str::stream() << "Unexpected partial state for " << getOpName(),
+                    kind == PartialStateKind::kStdDev);
+            PartialStateReader reader(input);
+            m2 = reader.readDouble();
+            mean = reader.readDouble();
+            count = reader.readLong();
+        } else {
+            verify(input.getType() == Object);
+            m2 = input["m2"].getDouble();
+            mean = input["mean"].getDouble();
+            count = input["count"].getLong();
+        }
 
         if (count == 0)
             return;  // This partition had no data to contribute.
@@ -90,6 +106,12 @@ Value AccumulatorStdDev::getValue(bool toBeMerged) {
             return Value(BSONNULL);  // standard deviation not well defined in this case
 
         return Value(sqrt(_m2 / adjustedCount));
+    } else if (_binaryPartialState) {
+        return PartialStateWriter(PartialStateKind::kStdDev)
+            .append(_m2)
+            .append(_mean)
+            .append(_count)
+            .done();
     } else {
         return Value(DOC("m2" << _m2 << "mean" << _mean << "count" << _count));
     }
@@ -84,6 +84,34 @@ void AccumulatorSum::processInternal(const Value& input, bool merging) {
     }
 }
 
+void AccumulatorSum::processColumn(const BSONElement* column, const uint32_t* rows, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        const BSONElement& elem = column[rows[i]];
+        switch (elem.type()) {
+            case NumberInt:
+                nonDecimalTotal.addLong(elem._numberInt());
+                break;
+            case NumberLong:
+                if (totalType == NumberInt)
+                    totalType = NumberLong;
+                nonDecimalTotal.addLong(elem._numberLong());
+                break;
+            case NumberDouble:
+                if (totalType != NumberDecimal)
+                    totalType = NumberDouble;
+                nonDecimalTotal.addDouble(elem._numberDouble());
+                break;
+            case NumberDecimal:
+                totalType = NumberDecimal;
+                decimalTotal = decimalTotal.add(elem._numberDecimal());
+                break;
+            default:
+                // Non-numeric values are ignored, as in processInternal().
+                break;
+        }
+    }
+}
+
 intrusive_ptr<Accumulator> AccumulatorSum::create(
     const boost::intrusive_ptr<ExpressionContext>& expCtx) {
     return new AccumulatorSum(expCtx);
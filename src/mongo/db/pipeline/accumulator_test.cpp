@@ -28,6 +28,8 @@
 
 #include "mongo/platform/basic.h"
 
+#include <cmath>
+
 #include "mongo/db/pipeline/accumulation_statement.h"
 #include "mongo/db/pipeline/accumulator.h"
 #include "mongo/db/pipeline/document.h"
@@ -91,6 +93,21 @@ static void assertExpectedResults(
                 ASSERT_VALUE_EQ(op.second, result);
                 ASSERT_EQUALS(op.second.getType(), result.getType());
             }
+
+            // Asserts that result equals expected result when each input is on a separate shard
+            // which sends its partial result in binary form.
+            {
+                boost::intrusive_ptr<Accumulator> accum(factory(expCtx));
+                for (auto&& val : op.first) {
+                    boost::intrusive_ptr<Accumulator> shard(factory(expCtx));
+                    shard->setBinaryPartialState(true);
+                    shard->process(val, false);
+                    accum->process(shard->getValue(true), true);
+                }
+                Value result = accum->getValue(false);
+                ASSERT_VALUE_EQ(op.second, result);
+                ASSERT_EQUALS(op.second.getType(), result.getType());
+            }
         } catch (...) {
             log() << "failed with arguments: " << Value(op.first);
             throw;
@@ -154,6 +171,72 @@ TEST(Accumulators, Avg) {
         });
 }
 
+TEST(Accumulators, StdDevPop) {
+    intrusive_ptr<ExpressionContext> expCtx(new ExpressionContextForTest());
+    assertExpectedResults("$stdDevPop",
+                          expCtx,
+                          {
+                              // No documents evaluated.
+                              {{}, Value(BSONNULL)},
+                              // Non-numeric values are ignored.
+                              {{Value("string"_sd), Value(BSONNULL)}, Value(BSONNULL)},
+                              // One value.
+                              {{Value(3)}, Value(0.0)},
+                              // Two values of different numeric types.
+                              {{Value(1), Value(3LL)}, Value(1.0)},
+                          });
+}
+
+TEST(Accumulators, StdDevSamp) {
+    intrusive_ptr<ExpressionContext> expCtx(new ExpressionContextForTest());
+    assertExpectedResults("$stdDevSamp",
+                          expCtx,
+                          {
+                              // One value is not enough for a sample standard deviation.
+                              {{Value(3)}, Value(BSONNULL)},
+                              // Two values.
+                              {{Value(1), Value(3.0)}, Value(std::sqrt(2.0))},
+                          });
+}
+
+TEST(Accumulators, MergesPartialStatesOfBothFormats) {
+    intrusive_ptr<ExpressionContext> expCtx(new ExpressionContextForTest());
+    for (auto&& name : {"$avg"_sd, "$stdDevPop"_sd}) {
+        auto factory = AccumulationStatement::getFactory(name);
+        boost::intrusive_ptr<Accumulator> merger(factory(expCtx));
+        boost::intrusive_ptr<Accumulator> expected(factory(expCtx));
+        for (int shardId = 0; shardId < 4; ++shardId) {
+            boost::intrusive_ptr<Accumulator> shard(factory(expCtx));
+            shard->setBinaryPartialState(shardId % 2 == 0);
+            for (int i = 0; i < 10; ++i) {
+                shard->process(Value(shardId * 10 + i), false);
+                expected->process(Value(shardId * 10 + i), false);
+            }
+            Value partial = shard->getValue(true);
+            ASSERT_EQ(shardId % 2 == 0 ? BinData : Object, partial.getType());
+            merger->process(partial, true);
+        }
+        ASSERT_APPROX_EQUAL(expected->getValue(false).getDouble(),
+                            merger->getValue(false).getDouble(),
+                            1e-12);
+    }
+}
+
+TEST(Accumulators, RejectsTruncatedPartialState) {
+    intrusive_ptr<ExpressionContext> expCtx(new ExpressionContextForTest());
+    boost::intrusive_ptr<Accumulator> shard(
+        AccumulationStatement::getFactory("$avg")(expCtx));
+    shard->setBinaryPartialState(true);
+    shard->process(Value(1), false);
+    Value partial = shard->getValue(true);
+    BSONBinData binData = partial.getBinData();
+    Value truncated(BSONBinData(binData.data, binData.length - 1, BinDataGeneral));
+
+    boost::intrusive_ptr<Accumulator> merger(
+        AccumulationStatement::getFactory("$avg")(expCtx));
+    ASSERT_THROWS_CODE(merger->process(truncated, true), UserException, 40508);
+}
+
 TEST(Accumulators, First) {
     intrusive_ptr<ExpressionContext> expCtx(new ExpressionContextForTest());
     assertExpectedResults(
@@ -0,0 +1,175 @@
+/**
+ * Copyright (C) 2017 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/column_batch.h"
+
+#include <algorithm>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/pipeline/document.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+namespace {
+
+// These mirror ExpressionFieldPath::evaluatePath() and evaluatePathArray(), with 'path' not
+// including the leading variable name.
+Value evaluatePath(const FieldPath& path, size_t index, const Document& input);
+
+Value evaluatePathArray(const FieldPath& path, size_t index, const Value& input) {
+    dassert(input.isArray());
+
+    // Check for remaining path in each element of array
+    std::vector<Value> result;
+    const std::vector<Value>& array = input.getArray();
+    for (size_t i = 0; i < array.size(); i++) {
+        if (array[i].getType() != Object)
+            continue;
+
+        const Value nested = evaluatePath(path, index, array[i].getDocument());
+        if (!nested.missing())
+            result.push_back(nested);
+    }
+
+    return Value(std::move(result));
+}
+
+Value evaluatePath(const FieldPath& path, size_t index, const Document& input) {
+    if (index == path.getPathLength() - 1)
+        return input[path.getFieldName(index)];
+
+    const Value val = input[path.getFieldName(index)];
+    switch (val.getType()) {
+        case Object:
+            return evaluatePath(path, index + 1, val.getDocument());
+        case Array:
+            return evaluatePathArray(path, index + 1, val);
+        default:
+            return Value();
+    }
+}
+
+}  // namespace
+
+ColumnBatch::ColumnBatch(size_t capacity) : _capacity(capacity) {
+    invariant(_capacity > 0);
+    _docs.reserve(_capacity);
+}
+
+size_t ColumnBatch::addFieldColumn(const FieldPath& path) {
+    invariant(_numRows == 0);
+
+    Column column;
+    column.path = path;
+    column.elements.resize(_capacity);
+    _columns.push_back(std::move(column));
+
+    _fieldColumns.push_back(_columns.size() - 1);
+    _topLevelNames.push_back(path.getFieldName(0).toString());
+    _found.resize(_fieldColumns.size());
+    return _columns.size() - 1;
+}
+
+size_t ColumnBatch::addConstantColumn(const Value& constant) {
+    invariant(_numRows == 0);
+
+    Column column;
+    BSONObjBuilder bob;
+    constant.addToBsonObj(&bob, "");
+    column.constantHolder = bob.obj();
+    column.elements.assign(_capacity, column.constantHolder.firstElement());
+    _columns.push_back(std::move(column));
+    return _columns.size() - 1;
+}
+
+void ColumnBatch::clear() {
+    _numRows = 0;
+    _approximateSize = 0;
+    _docs.clear();
+    _ownedValues.clear();
+}
+
+void ColumnBatch::append(const BSONObj& doc) {
+    invariant(!full());
+    const size_t row = _numRows++;
+    _docs.push_back(doc);
+    _approximateSize += doc.objsize();
+
+    const size_t numFieldColumns = _fieldColumns.size();
+    for (size_t i = 0; i < numFieldColumns; ++i) {
+        _columns[_fieldColumns[i]].elements[row] = BSONElement();
+    }
+    std::fill(_found.begin(), _found.end(), 0);
+
+    // Walk the top-level fields once, stopping as soon as every column has been found.
+    size_t remaining = numFieldColumns;
+    BSONObjIterator it(doc);
+    while (remaining > 0 && it.more()) {
+        const BSONElement elem = it.next();
+        const StringData name = elem.fieldNameStringData();
+        for (size_t i = 0; i < numFieldColumns; ++i) {
+            if (_found[i] || _topLevelNames[i] != name) {
+                continue;
+            }
+
+            Column& column = _columns[_fieldColumns[i]];
+            column.elements[row] = extractPath(*column.path, 1, elem);
+            _found[i] = 1;
+            --remaining;
+        }
+    }
+}
+
+BSONElement ColumnBatch::extractPath(const FieldPath& path, size_t index, BSONElement elem) {
+    if (index == path.getPathLength()) {
+        return elem;
+    }
+
+    switch (elem.type()) {
+        case Object:
+            return extractPath(path, index + 1, elem.embeddedObject()[path.getFieldName(index)]);
+        case Array:
+            // The result is built from the objects within the array, so it can't point into the
+            // document.
+            return ownValue(evaluatePathArray(path, index, Value(elem)));
+        default:
+            return BSONElement();
+    }
+}
+
+BSONElement ColumnBatch::ownValue(const Value& val) {
+    BSONObjBuilder bob;
+    val.addToBsonObj(&bob, "");
+    _ownedValues.push_back(bob.obj());
+    return _ownedValues.back().firstElement();
+}
+
+}  // namespace mongo
@@ -0,0 +1,171 @@
+/**
+ * Copyright (C) 2017 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/bson/bsonelement.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/pipeline/document_source.h"
+#include "mongo/db/pipeline/field_path.h"
+#include "mongo/db/pipeline/value.h"
+
+namespace mongo {
+
+/**
+ * A batch of input documents decoded into columns. Each column holds, for every row of the batch,
+ * the BSONElement found at one field path of the document, or an EOO element if the path is
+ * missing. Columns may also hold a single constant repeated for every row.
+ *
+ * Decoding walks the top-level elements of each document once, so a pipeline stage that only
+ * needs a handful of fields avoids building a Document for every input. Elements point into
+ * BSONObjs owned by the batch and are valid until the next call to clear().
+ *
+ * Paths are evaluated with the same semantics as an ExpressionFieldPath rooted at $$ROOT: when
+ * a path crosses an array, the value is computed through Value and stored in the batch as an
+ * owned BSON element.
+ */
+class ColumnBatch {
+    MONGO_DISALLOW_COPYING(ColumnBatch);
+
+public:
+    explicit ColumnBatch(size_t capacity);
+
+    /**
+     * Adds a column holding the value of 'path' in each document. 'path' must not include the
+     * leading variable name. Returns the index of the column.
+     */
+    size_t addFieldColumn(const FieldPath& path);
+
+    /**
+     * Adds a column holding 'constant' for every row. Returns the index of the column.
+     */
+    size_t addConstantColumn(const Value& constant);
+
+    /**
+     * Removes all rows from the batch, keeping its columns.
+     */
+    void clear();
+
+    /**
+     * Decodes 'doc' into a new row. 'doc' must be owned and the batch must not be full.
+     */
+    void append(const BSONObj& doc);
+
+    size_t size() const {
+        return _numRows;
+    }
+
+    size_t capacity() const {
+        return _capacity;
+    }
+
+    bool full() const {
+        return _numRows >= _capacity;
+    }
+
+    size_t numColumns() const {
+        return _columns.size();
+    }
+
+    /**
+     * Returns the approximate size in bytes of the documents held by the batch.
+     */
+    size_t getApproximateSize() const {
+        return _approximateSize;
+    }
+
+    /**
+     * Returns a pointer to the size() elements of column 'i'.
+     */
+    const BSONElement* column(size_t i) const {
+        return _columns[i].elements.data();
+    }
+
+private:
+    struct Column {
+        // The path of a field column, or boost::none for a constant column.
+        boost::optional<FieldPath> path;
+
+        // Holds the constant of a constant column.
+        BSONObj constantHolder;
+
+        std::vector<BSONElement> elements;
+    };
+
+    /**
+     * Looks up the remainder of 'path' starting at 'index' below the element 'elem', which was
+     * found at path component 'index - 1'.
+     */
+    BSONElement extractPath(const FieldPath& path, size_t index, BSONElement elem);
+
+    /**
+     * Stores 'val' in an owned BSONObj held by the batch and returns it as an element.
+     */
+    BSONElement ownValue(const Value& val);
+
+    const size_t _capacity;
+    size_t _numRows = 0;
+    size_t _approximateSize = 0;
+
+    std::vector<Column> _columns;
+
+    // The indexes of the field columns in '_columns', and the first component of each of their
+    // paths. These two vectors parallel each other.
+    std::vector<size_t> _fieldColumns;
+    std::vector<std::string> _topLevelNames;
+
+    // Scratch space used by append() to track which field columns have been found.
+    std::vector<char> _found;
+
+    // The documents of the batch, and any values computed while decoding them.
+    std::vector<BSONObj> _docs;
+    std::vector<BSONObj> _ownedValues;
+};
+
+/**
+ * A DocumentSource which is able to produce its output as ColumnBatches, in addition to one
+ * Document at a time. Consumers may use either interface but must not interleave them.
+ */
+class ColumnBatchSource {
+public:
+    virtual ~ColumnBatchSource() = default;
+
+    /**
+     * Clears 'batch' and fills it with up to batch->capacity() results. Returns kAdvanced if the
+     * batch holds at least one row. Otherwise returns kEOF once the source is exhausted, or
+     * kPauseExecution if the source could not produce a result right now.
+     */
+    virtual DocumentSource::GetNextResult::ReturnStatus getNextColumnBatch(ColumnBatch* batch) = 0;
+};
+
+}  // namespace mongo
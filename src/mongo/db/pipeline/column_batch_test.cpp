@@ -0,0 +1,148 @@
+/**
+ * Copyright (C) 2017 MongoDB Inc.
+ *
+ * This program is free software: you can redistribute it and/or  modify
+ * it under the terms of the GNU Affero General Public License, version 3,
+ * as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * As a special exception, the copyright holders give permission to link the
+ * code of portions of this program with the OpenSSL library under certain
+ * conditions as described in each individual source file and distribute
+ * linked combinations including the program with the OpenSSL library. You
+ * must comply with the GNU Affero General Public License in all respects
+ * for all of the code used other than as permitted herein. If you modify
+ * file(s) with this exception, you may extend this exception to your
+ * version of the file(s), but you are not obligated to do so. If you do not
+ * wish to do so, delete this exception statement from your version. If you
+ * delete this exception statement from all source files in the program,
+ * then also delete it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/column_batch.h"
+
+#include "mongo/db/json.h"
+#include "mongo/db/pipeline/document_value_test_util.h"
+#include "mongo/db/pipeline/value.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+TEST(ColumnBatchTest, TopLevelFields) {
+    ColumnBatch batch(4);
+    ASSERT_EQ(0U, batch.addFieldColumn(FieldPath("a")));
+    ASSERT_EQ(1U, batch.addFieldColumn(FieldPath("b")));
+
+    batch.append(fromjson("{a: 1, b: 'x'}"));
+    batch.append(fromjson("{b: 2.5, c: 3}"));
+    ASSERT_EQ(2U, batch.size());
+    ASSERT_FALSE(batch.full());
+
+    const BSONElement* a = batch.column(0);
+    const BSONElement* b = batch.column(1);
+    ASSERT_EQ(1, a[0].numberInt());
+    ASSERT_TRUE(a[1].eoo());
+    ASSERT_EQ("x", b[0].valueStringData());
+    ASSERT_EQ(2.5, b[1].numberDouble());
+}
+
+TEST(ColumnBatchTest, FirstOccurrenceOfDuplicateFieldWins) {
+    ColumnBatch batch(1);
+    batch.addFieldColumn(FieldPath("a"));
+    batch.append(fromjson("{a: 1, a: 2}"));
+    ASSERT_EQ(1, batch.column(0)[0].numberInt());
+}
+
+TEST(ColumnBatchTest, SameFieldInSeveralColumns) {
+    ColumnBatch batch(1);
+    batch.addFieldColumn(FieldPath("a"));
+    batch.addFieldColumn(FieldPath("a.b"));
+    batch.append(fromjson("{a: {b: 5}}"));
+    ASSERT_EQ(Object, batch.column(0)[0].type());
+    ASSERT_EQ(5, batch.column(1)[0].numberInt());
+}
+
+TEST(ColumnBatchTest, DottedPaths) {
+    ColumnBatch batch(4);
+    batch.addFieldColumn(FieldPath("a.b.c"));
+
+    batch.append(fromjson("{a: {b: {c: 1}}}"));
+    batch.append(fromjson("{a: {b: 1}}"));
+    batch.append(fromjson("{a: {x: {c: 1}}}"));
+    batch.append(fromjson("{a: 'str'}"));
+
+    const BSONElement* col = batch.column(0);
+    ASSERT_EQ(1, col[0].numberInt());
+    ASSERT_TRUE(col[1].eoo());
+    ASSERT_TRUE(col[2].eoo());
+    ASSERT_TRUE(col[3].eoo());
+    ASSERT_TRUE(batch.full());
+}
+
+TEST(ColumnBatchTest, ArrayInPathMatchesFieldPathExpressionSemantics) {
+    ColumnBatch batch(3);
+    batch.addFieldColumn(FieldPath("a.b"));
+
+    batch.append(fromjson("{a: [{b: 1}, 2, {c: 3}, {b: [4, 5]}]}"));
+    batch.append(fromjson("{a: []}"));
+    batch.append(fromjson("{a: [1, 2]}"));
+
+    const BSONElement* col = batch.column(0);
+    ASSERT_VALUE_EQ(Value(col[0]), Value(BSON_ARRAY(1 << BSON_ARRAY(4 << 5))));
+    ASSERT_VALUE_EQ(Value(col[1]), Value(BSONArray()));
+    ASSERT_VALUE_EQ(Value(col[2]), Value(BSONArray()));
+}
+
+TEST(ColumnBatchTest, ArrayAsFinalComponentIsReturnedAsIs) {
+    ColumnBatch batch(1);
+    batch.addFieldColumn(FieldPath("a"));
+    batch.append(fromjson("{a: [1, 2]}"));
+    ASSERT_VALUE_EQ(Value(batch.column(0)[0]), Value(BSON_ARRAY(1 << 2)));
+}
+
+TEST(ColumnBatchTest, ConstantColumns) {
+    ColumnBatch batch(2);
+    ASSERT_EQ(0U, batch.addConstantColumn(Value(1)));
+    ASSERT_EQ(1U, batch.addFieldColumn(FieldPath("a")));
+    ASSERT_EQ(2U, batch.addConstantColumn(Value(BSONNULL)));
+    ASSERT_EQ(3U, batch.numColumns());
+
+    batch.append(fromjson("{a: 1}"));
+    batch.append(BSONObj());
+    for (size_t i = 0; i < batch.size(); ++i) {
+        ASSERT_EQ(1, batch.column(0)[i].numberInt());
+        ASSERT_EQ(jstNULL, batch.column(2)[i].type());
+    }
+    ASSERT_TRUE(batch.column(1)[1].eoo());
+}
+
+TEST(ColumnBatchTest, ClearAllowsReuse) {
+    ColumnBatch batch(2);
+    batch.addFieldColumn(FieldPath("a"));
+
+    batch.append(fromjson("{a: 1}"));
+    batch.append(fromjson("{a: 2}"));
+    ASSERT_TRUE(batch.full());
+    ASSERT_GT(batch.getApproximateSize(), 0U);
+
+    batch.clear();
+    ASSERT_EQ(0U, batch.size());
+    ASSERT_EQ(0U, batch.getApproximateSize());
+
+    batch.append(fromjson("{b: 1}"));
+    ASSERT_EQ(1U, batch.size());
+    ASSERT_TRUE(batch.column(0)[0].eoo());
+}
+
+}  // namespace
+}  // namespace mongo
@@ -30,6 +30,8 @@
 
 #include "mongo/db/pipeline/document_source_cursor.h"
 
+#include <set>
+
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/db_raii.h"
@@ -64,6 +66,76 @@ DocumentSource::GetNextResult DocumentSourceCursor::getNext() {
     return std::move(out);
 }
 
+DocumentSource::GetNextResult::ReturnStatus DocumentSourceCursor::getNextColumnBatch(
+    ColumnBatch* batch) {
+    pExpCtx->checkForInterrupt();
+    batch->clear();
+
+    // Hand over anything already converted to Documents by getNext() first.
+    while (!_currentBatch.empty() && !batch->full()) {
+        batch->append(_currentBatch.front().toBson());
+        _currentBatch.pop_front();
+    }
+
+    if (!_exec) {
+        // No more documents.
+        if (batch->size() == 0) {
+            dispose();
+            return GetNextResult::ReturnStatus::kEOF;
+        }
+        return GetNextResult::ReturnStatus::kAdvanced;
+    }
+
+    PlanExecutor::ExecState state = PlanExecutor::ADVANCED;
+    BSONObj resultObj;
+    BSONObj indexKeyPattern;
+    {
+        AutoGetCollectionForRead autoColl(pExpCtx->opCtx, _exec->nss());
+        _exec->restoreState();
+
+        ON_BLOCK_EXIT([this] { recordPlanSummaryStats(); });
+
+        while (!batch->full() && batch->getApproximateSize() <=
+                   static_cast<size_t>(internalDocumentSourceCursorBatchSizeBytes.load())) {
+            if (_limit && _docsAddedToBatches == _limit->getLimit()) {
+                break;
+            }
+
+            state = _exec->getNextWithIndexKeyPattern(&resultObj, &indexKeyPattern);
+            if (state != PlanExecutor::ADVANCED) {
+                break;
+            }
+
+            if (_shouldProduceEmptyDocs) {
+                batch->append(BSONObj());
+            } else if (!indexKeyPattern.isEmpty()) {
+                prepareForIndexKeys(indexKeyPattern);
+                batch->append(objFromIndexKey(resultObj));
+            } else {
+                batch->append(resultObj.getOwned());
+            }
+            if (_limit) {
+                ++_docsAddedToBatches;
+            }
+        }
+
+        if (state == PlanExecutor::ADVANCED &&
+            !(_limit && _docsAddedToBatches == _limit->getLimit())) {
+            // End this batch and prepare PlanExecutor for yielding.
+            _exec->saveState();
+            return GetNextResult::ReturnStatus::kAdvanced;
+        }
+    }
+
+    // If we got here, there won't be any more documents, so destroy our PlanExecutor.
+    cleanupExecutor();
+
+    // We've reached our limit or exhausted the cursor.
+    uassertExecutorFinished(state, resultObj);
+    return batch->size() > 0 ? GetNextResult::ReturnStatus::kAdvanced
+                             : GetNextResult::ReturnStatus::kEOF;
+}
+
 void DocumentSourceCursor::loadBatch() {
     if (!_exec) {
         // No more documents.
@@ -73,6 +145,7 @@ void DocumentSourceCursor::loadBatch() {
 
     PlanExecutor::ExecState state;
     BSONObj resultObj;
+    BSONObj indexKeyPattern;
     {
         AutoGetCollectionForRead autoColl(pExpCtx->opCtx, _exec->nss());
         _exec->restoreState();
@@ -81,9 +154,13 @@ void DocumentSourceCursor::loadBatch() {
         {
             ON_BLOCK_EXIT([this] { recordPlanSummaryStats(); });
 
-            while ((state = _exec->getNext(&resultObj, nullptr)) == PlanExecutor::ADVANCED) {
+            while ((state = _exec->getNextWithIndexKeyPattern(&resultObj, &indexKeyPattern)) ==
+                   PlanExecutor::ADVANCED) {
                 if (_shouldProduceEmptyDocs) {
                     _currentBatch.push_back(Document());
+                } else if (!indexKeyPattern.isEmpty()) {
+                    prepareForIndexKeys(indexKeyPattern);
+                    _currentBatch.push_back(documentFromIndexKey(resultObj));
                 } else if (_dependencies) {
                     _currentBatch.push_back(_dependencies->extractFields(resultObj));
                 } else {
@@ -112,6 +189,70 @@ void DocumentSourceCursor::loadBatch() {
     // use dispose() since we want to keep the current batch.
     cleanupExecutor();
 
+    uassertExecutorFinished(state, resultObj);
+}
+
+void DocumentSourceCursor::prepareForIndexKeys(const BSONObj& indexKeyPattern) {
+    if (indexKeyPattern.binaryEqual(_indexKeyPattern)) {
+        return;
+    }
+    _indexKeyPattern = indexKeyPattern.getOwned();
+    _indexKeyFields.clear();
+
+    // The projection is a simple inclusion of top-level fields, which includes _id unless it is
+    // excluded explicitly. Without a projection, every field of the key is kept.
+    bool includeId = true;
+    std::set<StringData> includedFields;
+    for (auto&& elem : _projection) {
+        if (elem.fieldNameStringData() == "_id") {
+            includeId = elem.trueValue();
+        } else if ((elem.isNumber() || elem.isBoolean()) && elem.trueValue()) {
+            includedFields.insert(elem.fieldNameStringData());
+        }
+    }
+
+    size_t position = 0;
+    for (auto&& elem : _indexKeyPattern) {
+        const StringData fieldName = elem.fieldNameStringData();
+        const bool included = _projection.isEmpty() ||
+            (fieldName == "_id" ? includeId : includedFields.count(fieldName) > 0);
+        if (included) {
+            _indexKeyFields.emplace_back(position, fieldName.toString());
+        }
+        ++position;
+    }
+}
+
+Document DocumentSourceCursor::documentFromIndexKey(const BSONObj& key) const {
+    MutableDocument doc(_indexKeyFields.size());
+    auto field = _indexKeyFields.begin();
+    size_t position = 0;
+    for (BSONObjIterator it(key); it.more() && field != _indexKeyFields.end(); ++position) {
+        BSONElement elem = it.next();
+        if (position == field->first) {
+            doc.addField(field->second, Value(elem));
+            ++field;
+        }
+    }
+    return doc.freeze();
+}
+
+BSONObj DocumentSourceCursor::objFromIndexKey(const BSONObj& key) const {
+    BSONObjBuilder builder;
+    auto field = _indexKeyFields.begin();
+    size_t position = 0;
+    for (BSONObjIterator it(key); it.more() && field != _indexKeyFields.end(); ++position) {
+        BSONElement elem = it.next();
+        if (position == field->first) {
+            builder.appendAs(elem, field->second);
+            ++field;
+        }
+    }
+    return builder.obj();
+}
+
+void DocumentSourceCursor::uassertExecutorFinished(PlanExecutor::ExecState state,
+                                                   const BSONObj& resultObj) {
     switch (state) {
         case PlanExecutor::ADVANCED:
         case PlanExecutor::IS_EOF:
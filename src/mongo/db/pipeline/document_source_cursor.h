@@ -29,8 +29,12 @@
 #pragma once
 
 #include <deque>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "mongo/db/namespace_string.h"
+#include "mongo/db/pipeline/column_batch.h"
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/document_source_limit.h"
 #include "mongo/db/query/plan_summary_stats.h"
@@ -42,11 +46,17 @@ class PlanExecutor;
 
 /**
  * Constructs and returns Documents from the BSONObj objects produced by a supplied PlanExecutor.
+ * The BSONObjs can instead be decoded directly into ColumnBatches. When the PlanExecutor returns
+ * covered index keys, the projected fields are taken from the keys directly.
  */
-class DocumentSourceCursor final : public DocumentSource {
+class DocumentSourceCursor final : public DocumentSource, public ColumnBatchSource {
 public:
     // virtuals from DocumentSource
     GetNextResult getNext() final;
+
+    // virtuals from ColumnBatchSource
+    GetNextResult::ReturnStatus getNextColumnBatch(ColumnBatch* batch) final;
+
     const char* getSourceName() const final;
     BSONObjSet getOutputSorts() final {
         return _outputSorts;
@@ -162,6 +172,25 @@ private:
      */
     void loadBatch();
 
+    /**
+     * Throws if 'state', the state in which '_exec' stopped producing results, indicates that it
+     * was killed or failed. 'resultObj' is the last object returned by '_exec'.
+     */
+    void uassertExecutorFinished(PlanExecutor::ExecState state, const BSONObj& resultObj);
+
+    /**
+     * Prepares '_indexKeyFields' for reading the projected fields out of keys of the index with
+     * key pattern 'indexKeyPattern'.
+     */
+    void prepareForIndexKeys(const BSONObj& indexKeyPattern);
+
+    /**
+     * Returns the projected fields of the index key 'key' as a Document and as a BSONObj
+     * respectively. prepareForIndexKeys() must have been called with the key pattern of its index.
+     */
+    Document documentFromIndexKey(const BSONObj& key) const;
+    BSONObj objFromIndexKey(const BSONObj& key) const;
+
     void recordPlanSummaryStats();
 
     std::deque<Document> _currentBatch;
@@ -172,6 +201,11 @@ private:
     BSONObj _projection;
     bool _shouldProduceEmptyDocs = false;
     boost::optional<ParsedDeps> _dependencies;
+
+    // The key pattern of the last index key returned by '_exec', and the positions within its keys
+    // of the fields which '_projection' includes, along with their names.
+    BSONObj _indexKeyPattern;
+    std::vector<std::pair<size_t, std::string>> _indexKeyFields;
     boost::intrusive_ptr<DocumentSourceLimit> _limit;
     long long _docsAddedToBatches;  // for _limit enforcement
 
@@ -26,6 +26,8 @@
  *    it in the license file.
  */
 
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kQuery
+
 #include "mongo/platform/basic.h"
 
 #include "mongo/db/pipeline/document_source_graph_lookup.h"
@@ -41,12 +43,18 @@
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/value.h"
 #include "mongo/db/query/query_planner_common.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/util/log.h"
 
 namespace mongo {
 
 using boost::intrusive_ptr;
 
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceGraphLookupMaxMemoryBytes,
+                              int,
+                              100 * 1024 * 1024);
+
 namespace dps = ::mongo::dotted_path_support;
 
 std::unique_ptr<LiteParsedDocumentSourceOneForeignCollection> DocumentSourceGraphLookUp::liteParse(
@@ -98,11 +106,9 @@ DocumentSource::GetNextResult DocumentSourceGraphLookUp::getNext() {
     performSearch();
 
     std::vector<Value> results;
-    while (!_visited.empty()) {
+    while (!visitedEmpty()) {
         // Remove elements one at a time to avoid consuming more memory.
-        auto it = _visited.begin();
-        results.push_back(Value(it->second));
-        _visited.erase(it);
+        results.push_back(Value(popVisited()));
     }
 
     MutableDocument output(*_input);
@@ -110,7 +116,7 @@ DocumentSource::GetNextResult DocumentSourceGraphLookUp::getNext() {
 
     _visitedUsageBytes = 0;
 
-    invariant(_visited.empty());
+    invariant(visitedEmpty());
 
     return output.freeze();
 }
@@ -121,7 +127,7 @@ DocumentSource::GetNextResult DocumentSourceGraphLookUp::getNextUnwound() {
     // If the unwind is not preserving empty arrays, we might have to process multiple inputs before
     // we get one that will produce an output.
     while (true) {
-        if (_visited.empty()) {
+        if (visitedEmpty()) {
             // No results are left for the current input, so we should move on to the next one and
             // perform a new search.
 
@@ -137,7 +143,7 @@ DocumentSource::GetNextResult DocumentSourceGraphLookUp::getNextUnwound() {
         }
         MutableDocument unwound(*_input);
 
-        if (_visited.empty()) {
+        if (visitedEmpty()) {
             if ((*_unwind)->preserveNullAndEmptyArrays()) {
                 // Since "preserveNullAndEmptyArrays" was specified, output a document even though
                 // we had no result.
@@ -151,13 +157,11 @@ DocumentSource::GetNextResult DocumentSourceGraphLookUp::getNextUnwound() {
                 continue;
             }
         } else {
-            auto it = _visited.begin();
-            unwound.setNestedField(_as, Value(it->second));
+            unwound.setNestedField(_as, Value(popVisited()));
             if (indexPath) {
                 unwound.setNestedField(*indexPath, Value(_outputIndex));
                 ++_outputIndex;
             }
-            _visited.erase(it);
         }
 
         return unwound.freeze();
@@ -168,6 +172,25 @@ void DocumentSourceGraphLookUp::doDispose() {
     _cache.clear();
     _frontier.clear();
     _visited.clear();
+    _spilledIds.clear();
+    _spilledIdsUsageBytes = 0;
+    _spilledVisited.clear();
+}
+
+Document DocumentSourceGraphLookUp::popVisited() {
+    if (!_visited.empty()) {
+        auto it = _visited.begin();
+        Document result = std::move(it->second);
+        _visited.erase(it);
+        return result;
+    }
+
+    invariant(!_spilledVisited.empty());
+    Document result = _spilledVisited.front()->next().second;
+    if (!_spilledVisited.front()->more()) {
+        _spilledVisited.erase(_spilledVisited.begin());
+    }
+    return result;
 }
 
 void DocumentSourceGraphLookUp::doBreadthFirstSearch() {
@@ -221,12 +244,16 @@ void DocumentSourceGraphLookUp::doBreadthFirstSearch() {
 
     _frontier.clear();
     _frontierUsageBytes = 0;
+
+    // The spilled ids are only needed to de-duplicate during the search.
+    _spilledIds.clear();
+    _spilledIdsUsageBytes = 0;
 }
 
 bool DocumentSourceGraphLookUp::addToVisitedAndFrontier(Document result, long long depth) {
     auto id = result.getField("_id");
 
-    if (_visited.find(id) != _visited.end()) {
+    if (_visited.find(id) != _visited.end() || _spilledIds.find(id) != _spilledIds.end()) {
         // We've already seen this object, don't repeat any work.
         return false;
     }
@@ -382,11 +409,39 @@ BSONObjSet DocumentSourceGraphLookUp::getOutputSorts() {
 }
 
 void DocumentSourceGraphLookUp::checkMemoryUsage() {
-    // TODO SERVER-23980: Implement spilling to disk if allowDiskUse is specified.
+    const bool extSortAllowed = pExpCtx->extSortAllowed && !pExpCtx->inRouter;
+    // The '_id' values of spilled documents stay in memory, so they count against the limit too.
+    auto usageBytes = [this] {
+        return _visitedUsageBytes + _frontierUsageBytes + _spilledIdsUsageBytes;
+    };
+    if (usageBytes() >= _maxMemoryUsageBytes && extSortAllowed && !_visited.empty()) {
+        spillVisited();
+    }
+
     uassert(40099,
-            "$graphLookup reached maximum memory consumption",
-            (_visitedUsageBytes + _frontierUsageBytes) < _maxMemoryUsageBytes);
-    _cache.evictDownTo(_maxMemoryUsageBytes - _frontierUsageBytes - _visitedUsageBytes);
+            extSortAllowed ? "$graphLookup reached maximum memory consumption"
+                           : "$graphLookup reached maximum memory consumption. Pass "
+                             "allowDiskUse:true to opt in to spilling to disk.",
+            usageBytes() < _maxMemoryUsageBytes);
+    _cache.evictDownTo(_maxMemoryUsageBytes - usageBytes());
+}
+
+void DocumentSourceGraphLookUp::spillVisited() {
+    SortedFileWriter<Value, Document> writer(SortOptions().TempDir(pExpCtx->tempDir));
+    while (!_visited.empty()) {
+        // Remove elements one at a time to avoid consuming more memory.
+        auto it = _visited.begin();
+        writer.addAlreadySorted(it->first, it->second);
+        const size_t idUsageBytes = it->first.getApproximateSize();
+        _visitedUsageBytes -= idUsageBytes + it->second.getApproximateSize();
+        _spilledIdsUsageBytes += idUsageBytes;
+        _spilledIds.insert(it->first);
+        _visited.erase(it);
+    }
+    _spilledVisited.emplace_back(writer.done());
+
+    LOG(1) << "$graphLookup spilled " << _spilledVisited.size()
+           << " file(s) of discovered documents to disk";
 }
 
 void DocumentSourceGraphLookUp::serializeToArray(
@@ -458,8 +513,10 @@ DocumentSourceGraphLookUp::DocumentSourceGraphLookUp(
       _additionalFilter(additionalFilter),
       _depthField(depthField),
       _maxDepth(maxDepth),
+      _maxMemoryUsageBytes(internalDocumentSourceGraphLookupMaxMemoryBytes.load()),
       _frontier(pExpCtx->getValueComparator().makeUnorderedValueSet()),
       _visited(ValueComparator::kInstance.makeUnorderedValueMap<Document>()),
+      _spilledIds(ValueComparator::kInstance.makeUnorderedValueSet()),
       _cache(pExpCtx->getValueComparator()),
       _unwind(unwindSrc) {
     const auto& resolvedNamespace = pExpCtx->getResolvedNamespace(_from);
@@ -612,3 +669,6 @@ intrusive_ptr<DocumentSource> DocumentSourceGraphLookUp::createFromBson(
     return std::move(newSource);
 }
 }  // namespace mongo
+
+#include "mongo/db/sorter/sorter.cpp"
+// Explicit instantiation unneeded since we aren't exposing Sorter outside of this file.
@@ -33,9 +33,17 @@
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/lookup_set_cache.h"
 #include "mongo/db/pipeline/value_comparator.h"
+#include "mongo/db/sorter/sorter.h"
 
 namespace mongo {
 
+/**
+ * The most memory, in bytes, that the documents discovered by a $graphLookup search, along with
+ * its frontier, may use. With allowDiskUse, discovered documents are spilled to disk instead of
+ * failing the search.
+ */
+extern AtomicInt32 internalDocumentSourceGraphLookupMaxMemoryBytes;
+
 class DocumentSourceGraphLookUp final : public DocumentSourceNeedsMongod {
 public:
     static std::unique_ptr<LiteParsedDocumentSourceOneForeignCollection> liteParse(
@@ -152,11 +160,30 @@ private:
     void addToCache(Document result, const ValueUnorderedSet& queried);
 
     /**
-     * Assert that '_visited' and '_frontier' have not exceeded the maximum meory usage, and then
-     * evict from '_cache' until this source is using less than '_maxMemoryUsageBytes'.
+     * Spills '_visited' to disk if it and '_frontier' have exceeded the maximum memory usage and
+     * spilling is allowed, otherwise asserts that they have not. Then evicts from '_cache' until
+     * this source is using less than '_maxMemoryUsageBytes'.
      */
     void checkMemoryUsage();
 
+    /**
+     * Writes the documents in '_visited' to a temporary file, keeping only their _id values in
+     * memory so that the search can still skip documents it has already seen.
+     */
+    void spillVisited();
+
+    /**
+     * Returns true if '_visited' and its spilled files have no more documents to return.
+     */
+    bool visitedEmpty() const {
+        return _visited.empty() && _spilledVisited.empty();
+    }
+
+    /**
+     * Removes and returns one of the discovered documents. Must not be called if visitedEmpty().
+     */
+    Document popVisited();
+
     /**
      * Process 'result', adding it to '_visited' with the given 'depth', and updating '_frontier'
      * with the object's 'connectTo' values.
@@ -182,11 +209,12 @@ private:
     // The aggregation pipeline to perform against the '_from' namespace.
     std::vector<BSONObj> _fromPipeline;
 
-    size_t _maxMemoryUsageBytes = 100 * 1024 * 1024;
+    size_t _maxMemoryUsageBytes;
 
     // Track memory usage to ensure we don't exceed '_maxMemoryUsageBytes'.
     size_t _visitedUsageBytes = 0;
     size_t _frontierUsageBytes = 0;
+    size_t _spilledIdsUsageBytes = 0;
 
     // Only used during the breadth-first search, tracks the set of values on the current frontier.
     ValueUnorderedSet _frontier;
@@ -196,6 +224,12 @@ private:
     // using the simple collation.
     ValueUnorderedMap<Document> _visited;
 
+    // Only used when the search has spilled. The '_id' values of the discovered documents that
+    // were written to '_spilledVisited', and the files they were written to, in the order they
+    // were written. Exhausted files are removed as the documents are returned.
+    ValueUnorderedSet _spilledIds;
+    std::vector<std::unique_ptr<Sorter<Value, Document>::Iterator>> _spilledVisited;
+
     // Caches query results to avoid repeating any work. This structure is maintained across calls
     // to getNext().
     LookupSetCache _cache;
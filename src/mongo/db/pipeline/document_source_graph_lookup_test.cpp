@@ -37,6 +37,7 @@
 #include "mongo/db/pipeline/document_source_mock.h"
 #include "mongo/db/pipeline/document_value_test_util.h"
 #include "mongo/db/pipeline/stub_mongod_interface.h"
+#include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/mongoutils/str.h"
@@ -612,5 +613,100 @@ TEST_F(DocumentSourceGraphLookUpTest, ShouldNotExpandArraysWithinArraysAtEndOfCo
     ASSERT(graphLookupStage->getNext().isEOF());
 }
 
+class DocumentSourceGraphLookUpSpillTest : public AggregationContextFixture {
+public:
+    DocumentSourceGraphLookUpSpillTest()
+        : _oldMaxMemoryBytes(internalDocumentSourceGraphLookupMaxMemoryBytes.load()),
+          _tempDir("DocumentSourceGraphLookUpSpillTest") {
+        internalDocumentSourceGraphLookupMaxMemoryBytes.store(16 * 1024);
+    }
+
+    ~DocumentSourceGraphLookUpSpillTest() {
+        internalDocumentSourceGraphLookupMaxMemoryBytes.store(_oldMaxMemoryBytes);
+    }
+
+    /**
+     * Runs a $graphLookup over a chain of 'numNodes' documents of about 'padSize' bytes each,
+     * starting at its first node, and returns the _id values of the documents it found. If
+     * 'unwind' is true, the $graphLookup absorbs an $unwind.
+     */
+    std::vector<int> runSearch(bool extSortAllowed,
+                               bool unwind,
+                               int numNodes = kNumNodes,
+                               size_t padSize = 1024) {
+        auto expCtx = getExpCtx();
+        expCtx->extSortAllowed = extSortAllowed;
+        expCtx->tempDir = _tempDir.path();
+
+        const std::string pad(padSize, 'x');
+        std::deque<DocumentSource::GetNextResult> fromContents;
+        for (int i = 0; i < numNodes; ++i) {
+            fromContents.push_back(Document{{"_id", i}, {"to", i}, {"from", i + 1}, {"pad", pad}});
+        }
+
+        NamespaceString fromNs("test", "graph_lookup");
+        expCtx->setResolvedNamespace(fromNs, {fromNs, std::vector<BSONObj>{}});
+        boost::optional<boost::intrusive_ptr<DocumentSourceUnwind>> unwindStage;
+        if (unwind) {
+            unwindStage = DocumentSourceUnwind::create(expCtx, "results", false, boost::none);
+        }
+        auto graphLookupStage =
+            DocumentSourceGraphLookUp::create(expCtx,
+                                              fromNs,
+                                              "results",
+                                              "from",
+                                              "to",
+                                              ExpressionFieldPath::create(expCtx, "start"),
+                                              boost::none,
+                                              boost::none,
+                                              boost::none,
+                                              unwindStage);
+        auto inputMock = DocumentSourceMock::create(Document{{"start", 0}});
+        graphLookupStage->setSource(inputMock.get());
+        graphLookupStage->injectMongodInterface(
+            std::make_shared<MockMongodImplementation>(std::move(fromContents)));
+
+        std::vector<int> ids;
+        for (auto next = graphLookupStage->getNext(); next.isAdvanced();
+             next = graphLookupStage->getNext()) {
+            auto results = next.getDocument()["results"];
+            if (unwind) {
+                ids.push_back(results["_id"].getInt());
+                continue;
+            }
+            for (auto&& result : results.getArray()) {
+                ids.push_back(result["_id"].getInt());
+            }
+        }
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    }
+
+    static const int kNumNodes = 200;
+
+private:
+    const int _oldMaxMemoryBytes;
+    unittest::TempDir _tempDir;
+};
+
+TEST_F(DocumentSourceGraphLookUpSpillTest, ShouldErrorWhenOverMemoryLimitWithoutDiskUse) {
+    ASSERT_THROWS_CODE(runSearch(false, false), UserException, 40099);
+}
+
+TEST_F(DocumentSourceGraphLookUpSpillTest, ShouldSpillDiscoveredDocumentsWithDiskUse) {
+    for (bool unwind : {false, true}) {
+        auto ids = runSearch(true, unwind);
+        ASSERT_EQ(static_cast<size_t>(kNumNodes), ids.size());
+        for (int i = 0; i < kNumNodes; ++i) {
+            ASSERT_EQ(i, ids[i]);
+        }
+    }
+}
+
+TEST_F(DocumentSourceGraphLookUpSpillTest, ShouldCountSpilledIdsAgainstMemoryLimit) {
+    // The documents are small, but the _id values of 2000 of them don't fit in 16KB.
+    ASSERT_THROWS_CODE(runSearch(true, false, 2000, 0), UserException, 40099);
+}
+
 }  // namespace
 }  // namespace mongo
@@ -28,6 +28,9 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
+#include <iterator>
+
 #include "mongo/db/jsobj.h"
 #include "mongo/db/pipeline/accumulation_statement.h"
 #include "mongo/db/pipeline/accumulator.h"
@@ -38,6 +41,7 @@
 #include "mongo/db/pipeline/lite_parsed_document_source.h"
 #include "mongo/db/pipeline/value.h"
 #include "mongo/db/pipeline/value_comparator.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/stdx/memory.h"
 
 namespace mongo {
@@ -47,6 +51,8 @@ using std::shared_ptr;
 using std::pair;
 using std::vector;
 
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceGroupColumnarBatchSize, int, 4096);
+
 REGISTER_DOCUMENT_SOURCE(group,
                          LiteParsedDocumentSourceDefault::parse,
                          DocumentSourceGroup::createFromBson);
@@ -66,24 +72,24 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNext() {
         invariant(initializationResult.isEOF());
     }
 
-    for (auto&& accum : _currentAccumulators) {
-        accum->reset();  // Prep accumulators for a new group.
-    }
-
-    if (_spilled) {
-        return getNextSpilled();
-    } else if (_streaming) {
+    if (_streaming) {
         return getNextStreaming();
+    } else if (_spilled) {
+        return getNextSpilled();
     } else {
         return getNextStandard();
     }
 }
 
 DocumentSource::GetNextResult DocumentSourceGroup::getNextSpilled() {
-    // We aren't streaming, and we have spilled to disk.
+    // We have spilled to disk.
     if (!_sorterIterator)
         return GetNextResult::makeEOF();
 
+    for (auto&& accum : _currentAccumulators) {
+        accum->reset();  // Prep accumulators for a new group.
+    }
+
     _currentId = _firstPartOfNextGroup.first;
     const size_t numAccumulators = vpAccumulatorFactory.size();
     while (pExpCtx->getValueComparator().evaluate(_currentId == _firstPartOfNextGroup.first)) {
@@ -127,46 +133,103 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextStandard() {
 }
 
 DocumentSource::GetNextResult DocumentSourceGroup::getNextStreaming() {
-    // Streaming optimization is active.
-    if (!_firstDocOfNextGroup) {
+    // Streaming optimization is active. Read input until a run of equal sort keys is finished.
+    while (_finishedGroups.empty() && !_streamingInputExhausted) {
         auto nextInput = pSource->getNext();
-        if (!nextInput.isAdvanced()) {
+        if (nextInput.isPaused()) {
             return nextInput;
         }
-        _firstDocOfNextGroup = nextInput.releaseDocument();
-    }
 
-    Value id;
-    do {
-        // Add to the current accumulator(s).
-        for (size_t i = 0; i < _currentAccumulators.size(); i++) {
-            _currentAccumulators[i]->process(vpExpression[i]->evaluate(_variables.get()),
-                                             _doingMerge);
+        if (nextInput.isEOF()) {
+            // The last run is finished, and the groups of the input whose sort key was ambiguous
+            // are complete.
+            std::move(_runGroups.begin(), _runGroups.end(), std::back_inserter(_finishedGroups));
+            _runGroups.clear();
+            prepareGroupsForOutput();
+            _streamingInputExhausted = true;
+            break;
         }
 
-        // Release our references to the previous input document before asking for the next. This
-        // makes operations like $unwind more efficient.
-        _variables->clearRoot();
+        processStreamingInput(nextInput.releaseDocument());
+    }
 
-        // Retrieve the next document.
-        auto nextInput = pSource->getNext();
-        if (!nextInput.isAdvanced()) {
-            return nextInput;
-        }
+    if (_finishedGroups.empty()) {
+        return _spilled ? getNextSpilled() : getNextStandard();
+    }
+
+    auto& group = _finishedGroups.front();
+    Document out = makeDocument(group.first, group.second, pExpCtx->inShard);
+    _finishedGroups.pop_front();
+    return std::move(out);
+}
 
-        _firstDocOfNextGroup = nextInput.releaseDocument();
+void DocumentSourceGroup::processStreamingInput(Document input) {
+    auto sortKey = computeStreamingSortKey(input);
+    if (!sortKey) {
+        _streamingInputHashed = true;
+        addToGroups(std::move(input));
+        return;
+    }
 
-        _variables->setRoot(*_firstDocOfNextGroup);
+    if (_runGroups.empty()) {
+        _runSortKey = std::move(*sortKey);
+    } else if (pExpCtx->getValueComparator().evaluate(_runSortKey != *sortKey)) {
+        // The input is sorted, so no more documents can belong to the groups of the current run.
+        std::move(_runGroups.begin(), _runGroups.end(), std::back_inserter(_finishedGroups));
+        _runGroups.clear();
+        _runSortKey = std::move(*sortKey);
+    }
 
-        // Compute the id. If it does not match _currentId, we will exit the loop, leaving
-        // _firstDocOfNextGroup set for the next time getNext() is called.
-        id = computeId(_variables.get());
-    } while (pExpCtx->getValueComparator().evaluate(_currentId == id));
+    _variables->setRoot(std::move(input));
+    Value id = computeId(_variables.get());
 
-    Document out = makeDocument(_currentId, _currentAccumulators, pExpCtx->inShard);
-    _currentId = std::move(id);
+    // Runs rarely hold more than one group, so look for the group from the most recent one.
+    auto group = std::find_if(_runGroups.rbegin(), _runGroups.rend(), [&](const auto& runGroup) {
+        return pExpCtx->getValueComparator().evaluate(runGroup.first == id);
+    });
+    Accumulators* accumulators;
+    if (group != _runGroups.rend()) {
+        accumulators = &group->second;
+    } else {
+        Accumulators newAccumulators;
+        newAccumulators.reserve(vpAccumulatorFactory.size());
+        for (size_t i = 0; i < vpAccumulatorFactory.size(); i++) {
+            newAccumulators.push_back(makeAccumulator(i));
+        }
+        _runGroups.emplace_back(std::move(id), std::move(newAccumulators));
+        accumulators = &_runGroups.back().second;
+    }
 
-    return std::move(out);
+    for (size_t i = 0; i < accumulators->size(); i++) {
+        (*accumulators)[i]->process(vpExpression[i]->evaluate(_variables.get()), _doingMerge);
+    }
+
+    // Release our reference to the input document before asking for the next. This makes
+    // operations like $unwind more efficient.
+    _variables->clearRoot();
+}
+
+boost::optional<Value> DocumentSourceGroup::computeStreamingSortKey(const Document& input) const {
+    std::vector<Value> sortKey;
+    sortKey.reserve(_inputSortPaths.size());
+    for (auto&& path : _inputSortPaths) {
+        Value value(input);
+        for (size_t i = 0; i < path.getPathLength(); ++i) {
+            if (value.isArray()) {
+                return boost::none;
+            }
+            if (value.getType() != BSONType::Object) {
+                value = Value();
+                break;
+            }
+            value = value.getDocument().getField(path.getFieldName(i));
+        }
+        if (value.isArray()) {
+            return boost::none;
+        }
+        sortKey.push_back(value.nullish() ? Value(BSONNULL) : std::move(value));
+    }
+    return Value(std::move(sortKey));
 }
 
 void DocumentSourceGroup::doDispose() {
@@ -177,7 +240,19 @@ void DocumentSourceGroup::doDispose() {
     // Make us look done.
     groupsIterator = _groups->end();
 
-    _firstDocOfNextGroup = boost::none;
+    _runGroups.clear();
+    _finishedGroups.clear();
+
+    _memoryUsageBytes = 0;
+    _memoryTracker.set(0);
+}
+
+void DocumentSourceGroup::detachFromOperationContext() {
+    _memoryTracker.detach();
+}
+
+void DocumentSourceGroup::reattachToOperationContext(OperationContext* opCtx) {
+    _memoryTracker.attach(opCtx);
 }
 
 intrusive_ptr<DocumentSource> DocumentSourceGroup::optimize() {
@@ -226,6 +301,10 @@ Value DocumentSourceGroup::serialize(boost::optional<ExplainOptions::Verbosity>
         insides["$doingMerge"] = Value(true);
     }
 
+    if (_binaryPartialStates) {
+        insides["$binaryPartialStates"] = Value(true);
+    }
+
     if (explain && findRelevantInputSort()) {
         return Value(DOC("$streamingGroup" << insides.freeze()));
     }
@@ -268,6 +347,7 @@ DocumentSourceGroup::DocumentSourceGroup(const intrusive_ptr<ExpressionContext>&
     : DocumentSource(pExpCtx),
       _doingMerge(false),
       _maxMemoryUsageBytes(maxMemoryUsageBytes),
+      _memoryTracker(pExpCtx->opCtx),
       _inputSort(BSONObj()),
       _streaming(false),
       _initialized(false),
@@ -354,6 +434,12 @@ intrusive_ptr<DocumentSource> DocumentSourceGroup::createFromBson(
             massert(17030, "$doingMerge should be true if present", groupField.Bool());
 
             pGroup->setDoingMerge(true);
+        } else if (str::equals(pFieldName, "$binaryPartialStates")) {
+            uassert(40511,
+                    "$binaryPartialStates should be true if present",
+                    groupField.type() == Bool && groupField.Bool());
+
+            pGroup->setBinaryPartialStates(true);
         } else {
             // Any other field will be treated as an accumulator specification.
             pGroup->addAccumulator(
@@ -461,139 +547,274 @@ void getFieldPathListForSpilled(ExpressionObject* expressionObj,
 }
 }  // namespace
 
+void DocumentSourceGroup::spillIfOverMemoryLimit() {
+    _memoryTracker.set(_memoryUsageBytes);
+    if (_memoryUsageBytes > _maxMemoryUsageBytes) {
+        uassert(16945,
+                "Exceeded memory limit for $group, but didn't allow external sort."
+                " Pass allowDiskUse:true to opt in.",
+                _extSortAllowed);
+        _sortedFiles.push_back(spill());
+        _memoryUsageBytes = 0;
+        _memoryTracker.set(0);
+    }
+}
+
 DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
     const size_t numAccumulators = vpAccumulatorFactory.size();
 
     boost::optional<BSONObj> inputSort = findRelevantInputSort();
     if (inputSort) {
-        // We can convert to streaming.
+        // We can convert to streaming. Groups are formed as the input is read.
         _streaming = true;
         _inputSort = *inputSort;
-
-        // Set up accumulators.
-        _currentAccumulators.reserve(numAccumulators);
-        for (size_t i = 0; i < numAccumulators; i++) {
-            _currentAccumulators.push_back(vpAccumulatorFactory[i](pExpCtx));
+        for (auto&& sortField : _inputSort) {
+            _inputSortPaths.emplace_back(sortField.fieldName());
         }
-
-        // We only need to load the first document.
-        auto firstInput = pSource->getNext();
-        if (!firstInput.isAdvanced()) {
-            // Leave '_firstDocOfNextGroup' uninitialized and return.
-            return firstInput;
-        }
-        _firstDocOfNextGroup = firstInput.releaseDocument();
-        _variables->setRoot(*_firstDocOfNextGroup);
-
-        // Compute the _id value.
-        _currentId = computeId(_variables.get());
         _initialized = true;
         return DocumentSource::GetNextResult::makeEOF();
     }
 
     dassert(numAccumulators == vpExpression.size());
 
+    // If the input can be read in columnar batches, consumeColumnBatches() exhausts 'pSource'
+    // (barring any pausing) and the loop below never runs.
+    ColumnBatchSource* batchSource = getColumnBatchSource();
+    GetNextResult input = batchSource ? consumeColumnBatches(batchSource) : pSource->getNext();
+
     // Barring any pausing, this loop exhausts 'pSource' and populates '_groups'.
-    GetNextResult input = pSource->getNext();
     for (; input.isAdvanced(); input = pSource->getNext()) {
-        if (_memoryUsageBytes > _maxMemoryUsageBytes) {
-            uassert(16945,
-                    "Exceeded memory limit for $group, but didn't allow external sort."
-                    " Pass allowDiskUse:true to opt in.",
-                    _extSortAllowed);
-            _sortedFiles.push_back(spill());
-            _memoryUsageBytes = 0;
+        addToGroups(input.releaseDocument());
+    }
+
+    switch (input.getStatus()) {
+        case DocumentSource::GetNextResult::ReturnStatus::kAdvanced: {
+            MONGO_UNREACHABLE;  // We consumed all advances above.
+        }
+        case DocumentSource::GetNextResult::ReturnStatus::kPauseExecution: {
+            return input;  // Propagate pause.
+        }
+        case DocumentSource::GetNextResult::ReturnStatus::kEOF: {
+            _memoryTracker.set(_memoryUsageBytes);
+
+            // Do any final steps necessary to prepare to output results.
+            prepareGroupsForOutput();
+
+            // This must happen last so that, unless control gets here, we will re-enter
+            // initialization after getting a GetNextResult::ResultState::kPauseExecution.
+            _initialized = true;
+            return input;
         }
+    }
+    MONGO_UNREACHABLE;
+}
 
-        _variables->setRoot(input.releaseDocument());
+void DocumentSourceGroup::addToGroups(Document input) {
+    const size_t numAccumulators = vpAccumulatorFactory.size();
 
-        Value id = computeId(_variables.get());
+    spillIfOverMemoryLimit();
 
-        // Look for the _id value in the map. If it's not there, add a new entry with a blank
-        // accumulator. This is done in a somewhat odd way in order to avoid hashing 'id' and
-        // looking it up in '_groups' multiple times.
-        const size_t oldSize = _groups->size();
-        vector<intrusive_ptr<Accumulator>>& group = (*_groups)[id];
-        const bool inserted = _groups->size() != oldSize;
+    _variables->setRoot(std::move(input));
 
-        if (inserted) {
-            _memoryUsageBytes += id.getApproximateSize();
+    Value id = computeId(_variables.get());
 
-            // Add the accumulators
-            group.reserve(numAccumulators);
-            for (size_t i = 0; i < numAccumulators; i++) {
-                group.push_back(vpAccumulatorFactory[i](pExpCtx));
-            }
-        } else {
-            for (size_t i = 0; i < numAccumulators; i++) {
-                // subtract old mem usage. New usage added back after processing.
-                _memoryUsageBytes -= group[i]->memUsageForSorter();
-            }
+    // Look for the _id value in the map. If it's not there, add a new entry with a blank
+    // accumulator. This is done in a somewhat odd way in order to avoid hashing 'id' and
+    // looking it up in '_groups' multiple times.
+    const size_t oldSize = _groups->size();
+    vector<intrusive_ptr<Accumulator>>& group = (*_groups)[id];
+    const bool inserted = _groups->size() != oldSize;
+
+    if (inserted) {
+        _memoryUsageBytes += id.getApproximateSize();
+
+        // Add the accumulators
+        group.reserve(numAccumulators);
+        for (size_t i = 0; i < numAccumulators; i++) {
+            group.push_back(makeAccumulator(i));
         }
+    } else {
+        for (size_t i = 0; i < numAccumulators; i++) {
+            // subtract old mem usage. New usage added back after processing.
+            _memoryUsageBytes -= group[i]->memUsageForSorter();
+        }
+    }
+
+    /* tickle all the accumulators for the group we found */
+    dassert(numAccumulators == group.size());
+    for (size_t i = 0; i < numAccumulators; i++) {
+        group[i]->process(vpExpression[i]->evaluate(_variables.get()), _doingMerge);
+        _memoryUsageBytes += group[i]->memUsageForSorter();
+    }
 
-        /* tickle all the accumulators for the group we found */
-        dassert(numAccumulators == group.size());
+    // We are done with the ROOT document so release it.
+    _variables->clearRoot();
+
+    if (kDebugBuild && !storageGlobalParams.readOnly) {
+        // In debug mode, spill every time we have a duplicate id to stress merge logic.
+        if (!inserted &&                 // is a dup
+            !pExpCtx->inRouter &&        // can't spill to disk in router
+            !_extSortAllowed &&          // don't change behavior when testing external sort
+            _sortedFiles.size() < 20) {  // don't open too many FDs
+
+            _sortedFiles.push_back(spill());
+        }
+    }
+}
+
+void DocumentSourceGroup::prepareGroupsForOutput() {
+    if (!_sortedFiles.empty()) {
+        _spilled = true;
+        if (!_groups->empty()) {
+            _sortedFiles.push_back(spill());
+        }
+
+        // We won't be using groups again so free its memory.
+        _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
+        _memoryUsageBytes = 0;
+        _memoryTracker.set(0);
+
+        _sorterIterator.reset(Sorter<Value, Value>::Iterator::merge(
+            _sortedFiles, SortOptions(), SorterComparator(pExpCtx->getValueComparator())));
+
+        // prepare current to accumulate data
+        const size_t numAccumulators = vpAccumulatorFactory.size();
+        _currentAccumulators.reserve(numAccumulators);
         for (size_t i = 0; i < numAccumulators; i++) {
-            group[i]->process(vpExpression[i]->evaluate(_variables.get()), _doingMerge);
-            _memoryUsageBytes += group[i]->memUsageForSorter();
+            _currentAccumulators.push_back(makeAccumulator(i));
         }
 
-        // We are done with the ROOT document so release it.
-        _variables->clearRoot();
+        verify(_sorterIterator->more());  // we put data in, we should get something out.
+        _firstPartOfNextGroup = _sorterIterator->next();
+    } else {
+        // start the group iterator
+        groupsIterator = _groups->begin();
+    }
+}
+
+ColumnBatchSource* DocumentSourceGroup::getColumnBatchSource() {
+    if (_doingMerge || internalDocumentSourceGroupColumnarBatchSize.load() <= 0) {
+        return nullptr;
+    }
 
-        if (kDebugBuild && !storageGlobalParams.readOnly) {
-            // In debug mode, spill every time we have a duplicate id to stress merge logic.
-            if (!inserted &&                 // is a dup
-                !pExpCtx->inRouter &&        // can't spill to disk in router
-                !_extSortAllowed &&          // don't change behavior when testing external sort
-                _sortedFiles.size() < 20) {  // don't open too many FDs
+    auto batchSource = dynamic_cast<ColumnBatchSource*>(pSource);
+    if (!batchSource) {
+        return nullptr;
+    }
 
-                _sortedFiles.push_back(spill());
-            }
+    const auto isColumnExpression = [](const intrusive_ptr<Expression>& expr) {
+        if (dynamic_cast<ExpressionConstant*>(expr.get())) {
+            return true;
         }
+        auto fieldPath = dynamic_cast<ExpressionFieldPath*>(expr.get());
+        return fieldPath && fieldPath->getVariableId() == Variables::kRootId &&
+            fieldPath->getFieldPath().getPathLength() > 1;
+    };
+    if (!std::all_of(_idExpressions.begin(), _idExpressions.end(), isColumnExpression) ||
+        !std::all_of(vpExpression.begin(), vpExpression.end(), isColumnExpression)) {
+        return nullptr;
     }
 
-    switch (input.getStatus()) {
-        case DocumentSource::GetNextResult::ReturnStatus::kAdvanced: {
-            MONGO_UNREACHABLE;  // We consumed all advances above.
+    return batchSource;
+}
+
+DocumentSource::GetNextResult DocumentSourceGroup::consumeColumnBatches(
+    ColumnBatchSource* source) {
+    if (!_columnBatch) {
+        _columnBatch = stdx::make_unique<ColumnBatch>(
+            static_cast<size_t>(internalDocumentSourceGroupColumnarBatchSize.load()));
+
+        const auto addColumn = [this](const intrusive_ptr<Expression>& expr) {
+            if (auto constant = dynamic_cast<ExpressionConstant*>(expr.get())) {
+                return _columnBatch->addConstantColumn(constant->getValue());
+            }
+            // Strip the leading variable name, which is always ROOT here.
+            auto fieldPath = static_cast<ExpressionFieldPath*>(expr.get());
+            return _columnBatch->addFieldColumn(fieldPath->getFieldPath().tail());
+        };
+        for (auto&& expr : _idExpressions) {
+            _idColumns.push_back(addColumn(expr));
         }
-        case DocumentSource::GetNextResult::ReturnStatus::kPauseExecution: {
-            return input;  // Propagate pause.
+        for (auto&& expr : vpExpression) {
+            _accumulatorColumns.push_back(addColumn(expr));
         }
-        case DocumentSource::GetNextResult::ReturnStatus::kEOF: {
-            // Do any final steps necessary to prepare to output results.
-            if (!_sortedFiles.empty()) {
-                _spilled = true;
-                if (!_groups->empty()) {
-                    _sortedFiles.push_back(spill());
-                }
+    }
 
-                // We won't be using groups again so free its memory.
-                _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
+    while (true) {
+        spillIfOverMemoryLimit();
 
-                _sorterIterator.reset(Sorter<Value, Value>::Iterator::merge(
-                    _sortedFiles, SortOptions(), SorterComparator(pExpCtx->getValueComparator())));
+        switch (source->getNextColumnBatch(_columnBatch.get())) {
+            case GetNextResult::ReturnStatus::kAdvanced:
+                processColumnBatch();
+                break;
+            case GetNextResult::ReturnStatus::kPauseExecution:
+                return GetNextResult::makePauseExecution();
+            case GetNextResult::ReturnStatus::kEOF:
+                return GetNextResult::makeEOF();
+        }
+    }
+}
 
-                // prepare current to accumulate data
-                _currentAccumulators.reserve(numAccumulators);
-                for (size_t i = 0; i < numAccumulators; i++) {
-                    _currentAccumulators.push_back(vpAccumulatorFactory[i](pExpCtx));
-                }
+void DocumentSourceGroup::processColumnBatch() {
+    const size_t numRows = _columnBatch->size();
+    const size_t numAccumulators = vpAccumulatorFactory.size();
 
-                verify(_sorterIterator->more());  // we put data in, we should get something out.
-                _firstPartOfNextGroup = _sorterIterator->next();
-            } else {
-                // start the group iterator
-                groupsIterator = _groups->begin();
+    // Find the group of every row, creating groups as needed.
+    _batchGroups.clear();
+    _batchGroupIndexes.clear();
+    _batchGroupOfRow.resize(numRows);
+    for (size_t row = 0; row < numRows; ++row) {
+        Value id = computeIdFromColumns(row);
+
+        const size_t oldSize = _groups->size();
+        Accumulators& group = (*_groups)[id];
+        if (_groups->size() != oldSize) {
+            _memoryUsageBytes += id.getApproximateSize();
+
+            group.reserve(numAccumulators);
+            for (size_t i = 0; i < numAccumulators; i++) {
+                group.push_back(makeAccumulator(i));
+                _memoryUsageBytes += group.back()->memUsageForSorter();
             }
+        }
 
-            // This must happen last so that, unless control gets here, we will re-enter
-            // initialization after getting a GetNextResult::ResultState::kPauseExecution.
-            _initialized = true;
-            return input;
+        auto inserted = _batchGroupIndexes.emplace(&group, _batchGroups.size());
+        if (inserted.second) {
+            _batchGroups.push_back(&group);
+        }
+        _batchGroupOfRow[row] = inserted.first->second;
+    }
+
+    // Order the rows by group with a stable counting sort, so that order-sensitive accumulators
+    // see each group's inputs in their original order.
+    const size_t numGroups = _batchGroups.size();
+    _batchGroupOffsets.assign(numGroups + 1, 0);
+    for (size_t row = 0; row < numRows; ++row) {
+        ++_batchGroupOffsets[_batchGroupOfRow[row] + 1];
+    }
+    for (size_t g = 0; g < numGroups; ++g) {
+        _batchGroupOffsets[g + 1] += _batchGroupOffsets[g];
+    }
+    _batchRowsByGroup.resize(numRows);
+    for (size_t row = 0; row < numRows; ++row) {
+        _batchRowsByGroup[_batchGroupOffsets[_batchGroupOfRow[row]]++] = row;
+    }
+    // Each offset now holds the end of its group, so shift them back by one group.
+    for (size_t g = numGroups; g > 0; --g) {
+        _batchGroupOffsets[g] = _batchGroupOffsets[g - 1];
+    }
+    _batchGroupOffsets[0] = 0;
+
+    for (size_t g = 0; g < numGroups; ++g) {
+        Accumulators& group = *_batchGroups[g];
+        const uint32_t* rows = &_batchRowsByGroup[_batchGroupOffsets[g]];
+        const size_t groupRows = _batchGroupOffsets[g + 1] - _batchGroupOffsets[g];
+        for (size_t i = 0; i < numAccumulators; i++) {
+            _memoryUsageBytes -= group[i]->memUsageForSorter();
+            group[i]->processColumn(_columnBatch->column(_accumulatorColumns[i]), rows, groupRows);
+            _memoryUsageBytes += group[i]->memUsageForSorter();
         }
     }
-    MONGO_UNREACHABLE;
 }
 
 shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
@@ -637,12 +858,6 @@ shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
 }
 
 boost::optional<BSONObj> DocumentSourceGroup::findRelevantInputSort() const {
-    if (true) {
-        // Until streaming $group correctly handles nullish values, the streaming behavior is
-        // disabled. See SERVER-23318.
-        return boost::none;
-    }
-
     if (!pSource) {
         // Sometimes when performing an explain, or using $group as the merge point, 'pSource' will
         // not be set.
@@ -702,6 +917,21 @@ boost::optional<BSONObj> DocumentSourceGroup::findRelevantInputSort() const {
     return boost::none;
 }
 
+boost::optional<std::string> DocumentSourceGroup::getDistinctFieldName() const {
+    if (_doingMerge || !vFieldName.empty() || !_idFieldNames.empty() ||
+        _idExpressions.size() != 1) {
+        return boost::none;
+    }
+
+    // The path includes the leading variable name, which must be ROOT.
+    auto fieldPath = dynamic_cast<ExpressionFieldPath*>(_idExpressions[0].get());
+    if (!fieldPath || fieldPath->getVariableId() != Variables::kRootId ||
+        fieldPath->getFieldPath().getPathLength() != 2) {
+        return boost::none;
+    }
+    return fieldPath->getFieldPath().tail().fullPath();
+}
+
 BSONObjSet DocumentSourceGroup::getOutputSorts() {
     if (!_initialized) {
         initialize();  // Note this might not finish initializing, but that's OK. We just want to
@@ -709,14 +939,16 @@ BSONObjSet DocumentSourceGroup::getOutputSorts() {
                        // False negatives are OK.
     }
 
-    if (!(_streaming || _spilled)) {
+    // A streaming $group returns the groups it built in '_groups' only after every run, so once
+    // any input has gone through '_groups' its output is not sorted by anything.
+    if (!(_streaming || _spilled) || _streamingInputHashed) {
         return SimpleBSONObjComparator::kInstance.makeBSONObjSet();
     }
 
     BSONObjBuilder sortOrder;
 
     if (_idFieldNames.empty()) {
-        if (_spilled) {
+        if (!_streaming) {
             sortOrder.append("_id", 1);
         } else {
             // We have an expression like {_id: "$a"}. Check if this is a FieldPath, and if it is,
@@ -800,6 +1032,21 @@ Value DocumentSourceGroup::computeId(Variables* vars) {
     return Value(std::move(vals));
 }
 
+Value DocumentSourceGroup::computeIdFromColumns(size_t row) const {
+    // This must produce the same group key as computeId().
+    if (_idColumns.size() == 1) {
+        Value retValue(_columnBatch->column(_idColumns[0])[row]);
+        return retValue.missing() ? Value(BSONNULL) : std::move(retValue);
+    }
+
+    vector<Value> vals;
+    vals.reserve(_idColumns.size());
+    for (size_t column : _idColumns) {
+        vals.push_back(Value(_columnBatch->column(column)[row]));
+    }
+    return Value(std::move(vals));
+}
+
 Value DocumentSourceGroup::expandId(const Value& val) {
     // _id doesn't get wrapped in a document
     if (_idFieldNames.empty())
@@ -819,6 +1066,12 @@ Value DocumentSourceGroup::expandId(const Value& val) {
     return md.freezeToValue();
 }
 
+intrusive_ptr<Accumulator> DocumentSourceGroup::makeAccumulator(size_t i) const {
+    intrusive_ptr<Accumulator> accumulator = vpAccumulatorFactory[i](pExpCtx);
+    accumulator->setBinaryPartialState(_binaryPartialStates);
+    return accumulator;
+}
+
 Document DocumentSourceGroup::makeDocument(const Value& id,
                                            const Accumulators& accums,
                                            bool mergeableOutput) {
@@ -843,7 +1096,9 @@ Document DocumentSourceGroup::makeDocument(const Value& id,
 }
 
 intrusive_ptr<DocumentSource> DocumentSourceGroup::getShardSource() {
-    return this;  // No modifications necessary when on shard
+    // The merger built by getMergeSource() accepts the compact form of the partial results.
+    _binaryPartialStates = true;
+    return this;
 }
 
 intrusive_ptr<DocumentSource> DocumentSourceGroup::getMergeSource() {
@@ -28,16 +28,25 @@
 
 #pragma once
 
+#include <deque>
 #include <memory>
 #include <utility>
 
+#include "mongo/db/operation_memory_usage.h"
 #include "mongo/db/pipeline/accumulation_statement.h"
 #include "mongo/db/pipeline/accumulator.h"
+#include "mongo/db/pipeline/column_batch.h"
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/sorter/sorter.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/unordered_map.h"
 
 namespace mongo {
 
+// The number of documents a $group reads at a time from a ColumnBatchSource. 0 disables batched
+// input.
+extern AtomicInt32 internalDocumentSourceGroupColumnarBatchSize;
+
 class DocumentSourceGroup final : public DocumentSource, public SplittableDocumentSource {
 public:
     using Accumulators = std::vector<boost::intrusive_ptr<Accumulator>>;
@@ -52,6 +61,8 @@ public:
     GetNextResult getNext() final;
     const char* getSourceName() const final;
     BSONObjSet getOutputSorts() final;
+    void detachFromOperationContext() final;
+    void reattachToOperationContext(OperationContext* opCtx) final;
 
     /**
      * Convenience method for creating a new $group stage.
@@ -87,10 +98,25 @@ public:
         _doingMerge = doingMerge;
     }
 
+    /**
+     * Tell this source to emit the partial results of its accumulators in their compact binary
+     * form, for a merging $group which accepts it. Defaults to false.
+     */
+    void setBinaryPartialStates(bool binaryPartialStates) {
+        _binaryPartialStates = binaryPartialStates;
+    }
+
     bool isStreaming() const {
         return _streaming;
     }
 
+    /**
+     * If this $group has no accumulators and groups by a single top-level field, such as
+     * {$group: {_id: "$a"}}, returns the name of that field. Its output then only depends on the
+     * distinct values of the field, and not on how many input documents hold each of them.
+     */
+    boost::optional<std::string> getDistinctFieldName() const;
+
     // Virtuals for SplittableDocumentSource.
     boost::intrusive_ptr<DocumentSource> getShardSource() final;
     boost::intrusive_ptr<DocumentSource> getMergeSource() final;
@@ -104,13 +130,27 @@ private:
 
     /**
      * getNext() dispatches to one of these three depending on what type of $group it is. All three
-     * of these methods expect '_currentAccumulators' to have been reset before being called, and
-     * also expect initialize() to have been called already.
+     * of these methods expect initialize() to have been called already.
      */
     GetNextResult getNextStreaming();
     GetNextResult getNextSpilled();
     GetNextResult getNextStandard();
 
+    /**
+     * Adds 'input' to the group it belongs to in the current run of a streaming $group. Input
+     * whose sort key is ambiguous is added to '_groups' instead, to be returned once the input is
+     * exhausted.
+     */
+    void processStreamingInput(Document input);
+
+    /**
+     * Returns the values of the '_inputSort' fields in 'input', with null, undefined and missing
+     * values all replaced by null since sorting does not tell them apart. Returns boost::none if
+     * any of the paths contains an array, in which case 'input' may appear anywhere in the sort
+     * order relative to documents with the same values.
+     */
+    boost::optional<Value> computeStreamingSortKey(const Document& input) const;
+
     /**
      * Attempt to identify an input sort order that allows us to turn into a streaming $group. If we
      * find one, return it. Otherwise, return boost::none.
@@ -119,9 +159,9 @@ private:
 
     /**
      * Before returning anything, this source must prepare itself. In a streaming $group,
-     * initialize() requests the first document from the previous source, and uses it to prepare the
-     * accumulators. In an unsorted $group, initialize() exhausts the previous source before
-     * returning. The '_initialized' boolean indicates that initialize() has finished.
+     * initialize() only records the input sort order. In an unsorted $group, initialize() exhausts
+     * the previous source before returning. The '_initialized' boolean indicates that
+     * initialize() has finished.
      *
      * This method may not be able to finish initialization in a single call if 'pSource' returns a
      * DocumentSource::GetNextResult::kPauseExecution, so it returns the last GetNextResult
@@ -129,6 +169,36 @@ private:
      */
     GetNextResult initialize();
 
+    /**
+     * Adds 'input' to its group in '_groups', spilling to disk when over the memory limit.
+     */
+    void addToGroups(Document input);
+
+    /**
+     * Prepares the groups in '_groups', and any spilled to disk, to be returned once the input is
+     * exhausted.
+     */
+    void prepareGroupsForOutput();
+
+    /**
+     * Returns the previous stage as a ColumnBatchSource if this $group can consume its input in
+     * columnar batches, or nullptr otherwise. This requires every _id and accumulator argument to
+     * be either a constant or a field path rooted at $$ROOT.
+     */
+    ColumnBatchSource* getColumnBatchSource();
+
+    /**
+     * Populates '_groups' from the ColumnBatches produced by 'source' until it is exhausted or
+     * pauses. Returns either an EOF or a pause result, never an advanced one.
+     */
+    GetNextResult consumeColumnBatches(ColumnBatchSource* source);
+
+    /**
+     * Adds the rows of '_columnBatch' to their groups. The rows of each group are handed to its
+     * accumulators in one processColumn() call per accumulator, in their original order.
+     */
+    void processColumnBatch();
+
     /**
      * Spill groups map to disk and returns an iterator to the file. Note: Since a sorted $group
      * does not exhaust the previous stage before returning, and thus does not maintain as large a
@@ -136,13 +206,29 @@ private:
      */
     std::shared_ptr<Sorter<Value, Value>::Iterator> spill();
 
+    /**
+     * Spills the groups to disk if they use more than the memory limit. Throws if spilling is not
+     * allowed.
+     */
+    void spillIfOverMemoryLimit();
+
     Document makeDocument(const Value& id, const Accumulators& accums, bool mergeableOutput);
 
+    /**
+     * Creates a new instance of the accumulator at position 'i' of 'vpAccumulatorFactory'.
+     */
+    boost::intrusive_ptr<Accumulator> makeAccumulator(size_t i) const;
+
     /**
      * Computes the internal representation of the group key.
      */
     Value computeId(Variables* vars);
 
+    /**
+     * Computes the internal representation of the group key of row 'row' of '_columnBatch'.
+     */
+    Value computeIdFromColumns(size_t row) const;
+
     /**
      * Converts the internal representation of the group key to the _id shape specified by the
      * user.
@@ -160,8 +246,11 @@ private:
     std::vector<boost::intrusive_ptr<Expression>> vpExpression;
 
     bool _doingMerge;
+    bool _binaryPartialStates = false;
     size_t _memoryUsageBytes = 0;
     size_t _maxMemoryUsageBytes;
+    // Charges '_memoryUsageBytes' to the operation this stage runs in.
+    OperationMemoryUsage::Tracker _memoryTracker;
     std::unique_ptr<Variables> _variables;
     std::vector<std::string> _idFieldNames;  // used when id is a document
     std::vector<boost::intrusive_ptr<Expression>> _idExpressions;
@@ -170,6 +259,20 @@ private:
     bool _streaming;
     bool _initialized;
 
+    // Only used when '_streaming' is true. Documents whose values for the '_inputSort' fields
+    // compare equal form a run. The groups of the current run are accumulated in '_runGroups' and
+    // moved to '_finishedGroups' to be returned once a document from the next run is seen. Runs
+    // usually hold a single group, but null and missing values sort together while grouping
+    // apart.
+    std::vector<FieldPath> _inputSortPaths;
+    Value _runSortKey;
+    std::vector<std::pair<Value, Accumulators>> _runGroups;
+    std::deque<std::pair<Value, Accumulators>> _finishedGroups;
+    bool _streamingInputExhausted = false;
+    // Whether any input of a streaming $group had an ambiguous sort key and was added to
+    // '_groups'. Those groups are returned after every run, so the output is no longer sorted.
+    bool _streamingInputHashed = false;
+
     Value _currentId;
     Accumulators _currentAccumulators;
 
@@ -188,9 +291,21 @@ private:
     std::unique_ptr<Sorter<Value, Value>::Iterator> _sorterIterator;
     const bool _extSortAllowed;
 
+    // Only used when the input is read in columnar batches. '_idColumns' parallels
+    // '_idExpressions' and '_accumulatorColumns' parallels 'vpExpression'.
+    std::unique_ptr<ColumnBatch> _columnBatch;
+    std::vector<size_t> _idColumns;
+    std::vector<size_t> _accumulatorColumns;
+
+    // Scratch space for processColumnBatch(): the distinct groups of the batch in order of first
+    // appearance, the index into '_batchGroups' of each row, and the rows ordered by group.
+    std::vector<Accumulators*> _batchGroups;
+    stdx::unordered_map<Accumulators*, uint32_t> _batchGroupIndexes;
+    std::vector<uint32_t> _batchGroupOfRow;
+    std::vector<uint32_t> _batchRowsByGroup;
+    std::vector<uint32_t> _batchGroupOffsets;
+
     std::pair<Value, Value> _firstPartOfNextGroup;
-    // Only used when '_sorted' is true.
-    boost::optional<Document> _firstDocOfNextGroup;
 };
 
 }  // namespace mongo
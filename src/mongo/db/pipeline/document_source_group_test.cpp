@@ -28,8 +28,10 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
 #include <boost/intrusive_ptr.hpp>
 #include <deque>
+#include <limits>
 #include <map>
 #include <string>
 #include <vector>
@@ -40,6 +42,7 @@
 #include "mongo/bson/json.h"
 #include "mongo/db/pipeline/aggregation_context_fixture.h"
 #include "mongo/db/pipeline/aggregation_request.h"
+#include "mongo/db/pipeline/column_batch.h"
 #include "mongo/db/pipeline/dependencies.h"
 #include "mongo/db/pipeline/document_source_group.h"
 #include "mongo/db/pipeline/document_source_mock.h"
@@ -192,6 +195,170 @@ TEST_F(DocumentSourceGroupTest, ShouldCorrectlyTrackMemoryUsageBetweenPauses) {
     ASSERT_THROWS_CODE(group->getNext(), UserException, 16945);
 }
 
+/**
+ * A mock source which can also produce its documents in ColumnBatches. A batch ends early at a
+ * pause, which is returned by the next call.
+ */
+class ColumnarDocumentSourceMock final : public DocumentSourceMock, public ColumnBatchSource {
+public:
+    using DocumentSourceMock::DocumentSourceMock;
+
+    GetNextResult::ReturnStatus getNextColumnBatch(ColumnBatch* batch) final {
+        batch->clear();
+        while (!queue.empty() && !batch->full()) {
+            if (queue.front().isPaused()) {
+                if (batch->size() > 0) {
+                    break;
+                }
+                queue.pop_front();
+                return GetNextResult::ReturnStatus::kPauseExecution;
+            }
+            batch->append(queue.front().getDocument().toBson());
+            queue.pop_front();
+            ++numBatchedDocs;
+        }
+        return batch->size() > 0 ? GetNextResult::ReturnStatus::kAdvanced
+                                 : GetNextResult::ReturnStatus::kEOF;
+    }
+
+    size_t numBatchedDocs = 0;
+};
+
+class DocumentSourceGroupColumnarTest : public AggregationContextFixture {
+public:
+    DocumentSourceGroupColumnarTest()
+        : _oldBatchSize(internalDocumentSourceGroupColumnarBatchSize.load()) {
+        // Use a small batch size so that the inputs span several batches.
+        internalDocumentSourceGroupColumnarBatchSize.store(3);
+    }
+
+    ~DocumentSourceGroupColumnarTest() {
+        internalDocumentSourceGroupColumnarBatchSize.store(_oldBatchSize);
+    }
+
+    /**
+     * Runs the $group described by 'spec' over 'inputs' from 'source' and returns its output,
+     * sorted so that it can be compared regardless of group order.
+     */
+    vector<string> runGroup(const BSONObj& spec,
+                            const deque<DocumentSource::GetNextResult>& inputs,
+                            DocumentSourceMock* source) {
+        source->queue = inputs;
+        auto group = DocumentSourceGroup::createFromBson(BSON("$group" << spec).firstElement(),
+                                                         getExpCtx());
+        group->setSource(source);
+
+        vector<string> out;
+        for (auto result = group->getNext(); !result.isEOF(); result = group->getNext()) {
+            if (result.isAdvanced()) {
+                out.push_back(result.releaseDocument().toString());
+            }
+        }
+        std::sort(out.begin(), out.end());
+        return out;
+    }
+
+    /**
+     * Asserts that the $group described by 'spec' produces the same output whether 'inputs' are
+     * read one document at a time or in columnar batches, and returns how many documents were
+     * read in batches.
+     */
+    size_t assertSameResults(const BSONObj& spec,
+                             const deque<DocumentSource::GetNextResult>& inputs) {
+        auto documentSource = DocumentSourceMock::create();
+        auto expected = runGroup(spec, inputs, documentSource.get());
+
+        intrusive_ptr<ColumnarDocumentSourceMock> columnarSource(
+            new ColumnarDocumentSourceMock(deque<DocumentSource::GetNextResult>{}));
+        auto actual = runGroup(spec, inputs, columnarSource.get());
+
+        ASSERT_EQ(expected.size(), actual.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            ASSERT_EQ(expected[i], actual[i]);
+        }
+        return columnarSource->numBatchedDocs;
+    }
+
+    deque<DocumentSource::GetNextResult> makeInputs() {
+        return {Document{{"k", 1}, {"v", 1}, {"x", Document{{"y", "a"_sd}}}},
+                Document{{"k", 2}, {"v", 2LL}, {"x", Document{{"y", "b"_sd}}}},
+                DocumentSource::GetNextResult::makePauseExecution(),
+                Document{{"k", 1}, {"v", 2.5}},
+                Document{{"k", 2}, {"v", Decimal128("1.25")}, {"x", vector<Value>{}}},
+                Document{{"k", 1}, {"v", "str"_sd}, {"x", 7}},
+                Document{{"v", 4}},
+                Document{{"k", BSONNULL}, {"v", std::numeric_limits<long long>::max()}},
+                Document{{"k", 3},
+                         {"x",
+                          vector<Value>{Value(Document{{"y", 1}}),
+                                        Value(2),
+                                        Value(Document{{"y", vector<Value>{Value(3)}}})}}},
+                Document{{"k", Document{{"a", 1}}}, {"v", -1}},
+                Document{{"k", 1}, {"v", 1}}};
+    }
+
+private:
+    int _oldBatchSize;
+};
+
+TEST_F(DocumentSourceGroupColumnarTest, FieldPathAccumulatorsMatchDocumentAtATime) {
+    auto spec = fromjson(
+        "{_id: '$k', sum: {$sum: '$v'}, avg: {$avg: '$v'}, min: {$min: '$v'},"
+        " max: {$max: '$v'}, first: {$first: '$v'}, last: {$last: '$v'}, push: {$push: '$x.y'},"
+        " count: {$sum: 1}, set: {$addToSet: '$x'}}");
+    ASSERT_EQ(10U, assertSameResults(spec, makeInputs()));
+}
+
+TEST_F(DocumentSourceGroupColumnarTest, CompoundIdMatchesDocumentAtATime) {
+    auto spec = fromjson("{_id: {k: '$k', y: '$x.y'}, count: {$sum: 1}, total: {$sum: '$v'}}");
+    ASSERT_EQ(10U, assertSameResults(spec, makeInputs()));
+}
+
+TEST_F(DocumentSourceGroupColumnarTest, ConstantIdMatchesDocumentAtATime) {
+    auto spec = fromjson("{_id: null, count: {$sum: 1}, avg: {$avg: '$v'}}");
+    ASSERT_EQ(10U, assertSameResults(spec, makeInputs()));
+}
+
+TEST_F(DocumentSourceGroupColumnarTest, ComputedExpressionsFallBackToDocumentAtATime) {
+    auto spec = fromjson("{_id: {$add: ['$k', 1]}, sum: {$sum: '$v'}}");
+    ASSERT_EQ(0U, assertSameResults(spec, makeInputs()));
+
+    spec = fromjson("{_id: '$k', doc: {$push: '$$ROOT'}}");
+    ASSERT_EQ(0U, assertSameResults(spec, makeInputs()));
+}
+
+TEST_F(DocumentSourceGroupColumnarTest, DisabledByKnob) {
+    internalDocumentSourceGroupColumnarBatchSize.store(0);
+    auto spec = fromjson("{_id: '$k', sum: {$sum: '$v'}}");
+    ASSERT_EQ(0U, assertSameResults(spec, makeInputs()));
+}
+
+TEST_F(DocumentSourceGroupColumnarTest, ShouldErrorIfNotAllowedToSpill) {
+    auto expCtx = getExpCtx();
+    expCtx->inRouter = true;  // Disallow external sort.
+
+    VariablesIdGenerator idGen;
+    VariablesParseState vps(&idGen);
+    AccumulationStatement pushStatement{"spaceHog",
+                                        AccumulationStatement::getFactory("$push"),
+                                        ExpressionFieldPath::parse(expCtx, "$largeStr", vps)};
+    auto group = DocumentSourceGroup::create(expCtx,
+                                             ExpressionFieldPath::parse(expCtx, "$_id", vps),
+                                             {pushStatement},
+                                             idGen.getIdCount(),
+                                             1000);
+
+    string largeStr(1000, 'x');
+    intrusive_ptr<ColumnarDocumentSourceMock> mock(
+        new ColumnarDocumentSourceMock({Document{{"_id", 0}, {"largeStr", largeStr}},
+                                        Document{{"_id", 1}, {"largeStr", largeStr}},
+                                        Document{{"_id", 2}, {"largeStr", largeStr}},
+                                        Document{{"_id", 3}, {"largeStr", largeStr}}}));
+    group->setSource(mock.get());
+
+    ASSERT_THROWS_CODE(group->getNext(), UserException, 16945);
+}
+
 BSONObj toBson(const intrusive_ptr<DocumentSource>& source) {
     vector<Value> arr;
     source->serializeToArray(arr);
@@ -503,10 +670,11 @@ class CheckResultsBase : public Base {
 public:
     virtual ~CheckResultsBase() {}
     void run() {
-        runSharded(false);
-        runSharded(true);
+        runSharded(false, false);
+        runSharded(true, false);
+        runSharded(true, true);
     }
-    void runSharded(bool sharded) {
+    void runSharded(bool sharded, bool binaryPartialStates) {
         createGroup(groupSpec());
         auto source = DocumentSourceMock::create(inputData());
         group()->setSource(source.get());
@@ -514,8 +682,15 @@ public:
         intrusive_ptr<DocumentSource> sink = group();
         if (sharded) {
             sink = createMerger();
+            if (binaryPartialStates) {
+                // The shard stage of a split pipeline sends binary partial states, which the
+                // merger must accept as well as the Document form.
+                dynamic_cast<SplittableDocumentSource*>(group())->getShardSource();
+            }
             // Serialize and re-parse the shard stage.
-            createGroup(toBson(group())["$group"].Obj(), true);
+            BSONObj shardSpec = toBson(group())["$group"].Obj().getOwned();
+            ASSERT_EQUALS(binaryPartialStates, shardSpec["$binaryPartialStates"].trueValue());
+            createGroup(shardSpec, true);
             group()->setSource(source.get());
             sink->setSource(group());
         }
@@ -724,6 +899,23 @@ class UndefinedAccumulatorValue : public CheckResultsBase {
     }
 };
 
+/** The partial results of $avg and $stdDevPop are merged in their Document and binary forms. */
+class AvgAndStdDevAccumulators : public CheckResultsBase {
+    deque<DocumentSource::GetNextResult> inputData() {
+        return {DOC("_id" << 0 << "a" << 1),
+                DOC("_id" << 1 << "a" << 2),
+                DOC("_id" << 0 << "a" << 3),
+                DOC("_id" << 1 << "a" << Decimal128("4"))};
+    }
+    virtual BSONObj groupSpec() {
+        return fromjson("{_id:'$_id',avg:{$avg:'$a'},stdDev:{$stdDevPop:'$a'}}");
+    }
+    virtual BSONObj expectedResultSet() {
+        return BSON_ARRAY(BSON("_id" << 0 << "avg" << 2.0 << "stdDev" << 1.0)
+                          << BSON("_id" << 1 << "avg" << Decimal128("3") << "stdDev" << 1.0));
+    }
+};
+
 /** Simulate merging sharded results in the router. */
 class RouterMerger : public CheckResultsBase {
 public:
@@ -1006,6 +1198,111 @@ public:
     }
 };
 
+/** Null and missing values sort together, but form separate groups in a compound _id. */
+class StreamingWithNullAndMissingValues : public Base {
+public:
+    void run() {
+        auto source = DocumentSourceMock::create(
+            {"{b: 1}", "{a: null, b: 1}", "{b: 1}", "{a: 1, b: 1}", "{a: 1, b: 1}"});
+        source->sorts = {BSON("a" << 1 << "b" << 1)};
+
+        createGroup(fromjson("{_id: {x: '$a', y: '$b'}, n: {$sum: 1}}"));
+        group()->setSource(source.get());
+
+        auto res = group()->getNext();
+        ASSERT_TRUE(res.isAdvanced());
+        ASSERT_TRUE(group()->isStreaming());
+        ASSERT_TRUE(res.getDocument().getField("_id")["x"].missing());
+        ASSERT_VALUE_EQ(res.getDocument().getField("_id")["y"], Value(1));
+        ASSERT_VALUE_EQ(res.getDocument().getField("n"), Value(2));
+
+        res = group()->getNext();
+        ASSERT_TRUE(res.isAdvanced());
+        ASSERT_VALUE_EQ(res.getDocument().getField("_id")["x"], Value(BSONNULL));
+        ASSERT_VALUE_EQ(res.getDocument().getField("n"), Value(1));
+
+        res = group()->getNext();
+        ASSERT_TRUE(res.isAdvanced());
+        ASSERT_VALUE_EQ(res.getDocument().getField("_id")["x"], Value(1));
+        ASSERT_VALUE_EQ(res.getDocument().getField("n"), Value(2));
+
+        assertEOF(group());
+    }
+};
+
+/**
+ * Documents with an array in a sorted field are grouped after the rest of the input, and the output
+ * is no longer reported as sorted.
+ */
+class StreamingWithArrayValues : public Base {
+public:
+    void run() {
+        auto source = DocumentSourceMock::create(
+            {"{a: 1}", "{a: [1, 2]}", "{a: 1}", "{a: 2}", "{a: [1, 2]}"});
+        source->sorts = {BSON("a" << 1)};
+
+        // We pretend to be in the router so that we don't spill to disk, because this produces
+        // inconsistent output on debug vs. non-debug builds.
+        const bool inRouter = true;
+        const bool inShard = false;
+
+        createGroup(fromjson("{_id: '$a', n: {$sum: 1}}"), inShard, inRouter);
+        group()->setSource(source.get());
+
+        auto res = group()->getNext();
+        ASSERT_TRUE(res.isAdvanced());
+        ASSERT_TRUE(group()->isStreaming());
+        ASSERT_VALUE_EQ(res.getDocument().getField("_id"), Value(1));
+        ASSERT_VALUE_EQ(res.getDocument().getField("n"), Value(2));
+
+        res = group()->getNext();
+        ASSERT_TRUE(res.isAdvanced());
+        ASSERT_VALUE_EQ(res.getDocument().getField("_id"), Value(2));
+        ASSERT_VALUE_EQ(res.getDocument().getField("n"), Value(1));
+
+        res = group()->getNext();
+        ASSERT_TRUE(res.isAdvanced());
+        ASSERT_VALUE_EQ(res.getDocument().getField("_id"), Value(BSON_ARRAY(1 << 2)));
+        ASSERT_VALUE_EQ(res.getDocument().getField("n"), Value(2));
+
+        assertEOF(group());
+
+        // The array groups came after the rest, so the output is not sorted by _id.
+        ASSERT_TRUE(group()->getOutputSorts().empty());
+    }
+};
+
+/** A pause in the middle of a group does not lose or repeat any input. */
+class StreamingPropagatesPauses : public Base {
+public:
+    void run() {
+        auto source =
+            DocumentSourceMock::create({Document{{"a", 1}},
+                                        DocumentSource::GetNextResult::makePauseExecution(),
+                                        Document{{"a", 1}},
+                                        Document{{"a", 2}}});
+        source->sorts = {BSON("a" << 1)};
+
+        createGroup(fromjson("{_id: '$a', n: {$sum: 1}}"));
+        group()->setSource(source.get());
+
+        ASSERT_TRUE(group()->getNext().isPaused());
+        ASSERT_TRUE(group()->isStreaming());
+
+        auto res = group()->getNext();
+        ASSERT_TRUE(res.isAdvanced());
+        ASSERT_VALUE_EQ(res.getDocument().getField("_id"), Value(1));
+        ASSERT_VALUE_EQ(res.getDocument().getField("n"), Value(2));
+
+        res = group()->getNext();
+        ASSERT_TRUE(res.isAdvanced());
+        ASSERT_VALUE_EQ(res.getDocument().getField("_id"), Value(2));
+        ASSERT_VALUE_EQ(res.getDocument().getField("n"), Value(1));
+
+        assertEOF(group());
+    }
+};
+
 class NoOptimizationIfMissingDoubleSort : public Base {
 public:
     void run() {
@@ -1154,12 +1451,11 @@ public:
         add<GroupNullUndefinedIds>();
         add<ComplexId>();
         add<UndefinedAccumulatorValue>();
+        add<AvgAndStdDevAccumulators>();
         add<RouterMerger>();
         add<Dependencies>();
         add<StringConstantIdAndAccumulatorExpressions>();
         add<ArrayConstantAccumulatorExpression>();
-#if 0
-        // Disabled tests until SERVER-23318 is implemented.
         add<StreamingOptimization>();
         add<StreamingWithMultipleIdFields>();
         add<NoOptimizationIfMissingDoubleSort>();
@@ -1171,7 +1467,9 @@ public:
         add<StreamingWithRootSubfield>();
         add<StreamingWithConstantAndFieldPath>();
         add<StreamingWithFieldRepeated>();
-#endif
+        add<StreamingWithNullAndMissingValues>();
+        add<StreamingWithArrayValues>();
+        add<StreamingPropagatesPauses>();
     }
 };
 
@@ -33,10 +33,13 @@
 #include "mongo/base/init.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression_algo.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/matcher/extensions_callback_noop.h"
 #include "mongo/db/pipeline/document.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/value.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/stdx/memory.h"
 
 namespace mongo {
@@ -44,6 +47,10 @@ namespace mongo {
 using boost::intrusive_ptr;
 using std::vector;
 
+MONGO_EXPORT_SERVER_PARAMETER(internalDocumentSourceLookupHashJoinMaxMemoryBytes,
+                              int,
+                              100 * 1024 * 1024);
+
 DocumentSourceLookUp::DocumentSourceLookUp(NamespaceString fromNs,
                                            std::string as,
                                            std::string localField,
@@ -116,6 +123,18 @@ BSONObj buildEqualityOrQuery(const std::string& fieldName, const vector<Value>&
     return orBuilder.obj();
 }
 
+StringData joinStrategyToString(DocumentSourceLookUp::JoinStrategy strategy) {
+    switch (strategy) {
+        case DocumentSourceLookUp::JoinStrategy::kAdaptive:
+            return "adaptive"_sd;
+        case DocumentSourceLookUp::JoinStrategy::kNestedLoop:
+            return "nestedLoop"_sd;
+        case DocumentSourceLookUp::JoinStrategy::kHashJoin:
+            return "hashJoin"_sd;
+    }
+    MONGO_UNREACHABLE;
+}
+
 }  // namespace
 
 DocumentSource::GetNextResult DocumentSourceLookUp::getNext() {
@@ -145,13 +164,11 @@ DocumentSource::GetNextResult DocumentSourceLookUp::getNext() {
 
     auto matchStage =
         makeMatchStageFromInput(inputDoc, _localField, _foreignFieldFieldName, BSONObj());
-    // We've already allocated space for the trailing $match stage in '_fromPipeline'.
-    _fromPipeline.back() = matchStage;
-    auto pipeline = uassertStatusOK(_mongod->makePipeline(_fromPipeline, _fromExpCtx));
+    prepareMatches(inputDoc, matchStage);
 
     std::vector<Value> results;
     int objsize = 0;
-    while (auto result = pipeline->getNext()) {
+    while (auto result = getNextMatch()) {
         objsize += result->getApproximateSize();
         uassert(4568,
                 str::stream() << "Total size of documents in " << _fromNs.coll() << " matching "
@@ -160,12 +177,122 @@ DocumentSource::GetNextResult DocumentSourceLookUp::getNext() {
                 objsize <= BSONObjMaxInternalSize);
         results.emplace_back(std::move(*result));
     }
+    doDispose();
 
     MutableDocument output(std::move(inputDoc));
     output.setNestedField(_as, Value(std::move(results)));
     return output.freeze();
 }
 
+void DocumentSourceLookUp::updateJoinStrategy() {
+    ++_numInputDocs;
+    if (_joinStrategy != JoinStrategy::kAdaptive) {
+        return;
+    }
+
+    const long long maxMemoryUsageBytes =
+        internalDocumentSourceLookupHashJoinMaxMemoryBytes.load();
+    if (!_hashJoinAfterInputDocs) {
+        // Only a $lookup directly on a collection can be answered from a hash table; a view's
+        // pipeline may reshape the foreign documents.
+        if (maxMemoryUsageBytes <= 0 || _fromPipeline.size() != 1) {
+            _joinStrategy = JoinStrategy::kNestedLoop;
+            return;
+        }
+
+        BSONObjBuilder statsBuilder;
+        if (!_mongod->appendStorageStats(_fromExpCtx->ns, BSONObj(), &statsBuilder).isOK()) {
+            _joinStrategy = JoinStrategy::kNestedLoop;
+            return;
+        }
+        auto stats = statsBuilder.obj();
+        if (stats["size"].safeNumberLong() > maxMemoryUsageBytes) {
+            _joinStrategy = JoinStrategy::kNestedLoop;
+            return;
+        }
+        _hashJoinAfterInputDocs = stats["count"].safeNumberLong() / kForeignDocsScannedPerQuery;
+    }
+
+    if (_numInputDocs <= *_hashJoinAfterInputDocs) {
+        return;
+    }
+
+    if (buildHashJoinTable(static_cast<size_t>(maxMemoryUsageBytes))) {
+        _joinStrategy = JoinStrategy::kHashJoin;
+    } else {
+        _joinStrategy = JoinStrategy::kNestedLoop;
+    }
+}
+
+bool DocumentSourceLookUp::buildHashJoinTable(size_t maxMemoryUsageBytes) {
+    // Scan the foreign collection, applying any $match absorbed from after an $unwind so that only
+    // documents which may be returned are held in memory.
+    std::vector<BSONObj> scanPipeline;
+    if (_additionalFilter) {
+        scanPipeline.push_back(BSON("$match" << *_additionalFilter));
+    }
+    auto pipeline = uassertStatusOK(_mongod->makePipeline(scanPipeline, _fromExpCtx));
+
+    auto table = stdx::make_unique<LookupHashJoinTable>(
+        _fromExpCtx->getValueComparator(), _foreignFieldFieldName, maxMemoryUsageBytes);
+    while (auto foreignDoc = pipeline->getNext()) {
+        if (!table->add(foreignDoc->toBson())) {
+            return false;
+        }
+    }
+
+    _hashJoinTable = std::move(table);
+    return true;
+}
+
+void DocumentSourceLookUp::prepareMatches(const Document& input, const BSONObj& matchStage) {
+    updateJoinStrategy();
+
+    if (_joinStrategy == JoinStrategy::kHashJoin) {
+        // The table only narrows down the candidates, so filter them with the same query the
+        // nested loop join would have run.
+        auto matcher = uassertStatusOK(MatchExpressionParser::parse(
+            matchStage.firstElement().embeddedObject(),
+            ExtensionsCallbackNoop(),
+            _fromExpCtx->getCollator()));
+
+        _hashJoinMatches.clear();
+        _nextHashJoinMatch = 0;
+        for (auto position : _hashJoinTable->getCandidates(input.getNestedField(_localField))) {
+            if (matcher->matchesBSON(_hashJoinTable->getDocument(position))) {
+                _hashJoinMatches.push_back(position);
+            }
+        }
+        return;
+    }
+
+    // We've already allocated space for the trailing $match stage in '_fromPipeline'.
+    _fromPipeline.back() = matchStage;
+
+    if (_pipeline) {
+        _pipeline->dispose(pExpCtx->opCtx);
+    }
+    _pipeline = uassertStatusOK(_mongod->makePipeline(_fromPipeline, _fromExpCtx));
+
+    // The $lookup stage takes responsibility for disposing of its Pipeline, since it will
+    // potentially be used by multiple OperationContexts, and the $lookup stage is part of an
+    // outer Pipeline that will propagate dispose() calls before being destroyed.
+    _pipeline.get_deleter().dismissDisposal();
+}
+
+boost::optional<Document> DocumentSourceLookUp::getNextMatch() {
+    if (_joinStrategy == JoinStrategy::kHashJoin) {
+        if (_nextHashJoinMatch == _hashJoinMatches.size()) {
+            return boost::none;
+        }
+        auto position = _hashJoinMatches[_nextHashJoinMatch++];
+        return Document(_hashJoinTable->getDocument(position));
+    }
+
+    invariant(_pipeline);
+    return _pipeline->getNext();
+}
+
 DocumentSource::GetModPathsReturn DocumentSourceLookUp::getModifiedPaths() const {
     std::set<std::string> modifiedPaths{_as.fullPath()};
     if (_unwindSrc) {
@@ -368,7 +495,7 @@ DocumentSource::GetNextResult DocumentSourceLookUp::unwindResult() {
     // Loop until we get a document that has at least one match.
     // Note we may return early from this loop if our source stage is exhausted or if the unwind
     // source was asked to return empty arrays and we get a document without a match.
-    while (!_pipeline || !_nextValue) {
+    while (!_input || !_nextValue) {
         auto nextInput = pSource->getNext();
         if (!nextInput.isAdvanced()) {
             return nextInput;
@@ -379,21 +506,10 @@ DocumentSource::GetNextResult DocumentSourceLookUp::unwindResult() {
         BSONObj filter = _additionalFilter.value_or(BSONObj());
         auto matchStage =
             makeMatchStageFromInput(*_input, _localField, _foreignFieldFieldName, filter);
-        // We've already allocated space for the trailing $match stage in '_fromPipeline'.
-        _fromPipeline.back() = matchStage;
-
-        if (_pipeline) {
-            _pipeline->dispose(pExpCtx->opCtx);
-        }
-        _pipeline = uassertStatusOK(_mongod->makePipeline(_fromPipeline, _fromExpCtx));
-
-        // The $lookup stage takes responsibility for disposing of its Pipeline, since it will
-        // potentially be used by multiple OperationContexts, and the $lookup stage is part of an
-        // outer Pipeline that will propagate dispose() calls before being destroyed.
-        _pipeline.get_deleter().dismissDisposal();
+        prepareMatches(*_input, matchStage);
 
         _cursorIndex = 0;
-        _nextValue = _pipeline->getNext();
+        _nextValue = getNextMatch();
 
         if (_unwindSrc->preserveNullAndEmptyArrays() && !_nextValue) {
             // There were no results for this cursor, but the $unwind was asked to preserve empty
@@ -411,7 +527,7 @@ DocumentSource::GetNextResult DocumentSourceLookUp::unwindResult() {
 
     invariant(bool(_input) && bool(_nextValue));
     auto currentValue = *_nextValue;
-    _nextValue = _pipeline->getNext();
+    _nextValue = getNextMatch();
 
     // Move input document into output if this is the last or only result, otherwise perform a copy.
     MutableDocument output(_nextValue ? *_input : std::move(*_input));
@@ -451,6 +567,8 @@ void DocumentSourceLookUp::serializeToArray(
                           ->getQuery());
         }
 
+        output[getSourceName()]["strategy"] = Value(joinStrategyToString(_joinStrategy));
+
         array.push_back(Value(output.freeze()));
     } else {
         array.push_back(Value(output.freeze()));
@@ -32,18 +32,50 @@
 #include "mongo/db/pipeline/document_source_match.h"
 #include "mongo/db/pipeline/document_source_unwind.h"
 #include "mongo/db/pipeline/expression.h"
+#include "mongo/db/pipeline/lookup_hash_join_table.h"
 #include "mongo/db/pipeline/lookup_set_cache.h"
 #include "mongo/db/pipeline/value_comparator.h"
+#include "mongo/platform/atomic_word.h"
 
 namespace mongo {
 
+/**
+ * The most memory, in bytes, that the foreign documents of a $lookup hash join may use. A value of
+ * 0 disables hash joins.
+ */
+extern AtomicInt32 internalDocumentSourceLookupHashJoinMaxMemoryBytes;
+
 /**
  * Queries separate collection for equality matches with documents in the pipeline collection.
  * Adds matching documents to a new array field in the input document.
+ *
+ * Each input document is first joined by querying the foreign collection. Once enough input
+ * documents have been seen that reading the whole foreign collection is cheaper than continuing to
+ * query it, and the foreign collection fits in memory, the stage switches to a hash join.
  */
 class DocumentSourceLookUp final : public DocumentSourceNeedsMongod,
                                    public SplittableDocumentSource {
 public:
+    /**
+     * How the documents matching each input document are found.
+     */
+    enum class JoinStrategy {
+        // Queries the foreign collection for each input document until a hash join is chosen.
+        kAdaptive,
+
+        // Queries the foreign collection for each input document.
+        kNestedLoop,
+
+        // Probes a hash table built from a single scan of the foreign collection.
+        kHashJoin,
+    };
+
+    /**
+     * The number of foreign documents a hash join may read for the cost of one query against the
+     * foreign collection.
+     */
+    static constexpr long long kForeignDocsScannedPerQuery = 100;
+
     static std::unique_ptr<LiteParsedDocumentSourceOneForeignCollection> liteParse(
         const AggregationRequest& request, const BSONElement& spec);
 
@@ -108,6 +140,10 @@ public:
         _handlingUnwind = true;
     }
 
+    JoinStrategy getJoinStrategy() const {
+        return _joinStrategy;
+    }
+
 protected:
     void doDispose() final;
 
@@ -132,6 +168,26 @@ private:
 
     GetNextResult unwindResult();
 
+    /**
+     * Called once per input document. Decides whether to keep querying the foreign collection or
+     * to switch to a hash join, building the hash table if so.
+     */
+    void updateJoinStrategy();
+
+    /**
+     * Reads the foreign collection into '_hashJoinTable'. Returns false if it does not fit in
+     * 'maxMemoryUsageBytes'.
+     */
+    bool buildHashJoinTable(size_t maxMemoryUsageBytes);
+
+    /**
+     * Finds the foreign documents matching 'input', which are then returned by getNextMatch().
+     * 'matchStage' is the $match built for 'input' by makeMatchStageFromInput().
+     */
+    void prepareMatches(const Document& input, const BSONObj& matchStage);
+
+    boost::optional<Document> getNextMatch();
+
     NamespaceString _fromNs;
     FieldPath _as;
     FieldPath _localField;
@@ -152,10 +208,27 @@ private:
     bool _handlingUnwind = false;
     bool _handlingMatch = false;
 
+    JoinStrategy _joinStrategy = JoinStrategy::kAdaptive;
+
+    // The number of input documents joined so far, and how many to join by querying the foreign
+    // collection before switching to a hash join. The threshold is set on the first input
+    // document, while '_joinStrategy' is kAdaptive.
+    long long _numInputDocs = 0;
+    boost::optional<long long> _hashJoinAfterInputDocs;
+
+    // The build side of the hash join, and the positions in it of the documents matching the
+    // current input document.
+    std::unique_ptr<LookupHashJoinTable> _hashJoinTable;
+    std::vector<size_t> _hashJoinMatches;
+    size_t _nextHashJoinMatch = 0;
+
+    // The pipeline querying the foreign collection for the current input document, when not
+    // using a hash join.
+    std::unique_ptr<Pipeline, Pipeline::Deleter> _pipeline;
+
     // The following members are used to hold onto state across getNext() calls when
     // '_handlingUnwind' is true.
     long long _cursorIndex = 0;
-    std::unique_ptr<Pipeline, Pipeline::Deleter> _pipeline;
     boost::optional<Document> _input;
     boost::optional<Document> _nextValue;
 };
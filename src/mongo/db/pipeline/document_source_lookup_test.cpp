@@ -171,6 +171,22 @@ public:
         return pipeline;
     }
 
+    Status appendStorageStats(const NamespaceString& nss,
+                              const BSONObj& param,
+                              BSONObjBuilder* builder) const final {
+        long long count = 0;
+        long long size = 0;
+        for (auto&& result : _mockResults) {
+            if (result.isAdvanced()) {
+                ++count;
+                size += result.getDocument().toBson().objsize();
+            }
+        }
+        builder->append("count", count);
+        builder->append("size", size);
+        return Status::OK();
+    }
+
 private:
     deque<DocumentSource::GetNextResult> _mockResults;
 };
@@ -329,5 +345,236 @@ TEST_F(DocumentSourceLookUpTest, LookupReportsFieldsModifiedByAbsorbedUnwind) {
     lookup->dispose();
 }
 
+class DocumentSourceLookUpHashJoinTest : public AggregationContextFixture {
+public:
+    DocumentSourceLookUpHashJoinTest()
+        : _oldMaxMemoryBytes(internalDocumentSourceLookupHashJoinMaxMemoryBytes.load()) {}
+
+    ~DocumentSourceLookUpHashJoinTest() {
+        internalDocumentSourceLookupHashJoinMaxMemoryBytes.store(_oldMaxMemoryBytes);
+    }
+
+    /**
+     * Joins 'localDocs' with 'foreignDocs' on 'localField' and 'foreignField' and returns the
+     * output. If 'unwind' is true, the $lookup absorbs an $unwind which includes the array index.
+     * The strategy the $lookup used is returned through 'strategy'.
+     */
+    vector<Document> runLookup(const vector<Document>& localDocs,
+                               const vector<Document>& foreignDocs,
+                               StringData localField,
+                               StringData foreignField,
+                               bool unwind,
+                               DocumentSourceLookUp::JoinStrategy* strategy) {
+        auto expCtx = getExpCtx();
+        NamespaceString fromNs("test", "foreign");
+        expCtx->setResolvedNamespace(fromNs, {fromNs, std::vector<BSONObj>{}});
+
+        auto lookupSpec = Document{{"$lookup",
+                                    Document{{"from", fromNs.coll()},
+                                             {"localField", localField},
+                                             {"foreignField", foreignField},
+                                             {"as", "joined"_sd}}}}
+                              .toBson();
+        auto parsed = DocumentSourceLookUp::createFromBson(lookupSpec.firstElement(), expCtx);
+        auto lookup = static_cast<DocumentSourceLookUp*>(parsed.get());
+        if (unwind) {
+            lookup->setUnwindStage(
+                DocumentSourceUnwind::create(expCtx, "joined", false, std::string("index")));
+        }
+
+        deque<DocumentSource::GetNextResult> localResults;
+        for (auto&& doc : localDocs) {
+            localResults.emplace_back(Document(doc));
+        }
+        auto mockLocalSource = DocumentSourceMock::create(std::move(localResults));
+        lookup->setSource(mockLocalSource.get());
+
+        deque<DocumentSource::GetNextResult> foreignResults;
+        for (auto&& doc : foreignDocs) {
+            foreignResults.emplace_back(Document(doc));
+        }
+        lookup->injectMongodInterface(
+            std::make_shared<MockMongodInterface>(std::move(foreignResults)));
+
+        vector<Document> output;
+        for (auto next = lookup->getNext(); next.isAdvanced(); next = lookup->getNext()) {
+            output.push_back(next.releaseDocument());
+        }
+        *strategy = lookup->getJoinStrategy();
+        lookup->dispose();
+        return output;
+    }
+
+    /**
+     * Asserts that a hash join and a nested loop join of 'localDocs' with 'foreignDocs' produce
+     * the same output.
+     */
+    void assertHashJoinMatchesNestedLoopJoin(const vector<Document>& localDocs,
+                                             const vector<Document>& foreignDocs,
+                                             StringData localField,
+                                             StringData foreignField,
+                                             bool unwind) {
+        DocumentSourceLookUp::JoinStrategy strategy;
+
+        internalDocumentSourceLookupHashJoinMaxMemoryBytes.store(0);
+        auto expected =
+            runLookup(localDocs, foreignDocs, localField, foreignField, unwind, &strategy);
+        ASSERT(strategy == DocumentSourceLookUp::JoinStrategy::kNestedLoop);
+
+        internalDocumentSourceLookupHashJoinMaxMemoryBytes.store(_oldMaxMemoryBytes);
+        auto actual =
+            runLookup(localDocs, foreignDocs, localField, foreignField, unwind, &strategy);
+        ASSERT(strategy == DocumentSourceLookUp::JoinStrategy::kHashJoin);
+
+        ASSERT_EQ(expected.size(), actual.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            ASSERT_DOCUMENT_EQ(expected[i], actual[i]);
+        }
+    }
+
+private:
+    const int _oldMaxMemoryBytes;
+};
+
+const vector<Document> kHashJoinLocalDocs{Document{{"_id", 0}, {"key", 1}},
+                                          Document{{"_id", 1}, {"key", 2}},
+                                          Document{{"_id", 2}, {"key", vector<Value>{}}},
+                                          Document{{"_id", 3}, {"key", BSONNULL}},
+                                          Document{{"_id", 4}},
+                                          Document{{"_id", 5}, {"key", 1.0}},
+                                          Document{{"_id", 6}, {"key", "x"_sd}},
+                                          Document{{"_id", 7}, {"key", Document{{"b", 3}}}},
+                                          Document{{"_id", 8}, {"key", 7}}};
+
+TEST_F(DocumentSourceLookUpHashJoinTest, MatchesNestedLoopJoinOnScalarsNullsAndArrays) {
+    const vector<Document> localDocs = [] {
+        auto docs = kHashJoinLocalDocs;
+        docs.push_back(Document{{"_id", 9}, {"key", vector<Value>{Value(1), Value(2)}}});
+        docs.push_back(
+            Document{{"_id", 10}, {"key", vector<Value>{Value(vector<Value>{Value(2)})}}});
+        return docs;
+    }();
+    const vector<Document> foreignDocs{
+        Document{{"_id", 0}, {"key", 1}},
+        Document{{"_id", 1}, {"key", 1LL}},
+        Document{{"_id", 2}, {"key", vector<Value>{Value(2), Value(3)}}},
+        Document{{"_id", 3}, {"key", vector<Value>{Value(vector<Value>{Value(2)})}}},
+        Document{{"_id", 4}, {"key", BSONNULL}},
+        Document{{"_id", 5}},
+        Document{{"_id", 6}, {"key", vector<Value>{}}},
+        Document{{"_id", 7}, {"key", "x"_sd}},
+        Document{{"_id", 8}, {"key", Document{{"b", 3}}}}};
+
+    assertHashJoinMatchesNestedLoopJoin(localDocs, foreignDocs, "key", "key", false);
+}
+
+TEST_F(DocumentSourceLookUpHashJoinTest, MatchesNestedLoopJoinOnDottedForeignField) {
+    const vector<Document> foreignDocs{
+        Document{{"_id", 0}, {"a", Document{{"key", 1}}}},
+        Document{{"_id", 1}, {"a", vector<Value>{Value(Document{{"key", 2}}), Value(1)}}},
+        Document{{"_id", 2}, {"a", vector<Value>{Value(Document{{"key", 7}}), Value(2)}}},
+        Document{{"_id", 3}, {"a", 1}},
+        Document{{"_id", 4}},
+        Document{{"_id", 5}, {"a", Document{{"key", vector<Value>{Value(1), Value(7)}}}}}};
+
+    assertHashJoinMatchesNestedLoopJoin(kHashJoinLocalDocs, foreignDocs, "key", "a.key", false);
+}
+
+TEST_F(DocumentSourceLookUpHashJoinTest, MatchesNestedLoopJoinWhileUnwinding) {
+    const vector<Document> foreignDocs{Document{{"_id", 0}, {"key", 1}},
+                                       Document{{"_id", 1}, {"key", 2}},
+                                       Document{{"_id", 2}, {"key", 1}},
+                                       Document{{"_id", 3}},
+                                       Document{{"_id", 4}, {"key", vector<Value>{Value(7)}}}};
+
+    assertHashJoinMatchesNestedLoopJoin(kHashJoinLocalDocs, foreignDocs, "key", "key", true);
+}
+
+TEST_F(DocumentSourceLookUpHashJoinTest, QueriesForeignCollectionUntilHashJoinIsCheaper) {
+    // With 300 foreign documents, scanning them is worth it once more than three input documents
+    // have been joined.
+    vector<Document> foreignDocs;
+    for (int i = 0; i < 300; ++i) {
+        foreignDocs.push_back(Document{{"_id", i}});
+    }
+    vector<Document> localDocs{Document{{"_id", 1}}, Document{{"_id", 2}}, Document{{"_id", 3}}};
+
+    DocumentSourceLookUp::JoinStrategy strategy;
+    auto output = runLookup(localDocs, foreignDocs, "_id", "_id", false, &strategy);
+    ASSERT(strategy == DocumentSourceLookUp::JoinStrategy::kAdaptive);
+    ASSERT_EQ(3U, output.size());
+
+    localDocs.push_back(Document{{"_id", 4}});
+    output = runLookup(localDocs, foreignDocs, "_id", "_id", false, &strategy);
+    ASSERT(strategy == DocumentSourceLookUp::JoinStrategy::kHashJoin);
+    ASSERT_EQ(4U, output.size());
+    ASSERT_DOCUMENT_EQ(
+        output[3], (Document{{"_id", 4}, {"joined", vector<Value>{Value(Document{{"_id", 4}})}}}));
+}
+
+TEST_F(DocumentSourceLookUpHashJoinTest, FallsBackToNestedLoopJoinWhenOverMemoryLimit) {
+    vector<Document> foreignDocs;
+    for (int i = 0; i < 10; ++i) {
+        foreignDocs.push_back(Document{{"_id", i}, {"key", i % 2}});
+    }
+    const vector<Document> localDocs{Document{{"key", 0}}, Document{{"key", 1}}};
+
+    // The foreign collection is larger than the limit.
+    internalDocumentSourceLookupHashJoinMaxMemoryBytes.store(100);
+    DocumentSourceLookUp::JoinStrategy strategy;
+    auto output = runLookup(localDocs, foreignDocs, "key", "key", false, &strategy);
+    ASSERT(strategy == DocumentSourceLookUp::JoinStrategy::kNestedLoop);
+    ASSERT_EQ(2U, output.size());
+    ASSERT_EQ(5U, output[0]["joined"].getArrayLength());
+    ASSERT_EQ(5U, output[1]["joined"].getArrayLength());
+
+    // The foreign collection is smaller than the limit, but its hash table is not.
+    long long foreignBytes = 0;
+    for (auto&& doc : foreignDocs) {
+        foreignBytes += doc.toBson().objsize();
+    }
+    internalDocumentSourceLookupHashJoinMaxMemoryBytes.store(foreignBytes);
+    output = runLookup(localDocs, foreignDocs, "key", "key", false, &strategy);
+    ASSERT(strategy == DocumentSourceLookUp::JoinStrategy::kNestedLoop);
+    ASSERT_EQ(2U, output.size());
+    ASSERT_EQ(5U, output[0]["joined"].getArrayLength());
+    ASSERT_EQ(5U, output[1]["joined"].getArrayLength());
+}
+
+TEST_F(DocumentSourceLookUpHashJoinTest, ExplainReportsJoinStrategy) {
+    auto expCtx = getExpCtx();
+    NamespaceString fromNs("test", "foreign");
+    expCtx->setResolvedNamespace(fromNs, {fromNs, std::vector<BSONObj>{}});
+
+    auto lookupSpec = Document{{"$lookup",
+                                Document{{"from", fromNs.coll()},
+                                         {"localField", "foreignId"_sd},
+                                         {"foreignField", "_id"_sd},
+                                         {"as", "foreignDocs"_sd}}}}
+                          .toBson();
+    auto parsed = DocumentSourceLookUp::createFromBson(lookupSpec.firstElement(), expCtx);
+    auto lookup = static_cast<DocumentSourceLookUp*>(parsed.get());
+
+    auto mockLocalSource = DocumentSourceMock::create({Document{{"foreignId", 0}}});
+    lookup->setSource(mockLocalSource.get());
+    lookup->injectMongodInterface(std::make_shared<MockMongodInterface>(
+        deque<DocumentSource::GetNextResult>{Document{{"_id", 0}}}));
+
+    vector<Value> explain;
+    lookup->serializeToArray(explain, ExplainOptions::Verbosity::kQueryPlanner);
+    ASSERT_VALUE_EQ(explain[0]["$lookup"]["strategy"], Value("adaptive"_sd));
+
+    ASSERT_TRUE(lookup->getNext().isAdvanced());
+    explain.clear();
+    lookup->serializeToArray(explain, ExplainOptions::Verbosity::kQueryPlanner);
+    ASSERT_VALUE_EQ(explain[0]["$lookup"]["strategy"], Value("hashJoin"_sd));
+
+    // The strategy is not part of the serialized stage.
+    explain.clear();
+    lookup->serializeToArray(explain);
+    ASSERT_TRUE(explain[0]["$lookup"]["strategy"].missing());
+    lookup->dispose();
+}
+
 }  // namespace
 }  // namespace mongo
@@ -0,0 +1,111 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/lookup_hash_join_table.h"
+
+#include <algorithm>
+
+#include "mongo/db/bson/dotted_path_support.h"
+
+namespace mongo {
+
+namespace dps = ::mongo::dotted_path_support;
+
+LookupHashJoinTable::LookupHashJoinTable(const ValueComparator& comparator,
+                                         std::string foreignField,
+                                         size_t maxMemoryUsageBytes)
+    : _foreignField(std::move(foreignField)),
+      _maxMemoryUsageBytes(maxMemoryUsageBytes),
+      _positionsByValue(comparator.makeUnorderedValueMap<std::vector<size_t>>()) {}
+
+bool LookupHashJoinTable::add(BSONObj foreignDoc) {
+    // Gather both the elements of a trailing array and the array itself, since an equality query
+    // matches either.
+    BSONElementSet elements;
+    std::set<size_t> arrayComponents;
+    const bool expandArrayOnTrailingField = true;
+    dps::extractAllElementsAlongPath(
+        foreignDoc, _foreignField, elements, expandArrayOnTrailingField, &arrayComponents);
+    dps::extractAllElementsAlongPath(
+        foreignDoc, _foreignField, elements, !expandArrayOnTrailingField);
+
+    size_t memoryUsageBytes = foreignDoc.objsize() + sizeof(BSONObj);
+    for (auto&& element : elements) {
+        memoryUsageBytes += element.size() + sizeof(size_t);
+    }
+    if (_memoryUsageBytes + memoryUsageBytes > _maxMemoryUsageBytes) {
+        return false;
+    }
+    _memoryUsageBytes += memoryUsageBytes;
+
+    const size_t position = _documents.size();
+    bool isNullish = elements.empty() || !arrayComponents.empty();
+    for (auto&& element : elements) {
+        isNullish = isNullish || element.isNull() || element.type() == BSONType::Undefined;
+        _positionsByValue[Value(element)].push_back(position);
+    }
+    if (isNullish) {
+        _nullishPositions.push_back(position);
+    }
+
+    _documents.push_back(foreignDoc.getOwned());
+    return true;
+}
+
+std::vector<size_t> LookupHashJoinTable::getCandidates(const Value& localValue) const {
+    std::vector<size_t> candidates;
+    if (localValue.isArray()) {
+        for (auto&& element : localValue.getArray()) {
+            addCandidatesForValue(element, &candidates);
+        }
+    } else {
+        addCandidatesForValue(localValue.missing() ? Value(BSONNULL) : localValue, &candidates);
+    }
+
+    // Return each document once, in the order it was added to the table.
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+    return candidates;
+}
+
+void LookupHashJoinTable::addCandidatesForValue(const Value& value,
+                                                std::vector<size_t>* candidates) const {
+    if (value.nullish()) {
+        candidates->insert(candidates->end(), _nullishPositions.begin(), _nullishPositions.end());
+        return;
+    }
+
+    auto it = _positionsByValue.find(value);
+    if (it != _positionsByValue.end()) {
+        candidates->insert(candidates->end(), it->second.begin(), it->second.end());
+    }
+}
+
+}  // namespace mongo
@@ -0,0 +1,103 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/pipeline/value.h"
+#include "mongo/db/pipeline/value_comparator.h"
+
+namespace mongo {
+
+/**
+ * The build side of a hash join for $lookup. Holds the documents of the foreign collection, hashed
+ * on every value a query on 'foreignField' could match them by, so that the documents matching
+ * a local value can be found without querying the foreign collection.
+ *
+ * Lookups return candidates: a superset of the documents the equality query built by
+ * DocumentSourceLookUp::makeMatchStageFromInput() matches. Callers must still filter the
+ * candidates with that query, which keeps the exact query semantics for nulls, arrays and
+ * collation.
+ */
+class LookupHashJoinTable {
+public:
+    /**
+     * 'comparator' must respect the collation of the foreign query. Adding documents fails once
+     * their approximate memory usage exceeds 'maxMemoryUsageBytes'.
+     */
+    LookupHashJoinTable(const ValueComparator& comparator,
+                        std::string foreignField,
+                        size_t maxMemoryUsageBytes);
+
+    /**
+     * Adds a foreign document to the table. Returns false, without adding the document, if that
+     * would take the table over its memory limit.
+     */
+    bool add(BSONObj foreignDoc);
+
+    /**
+     * Returns the positions of the documents which may match a $lookup on 'localValue', in the
+     * order the documents were added. A missing 'localValue' is treated as null, and an array
+     * matches the documents matching any of its elements.
+     */
+    std::vector<size_t> getCandidates(const Value& localValue) const;
+
+    const BSONObj& getDocument(size_t position) const {
+        return _documents[position];
+    }
+
+    size_t size() const {
+        return _documents.size();
+    }
+
+    size_t getMemoryUsageBytes() const {
+        return _memoryUsageBytes;
+    }
+
+private:
+    void addCandidatesForValue(const Value& value, std::vector<size_t>* candidates) const;
+
+    const std::string _foreignField;
+    const size_t _maxMemoryUsageBytes;
+    size_t _memoryUsageBytes = 0;
+
+    std::vector<BSONObj> _documents;
+
+    // Positions in '_documents' keyed by each value of 'foreignField' in the document, including
+    // the elements of arrays as well as the arrays themselves.
+    ValueUnorderedMap<std::vector<size_t>> _positionsByValue;
+
+    // Positions of the documents that a query for null may match: documents where 'foreignField'
+    // is missing, null or undefined, or where its path crosses an array.
+    std::vector<size_t> _nullishPositions;
+};
+
+}  // namespace mongo
@@ -37,6 +37,7 @@
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/catalog/document_validation.h"
+#include "mongo/db/catalog/index_catalog.h"
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/db_raii.h"
@@ -47,10 +48,12 @@
 #include "mongo/db/exec/shard_filter.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/index/index_access_method.h"
+#include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/matcher/extensions_callback_real.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/pipeline/document_source.h"
 #include "mongo/db/pipeline/document_source_cursor.h"
+#include "mongo/db/pipeline/document_source_group.h"
 #include "mongo/db/pipeline/document_source_match.h"
 #include "mongo/db/pipeline/document_source_merge_cursors.h"
 #include "mongo/db/pipeline/document_source_sample.h"
@@ -59,6 +62,7 @@
 #include "mongo/db/pipeline/pipeline.h"
 #include "mongo/db/query/collation/collator_interface.h"
 #include "mongo/db/query/get_executor.h"
+#include "mongo/db/query/parsed_distinct.h"
 #include "mongo/db/query/plan_summary_stats.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/s/collection_sharding_state.h"
@@ -333,6 +337,91 @@ StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> attemptToGetExe
     return getExecutor(
         opCtx, collection, std::move(cq.getValue()), PlanExecutor::YIELD_AUTO, plannerOpts);
 }
+
+bool hasStageOfType(const PlanStage* stage, StageType type) {
+    if (stage->stageType() == type) {
+        return true;
+    }
+    for (auto&& child : stage->getChildren()) {
+        if (hasStageOfType(child.get(), type)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * If the pipeline starts with a $group whose output only depends on the distinct values of a field,
+ * attempts to build a PlanExecutor which returns a single document for each value of that field
+ * matching 'queryObj', by skipping through the keys of an index on the field. The $group is left in
+ * place to group these documents.
+ *
+ * Returns nullptr if there is no such $group, or if no index can provide a DISTINCT_SCAN for it.
+ * Indexes which may be multikey or sparse on the field rule the optimization out, since their keys
+ * aren't the values the $group would see. Sharded collections are also ruled out, as a
+ * DISTINCT_SCAN cannot filter out orphaned documents. On success, sets 'projectionObj' to the
+ * projection which the executor returns.
+ */
+std::unique_ptr<PlanExecutor, PlanExecutor::Deleter> attemptToGetDistinctScanExecutor(
+    OperationContext* opCtx,
+    Collection* collection,
+    const intrusive_ptr<ExpressionContext>& pExpCtx,
+    const Pipeline::SourceContainer& sources,
+    const BSONObj& queryObj,
+    const AggregationRequest* aggRequest,
+    BSONObj* projectionObj) {
+    if (!collection || sources.empty() || (aggRequest && !aggRequest->getHint().isEmpty()) ||
+        ShardingState::get(opCtx)->needCollectionMetadata(opCtx, pExpCtx->ns.ns())) {
+        return nullptr;
+    }
+
+    auto groupStage = dynamic_cast<DocumentSourceGroup*>(sources.front().get());
+    boost::optional<std::string> field =
+        groupStage ? groupStage->getDistinctFieldName() : boost::none;
+    if (!field || *field == "_id") {
+        return nullptr;
+    }
+
+    bool hasSuitableIndex = false;
+    IndexCatalog::IndexIterator ii = collection->getIndexCatalog()->getIndexIterator(opCtx, false);
+    while (ii.more()) {
+        const IndexDescriptor* desc = ii.next();
+        if (!desc->keyPattern().hasField(*field)) {
+            continue;
+        }
+        if (desc->isMultikey(opCtx) || desc->isSparse()) {
+            return nullptr;
+        }
+        hasSuitableIndex = true;
+    }
+    if (!hasSuitableIndex) {
+        return nullptr;
+    }
+
+    auto qr = stdx::make_unique<QueryRequest>(pExpCtx->ns);
+    qr->setFilter(queryObj);
+    if (aggRequest) {
+        qr->setExplain(static_cast<bool>(aggRequest->getExplain()));
+    }
+    qr->setCollation(pExpCtx->getCollator() ? pExpCtx->getCollator()->getSpec().toBSON()
+                                            : pExpCtx->collation);
+
+    const ExtensionsCallbackReal extensionsCallback(pExpCtx->opCtx, &pExpCtx->ns);
+    auto cq = CanonicalQuery::canonicalize(opCtx, std::move(qr), extensionsCallback);
+    if (!cq.isOK()) {
+        return nullptr;
+    }
+
+    ParsedDistinct parsedDistinct(std::move(cq.getValue()), *field);
+    auto exec = getExecutorDistinct(
+        opCtx, collection, pExpCtx->ns.ns(), &parsedDistinct, PlanExecutor::YIELD_AUTO);
+    if (!exec.isOK() || !hasStageOfType(exec.getValue()->getRootStage(), STAGE_DISTINCT_SCAN)) {
+        return nullptr;
+    }
+
+    *projectionObj = BSON("_id" << 0 << *field << 1);
+    return std::move(exec.getValue());
+}
 }  // namespace
 
 void PipelineD::prepareCursorSource(Collection* collection,
@@ -405,6 +494,15 @@ void PipelineD::prepareCursorSource(Collection* collection,
 
     BSONObj projForQuery = deps.toProjection();
 
+    // A leading $group on the distinct values of an indexed field only needs to see each value
+    // once.
+    if (auto exec = attemptToGetDistinctScanExecutor(
+            expCtx->opCtx, collection, expCtx, sources, queryObj, aggRequest, &projForQuery)) {
+        addCursorSource(
+            collection, pipeline, expCtx, std::move(exec), deps, queryObj, BSONObj(), projForQuery);
+        return;
+    }
+
     /*
       Look for an initial sort; we'll try to add this to the
       Cursor we create.  If we're successful in doing that (further down),
@@ -477,6 +575,10 @@ StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> PipelineD::prep
         plannerOpts |= QueryPlannerParams::INCLUDE_SHARD_FILTER;
     }
 
+    if (canUseParallelCollectionScan(opCtx, collection)) {
+        plannerOpts |= QueryPlannerParams::PARALLEL_COLLSCAN;
+    }
+
     if (deps.hasNoRequirements()) {
         // If we don't need any fields from the input document, performing a count is faster, and
         // will output empty documents, which is okay.
@@ -486,8 +588,12 @@ StatusWith<std::unique_ptr<PlanExecutor, PlanExecutor::Deleter>> PipelineD::prep
     // The only way to get a text score is to let the query system handle the projection. In all
     // other cases, unless the query system can do an index-covered projection and avoid going to
     // the raw record at all, it is faster to have ParsedDeps filter the fields we need.
+    //
+    // A covered projection of top-level fields is read straight out of the index keys by the
+    // DocumentSourceCursor, without building an intermediate BSONObj for each of them.
     if (!deps.getNeedTextScore()) {
-        plannerOpts |= QueryPlannerParams::NO_UNCOVERED_PROJECTIONS;
+        plannerOpts |= QueryPlannerParams::NO_UNCOVERED_PROJECTIONS |
+            QueryPlannerParams::RETURN_COVERED_INDEX_KEYS;
     }
 
     BSONObj emptyProjection;
@@ -182,6 +182,7 @@ public:
     const char* getRegexFlags() const;
     std::string getSymbol() const;
     std::string getCode() const;
+    BSONBinData getBinData() const;
     int getInt() const;
     long long getLong() const;
     const std::vector<Value>& getArray() const {
@@ -389,6 +390,12 @@ inline std::string Value::getString() const {
     return _storage.getString().toString();
 }
 
+inline BSONBinData Value::getBinData() const {
+    verify(getType() == BinData);
+    StringData data = _storage.getString();
+    return BSONBinData(data.rawData(), data.size(), _storage.binDataType());
+}
+
 inline OID Value::getOid() const {
     verify(getType() == jstOID);
     return OID(_storage.oid);
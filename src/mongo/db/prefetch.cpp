@@ -170,10 +170,10 @@ void prefetchPagesForReplicatedOp(OperationContext* opCtx, Database* db, const B
     BSONObj obj = op.getObjectField(opField);
     const char* ns = op.getStringField("ns");
 
-    // This will have to change for engines other than MMAP V1, because they might not have
-    // means for directly prefetching pages from the collection. For this purpose, acquire S
-    // lock on the database, instead of optimizing with IS.
-    Lock::CollectionLock collLock(opCtx->lockState(), ns, MODE_S);
+    // Engines without document-level locking upgrade this to an S lock, since touching pages
+    // directly must not race with writers. Other engines only need to read through the normal
+    // cursors, which is safe alongside the writer threads' IX locks.
+    Lock::CollectionLock collLock(opCtx->lockState(), ns, MODE_IS);
 
     Collection* collection = db->getCollection(opCtx, ns);
     if (!collection) {
@@ -0,0 +1,434 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/collection_statistics.h"
+
+#include <algorithm>
+
+#include "mongo/bson/simple_bsonobj_comparator.h"
+#include "mongo/bson/util/bson_extract.h"
+#include "mongo/db/bson/dotted_path_support.h"
+#include "mongo/db/query/index_bounds.h"
+#include "mongo/db/query/query_solution.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+namespace dps = ::mongo::dotted_path_support;
+
+namespace {
+
+/**
+ * Returns 'element' as a single-element object with an empty field name.
+ */
+BSONObj wrapValue(const BSONElement& element) {
+    BSONObjBuilder builder;
+    builder.appendAs(element, "");
+    return builder.obj();
+}
+
+/**
+ * Estimates the fraction of the values counted by 'histogram' which fall in 'interval'. Buckets
+ * partly covered by the interval count in proportion to the covered part of their range if it is
+ * numeric, and by half otherwise, but never less than one of their distinct values.
+ */
+double estimateIntervalFraction(const std::vector<FieldStatistics::Bucket>& histogram,
+                                const Interval& interval) {
+    // Intervals are oriented in the direction of the index, so they may be descending.
+    BSONElement low = interval.start;
+    BSONElement high = interval.end;
+    bool lowInclusive = interval.startInclusive;
+    bool highInclusive = interval.endInclusive;
+    if (low.woCompare(high, false) > 0) {
+        std::swap(low, high);
+        std::swap(lowInclusive, highInclusive);
+    }
+
+    const bool isPoint = low.woCompare(high, false) == 0;
+    if (isPoint && !(lowInclusive && highInclusive)) {
+        return 0;
+    }
+
+    double fraction = 0;
+    for (auto&& bucket : histogram) {
+        const BSONElement lower = bucket.lowerBound.firstElement();
+        const BSONElement upper = bucket.upperBound.firstElement();
+
+        const int lowToUpper = low.woCompare(upper, false);
+        const int highToLower = high.woCompare(lower, false);
+        if (lowToUpper > 0 || (lowToUpper == 0 && !lowInclusive) || highToLower < 0 ||
+            (highToLower == 0 && !highInclusive)) {
+            continue;
+        }
+
+        const int lowToLower = low.woCompare(lower, false);
+        const int highToUpper = high.woCompare(upper, false);
+        const bool coversLower = lowToLower < 0 || (lowToLower == 0 && lowInclusive);
+        const bool coversUpper = highToUpper > 0 || (highToUpper == 0 && highInclusive);
+        if (coversLower && coversUpper) {
+            fraction += bucket.fraction;
+            continue;
+        }
+
+        const double valueFraction =
+            bucket.fraction / std::max(bucket.distinctValues, static_cast<long long>(1));
+        if (isPoint) {
+            fraction += valueFraction;
+            continue;
+        }
+
+        double coveredPart = 0.5;
+        if (low.isNumber() && high.isNumber() && lower.isNumber() && upper.isNumber()) {
+            const double width = upper.numberDouble() - lower.numberDouble();
+            if (width > 0) {
+                const double from = std::max(low.numberDouble(), lower.numberDouble());
+                const double to = std::min(high.numberDouble(), upper.numberDouble());
+                coveredPart = std::min(std::max((to - from) / width, 0.0), 1.0);
+            }
+        }
+        fraction += std::max(bucket.fraction * coveredPart, valueFraction);
+    }
+    return fraction;
+}
+
+boost::optional<double> estimateIndexScanCost(const IndexScanNode* node,
+                                              const CollectionStatistics& stats,
+                                              long long numRecords) {
+    if (node->index.type != INDEX_BTREE || node->bounds.isSimpleRange) {
+        return boost::none;
+    }
+
+    // Each field's bounds narrow the scan further only while the bounds of the fields before it
+    // are points. The fields are assumed to be independent.
+    double fraction = 1;
+    double valuesPerDocument = 1;
+    size_t fieldIndex = 0;
+    for (auto&& keyElt : node->index.keyPattern) {
+        if (fieldIndex >= node->bounds.fields.size()) {
+            break;
+        }
+        const FieldStatistics* fieldStats = stats.getField(keyElt.fieldNameStringData());
+        if (!fieldStats) {
+            if (fieldIndex == 0) {
+                return boost::none;
+            }
+            break;
+        }
+        if (fieldIndex == 0) {
+            valuesPerDocument = fieldStats->valuesPerDocument;
+        }
+
+        const OrderedIntervalList& oil = node->bounds.fields[fieldIndex];
+        fraction *= fieldStats->estimateFraction(oil);
+        if (!std::all_of(oil.intervals.begin(), oil.intervals.end(), [](const Interval& interval) {
+                return interval.isPoint();
+            })) {
+            break;
+        }
+        ++fieldIndex;
+    }
+
+    return std::max(1.0, numRecords * valuesPerDocument * fraction);
+}
+
+}  // namespace
+
+//
+// FieldStatistics
+//
+
+// static
+FieldStatistics FieldStatistics::build(StringData path,
+                                       const std::vector<BSONObj>& sample,
+                                       long long numRecords,
+                                       size_t maxBuckets) {
+    invariant(maxBuckets > 0);
+
+    FieldStatistics stats;
+    if (sample.empty()) {
+        return stats;
+    }
+
+    long long numNull = 0;
+    long long numArray = 0;
+    std::vector<BSONObj> values;
+    for (auto&& doc : sample) {
+        BSONElementSet elements;
+        std::set<size_t> arrayComponents;
+        dps::extractAllElementsAlongPath(doc, path, elements, true, &arrayComponents);
+        if (!arrayComponents.empty()) {
+            numArray++;
+        }
+        if (elements.empty()) {
+            // Documents without the path are indexed under null.
+            numNull++;
+            values.push_back(BSON("" << BSONNULL));
+            continue;
+        }
+        for (auto&& element : elements) {
+            if (element.isNull()) {
+                numNull++;
+            }
+            values.push_back(wrapValue(element));
+        }
+    }
+
+    const double numSampled = static_cast<double>(sample.size());
+    const double numValues = static_cast<double>(values.size());
+    stats.nullFraction = std::min(numNull / numSampled, 1.0);
+    stats.arrayFraction = numArray / numSampled;
+    stats.valuesPerDocument = numValues / numSampled;
+
+    std::sort(values.begin(), values.end(), SimpleBSONObjComparator::kInstance.makeLessThan());
+
+    // Fill each bucket up to its share of the values, without splitting a run of equal values.
+    const size_t valuesPerBucket =
+        std::max<size_t>(1, (values.size() + maxBuckets - 1) / maxBuckets);
+    size_t valuesInBucket = 0;
+    long long numDistinct = 0;
+    long long numSingletons = 0;
+    for (size_t i = 0; i < values.size();) {
+        size_t runEnd = i + 1;
+        while (runEnd < values.size() &&
+               SimpleBSONObjComparator::kInstance.evaluate(values[runEnd] == values[i])) {
+            ++runEnd;
+        }
+        const size_t runLength = runEnd - i;
+
+        if (stats.histogram.empty() || valuesInBucket >= valuesPerBucket) {
+            stats.histogram.emplace_back();
+            stats.histogram.back().lowerBound = values[i];
+            valuesInBucket = 0;
+        }
+        Bucket& bucket = stats.histogram.back();
+        bucket.upperBound = values[i];
+        bucket.fraction += runLength / numValues;
+        bucket.distinctValues++;
+        valuesInBucket += runLength;
+
+        numDistinct++;
+        if (runLength == 1) {
+            numSingletons++;
+        }
+        i = runEnd;
+    }
+
+    // Scale the number of distinct values in the sample up to the whole collection with the Duj1
+    // estimator, which assumes values seen once in the sample are rare in the collection too.
+    const double totalValues = std::max(numValues, numRecords * stats.valuesPerDocument);
+    const double estimate = numValues * numDistinct /
+        (numValues - numSingletons + numSingletons * numValues / totalValues);
+    stats.distinctValues =
+        std::min(std::max(estimate, static_cast<double>(numDistinct)), totalValues);
+
+    return stats;
+}
+
+// static
+StatusWith<FieldStatistics> FieldStatistics::parse(const BSONObj& obj) {
+    FieldStatistics stats;
+    for (auto&& field : {std::make_pair("distinctValues", &stats.distinctValues),
+                         std::make_pair("nullFraction", &stats.nullFraction),
+                         std::make_pair("arrayFraction", &stats.arrayFraction),
+                         std::make_pair("valuesPerDocument", &stats.valuesPerDocument)}) {
+        Status status = bsonExtractDoubleField(obj, field.first, field.second);
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+
+    BSONElement histogramElt;
+    Status status = bsonExtractTypedField(obj, "histogram", Array, &histogramElt);
+    if (!status.isOK()) {
+        return status;
+    }
+    for (auto&& bucketElt : histogramElt.Obj()) {
+        if (bucketElt.type() != Object) {
+            return Status(ErrorCodes::TypeMismatch,
+                          str::stream() << "histogram buckets must be objects, but found "
+                                        << typeName(bucketElt.type()));
+        }
+        const BSONObj bucketObj = bucketElt.Obj();
+
+        Bucket bucket;
+        BSONElement lowerBound;
+        status = bsonExtractField(bucketObj, "lowerBound", &lowerBound);
+        if (!status.isOK()) {
+            return status;
+        }
+        BSONElement upperBound;
+        status = bsonExtractField(bucketObj, "upperBound", &upperBound);
+        if (!status.isOK()) {
+            return status;
+        }
+        status = bsonExtractDoubleField(bucketObj, "fraction", &bucket.fraction);
+        if (!status.isOK()) {
+            return status;
+        }
+        status = bsonExtractIntegerField(bucketObj, "distinctValues", &bucket.distinctValues);
+        if (!status.isOK()) {
+            return status;
+        }
+        bucket.lowerBound = wrapValue(lowerBound);
+        bucket.upperBound = wrapValue(upperBound);
+        stats.histogram.push_back(std::move(bucket));
+    }
+
+    return stats;
+}
+
+void FieldStatistics::appendTo(BSONObjBuilder* builder) const {
+    builder->append("distinctValues", distinctValues);
+    builder->append("nullFraction", nullFraction);
+    builder->append("arrayFraction", arrayFraction);
+    builder->append("valuesPerDocument", valuesPerDocument);
+
+    BSONArrayBuilder histogramBuilder(builder->subarrayStart("histogram"));
+    for (auto&& bucket : histogram) {
+        BSONObjBuilder bucketBuilder(histogramBuilder.subobjStart());
+        bucketBuilder.appendAs(bucket.lowerBound.firstElement(), "lowerBound");
+        bucketBuilder.appendAs(bucket.upperBound.firstElement(), "upperBound");
+        bucketBuilder.append("fraction", bucket.fraction);
+        bucketBuilder.appendNumber("distinctValues", bucket.distinctValues);
+    }
+}
+
+double FieldStatistics::estimateFraction(const OrderedIntervalList& oil) const {
+    double fraction = 0;
+    for (auto&& interval : oil.intervals) {
+        fraction += estimateIntervalFraction(histogram, interval);
+    }
+    return std::min(fraction, 1.0);
+}
+
+//
+// CollectionStatistics
+//
+
+constexpr StringData CollectionStatistics::kCollectionName;
+
+// static
+StatusWith<CollectionStatistics> CollectionStatistics::parse(const BSONObj& obj) {
+    CollectionStatistics stats;
+    Status status = bsonExtractIntegerField(obj, "numRecords", &stats.numRecords);
+    if (!status.isOK()) {
+        return status;
+    }
+    status = bsonExtractIntegerField(obj, "sampleSize", &stats.sampleSize);
+    if (!status.isOK()) {
+        return status;
+    }
+
+    BSONElement analyzedAtElt;
+    status = bsonExtractTypedField(obj, "analyzedAt", Date, &analyzedAtElt);
+    if (!status.isOK()) {
+        return status;
+    }
+    stats.analyzedAt = analyzedAtElt.date();
+
+    BSONElement fieldsElt;
+    status = bsonExtractTypedField(obj, "fields", Array, &fieldsElt);
+    if (!status.isOK()) {
+        return status;
+    }
+    for (auto&& fieldElt : fieldsElt.Obj()) {
+        if (fieldElt.type() != Object) {
+            return Status(ErrorCodes::TypeMismatch,
+                          str::stream() << "field statistics must be objects, but found "
+                                        << typeName(fieldElt.type()));
+        }
+        std::string path;
+        status = bsonExtractStringField(fieldElt.Obj(), "path", &path);
+        if (!status.isOK()) {
+            return status;
+        }
+        auto fieldStats = FieldStatistics::parse(fieldElt.Obj());
+        if (!fieldStats.isOK()) {
+            return fieldStats.getStatus();
+        }
+        stats.fields[path] = std::move(fieldStats.getValue());
+    }
+
+    return stats;
+}
+
+void CollectionStatistics::appendTo(BSONObjBuilder* builder) const {
+    builder->appendNumber("numRecords", numRecords);
+    builder->appendNumber("sampleSize", sampleSize);
+    builder->appendDate("analyzedAt", analyzedAt);
+
+    // Field paths may be dotted, so they are values rather than field names.
+    BSONArrayBuilder fieldsBuilder(builder->subarrayStart("fields"));
+    for (auto&& field : fields) {
+        BSONObjBuilder fieldBuilder(fieldsBuilder.subobjStart());
+        fieldBuilder.append("path", field.first);
+        field.second.appendTo(&fieldBuilder);
+    }
+}
+
+const FieldStatistics* CollectionStatistics::getField(StringData path) const {
+    auto it = fields.find(path.toString());
+    return it == fields.end() ? nullptr : &it->second;
+}
+
+boost::optional<double> estimateSolutionCost(const QuerySolutionNode* root,
+                                             const CollectionStatistics& stats,
+                                             long long numRecords) {
+    switch (root->getType()) {
+        case STAGE_COLLSCAN:
+            return static_cast<double>(numRecords);
+        case STAGE_IXSCAN:
+            return estimateIndexScanCost(
+                static_cast<const IndexScanNode*>(root), stats, numRecords);
+        default:
+            break;
+    }
+
+    if (root->children.empty()) {
+        return boost::none;
+    }
+
+    double cost = 0;
+    for (auto&& child : root->children) {
+        auto childCost = estimateSolutionCost(child, stats, numRecords);
+        if (!childCost) {
+            return boost::none;
+        }
+        cost += *childCost;
+    }
+
+    // A fetch examines a document for each key its input examined, at most.
+    if (root->getType() == STAGE_FETCH) {
+        cost *= 2;
+    }
+    return cost;
+}
+
+}  // namespace mongo
@@ -0,0 +1,150 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "mongo/base/status_with.h"
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+struct IndexBounds;
+struct OrderedIntervalList;
+struct QuerySolutionNode;
+
+/**
+ * Statistics about the values of one field path, built from a sample of a collection's documents
+ * by the 'analyze' command. The values are the keys an index on the path would hold: an array
+ * contributes each of its distinct elements, and a document without the path contributes null.
+ * Values are compared without a collation.
+ */
+class FieldStatistics {
+public:
+    /**
+     * A bucket of an equi-depth histogram, which holds about as many of the sampled values as
+     * every other bucket. A run of equal values is never split between buckets.
+     */
+    struct Bucket {
+        // Single-element objects with empty field names, holding the smallest and the largest
+        // value in the bucket.
+        BSONObj lowerBound;
+        BSONObj upperBound;
+
+        // The fraction of all the sampled values which fall in the bucket.
+        double fraction = 0;
+
+        // The number of distinct sampled values in the bucket.
+        long long distinctValues = 0;
+    };
+
+    /**
+     * Builds the statistics of 'path' from 'sample', using at most 'maxBuckets' histogram buckets.
+     * 'numRecords' is the number of documents in the sampled collection, from which the number of
+     * distinct values in the whole collection is estimated.
+     */
+    static FieldStatistics build(StringData path,
+                                 const std::vector<BSONObj>& sample,
+                                 long long numRecords,
+                                 size_t maxBuckets);
+
+    static StatusWith<FieldStatistics> parse(const BSONObj& obj);
+
+    void appendTo(BSONObjBuilder* builder) const;
+
+    /**
+     * Estimates the fraction of this field's values which fall in the intervals of 'oil'.
+     */
+    double estimateFraction(const OrderedIntervalList& oil) const;
+
+    // The estimated number of distinct values of the field in the whole collection.
+    double distinctValues = 0;
+
+    // The fraction of sampled documents in which the field is null or missing.
+    double nullFraction = 0;
+
+    // The fraction of sampled documents in which the field is an array.
+    double arrayFraction = 0;
+
+    // The average number of values, and so of index keys, per sampled document.
+    double valuesPerDocument = 1;
+
+    std::vector<Bucket> histogram;
+};
+
+/**
+ * The statistics of a collection's fields, as built by the 'analyze' command and persisted in the
+ * database's system.statistics collection under the collection's name.
+ */
+class CollectionStatistics {
+public:
+    // The collection in each database which holds the statistics of its analyzed collections.
+    static constexpr StringData kCollectionName = "system.statistics"_sd;
+
+    static StatusWith<CollectionStatistics> parse(const BSONObj& obj);
+
+    /**
+     * Appends every field except the _id under which the statistics are persisted.
+     */
+    void appendTo(BSONObjBuilder* builder) const;
+
+    /**
+     * Returns the statistics of 'path', or nullptr if it wasn't analyzed.
+     */
+    const FieldStatistics* getField(StringData path) const;
+
+    // The number of documents in the collection when it was analyzed.
+    long long numRecords = 0;
+
+    // The number of documents sampled.
+    long long sampleSize = 0;
+
+    Date_t analyzedAt;
+
+    std::map<std::string, FieldStatistics> fields;
+};
+
+/**
+ * Estimates the cost of executing the query solution rooted at 'root' against a collection of
+ * 'numRecords' documents, as the number of index keys and documents it examines.
+ *
+ * Returns boost::none if the solution has a leaf other than a collection scan or a scan of a btree
+ * index whose leading field has statistics, since there is nothing to compare it by.
+ */
+boost::optional<double> estimateSolutionCost(const QuerySolutionNode* root,
+                                             const CollectionStatistics& stats,
+                                             long long numRecords);
+
+}  // namespace mongo
@@ -0,0 +1,189 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/collection_statistics.h"
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/query/index_bounds.h"
+#include "mongo/db/query/index_entry.h"
+#include "mongo/db/query/query_solution.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+using namespace mongo;
+
+/**
+ * Returns 'numDocs' documents in which 'a' takes each of ten values equally often and 'b' is
+ * distinct.
+ */
+std::vector<BSONObj> makeSample(int numDocs) {
+    std::vector<BSONObj> sample;
+    for (int i = 0; i < numDocs; ++i) {
+        sample.push_back(BSON("a" << (i % 10) << "b" << i));
+    }
+    return sample;
+}
+
+OrderedIntervalList makeOil(const std::string& name, BSONObj base) {
+    OrderedIntervalList oil(name);
+    oil.intervals.push_back(Interval(base, true, true));
+    return oil;
+}
+
+TEST(FieldStatisticsTest, HistogramDoesNotSplitRunsOfEqualValues) {
+    FieldStatistics stats = FieldStatistics::build("a", makeSample(1000), 1000, 4);
+
+    ASSERT_EQUALS(4U, stats.histogram.size());
+    ASSERT_BSONOBJ_EQ(BSON("" << 0), stats.histogram[0].lowerBound);
+    ASSERT_BSONOBJ_EQ(BSON("" << 2), stats.histogram[0].upperBound);
+    ASSERT_APPROX_EQUAL(0.3, stats.histogram[0].fraction, 1e-9);
+    ASSERT_EQUALS(3, stats.histogram[0].distinctValues);
+    ASSERT_BSONOBJ_EQ(BSON("" << 9), stats.histogram[3].lowerBound);
+    ASSERT_BSONOBJ_EQ(BSON("" << 9), stats.histogram[3].upperBound);
+    ASSERT_APPROX_EQUAL(0.1, stats.histogram[3].fraction, 1e-9);
+
+    ASSERT_APPROX_EQUAL(10.0, stats.distinctValues, 1e-9);
+    ASSERT_EQUALS(0.0, stats.nullFraction);
+    ASSERT_EQUALS(0.0, stats.arrayFraction);
+    ASSERT_EQUALS(1.0, stats.valuesPerDocument);
+}
+
+TEST(FieldStatisticsTest, DistinctValuesSeenOnceScaleUpToCollection) {
+    auto sample = makeSample(1000);
+    ASSERT_APPROX_EQUAL(1000.0, FieldStatistics::build("b", sample, 1000, 4).distinctValues, 1e-6);
+    ASSERT_APPROX_EQUAL(
+        100000.0, FieldStatistics::build("b", sample, 100000, 4).distinctValues, 1e-6);
+}
+
+TEST(FieldStatisticsTest, ArraysContributeEachElementAndMissingFieldsAreNull) {
+    std::vector<BSONObj> sample{
+        BSON("a" << BSON_ARRAY(1 << 2)), BSONObj(), BSON("a" << BSONNULL), BSON("a" << 3)};
+    FieldStatistics stats = FieldStatistics::build("a", sample, 4, 10);
+
+    ASSERT_APPROX_EQUAL(0.5, stats.nullFraction, 1e-9);
+    ASSERT_APPROX_EQUAL(0.25, stats.arrayFraction, 1e-9);
+    ASSERT_APPROX_EQUAL(1.25, stats.valuesPerDocument, 1e-9);
+    ASSERT_EQUALS(4U, stats.histogram.size());
+    ASSERT_BSONOBJ_EQ(BSON("" << BSONNULL), stats.histogram[0].lowerBound);
+    ASSERT_APPROX_EQUAL(0.4, stats.histogram[0].fraction, 1e-9);
+}
+
+TEST(FieldStatisticsTest, EstimateFraction) {
+    FieldStatistics stats = FieldStatistics::build("a", makeSample(1000), 1000, 4);
+
+    // A point counts as one of the distinct values of its bucket.
+    ASSERT_APPROX_EQUAL(0.1, stats.estimateFraction(makeOil("a", BSON("" << 5 << "" << 5))), 1e-9);
+
+    // A range covering whole buckets counts all of their values.
+    ASSERT_APPROX_EQUAL(0.3, stats.estimateFraction(makeOil("a", BSON("" << 0 << "" << 2))), 1e-9);
+
+    // A numeric range partly covering a bucket counts the covered share of its range.
+    ASSERT_APPROX_EQUAL(
+        0.525, stats.estimateFraction(makeOil("a", BSON("" << 0 << "" << 4.5))), 1e-9);
+
+    // Descending intervals are estimated the same as ascending ones.
+    ASSERT_APPROX_EQUAL(0.3, stats.estimateFraction(makeOil("a", BSON("" << 2 << "" << 0))), 1e-9);
+
+    // Values outside of the histogram aren't counted.
+    ASSERT_EQUALS(0.0, stats.estimateFraction(makeOil("a", BSON("" << 20 << "" << 30))));
+    ASSERT_EQUALS(0.0, stats.estimateFraction(makeOil("a", BSON("" << "x" << "" << "y"))));
+}
+
+TEST(CollectionStatisticsTest, ParseRoundTrips) {
+    CollectionStatistics stats;
+    stats.numRecords = 1000;
+    stats.sampleSize = 1000;
+    stats.analyzedAt = Date_t::fromMillisSinceEpoch(1000);
+    auto sample = makeSample(1000);
+    stats.fields.emplace("a", FieldStatistics::build("a", sample, 1000, 4));
+    stats.fields.emplace("b", FieldStatistics::build("b", sample, 1000, 4));
+
+    BSONObjBuilder builder;
+    stats.appendTo(&builder);
+    const BSONObj obj = builder.obj();
+
+    auto parsed = CollectionStatistics::parse(obj);
+    ASSERT_OK(parsed.getStatus());
+    ASSERT_EQUALS(2U, parsed.getValue().fields.size());
+    ASSERT(parsed.getValue().getField("a"));
+    ASSERT_FALSE(parsed.getValue().getField("c"));
+
+    BSONObjBuilder reparsed;
+    parsed.getValue().appendTo(&reparsed);
+    ASSERT_BSONOBJ_EQ(obj, reparsed.obj());
+}
+
+TEST(CollectionStatisticsTest, ParseRejectsMissingHistogram) {
+    auto parsed = CollectionStatistics::parse(
+        BSON("numRecords" << 1 << "sampleSize" << 1 << "analyzedAt"
+                          << Date_t::fromMillisSinceEpoch(1000)
+                          << "fields"
+                          << BSON_ARRAY(BSON("path"
+                                             << "a"
+                                             << "distinctValues"
+                                             << 1.0
+                                             << "nullFraction"
+                                             << 0.0
+                                             << "arrayFraction"
+                                             << 0.0
+                                             << "valuesPerDocument"
+                                             << 1.0))));
+    ASSERT_NOT_OK(parsed.getStatus());
+}
+
+TEST(CollectionStatisticsTest, EstimateSolutionCost) {
+    CollectionStatistics stats;
+    auto sample = makeSample(1000);
+    stats.fields.emplace("a", FieldStatistics::build("a", sample, 1000, 4));
+    stats.fields.emplace("b", FieldStatistics::build("b", sample, 1000, 4));
+
+    CollectionScanNode collScan;
+    ASSERT_EQUALS(1000.0, *estimateSolutionCost(&collScan, stats, 1000));
+
+    // A fetch of a point on 'a' examines a tenth of the keys, and as many documents.
+    FetchNode fetchA;
+    auto ixscanA = new IndexScanNode(IndexEntry(BSON("a" << 1)));
+    ixscanA->bounds.fields.push_back(makeOil("a", BSON("" << 5 << "" << 5)));
+    fetchA.children.push_back(ixscanA);
+    ASSERT_APPROX_EQUAL(200.0, *estimateSolutionCost(&fetchA, stats, 1000), 1e-6);
+
+    // A point on the distinct 'b' examines a single key.
+    IndexScanNode ixscanB(IndexEntry(BSON("b" << 1)));
+    ixscanB.bounds.fields.push_back(makeOil("b", BSON("" << 5 << "" << 5)));
+    ASSERT_APPROX_EQUAL(1.0, *estimateSolutionCost(&ixscanB, stats, 1000), 1e-6);
+
+    // Scans of fields which weren't analyzed can't be estimated.
+    IndexScanNode ixscanC(IndexEntry(BSON("c" << 1)));
+    ixscanC.bounds.fields.push_back(makeOil("c", BSON("" << 5 << "" << 5)));
+    ASSERT_FALSE(estimateSolutionCost(&ixscanC, stats, 1000));
+}
+
+}  // namespace
@@ -50,6 +50,7 @@
 #include "mongo/db/query/find_common.h"
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/internal_plans.h"
+#include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/plan_summary_stats.h"
 #include "mongo/db/query/query_planner_params.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
@@ -155,6 +156,16 @@ void endQueryOp(OperationContext* opCtx,
 
     if (collection) {
         collection->infoCache()->notifyOfQuery(opCtx, summaryStats.indexesUsed);
+
+        // Add this execution to the runtime statistics of the query's shape, if it is cached.
+        const std::string& planCacheKey = curOp->debug().planCacheKey;
+        if (!planCacheKey.empty()) {
+            collection->infoCache()->getPlanCache()->recordExecution(
+                planCacheKey,
+                summaryStats.totalKeysExamined,
+                summaryStats.totalDocsExamined,
+                curOp->elapsedMicros());
+        }
     }
 
     if (curOp->shouldDBProfile()) {
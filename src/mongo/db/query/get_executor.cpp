@@ -32,6 +32,7 @@
 
 #include "mongo/db/query/get_executor.h"
 
+#include <algorithm>
 #include <boost/optional.hpp>
 #include <limits>
 #include <memory>
@@ -39,6 +40,7 @@
 #include "mongo/base/error_codes.h"
 #include "mongo/base/parse_number.h"
 #include "mongo/client/dbclientinterface.h"
+#include "mongo/db/curop.h"
 #include "mongo/db/exec/cached_plan.h"
 #include "mongo/db/exec/count.h"
 #include "mongo/db/exec/delete.h"
@@ -59,6 +61,7 @@
 #include "mongo/db/matcher/extensions_callback_real.h"
 #include "mongo/db/ops/update_lifecycle.h"
 #include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/collection_statistics.h"
 #include "mongo/db/query/collation/collator_factory_interface.h"
 #include "mongo/db/query/explain.h"
 #include "mongo/db/query/index_bounds_builder.h"
@@ -225,6 +228,65 @@ struct PrepareExecutionResult {
     unique_ptr<PlanStage> root;
 };
 
+/**
+ * Removes from 'solutions' every solution whose cost, estimated from the collection's statistics,
+ * is more than internalQueryPlannerStatisticsPruningRatio times that of the cheapest solution, so
+ * that the MultiPlanStage only has to try the plans which could win.
+ *
+ * Returns true if any solution was removed. Nothing is removed when the collection hasn't been
+ * analyzed, or when the cost of some solution can't be estimated. Queries with a sort, a limit or
+ * a collation are left alone, since the estimates take none of them into account.
+ */
+bool pruneSolutionsByEstimatedCost(OperationContext* opCtx,
+                                   Collection* collection,
+                                   const CanonicalQuery& canonicalQuery,
+                                   vector<QuerySolution*>* solutions) {
+    if (!internalQueryPlannerPruneByStatistics.load()) {
+        return false;
+    }
+
+    const QueryRequest& qr = canonicalQuery.getQueryRequest();
+    if (!qr.getSort().isEmpty() || qr.getLimit() || qr.getNToReturn() ||
+        canonicalQuery.getCollator()) {
+        return false;
+    }
+
+    auto stats = collection->infoCache()->getStatistics(opCtx);
+    if (!stats) {
+        return false;
+    }
+
+    const long long numRecords = collection->numRecords(opCtx);
+    vector<double> costs;
+    for (auto solution : *solutions) {
+        auto cost = estimateSolutionCost(solution->root.get(), *stats, numRecords);
+        if (!cost) {
+            return false;
+        }
+        costs.push_back(*cost);
+    }
+
+    const double maxCost = *std::min_element(costs.begin(), costs.end()) *
+        internalQueryPlannerStatisticsPruningRatio.load();
+    vector<QuerySolution*> kept;
+    for (size_t i = 0; i < solutions->size(); ++i) {
+        if (costs[i] <= maxCost) {
+            kept.push_back((*solutions)[i]);
+        } else {
+            delete (*solutions)[i];
+        }
+    }
+
+    if (kept.size() == solutions->size()) {
+        return false;
+    }
+
+    LOG(2) << "Pruned " << (solutions->size() - kept.size()) << " of " << solutions->size()
+           << " plans by their estimated cost: " << redact(canonicalQuery.toStringShort());
+    solutions->swap(kept);
+    return true;
+}
+
 /**
  * Build an execution tree for the query described in 'canonicalQuery'.
  *
@@ -332,10 +394,16 @@ StatusWith<PrepareExecutionResult> prepareExecution(OperationContext* opCtx,
         }
     }
 
-    // Try to look up a cached solution for the query.
+    // Try to look up a cached solution for the query. The cache key is kept on the operation so
+    // that its execution can be recorded against the cached shape once it is done.
     CachedSolution* rawCS;
-    if (PlanCache::shouldCacheQuery(*canonicalQuery) &&
-        collection->infoCache()->getPlanCache()->get(*canonicalQuery, &rawCS).isOK()) {
+    PlanCacheKey planCacheKey;
+    if (PlanCache::shouldCacheQuery(*canonicalQuery)) {
+        planCacheKey = collection->infoCache()->getPlanCache()->computeKey(*canonicalQuery);
+        CurOp::get(opCtx)->debug().planCacheKey = planCacheKey;
+    }
+    if (!planCacheKey.empty() &&
+        collection->infoCache()->getPlanCache()->get(planCacheKey, &rawCS).isOK()) {
         // We have a CachedSolution.  Have the planner turn it into a QuerySolution.
         unique_ptr<CachedSolution> cs(rawCS);
         QuerySolution* qs;
@@ -353,13 +421,14 @@ StatusWith<PrepareExecutionResult> prepareExecution(OperationContext* opCtx,
             //
             // 'decisionWorks' is used to determine whether the existing cache entry should
             // be evicted, and the query replanned.
-            root = make_unique<CachedPlanStage>(opCtx,
-                                                collection,
-                                                ws,
-                                                canonicalQuery.get(),
-                                                plannerParams,
-                                                cs->decisionWorks,
-                                                rawRoot);
+            auto cachedPlanStage = make_unique<CachedPlanStage>(opCtx,
+                                                                collection,
+                                                                ws,
+                                                                canonicalQuery.get(),
+                                                                plannerParams,
+                                                                cs->decisionWorks,
+                                                                rawRoot);
+            root = std::move(cachedPlanStage);
             querySolution.reset(qs);
             return PrepareExecutionResult(
                 std::move(canonicalQuery), std::move(querySolution), std::move(root));
@@ -419,7 +488,11 @@ StatusWith<PrepareExecutionResult> prepareExecution(OperationContext* opCtx,
         }
     }
 
-    if (1 == solutions.size()) {
+    const bool prunedByStatistics = (solutions.size() > 1) &&
+        pruneSolutionsByEstimatedCost(opCtx, collection, *canonicalQuery, &solutions);
+
+    // A plan left after pruning still goes through the MultiPlanStage so that it is cached.
+    if (1 == solutions.size() && !prunedByStatistics) {
         // Only one possible plan.  Run it.  Build the stages from the solution.
         PlanStage* rawRoot;
         verify(
@@ -616,6 +689,15 @@ StatusWith<unique_ptr<PlanExecutor, PlanExecutor::Deleter>> getOplogStartHack(
 
 }  // namespace
 
+bool canUseParallelCollectionScan(OperationContext* opCtx, const Collection* collection) {
+    // The workers read in snapshots of their own, so they cannot read from the majority committed
+    // snapshot, and only storage engines with document-level locking can split a scan by RecordId.
+    return collection && internalQueryExecParallelCollectionScanThreads.load() > 1 &&
+        !collection->isCapped() &&
+        opCtx->getServiceContext()->getGlobalStorageEngine()->supportsDocLocking() &&
+        !opCtx->recoveryUnit()->isReadingFromMajorityCommittedSnapshot();
+}
+
 StatusWith<unique_ptr<PlanExecutor, PlanExecutor::Deleter>> getExecutorFind(
     OperationContext* opCtx,
     Collection* collection,
@@ -630,6 +712,9 @@ StatusWith<unique_ptr<PlanExecutor, PlanExecutor::Deleter>> getExecutorFind(
     if (ShardingState::get(opCtx)->needCollectionMetadata(opCtx, nss.ns())) {
         options |= QueryPlannerParams::INCLUDE_SHARD_FILTER;
     }
+    if (canUseParallelCollectionScan(opCtx, collection)) {
+        options |= QueryPlannerParams::PARALLEL_COLLSCAN;
+    }
     return getExecutor(
         opCtx, collection, std::move(canonicalQuery), PlanExecutor::YIELD_AUTO, options);
 }
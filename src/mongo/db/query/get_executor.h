@@ -63,6 +63,13 @@ void fillOutPlannerParams(OperationContext* opCtx,
                           CanonicalQuery* canonicalQuery,
                           QueryPlannerParams* plannerParams);
 
+/**
+ * Returns whether this operation may split a scan of 'collection', whose results need not be in
+ * natural order, across worker threads. Operations which only read from the collection pass
+ * QueryPlannerParams::PARALLEL_COLLSCAN to getExecutor() when this is true.
+ */
+bool canUseParallelCollectionScan(OperationContext* opCtx, const Collection* collection);
+
 /**
  * Get a plan executor for a query.
  *
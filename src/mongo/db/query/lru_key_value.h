@@ -87,9 +87,10 @@ public:
      * kv-store is full prior to the add() operation.
      *
      * If an entry is evicted, it will be returned in
-     * an unique_ptr for the caller to use before disposing.
+     * an unique_ptr for the caller to use before disposing,
+     * and its key is stored in 'evictedKeyOut' if non-null.
      */
-    std::unique_ptr<V> add(const K& key, V* entry) {
+    std::unique_ptr<V> add(const K& key, V* entry, K* evictedKeyOut = nullptr) {
         // If the key already exists, delete it first.
         KVMapConstIt i = _kvMap.find(key);
         if (i != _kvMap.end()) {
@@ -110,6 +111,9 @@ public:
             V* evictedEntry = _kvList.back().second;
             invariant(evictedEntry);
 
+            if (evictedKeyOut) {
+                *evictedKeyOut = _kvList.back().first;
+            }
             _kvMap.erase(_kvList.back().first);
             _kvList.pop_back();
             _currentSize--;
@@ -140,16 +144,13 @@ public:
             return Status(ErrorCodes::NoSuchKey, "no such key in LRU key-value store");
         }
         KVListIt found = i->second;
-        V* foundEntry = found->second;
 
         // Promote the kv-store entry to the front of the list.
-        // It is now the most recently used.
-        _kvMap.erase(i);
-        _kvList.erase(found);
-        _kvList.push_front(std::make_pair(key, foundEntry));
-        _kvMap[key] = _kvList.begin();
+        // It is now the most recently used. Splicing keeps 'found'
+        // valid, so the map entry needn't change.
+        _kvList.splice(_kvList.begin(), _kvList, found);
 
-        *entryOut = foundEntry;
+        *entryOut = found->second;
         return Status::OK();
     }
 
@@ -33,6 +33,7 @@
 #include "mongo/db/query/plan_cache.h"
 
 #include <algorithm>
+#include <functional>
 #include <math.h>
 #include <memory>
 #include <vector>
@@ -42,9 +43,14 @@
 #include "mongo/db/matcher/expression_array.h"
 #include "mongo/db/matcher/expression_geo.h"
 #include "mongo/db/query/collation/collator_interface.h"
+#include "mongo/db/query/lru_key_value.h"
 #include "mongo/db/query/plan_ranker.h"
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/db/query/query_solution.h"
+#include "mongo/platform/bits.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/stdx/unordered_map.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
 #include "mongo/util/mongoutils/str.h"
@@ -53,6 +59,10 @@
 namespace mongo {
 namespace {
 
+// The most shards a PlanCache is split into. A cache holding fewer entries than this has one
+// shard per entry.
+const size_t kMaxPlanCacheShards = 16;
+
 // Delimiters for cache key encoding.
 const char kEncodeDiscriminatorsBegin = '<';
 const char kEncodeDiscriminatorsEnd = '>';
@@ -249,8 +259,31 @@ void encodeGeoNearMatchExpression(const GeoNearMatchExpression* tree, StringBuil
     }
 }
 
+size_t decisionWorks(const PlanCacheEntry& entry) {
+    return entry.decision->stats[0]->common.works;
+}
+
+/**
+ * Returns a description of the plan an entry makes the planner build, used to tell whether two
+ * entries of the same query shape hold the same plan.
+ */
+std::string describePlan(const std::vector<SolutionCacheData*>& plannerData) {
+    return plannerData.empty() ? std::string() : plannerData[0]->toString();
+}
+
 }  // namespace
 
+//
+// PlanCacheRuntimeStats
+//
+
+// static
+size_t PlanCacheRuntimeStats::bucketFor(long long value) {
+    invariant(value >= 0);
+    const size_t bucket = 63 - countLeadingZeros64(static_cast<unsigned long long>(value) + 1);
+    return std::min(bucket, kNumBuckets - 1);
+}
+
 //
 // Cache-related functions for CanonicalQuery
 //
@@ -379,12 +412,18 @@ PlanCacheEntry* PlanCacheEntry::clone() const {
     entry->collation = collation.getOwned();
 
     // Copy performance stats.
+    entry->shapeStats = shapeStats;
+    entry->runtimeStats = runtimeStats;
     for (size_t i = 0; i < feedback.size(); ++i) {
         PlanCacheEntryFeedback* fb = new PlanCacheEntryFeedback();
         fb->stats.reset(feedback[i]->stats->clone());
         fb->score = feedback[i]->score;
         entry->feedback.push_back(fb);
     }
+
+    for (auto&& alternate : alternates) {
+        entry->alternates.emplace_back(alternate->clone());
+    }
     return entry;
 }
 
@@ -498,12 +537,248 @@ std::string SolutionCacheData::toString() const {
 // PlanCache
 //
 
-PlanCache::PlanCache() : _cache(internalQueryCacheSize.load()) {}
+/**
+ * The statistics of a cached query shape which lookups and executions of the shape update without
+ * taking the mutex of its shard. Shared by the CacheSlots which hold the shape while it stays
+ * cached.
+ */
+struct PlanCache::ShapeCounters {
+    void record(long long keysExaminedCount, long long docsExaminedCount, long long micros) {
+        executions.fetchAndAdd(1);
+        keysExamined[PlanCacheRuntimeStats::bucketFor(std::max(keysExaminedCount, 0LL))]
+            .fetchAndAdd(1);
+        docsExamined[PlanCacheRuntimeStats::bucketFor(std::max(docsExaminedCount, 0LL))]
+            .fetchAndAdd(1);
+        latencyMicros[PlanCacheRuntimeStats::bucketFor(std::max(micros, 0LL))].fetchAndAdd(1);
+    }
+
+    PlanCacheRuntimeStats runtimeStats() const {
+        PlanCacheRuntimeStats stats;
+        stats.executions = executions.load();
+        for (size_t i = 0; i < PlanCacheRuntimeStats::kNumBuckets; ++i) {
+            stats.keysExamined[i] = keysExamined[i].load();
+            stats.docsExamined[i] = docsExamined[i].load();
+            stats.latencyMicros[i] = latencyMicros[i].load();
+        }
+        return stats;
+    }
+
+    using AtomicHistogram = std::array<AtomicInt64, PlanCacheRuntimeStats::kNumBuckets>;
+
+    AtomicInt64 hits;
+
+    // Set by the lookups which hit, so that the shape is promoted in its shard's LRU list before
+    // the shard next evicts. Lookups only write it when it is clear, to keep the cache line of a
+    // hot shape shared.
+    AtomicWord<bool> recentlyUsed{false};
+
+    AtomicInt64 executions;
+    AtomicHistogram keysExamined;
+    AtomicHistogram docsExamined;
+    AtomicHistogram latencyMicros;
+};
+
+/**
+ * A cached entry together with the alternate plans and the statistics of its query shape.
+ */
+struct PlanCache::CacheSlot {
+    /**
+     * Makes 'newEntry' the plan of this slot's query shape, keeping the plan it replaces and the
+     * existing alternates as alternates, unless they hold the same plan as 'newEntry' or as a more
+     * recent alternate.
+     */
+    void replaceEntry(std::shared_ptr<PlanCacheEntry> newEntry) {
+        std::vector<std::shared_ptr<PlanCacheEntry>> candidates{std::move(entry)};
+        candidates.insert(candidates.end(), alternates.begin(), alternates.end());
+        alternates.clear();
+        entry = std::move(newEntry);
+
+        const size_t maxAlternates =
+            static_cast<size_t>(std::max(internalQueryCacheMaxAlternatePlans.load(), 0));
+        std::set<std::string> keptPlans{describePlan(entry->plannerData)};
+        for (auto&& candidate : candidates) {
+            if (alternates.size() >= maxAlternates) {
+                break;
+            }
+            if (keptPlans.insert(describePlan(candidate->plannerData)).second) {
+                alternates.push_back(std::move(candidate));
+            }
+        }
+    }
+
+    /**
+     * Returns the lookup statistics of this slot's query shape.
+     */
+    PlanCacheStats shapeStats() const {
+        PlanCacheStats shapeStats = stats;
+        shapeStats.hits += counters->hits.load();
+        return shapeStats;
+    }
+
+    /**
+     * Returns a copy of the entry with the statistics and alternates of its query shape filled in.
+     */
+    PlanCacheEntry* copyEntry() const {
+        PlanCacheEntry* copy = entry->clone();
+        copy->shapeStats = shapeStats();
+        copy->runtimeStats = counters->runtimeStats();
+        for (auto&& alternate : alternates) {
+            copy->alternates.emplace_back(alternate->clone());
+        }
+        return copy;
+    }
+
+    // Held through a shared_ptr so that lookups can copy the entry without holding the shard's
+    // mutex, and without it being freed by a concurrent eviction. Everything in a cached entry
+    // except its feedback is immutable, and the feedback is only accessed under the mutex.
+    std::shared_ptr<PlanCacheEntry> entry;
+
+    // Plans previously cached for this query shape, most recently replaced first. Held like
+    // 'entry'.
+    std::vector<std::shared_ptr<PlanCacheEntry>> alternates;
+
+    // The hits of the shape before it was last cached. Hits since are counted in 'counters'.
+    PlanCacheStats stats;
 
-PlanCache::PlanCache(const std::string& ns) : _cache(internalQueryCacheSize.load()), _ns(ns) {}
+    std::shared_ptr<ShapeCounters> counters = std::make_shared<ShapeCounters>();
+};
+
+/**
+ * One of the independently locked parts of a PlanCache.
+ *
+ * Lookups, and the executions which record their statistics, do not take the mutex. The cached
+ * entries of the shard are published in an immutable Snapshot, which is rebuilt whenever they
+ * change. Readers announce themselves in 'activeReaders' while they use the snapshot, and a
+ * writer which replaces it waits for the readers of the old one to finish before freeing it.
+ * Since writes follow query planning, they are rare next to lookups, and each rebuild is linear in
+ * the few hundred entries of a shard.
+ */
+struct PlanCache::Shard {
+    struct PublishedSlot {
+        std::shared_ptr<PlanCacheEntry> entry;
+        std::shared_ptr<ShapeCounters> counters;
+    };
+
+    using Snapshot = stdx::unordered_map<PlanCacheKey, PublishedSlot>;
+
+    explicit Shard(size_t maxSize) : maxSize(maxSize), cache(maxSize), snapshot(new Snapshot()) {}
+
+    ~Shard() {
+        delete snapshot.load();
+    }
+
+    /**
+     * Calls 'fn' with the published slot of 'key' without taking the mutex, and returns true, if
+     * 'key' is cached. Returns false otherwise. 'fn' must be short, since writers wait for it.
+     */
+    template <typename Fn>
+    bool readPublished(const PlanCacheKey& key, Fn fn) const {
+        AtomicInt64& readers = activeReaders[readersEpoch.load() & 1];
+        readers.fetchAndAdd(1);
+        const Snapshot* current = snapshot.load();
+        const auto it = current->find(key);
+        const bool found = it != current->end();
+        if (found) {
+            fn(it->second);
+        }
+        readers.subtractAndFetch(1);
+        return found;
+    }
+
+    /**
+     * Publishes the current contents of 'cache' to readers. Must be called with 'mutex' held
+     * after every change to which entries are cached.
+     */
+    void publish() {
+        auto next = stdx::make_unique<Snapshot>();
+        for (auto it = cache.begin(); it != cache.end(); ++it) {
+            next->emplace(it->first, PublishedSlot{it->second->entry, it->second->counters});
+        }
+        std::unique_ptr<const Snapshot> previous(snapshot.swap(next.release()));
+
+        // Any reader of 'previous' registered before the swap, in one of the two counters. Each
+        // counter reaches zero once new readers register in the other one.
+        for (int phase = 0; phase < 2; ++phase) {
+            const unsigned epoch = readersEpoch.load();
+            readersEpoch.store(epoch + 1);
+            while (activeReaders[epoch & 1].load() != 0) {
+                stdx::this_thread::yield();
+            }
+        }
+    }
+
+    /**
+     * Promotes the shapes which lookups used since the last call in the LRU list, so that
+     * eviction approximates least recently used. Must be called with 'mutex' held.
+     */
+    void promoteRecentlyUsed() {
+        std::vector<PlanCacheKey> used;
+        for (auto it = cache.begin(); it != cache.end(); ++it) {
+            if (it->second->counters->recentlyUsed.swap(false)) {
+                used.push_back(it->first);
+            }
+        }
+        CacheSlot* slot;
+        for (auto&& key : used) {
+            cache.get(key, &slot);
+        }
+    }
+
+    /**
+     * Returns the statistics of 'key', which isn't cached, creating them if needed.
+     */
+    PlanCacheStats& uncachedStats(const PlanCacheKey& key) {
+        // Keep the statistics of at most as many uncached shapes as there are cached ones.
+        if (uncachedShapeStats.size() >= maxSize && !uncachedShapeStats.count(key)) {
+            uncachedShapeStats.clear();
+        }
+        return uncachedShapeStats[key];
+    }
+
+    const size_t maxSize;
+
+    stdx::mutex mutex;
+
+    // Everything below up to 'snapshot' is protected by 'mutex'.
+
+    LRUKeyValue<PlanCacheKey, CacheSlot> cache;
+
+    // The statistics of shapes which missed or were evicted, carried over if they are cached
+    // again.
+    stdx::unordered_map<PlanCacheKey, PlanCacheStats> uncachedShapeStats;
+
+    // Replaced, and only written, under 'mutex'.
+    AtomicWord<const Snapshot*> snapshot;
+
+    // Readers of 'snapshot' register in the counter which 'readersEpoch' selects.
+    AtomicWord<unsigned> readersEpoch;
+    mutable std::array<AtomicInt64, 2> activeReaders;
+
+    // The statistics of every shape in this shard.
+    AtomicInt64 hits;
+    AtomicInt64 misses;
+    AtomicInt64 evictions;
+};
+
+PlanCache::PlanCache() : PlanCache("") {}
+
+PlanCache::PlanCache(const std::string& ns) : _ns(ns) {
+    // Split the entries between the shards so that the cache as a whole holds no more than
+    // internalQueryCacheSize of them.
+    const size_t maxSize = static_cast<size_t>(std::max(internalQueryCacheSize.load(), 0));
+    const size_t numShards = std::max<size_t>(1, std::min(maxSize, kMaxPlanCacheShards));
+    for (size_t i = 0; i < numShards; ++i) {
+        const size_t maxSizeOfShard = maxSize / numShards + (i < maxSize % numShards ? 1 : 0);
+        _shards.push_back(stdx::make_unique<Shard>(maxSizeOfShard));
+    }
+}
 
 PlanCache::~PlanCache() {}
 
+PlanCache::Shard& PlanCache::getShard(const PlanCacheKey& key) const {
+    return *_shards[std::hash<PlanCacheKey>()(key) % _shards.size()];
+}
+
 /**
  * Traverses expression tree pre-order.
  * Appends an encoding of each node's match type and path name
@@ -677,34 +952,113 @@ Status PlanCache::add(const CanonicalQuery& query,
     }
     entry->projection = projBuilder.obj();
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    std::unique_ptr<PlanCacheEntry> evictedEntry = _cache.add(computeKey(query), entry);
+    const PlanCacheKey key = computeKey(query);
+    auto slot = stdx::make_unique<CacheSlot>();
+    std::shared_ptr<PlanCacheEntry> newEntry(entry);
+
+    Shard& shard = getShard(key);
+    stdx::lock_guard<stdx::mutex> shardLock(shard.mutex);
 
-    if (NULL != evictedEntry.get()) {
+    // Carry over the statistics of the shape, whether it is already cached or not. A cached plan
+    // which is being replaced may be kept as an alternate.
+    CacheSlot* existing;
+    if (!shard.cache.hasKey(key) && shard.cache.size() >= shard.maxSize) {
+        // Lookups don't reorder the LRU list, so catch up with them before evicting.
+        shard.promoteRecentlyUsed();
+    }
+    if (shard.cache.get(key, &existing).isOK()) {
+        *slot = *existing;
+        slot->replaceEntry(std::move(newEntry));
+    } else {
+        slot->entry = std::move(newEntry);
+        auto it = shard.uncachedShapeStats.find(key);
+        if (it != shard.uncachedShapeStats.end()) {
+            slot->stats = it->second;
+            shard.uncachedShapeStats.erase(it);
+        }
+    }
+
+    PlanCacheKey evictedKey;
+    std::unique_ptr<CacheSlot> evictedSlot = shard.cache.add(key, slot.release(), &evictedKey);
+
+    if (NULL != evictedSlot.get()) {
         LOG(1) << _ns << ": plan cache maximum size exceeded - "
-               << "removed least recently used entry " << redact(evictedEntry->toString());
+               << "removed least recently used entry " << redact(evictedSlot->entry->toString());
+
+        evictedSlot->stats.evictions++;
+        shard.evictions.fetchAndAdd(1);
+        shard.uncachedStats(evictedKey) = evictedSlot->shapeStats();
     }
 
+    shard.publish();
     return Status::OK();
 }
 
 Status PlanCache::get(const CanonicalQuery& query, CachedSolution** crOut) const {
-    PlanCacheKey key = computeKey(query);
+    return get(computeKey(query), crOut);
+}
+
+Status PlanCache::get(const PlanCacheKey& key, CachedSolution** crOut) const {
     verify(crOut);
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    PlanCacheEntry* entry;
-    Status cacheStatus = _cache.get(key, &entry);
-    if (!cacheStatus.isOK()) {
-        return cacheStatus;
+    Shard& shard = getShard(key);
+    std::shared_ptr<PlanCacheEntry> entry;
+    const auto hit = [&](const Shard::PublishedSlot& slot) {
+        slot.counters->hits.fetchAndAdd(1);
+        if (!slot.counters->recentlyUsed.loadRelaxed()) {
+            slot.counters->recentlyUsed.store(true);
+        }
+        entry = slot.entry;
+    };
+
+    // Hits, which all lookups of a hot query shape are, don't take the shard's mutex.
+    if (!shard.readPublished(key, hit)) {
+        // Misses are followed by query planning, so counting them by shape under the mutex is
+        // cheap in comparison.
+        stdx::lock_guard<stdx::mutex> shardLock(shard.mutex);
+        CacheSlot* slot;
+        Status cacheStatus = shard.cache.get(key, &slot);
+        if (!cacheStatus.isOK()) {
+            shard.uncachedStats(key).misses++;
+            shard.misses.fetchAndAdd(1);
+            return cacheStatus;
+        }
+        slot->counters->hits.fetchAndAdd(1);
+        entry = slot->entry;
     }
+    shard.hits.fetchAndAdd(1);
     invariant(entry);
 
+    // Copy the entry outside of the shard's mutex, since this clones all of its planner data.
     *crOut = new CachedSolution(key, *entry);
 
     return Status::OK();
 }
 
+Status PlanCache::getAlternates(const CanonicalQuery& query,
+                                std::vector<std::unique_ptr<CachedSolution>>* out) const {
+    const PlanCacheKey key = computeKey(query);
+    invariant(out);
+
+    std::vector<std::shared_ptr<PlanCacheEntry>> alternates;
+    {
+        Shard& shard = getShard(key);
+        stdx::lock_guard<stdx::mutex> shardLock(shard.mutex);
+        CacheSlot* slot;
+        Status cacheStatus = shard.cache.get(key, &slot);
+        if (!cacheStatus.isOK()) {
+            return cacheStatus;
+        }
+        alternates = slot->alternates;
+    }
+
+    for (auto&& alternate : alternates) {
+        out->push_back(stdx::make_unique<CachedSolution>(key, *alternate));
+    }
+
+    return Status::OK();
+}
+
 Status PlanCache::feedback(const CanonicalQuery& cq, PlanCacheEntryFeedback* feedback) {
     if (NULL == feedback) {
         return Status(ErrorCodes::BadValue, "feedback is NULL");
@@ -712,12 +1066,14 @@ Status PlanCache::feedback(const CanonicalQuery& cq, PlanCacheEntryFeedback* fee
     std::unique_ptr<PlanCacheEntryFeedback> autoFeedback(feedback);
     PlanCacheKey ck = computeKey(cq);
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    PlanCacheEntry* entry;
-    Status cacheStatus = _cache.get(ck, &entry);
+    Shard& shard = getShard(ck);
+    stdx::lock_guard<stdx::mutex> shardLock(shard.mutex);
+    CacheSlot* slot;
+    Status cacheStatus = shard.cache.get(ck, &slot);
     if (!cacheStatus.isOK()) {
         return cacheStatus;
     }
+    PlanCacheEntry* entry = slot->entry.get();
     invariant(entry);
 
     // We store up to a constant number of feedback entries.
@@ -728,14 +1084,67 @@ Status PlanCache::feedback(const CanonicalQuery& cq, PlanCacheEntryFeedback* fee
     return Status::OK();
 }
 
+Status PlanCache::promoteAlternate(const CanonicalQuery& cq, const CachedSolution& alternate) {
+    const PlanCacheKey key = computeKey(cq);
+    const std::string plan = describePlan(alternate.plannerData);
+
+    Shard& shard = getShard(key);
+    stdx::lock_guard<stdx::mutex> shardLock(shard.mutex);
+    CacheSlot* slot;
+    Status cacheStatus = shard.cache.get(key, &slot);
+    if (!cacheStatus.isOK()) {
+        return cacheStatus;
+    }
+
+    auto& alternates = slot->alternates;
+    auto it = std::find_if(alternates.begin(), alternates.end(), [&](const auto& candidate) {
+        return decisionWorks(*candidate) == alternate.decisionWorks &&
+            describePlan(candidate->plannerData) == plan;
+    });
+    if (it == alternates.end()) {
+        return Status(ErrorCodes::NoSuchKey, "alternate plan is no longer in the plan cache");
+    }
+
+    // Swap the alternate with the cached plan, which becomes the most recent alternate.
+    std::swap(slot->entry, *it);
+    std::rotate(alternates.begin(), it, it + 1);
+
+    shard.publish();
+    return Status::OK();
+}
+
+Status PlanCache::recordExecution(const PlanCacheKey& key,
+                                  long long keysExamined,
+                                  long long docsExamined,
+                                  long long micros) {
+    // Every execution of a cached shape records itself, so this doesn't take the shard's mutex.
+    const bool cached = getShard(key).readPublished(key, [&](const Shard::PublishedSlot& slot) {
+        slot.counters->record(keysExamined, docsExamined, micros);
+    });
+    if (!cached) {
+        return Status(ErrorCodes::NoSuchKey, "query shape is not in the plan cache");
+    }
+    return Status::OK();
+}
+
 Status PlanCache::remove(const CanonicalQuery& canonicalQuery) {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    return _cache.remove(computeKey(canonicalQuery));
+    const PlanCacheKey key = computeKey(canonicalQuery);
+    Shard& shard = getShard(key);
+    stdx::lock_guard<stdx::mutex> shardLock(shard.mutex);
+    Status status = shard.cache.remove(key);
+    if (status.isOK()) {
+        shard.publish();
+    }
+    return status;
 }
 
 void PlanCache::clear() {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    _cache.clear();
+    for (auto&& shard : _shards) {
+        stdx::lock_guard<stdx::mutex> shardLock(shard->mutex);
+        shard->cache.clear();
+        shard->uncachedShapeStats.clear();
+        shard->publish();
+    }
 }
 
 PlanCacheKey PlanCache::computeKey(const CanonicalQuery& cq) const {
@@ -750,39 +1159,57 @@ Status PlanCache::getEntry(const CanonicalQuery& query, PlanCacheEntry** entryOu
     PlanCacheKey key = computeKey(query);
     verify(entryOut);
 
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    PlanCacheEntry* entry;
-    Status cacheStatus = _cache.get(key, &entry);
+    Shard& shard = getShard(key);
+    stdx::lock_guard<stdx::mutex> shardLock(shard.mutex);
+    CacheSlot* slot;
+    Status cacheStatus = shard.cache.get(key, &slot);
     if (!cacheStatus.isOK()) {
         return cacheStatus;
     }
-    invariant(entry);
+    invariant(slot->entry);
 
-    *entryOut = entry->clone();
+    *entryOut = slot->copyEntry();
 
     return Status::OK();
 }
 
 std::vector<PlanCacheEntry*> PlanCache::getAllEntries() const {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
     std::vector<PlanCacheEntry*> entries;
-    typedef std::list<std::pair<PlanCacheKey, PlanCacheEntry*>>::const_iterator ConstIterator;
-    for (ConstIterator i = _cache.begin(); i != _cache.end(); i++) {
-        PlanCacheEntry* entry = i->second;
-        entries.push_back(entry->clone());
+    for (auto&& shard : _shards) {
+        stdx::lock_guard<stdx::mutex> shardLock(shard->mutex);
+        for (auto i = shard->cache.begin(); i != shard->cache.end(); i++) {
+            const CacheSlot* slot = i->second;
+            entries.push_back(slot->copyEntry());
+        }
     }
 
     return entries;
 }
 
 bool PlanCache::contains(const CanonicalQuery& cq) const {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    return _cache.hasKey(computeKey(cq));
+    const PlanCacheKey key = computeKey(cq);
+    Shard& shard = getShard(key);
+    stdx::lock_guard<stdx::mutex> shardLock(shard.mutex);
+    return shard.cache.hasKey(key);
 }
 
 size_t PlanCache::size() const {
-    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
-    return _cache.size();
+    size_t size = 0;
+    for (auto&& shard : _shards) {
+        stdx::lock_guard<stdx::mutex> shardLock(shard->mutex);
+        size += shard->cache.size();
+    }
+    return size;
+}
+
+PlanCacheStats PlanCache::getStats() const {
+    PlanCacheStats stats;
+    for (auto&& shard : _shards) {
+        stats.hits += shard->hits.load();
+        stats.misses += shard->misses.load();
+        stats.evictions += shard->evictions.load();
+    }
+    return stats;
 }
 
 void PlanCache::notifyOfIndexEntries(const std::vector<IndexEntry>& indexEntries) {
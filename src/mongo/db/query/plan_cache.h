@@ -28,13 +28,15 @@
 
 #pragma once
 
+#include <array>
 #include <boost/optional/optional.hpp>
+#include <memory>
 #include <set>
+#include <vector>
 
 #include "mongo/db/exec/plan_stats.h"
 #include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/index_tag.h"
-#include "mongo/db/query/lru_key_value.h"
 #include "mongo/db/query/plan_cache_indexability.h"
 #include "mongo/db/query/query_planner_params.h"
 #include "mongo/platform/atomic_word.h"
@@ -190,6 +192,42 @@ struct SolutionCacheData {
 
 class PlanCacheEntry;
 
+/**
+ * Counts of the plan cache lookups for one query shape, or for every shape in a PlanCache.
+ */
+struct PlanCacheStats {
+    // Lookups which found a cached plan.
+    long long hits = 0;
+
+    // Lookups which found no cached plan.
+    long long misses = 0;
+
+    // Cached plans evicted to make room for other query shapes.
+    long long evictions = 0;
+};
+
+/**
+ * Histograms of the work done by the executions of one query shape, whichever of its cached plans
+ * they used. A value v is counted in bucket floor(log2(v + 1)), so bucket i holds the values in
+ * [2^i - 1, 2^(i+1) - 1) and the last bucket also holds everything larger.
+ */
+struct PlanCacheRuntimeStats {
+    static const size_t kNumBuckets = 32;
+
+    using Histogram = std::array<long long, kNumBuckets>;
+
+    /**
+     * Returns the histogram bucket which counts 'value', which must not be negative.
+     */
+    static size_t bucketFor(long long value);
+
+    long long executions = 0;
+
+    Histogram keysExamined{};
+    Histogram docsExamined{};
+    Histogram latencyMicros{};
+};
+
 /**
  * Information returned from a get(...) query.
  */
@@ -279,6 +317,19 @@ public:
     // Annotations from cached runs.  The CachedPlanStage provides these stats about its
     // runs when they complete.
     std::vector<PlanCacheEntryFeedback*> feedback;
+
+    // Lookup statistics for this entry's query shape. Only filled in on the copies returned by
+    // PlanCache::getEntry() and PlanCache::getAllEntries().
+    PlanCacheStats shapeStats;
+
+    // Execution statistics for this entry's query shape. Only filled in on the copies returned by
+    // PlanCache::getEntry() and PlanCache::getAllEntries().
+    PlanCacheRuntimeStats runtimeStats;
+
+    // Plans which were cached for this entry's query shape before being replaced by replanning,
+    // most recently replaced first. Only filled in on the copies returned by
+    // PlanCache::getEntry() and PlanCache::getAllEntries().
+    std::vector<std::unique_ptr<PlanCacheEntry>> alternates;
 };
 
 /**
@@ -286,6 +337,20 @@ public:
  * mapping, the cache contains information on why that mapping was made and statistics on the
  * cache entry's actual performance on subsequent runs.
  *
+ * When replanning replaces the plan of a query shape, the old plan is kept as an alternate. Each
+ * of a shape's plans won for parameter values of a different selectivity, so this lets a shape
+ * whose parameter values are skewed keep a plan for each kind of value, and switch between them
+ * without replanning from scratch each time.
+ *
+ * The cache is split into shards by the hash of the query shape, each with its own mutex and
+ * LRU list, so that changes to different shapes rarely contend. The internalQueryCacheSize
+ * entries are divided between the shards, so eviction is least recently used within each shard,
+ * and a shard may evict while others have room.
+ *
+ * Lookups which hit, and the recording of executions, take no mutex at all, so that concurrent
+ * queries of one hot shape don't contend either. They read an immutable snapshot of their shard,
+ * count hits in atomics, and only mark the shape as recently used. The shard catches up with those
+ * marks in its LRU list before it next evicts, so eviction is approximately least recently used.
  */
 class PlanCache {
 private:
@@ -334,6 +399,23 @@ public:
      */
     Status get(const CanonicalQuery& query, CachedSolution** crOut) const;
 
+    /**
+     * As above, for callers which have already computed the cache key of the query.
+     */
+    Status get(const PlanCacheKey& key, CachedSolution** crOut) const;
+
+    /**
+     * Looks up the other plans cached for the query shape of 'query', in the order in which they
+     * should be tried if the cached plan does not finish its trial period within its works
+     * budget. Only used by the CachedPlanStage once the cached plan has overrun its budget, so
+     * that cache hits don't pay for copying them.
+     *
+     * Returns an error Status if there is no entry in the cache for 'query'. Otherwise appends
+     * the alternates, which may be none, to 'out' and returns Status::OK().
+     */
+    Status getAlternates(const CanonicalQuery& query,
+                         std::vector<std::unique_ptr<CachedSolution>>* out) const;
+
     /**
      * When the CachedPlanStage runs a plan out of the cache, we want to record data about the
      * plan's performance.  The CachedPlanStage calls feedback(...) after executing the cached
@@ -349,6 +431,28 @@ public:
      */
     Status feedback(const CanonicalQuery& cq, PlanCacheEntryFeedback* feedback);
 
+    /**
+     * Makes 'alternate', one of the alternates returned by getAlternates(...) for 'cq', the plan
+     * cached for the query shape of 'cq', and keeps the plan it replaces as an alternate. The
+     * CachedPlanStage calls this when an alternate finishes its trial period after the cached plan
+     * did not.
+     *
+     * Returns an error Status if 'alternate' is no longer cached as an alternate for 'cq'.
+     */
+    Status promoteAlternate(const CanonicalQuery& cq, const CachedSolution& alternate);
+
+    /**
+     * Adds an execution of the query shape with cache key 'key' which examined 'keysExamined'
+     * index keys and 'docsExamined' documents in 'micros' microseconds to the runtime statistics
+     * of the shape.
+     *
+     * Returns an error Status, and ignores the execution, if the shape isn't cached.
+     */
+    Status recordExecution(const PlanCacheKey& key,
+                           long long keysExamined,
+                           long long docsExamined,
+                           long long micros);
+
     /**
      * Remove the entry corresponding to 'ck' from the cache.  Returns Status::OK() if the plan
      * was present and removed and an error status otherwise.
@@ -402,6 +506,11 @@ public:
      */
     size_t size() const;
 
+    /**
+     * Returns the lookup statistics summed over every query shape.
+     */
+    PlanCacheStats getStats() const;
+
     /**
      * Updates internal state kept about the collection's indexes.  Must be called when the set
      * of indexes on the associated collection have changed.
@@ -415,10 +524,13 @@ private:
     void encodeKeyForSort(const BSONObj& sortObj, StringBuilder* keyBuilder) const;
     void encodeKeyForProj(const BSONObj& projObj, StringBuilder* keyBuilder) const;
 
-    LRUKeyValue<PlanCacheKey, PlanCacheEntry> _cache;
+    struct ShapeCounters;
+    struct CacheSlot;
+    struct Shard;
+
+    Shard& getShard(const PlanCacheKey& key) const;
 
-    // Protects _cache.
-    mutable stdx::mutex _cacheMutex;
+    std::vector<std::unique_ptr<Shard>> _shards;
 
     // Full namespace of collection.
     std::string _ns;
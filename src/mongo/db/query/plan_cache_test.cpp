@@ -46,6 +46,7 @@
 #include "mongo/db/query/query_planner_test_lib.h"
 #include "mongo/db/query/query_solution.h"
 #include "mongo/db/query/query_test_service_context.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/scopeguard.h"
@@ -423,6 +424,292 @@ TEST(PlanCacheTest, AddValidSolution) {
     ASSERT_EQUALS(planCache.size(), 1U);
 }
 
+TEST(PlanCacheTest, StatsCountHitsAndMissesPerShape) {
+    PlanCache planCache;
+    unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+
+    // A lookup before the shape is cached is a miss, which is remembered once it is cached.
+    CachedSolution* rawCachedSolution;
+    ASSERT_NOT_OK(planCache.get(*cq, &rawCachedSolution));
+    ASSERT_OK(planCache.add(*cq, solns, createDecision(1U)));
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_OK(planCache.get(*cq, &rawCachedSolution));
+        delete rawCachedSolution;
+    }
+
+    PlanCacheEntry* rawEntry;
+    ASSERT_OK(planCache.getEntry(*cq, &rawEntry));
+    unique_ptr<PlanCacheEntry> entry(rawEntry);
+    ASSERT_EQUALS(entry->shapeStats.hits, 3);
+    ASSERT_EQUALS(entry->shapeStats.misses, 1);
+    ASSERT_EQUALS(entry->shapeStats.evictions, 0);
+
+    PlanCacheStats stats = planCache.getStats();
+    ASSERT_EQUALS(stats.hits, 3);
+    ASSERT_EQUALS(stats.misses, 1);
+    ASSERT_EQUALS(stats.evictions, 0);
+}
+
+TEST(PlanCacheTest, ConcurrentHitsOfOneShapeAreAllCounted) {
+    PlanCache planCache;
+    unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+    unique_ptr<CanonicalQuery> otherCq(canonicalize("{b: 1}"));
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+    ASSERT_OK(planCache.add(*cq, solns, createDecision(1U)));
+    const PlanCacheKey key = planCache.computeKey(*cq);
+
+    // Lookups of the hot shape proceed while another shape is added and removed, which replaces
+    // the snapshot that the lookups read.
+    const int numThreads = 4;
+    const int lookupsPerThread = 1000;
+    std::vector<stdx::thread> threads;
+    for (int i = 0; i < numThreads; ++i) {
+        threads.emplace_back([&] {
+            for (int j = 0; j < lookupsPerThread; ++j) {
+                CachedSolution* rawCachedSolution;
+                invariantOK(planCache.get(key, &rawCachedSolution));
+                delete rawCachedSolution;
+                invariantOK(planCache.recordExecution(key, 1, 1, 1));
+            }
+        });
+    }
+    for (int i = 0; i < 100; ++i) {
+        ASSERT_OK(planCache.add(*otherCq, solns, createDecision(1U)));
+        ASSERT_OK(planCache.remove(*otherCq));
+    }
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+
+    PlanCacheEntry* rawEntry;
+    ASSERT_OK(planCache.getEntry(*cq, &rawEntry));
+    unique_ptr<PlanCacheEntry> entry(rawEntry);
+    ASSERT_EQUALS(entry->shapeStats.hits, numThreads * lookupsPerThread);
+    ASSERT_EQUALS(entry->runtimeStats.executions, numThreads * lookupsPerThread);
+    ASSERT_EQUALS(planCache.getStats().hits, numThreads * lookupsPerThread);
+}
+
+TEST(PlanCacheTest, StatsCountEvictions) {
+    const int oldCacheSize = internalQueryCacheSize.load();
+    ON_BLOCK_EXIT([&] { internalQueryCacheSize.store(oldCacheSize); });
+
+    // The size of the cache bounds all of its shards together.
+    const int cacheSize = 20;
+    internalQueryCacheSize.store(cacheSize);
+    PlanCache planCache;
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+
+    const int numShapes = 64;
+    for (int i = 0; i < numShapes; ++i) {
+        const std::string field = str::stream() << "field" << i;
+        unique_ptr<CanonicalQuery> cq(canonicalize(BSON(field << 1)));
+        ASSERT_OK(planCache.add(*cq, solns, createDecision(1U)));
+    }
+
+    const PlanCacheStats stats = planCache.getStats();
+    ASSERT_LTE(planCache.size(), static_cast<size_t>(cacheSize));
+    ASSERT_GTE(stats.evictions, numShapes - cacheSize);
+    ASSERT_EQUALS(static_cast<size_t>(stats.evictions) + planCache.size(),
+                  static_cast<size_t>(numShapes));
+
+    std::vector<PlanCacheEntry*> entries = planCache.getAllEntries();
+    ASSERT_EQUALS(entries.size(), planCache.size());
+    for (auto entry : entries) {
+        delete entry;
+    }
+
+    // Clearing the cache keeps the running totals.
+    planCache.clear();
+    ASSERT_EQUALS(planCache.size(), 0U);
+    ASSERT_EQUALS(planCache.getStats().evictions, stats.evictions);
+}
+
+TEST(PlanCacheTest, CacheSizeSmallerThanShardCountIsABound) {
+    const int oldCacheSize = internalQueryCacheSize.load();
+    ON_BLOCK_EXIT([&] { internalQueryCacheSize.store(oldCacheSize); });
+
+    internalQueryCacheSize.store(1);
+    PlanCache planCache;
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+
+    for (int i = 0; i < 8; ++i) {
+        const std::string field = str::stream() << "field" << i;
+        unique_ptr<CanonicalQuery> cq(canonicalize(BSON(field << 1)));
+        ASSERT_OK(planCache.add(*cq, solns, createDecision(1U)));
+        ASSERT_EQUALS(planCache.size(), 1U);
+
+        // The most recently added shape is the one cached.
+        CachedSolution* rawCachedSolution;
+        ASSERT_OK(planCache.get(*cq, &rawCachedSolution));
+        delete rawCachedSolution;
+    }
+    ASSERT_EQUALS(planCache.getStats().evictions, 7);
+}
+
+/**
+ * Adds a plan for 'cq' of type 'solnType' and direction 'wholeIXSolnDir', which took 'works' work
+ * cycles to be chosen.
+ */
+void addPlanWithWorks(PlanCache* planCache,
+                      const CanonicalQuery& cq,
+                      SolutionCacheData::SolutionType solnType,
+                      int wholeIXSolnDir,
+                      size_t works) {
+    QuerySolution qs;
+    qs.cacheData.reset(new SolutionCacheData());
+    qs.cacheData->solnType = solnType;
+    qs.cacheData->wholeIXSolnDir = wholeIXSolnDir;
+    qs.cacheData->tree.reset(new PlanCacheIndexTree());
+    std::vector<QuerySolution*> solns;
+    solns.push_back(&qs);
+    PlanRankingDecision* decision = createDecision(1U);
+    decision->stats[0]->common.works = works;
+    ASSERT_OK(planCache->add(cq, solns, decision));
+}
+
+TEST(PlanCacheTest, RuntimeStatsBucketsByPowersOfTwo) {
+    ASSERT_EQUALS(PlanCacheRuntimeStats::bucketFor(0), 0U);
+    ASSERT_EQUALS(PlanCacheRuntimeStats::bucketFor(1), 1U);
+    ASSERT_EQUALS(PlanCacheRuntimeStats::bucketFor(2), 1U);
+    ASSERT_EQUALS(PlanCacheRuntimeStats::bucketFor(3), 2U);
+    ASSERT_EQUALS(PlanCacheRuntimeStats::bucketFor(1000), 9U);
+    ASSERT_EQUALS(PlanCacheRuntimeStats::bucketFor(1LL << 40),
+                  PlanCacheRuntimeStats::kNumBuckets - 1);
+}
+
+TEST(PlanCacheTest, RecordExecutionFillsRuntimeStatsOfCachedShape) {
+    PlanCache planCache;
+    unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+
+    // Executions of a shape which isn't cached are ignored.
+    ASSERT_NOT_OK(planCache.recordExecution(planCache.computeKey(*cq), 10, 10, 100));
+
+    addPlanWithWorks(&planCache, *cq, SolutionCacheData::COLLSCAN_SOLN, 1, 10);
+    ASSERT_OK(planCache.recordExecution(planCache.computeKey(*cq), 0, 1, 100));
+    ASSERT_OK(planCache.recordExecution(planCache.computeKey(*cq), 0, 1000, 5000));
+
+    // Replanning the shape keeps its runtime statistics.
+    addPlanWithWorks(&planCache, *cq, SolutionCacheData::WHOLE_IXSCAN_SOLN, 1, 1000);
+
+    PlanCacheEntry* rawEntry;
+    ASSERT_OK(planCache.getEntry(*cq, &rawEntry));
+    unique_ptr<PlanCacheEntry> entry(rawEntry);
+    const PlanCacheRuntimeStats& stats = entry->runtimeStats;
+    ASSERT_EQUALS(stats.executions, 2);
+    ASSERT_EQUALS(stats.keysExamined[0], 2);
+    ASSERT_EQUALS(stats.docsExamined[1], 1);
+    ASSERT_EQUALS(stats.docsExamined[9], 1);
+    ASSERT_EQUALS(stats.latencyMicros[6], 1);
+    ASSERT_EQUALS(stats.latencyMicros[12], 1);
+}
+
+TEST(PlanCacheTest, ReplacedPlanIsKeptAsAlternateUnlessSamePlan) {
+    PlanCache planCache;
+    unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+
+    std::vector<unique_ptr<CachedSolution>> alternates;
+    ASSERT_NOT_OK(planCache.getAlternates(*cq, &alternates));
+
+    addPlanWithWorks(&planCache, *cq, SolutionCacheData::COLLSCAN_SOLN, 1, 10);
+
+    // The same plan chosen again replaces the cached plan without becoming its own alternate.
+    addPlanWithWorks(&planCache, *cq, SolutionCacheData::COLLSCAN_SOLN, 1, 100);
+    CachedSolution* rawCachedSolution;
+    ASSERT_OK(planCache.get(*cq, &rawCachedSolution));
+    unique_ptr<CachedSolution> cachedSolution(rawCachedSolution);
+    ASSERT_EQUALS(cachedSolution->decisionWorks, 100U);
+    ASSERT_OK(planCache.getAlternates(*cq, &alternates));
+    ASSERT_TRUE(alternates.empty());
+
+    // A different plan keeps the replaced plan as an alternate.
+    addPlanWithWorks(&planCache, *cq, SolutionCacheData::WHOLE_IXSCAN_SOLN, 1, 1000);
+    ASSERT_OK(planCache.get(*cq, &rawCachedSolution));
+    cachedSolution.reset(rawCachedSolution);
+    ASSERT_EQUALS(cachedSolution->decisionWorks, 1000U);
+    ASSERT_OK(planCache.getAlternates(*cq, &alternates));
+    ASSERT_EQUALS(alternates.size(), 1U);
+    ASSERT_EQUALS(alternates[0]->decisionWorks, 100U);
+
+    // Replanning back to the alternate's plan drops the alternate.
+    addPlanWithWorks(&planCache, *cq, SolutionCacheData::COLLSCAN_SOLN, 1, 10);
+    PlanCacheEntry* rawEntry;
+    ASSERT_OK(planCache.getEntry(*cq, &rawEntry));
+    unique_ptr<PlanCacheEntry> entry(rawEntry);
+    ASSERT_EQUALS(entry->alternates.size(), 1U);
+    ASSERT_EQUALS(entry->alternates[0]->decision->stats[0]->common.works, 1000U);
+}
+
+TEST(PlanCacheTest, AlternatePlansAreLimitedByKnob) {
+    const int oldMaxAlternates = internalQueryCacheMaxAlternatePlans.load();
+    ON_BLOCK_EXIT([&] { internalQueryCacheMaxAlternatePlans.store(oldMaxAlternates); });
+
+    PlanCache planCache;
+    unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+
+    internalQueryCacheMaxAlternatePlans.store(1);
+    addPlanWithWorks(&planCache, *cq, SolutionCacheData::COLLSCAN_SOLN, 1, 10);
+    addPlanWithWorks(&planCache, *cq, SolutionCacheData::WHOLE_IXSCAN_SOLN, 1, 1000);
+    addPlanWithWorks(&planCache, *cq, SolutionCacheData::WHOLE_IXSCAN_SOLN, -1, 100000);
+
+    std::vector<unique_ptr<CachedSolution>> alternates;
+    ASSERT_OK(planCache.getAlternates(*cq, &alternates));
+    ASSERT_EQUALS(alternates.size(), 1U);
+    ASSERT_EQUALS(alternates[0]->decisionWorks, 1000U);
+
+    internalQueryCacheMaxAlternatePlans.store(0);
+    addPlanWithWorks(&planCache, *cq, SolutionCacheData::COLLSCAN_SOLN, 1, 10);
+    alternates.clear();
+    ASSERT_OK(planCache.getAlternates(*cq, &alternates));
+    ASSERT_TRUE(alternates.empty());
+}
+
+TEST(PlanCacheTest, PromoteAlternateSwapsItWithCachedPlan) {
+    PlanCache planCache;
+    unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+
+    addPlanWithWorks(&planCache, *cq, SolutionCacheData::COLLSCAN_SOLN, 1, 10);
+    addPlanWithWorks(&planCache, *cq, SolutionCacheData::WHOLE_IXSCAN_SOLN, 1, 1000);
+    addPlanWithWorks(&planCache, *cq, SolutionCacheData::WHOLE_IXSCAN_SOLN, -1, 100000);
+
+    std::vector<unique_ptr<CachedSolution>> alternates;
+    ASSERT_OK(planCache.getAlternates(*cq, &alternates));
+    ASSERT_EQUALS(alternates.size(), 2U);
+    ASSERT_EQUALS(alternates[0]->decisionWorks, 1000U);
+    ASSERT_EQUALS(alternates[1]->decisionWorks, 10U);
+
+    ASSERT_OK(planCache.promoteAlternate(*cq, *alternates[1]));
+    CachedSolution* rawPromoted;
+    ASSERT_OK(planCache.get(*cq, &rawPromoted));
+    unique_ptr<CachedSolution> promoted(rawPromoted);
+    ASSERT_EQUALS(promoted->decisionWorks, 10U);
+    ASSERT_EQUALS(promoted->plannerData[0]->solnType, SolutionCacheData::COLLSCAN_SOLN);
+    std::vector<unique_ptr<CachedSolution>> promotedAlternates;
+    ASSERT_OK(planCache.getAlternates(*cq, &promotedAlternates));
+    ASSERT_EQUALS(promotedAlternates.size(), 2U);
+    ASSERT_EQUALS(promotedAlternates[0]->decisionWorks, 100000U);
+    ASSERT_EQUALS(promotedAlternates[1]->decisionWorks, 1000U);
+
+    // The same alternate can't be promoted twice.
+    ASSERT_NOT_OK(planCache.promoteAlternate(*cq, *alternates[1]));
+}
+
 /**
  * Each test in the CachePlanSelectionTest suite goes through
  * the following flow:
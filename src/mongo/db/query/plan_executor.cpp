@@ -374,6 +374,16 @@ PlanExecutor::ExecState PlanExecutor::getNext(BSONObj* objOut, RecordId* dlOut)
     return state;
 }
 
+PlanExecutor::ExecState PlanExecutor::getNextWithIndexKeyPattern(BSONObj* objOut,
+                                                                 BSONObj* indexKeyPatternOut) {
+    invariant(objOut && indexKeyPatternOut);
+    Snapshotted<BSONObj> snapshotted;
+    *indexKeyPatternOut = BSONObj();
+    ExecState state = getNextImpl(&snapshotted, nullptr, indexKeyPatternOut);
+    *objOut = snapshotted.value();
+    return state;
+}
+
 PlanExecutor::ExecState PlanExecutor::getNextSnapshotted(Snapshotted<BSONObj>* objOut,
                                                          RecordId* dlOut) {
     // Detaching from the OperationContext means that the returned snapshot ids could be invalid.
@@ -381,7 +391,9 @@ PlanExecutor::ExecState PlanExecutor::getNextSnapshotted(Snapshotted<BSONObj>* o
     return getNextImpl(objOut, dlOut);
 }
 
-PlanExecutor::ExecState PlanExecutor::getNextImpl(Snapshotted<BSONObj>* objOut, RecordId* dlOut) {
+PlanExecutor::ExecState PlanExecutor::getNextImpl(Snapshotted<BSONObj>* objOut,
+                                                  RecordId* dlOut,
+                                                  BSONObj* indexKeyPatternOut) {
     if (MONGO_FAIL_POINT(planExecutorAlwaysFails)) {
         Status status(ErrorCodes::OperationFailed,
                       str::stream() << "PlanExecutor hit planExecutorAlwaysFails fail point");
@@ -463,9 +475,15 @@ PlanExecutor::ExecState PlanExecutor::getNextImpl(Snapshotted<BSONObj>* objOut,
                         // TODO: currently snapshot ids are only associated with documents, and
                         // not with index keys.
                         *objOut = Snapshotted<BSONObj>(SnapshotId(), member->keyData[0].keyData);
+                        if (indexKeyPatternOut) {
+                            *indexKeyPatternOut = member->keyData[0].indexKeyPattern;
+                        }
                     }
                 } else if (member->hasObj()) {
                     *objOut = member->obj;
+                    if (indexKeyPatternOut) {
+                        *indexKeyPatternOut = BSONObj();
+                    }
                 } else {
                     _workingSet->free(id);
                     hasRequestedData = false;
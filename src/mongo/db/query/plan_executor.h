@@ -315,6 +315,14 @@ public:
 
     ExecState getNext(BSONObj* objOut, RecordId* dlOut);
 
+    /**
+     * Like getNext(), but for plans which may return index keys rather than documents, such as
+     * those planned with the RETURN_COVERED_INDEX_KEYS option. When the result is an index key,
+     * 'indexKeyPatternOut' is set to the key pattern of its index and 'objOut' to the key, whose
+     * field names are empty. Otherwise 'indexKeyPatternOut' is set to the empty object.
+     */
+    ExecState getNextWithIndexKeyPattern(BSONObj* objOut, BSONObj* indexKeyPatternOut);
+
     /**
      * Returns 'true' if the plan is done producing results (or writing), 'false' otherwise.
      *
@@ -412,7 +420,9 @@ public:
     }
 
 private:
-    ExecState getNextImpl(Snapshotted<BSONObj>* objOut, RecordId* dlOut);
+    ExecState getNextImpl(Snapshotted<BSONObj>* objOut,
+                          RecordId* dlOut,
+                          BSONObj* indexKeyPatternOut = nullptr);
 
     /**
      * New PlanExecutor instances are created with the static make() methods above.
@@ -153,12 +153,15 @@ QuerySolutionNode* QueryPlannerAccess::makeCollectionScan(const CanonicalQuery&
     csn->tailable = tailable;
     csn->maxScan = query.getQueryRequest().getMaxScan();
 
+    bool naturalOrderRequested = false;
+
     // If the hint is {$natural: +-1} this changes the direction of the collection scan.
     if (!query.getQueryRequest().getHint().isEmpty()) {
         BSONElement natural =
             dps::extractElementAtPath(query.getQueryRequest().getHint(), "$natural");
         if (!natural.eoo()) {
             csn->direction = natural.numberInt() >= 0 ? 1 : -1;
+            naturalOrderRequested = true;
         }
     }
 
@@ -169,9 +172,14 @@ QuerySolutionNode* QueryPlannerAccess::makeCollectionScan(const CanonicalQuery&
         BSONElement natural = dps::extractElementAtPath(sortObj, "$natural");
         if (!natural.eoo()) {
             csn->direction = natural.numberInt() >= 0 ? 1 : -1;
+            naturalOrderRequested = true;
         }
     }
 
+    // A parallel scan returns documents out of natural order, and examines every document.
+    csn->parallel = (params.options & QueryPlannerParams::PARALLEL_COLLSCAN) && !tailable &&
+        !naturalOrderRequested && 0 == csn->maxScan && !query.getQueryRequest().isSnapshot();
+
     return csn;
 }
 
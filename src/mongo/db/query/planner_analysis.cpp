@@ -42,6 +42,7 @@
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/query_planner_common.h"
 #include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
 
@@ -801,14 +802,27 @@ QuerySolution* QueryPlannerAnalysis::analyzeDataAccess(const CanonicalQuery& que
             solnRoot = keyGenNode;
         }
 
-        // We now know we have whatever data is required for the projection.
-        ProjectionNode* projNode = new ProjectionNode(*query.getProj());
-        projNode->children.push_back(solnRoot);
-        projNode->fullExpression = query.root();
-        projNode->projection = qr.getProj();
-        projNode->projType = projType;
-        projNode->coveredKeyObj = coveredKeyObj;
-        solnRoot = projNode;
+        // The caller may take covered index keys as they are and pick out the projected fields
+        // itself. Only plain field names are handled, so that each projected field is a whole
+        // element of the key.
+        bool returnIndexKeys = (params.options & QueryPlannerParams::RETURN_COVERED_INDEX_KEYS) &&
+            projType == ProjectionNode::COVERED_ONE_INDEX;
+        for (auto&& elt : coveredKeyObj) {
+            if (str::contains(elt.fieldName(), '.')) {
+                returnIndexKeys = false;
+            }
+        }
+
+        if (!returnIndexKeys) {
+            // We now know we have whatever data is required for the projection.
+            ProjectionNode* projNode = new ProjectionNode(*query.getProj());
+            projNode->children.push_back(solnRoot);
+            projNode->fullExpression = query.root();
+            projNode->projection = qr.getProj();
+            projNode->projType = projType;
+            projNode->coveredKeyObj = coveredKeyObj;
+            solnRoot = projNode;
+        }
     } else {
         // If there's no projection, we must fetch, as the user wants the entire doc.
         if (!solnRoot->fetched()) {
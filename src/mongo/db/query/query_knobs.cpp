@@ -29,6 +29,7 @@
 #include "mongo/db/query/query_knobs.h"
 #include "mongo/db/server_options.h"
 #include "mongo/db/server_parameters.h"
+#include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
 
@@ -44,6 +45,8 @@ MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheFeedbacksStored, int, 20);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheEvictionRatio, double, 10.0);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryCacheMaxAlternatePlans, int, 2);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerMaxIndexedSolutions, int, 64);
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryEnumerationMaxOrSolutions, int, 10);
@@ -60,8 +63,44 @@ MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlanOrChildrenIndependently, bool, tr
 
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryMaxScansToExplode, int, 200);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerPruneByStatistics, bool, true);
+
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryPlannerStatisticsPruningRatio, double, 10.0);
+
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecMaxBlockingSortBytes, int, 32 * 1024 * 1024);
 
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecCollectionScanBatchSize, int, 64);
+
+server_parameter_storage_type<int, ServerParameterType::kStartupAndRuntime>::value_type
+    internalQueryExecParallelCollectionScanThreads(1);
+
+class InternalQueryExecParallelCollectionScanThreads
+    : public ExportedServerParameter<int, ServerParameterType::kStartupAndRuntime> {
+public:
+    // Each worker holds a thread, a Client and a storage engine session while it scans.
+    static const int kMaxThreads = 64;
+
+    InternalQueryExecParallelCollectionScanThreads()
+        : ExportedServerParameter<int, ServerParameterType::kStartupAndRuntime>(
+              ServerParameterSet::getGlobal(),
+              "internalQueryExecParallelCollectionScanThreads",
+              &internalQueryExecParallelCollectionScanThreads) {}
+
+    Status validate(const int& potentialNewValue) {
+        if (potentialNewValue > kMaxThreads) {
+            return Status(ErrorCodes::BadValue,
+                          str::stream()
+                              << "internalQueryExecParallelCollectionScanThreads cannot be greater "
+                                 "than "
+                              << kMaxThreads
+                              << ", but attempted to set to: "
+                              << potentialNewValue);
+        }
+
+        return Status::OK();
+    }
+} internalQueryExecParallelCollectionScanThreadsParameter;
+
 // Yield every 128 cycles or 10ms.
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecYieldIterations, int, 128);
 MONGO_EXPORT_SERVER_PARAMETER(internalQueryExecYieldPeriodMS, int, 10);
@@ -72,6 +72,10 @@ extern AtomicInt32 internalQueryCacheFeedbacksStored;
 // and replanning?
 extern AtomicDouble internalQueryCacheEvictionRatio;
 
+// How many plans replaced by replanning do we keep for each query shape, to try before replanning
+// from scratch when the shape's cached plan takes too long?
+extern AtomicInt32 internalQueryCacheMaxAlternatePlans;
+
 //
 // Planning and enumeration.
 //
@@ -92,12 +96,29 @@ extern AtomicBool internalQueryPlanOrChildrenIndependently;
 // during explodeForSort?
 extern AtomicInt32 internalQueryMaxScansToExplode;
 
+// Do we drop candidate plans whose cost, estimated from the statistics built by the 'analyze'
+// command, is much higher than that of the cheapest candidate before multi-planning?
+extern AtomicBool internalQueryPlannerPruneByStatistics;
+
+// How many times the estimated cost of the cheapest candidate plan may another candidate's be
+// without being pruned?
+extern AtomicDouble internalQueryPlannerStatisticsPruningRatio;
+
 //
 // Query execution.
 //
 
 extern AtomicInt32 internalQueryExecMaxBlockingSortBytes;
 
+// How many records a collection scan reads from its RecordCursor at a time. Values of 1 or less
+// read one record at a time.
+extern AtomicInt32 internalQueryExecCollectionScanBatchSize;
+
+// How many worker threads a collection scan, whose results need not be in natural order, may be
+// split across. Values of 1 or less disable parallel collection scans, and values above 64 are
+// rejected.
+extern AtomicInt32 internalQueryExecParallelCollectionScanThreads;
+
 // Yield after this many "should yield?" checks.
 extern AtomicInt32 internalQueryExecYieldIterations;
 
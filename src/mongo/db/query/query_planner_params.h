@@ -95,6 +95,15 @@ struct QueryPlannerParams {
         // Set this if you don't want any plans with a non-covered projection stage. All projections
         // must be provided/covered by an index.
         NO_UNCOVERED_PROJECTIONS = 1 << 10,
+
+        // Set this to allow a collection scan, whose results need not be in natural order, to be
+        // split across worker threads.
+        PARALLEL_COLLSCAN = 1 << 11,
+
+        // Set this to have plans whose projection is covered by the keys of a single btree index
+        // without dotted fields return those index keys as they are, rather than projecting each
+        // of them into an owned object. See PlanExecutor::getNextWithIndexKeyPattern().
+        RETURN_COVERED_INDEX_KEYS = 1 << 12,
     };
 
     // See Options enum above.
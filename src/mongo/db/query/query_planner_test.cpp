@@ -1362,6 +1362,42 @@ TEST_F(QueryPlannerTest, IdCovering) {
         "{filter: null, pattern: {_id: 1}}}}}");
 }
 
+TEST_F(QueryPlannerTest, ReturnCoveredIndexKeysOmitsCoveredProjection) {
+    params.options = QueryPlannerParams::NO_UNCOVERED_PROJECTIONS |
+        QueryPlannerParams::RETURN_COVERED_INDEX_KEYS;
+    addIndex(BSON("x" << 1 << "y" << 1));
+    runQuerySortProj(fromjson("{x: {$gt: 1}}"), BSONObj(), fromjson("{_id: 0, x: 1}"));
+
+    assertNumSolutions(1U);
+    assertSolutionExists("{ixscan: {filter: null, pattern: {x: 1, y: 1}}}");
+}
+
+TEST_F(QueryPlannerTest, ReturnCoveredIndexKeysKeepsProjectionOfDottedIndexFields) {
+    params.options = QueryPlannerParams::NO_UNCOVERED_PROJECTIONS |
+        QueryPlannerParams::RETURN_COVERED_INDEX_KEYS;
+    addIndex(BSON("x" << 1 << "a.b" << 1));
+    runQuerySortProj(fromjson("{x: {$gt: 1}}"), BSONObj(), fromjson("{_id: 0, x: 1}"));
+
+    assertNumSolutions(1U);
+    assertSolutionExists(
+        "{proj: {spec: {_id: 0, x: 1}, node: {ixscan: "
+        "{filter: null, pattern: {x: 1, 'a.b': 1}}}}}");
+}
+
+TEST_F(QueryPlannerTest, ReturnCoveredIndexKeysKeepsUncoveredProjection) {
+    params.options |= QueryPlannerParams::RETURN_COVERED_INDEX_KEYS;
+    addIndex(BSON("x" << 1));
+    runQuerySortProj(fromjson("{x: {$gt: 1}}"), BSONObj(), fromjson("{_id: 0, x: 1, y: 1}"));
+
+    assertNumSolutions(2U);
+    assertSolutionExists(
+        "{proj: {spec: {_id: 0, x: 1, y: 1}, node: "
+        "{cscan: {dir: 1, filter: {x: {$gt: 1}}}}}}");
+    assertSolutionExists(
+        "{proj: {spec: {_id: 0, x: 1, y: 1}, node: {fetch: {filter: null, node: "
+        "{ixscan: {filter: null, pattern: {x: 1}}}}}}}");
+}
+
 TEST_F(QueryPlannerTest, ProjNonCovering) {
     addIndex(BSON("x" << 1));
     runQuerySortProj(fromjson("{ x : {$gt: 1}}"), BSONObj(), fromjson("{x: 1}"));
@@ -2280,6 +2316,47 @@ TEST_F(QueryPlannerTest, CannotMergeSort) {
         "{pattern: {b: 1}, dir: 1}}]}}}}}}}}");
 }
 
+//
+// Parallel collection scan tests
+//
+
+TEST_F(QueryPlannerTest, ParallelCollectionScanAllowed) {
+    params.options |= QueryPlannerParams::PARALLEL_COLLSCAN;
+    runQuerySortProj(BSON("a" << 1), BSON("b" << 1), BSONObj());
+
+    assertNumSolutions(1U);
+    assertSolutionExists(
+        "{sort: {pattern: {b: 1}, limit: 0, node: {sortKeyGen: {node: "
+        "{cscan: {filter: {a: 1}, dir: 1, parallel: true}}}}}}");
+}
+
+TEST_F(QueryPlannerTest, ParallelCollectionScanNotUsedWithoutOption) {
+    runQuery(BSON("a" << 1));
+
+    assertNumSolutions(1U);
+    assertSolutionExists("{cscan: {filter: {a: 1}, dir: 1, parallel: false}}");
+}
+
+TEST_F(QueryPlannerTest, ParallelCollectionScanNotUsedForNaturalOrder) {
+    params.options |= QueryPlannerParams::PARALLEL_COLLSCAN;
+
+    runQueryHint(BSON("a" << 1), BSON("$natural" << 1));
+    assertNumSolutions(1U);
+    assertSolutionExists("{cscan: {filter: {a: 1}, dir: 1, parallel: false}}");
+
+    runQuerySortHint(BSON("a" << 1), BSON("$natural" << -1), BSONObj());
+    assertNumSolutions(1U);
+    assertSolutionExists("{cscan: {filter: {a: 1}, dir: -1, parallel: false}}");
+}
+
+TEST_F(QueryPlannerTest, ParallelCollectionScanNotUsedWithSnapshot) {
+    params.options |= QueryPlannerParams::PARALLEL_COLLSCAN;
+    runQuerySnapshot(BSON("a" << 1));
+
+    assertNumSolutions(1U);
+    assertSolutionExists("{cscan: {filter: {a: 1}, dir: 1, parallel: false}}");
+}
+
 //
 // Hint tests
 //
@@ -247,6 +247,12 @@ bool QueryPlannerTestLib::solutionMatches(const BSONObj& testSoln,
             return false;
         }
 
+        if (BSONElement parallel = csObj["parallel"]) {
+            if (!parallel.isBoolean() || parallel.boolean() != csn->parallel) {
+                return false;
+            }
+        }
+
         BSONElement filter = csObj["filter"];
         if (filter.eoo()) {
             return true;
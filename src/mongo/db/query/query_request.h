@@ -378,6 +378,14 @@ public:
         _allowPartialResults = allowPartialResults;
     }
 
+    bool allowDiskUse() const {
+        return _allowDiskUse;
+    }
+
+    void setAllowDiskUse(bool allowDiskUse) {
+        _allowDiskUse = allowDiskUse;
+    }
+
     boost::optional<long long> getReplicationTerm() const {
         return _replicationTerm;
     }
@@ -507,6 +515,9 @@ private:
     bool _exhaust = false;
     bool _allowPartialResults = false;
 
+    // Whether a blocking sort may spill to disk rather than fail once it exceeds its memory limit.
+    bool _allowDiskUse = false;
+
     boost::optional<long long> _replicationTerm;
 };
 
@@ -224,13 +224,18 @@ CollectionScanNode::CollectionScanNode()
     : _sort(SimpleBSONObjComparator::kInstance.makeBSONObjSet()),
       tailable(false),
       direction(1),
-      maxScan(0) {}
+      maxScan(0),
+      parallel(false) {}
 
 void CollectionScanNode::appendToString(mongoutils::str::stream* ss, int indent) const {
     addIndent(ss, indent);
     *ss << "COLLSCAN\n";
     addIndent(ss, indent + 1);
     *ss << "ns = " << name << '\n';
+    if (parallel) {
+        addIndent(ss, indent + 1);
+        *ss << "parallel = true\n";
+    }
     if (NULL != filter) {
         addIndent(ss, indent + 1);
         *ss << "filter = " << filter->toString();
@@ -247,6 +252,7 @@ QuerySolutionNode* CollectionScanNode::clone() const {
     copy->tailable = this->tailable;
     copy->direction = this->direction;
     copy->maxScan = this->maxScan;
+    copy->parallel = this->parallel;
 
     return copy;
 }
@@ -293,6 +293,9 @@ struct CollectionScanNode : public QuerySolutionNode {
 
     // maxScan option to .find() limits how many docs we look at.
     int maxScan;
+
+    // May the scan be split across worker threads, returning documents out of natural order?
+    bool parallel;
 };
 
 struct AndHashNode : public QuerySolutionNode {
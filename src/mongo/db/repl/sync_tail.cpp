@@ -144,6 +144,59 @@ ServerStatusMetricField<Counter64> displayAttemptsToBecomeSecondary(
 // Number and time of each ApplyOps worker pool round
 TimerStats applyBatchStats;
 ServerStatusMetricField<TimerStats> displayOpBatchesApplied("repl.apply.batches", &applyBatchStats);
+
+// Time the applier spent waiting for the batcher to hand it the next batch
+TimerStats waitForBatchStats;
+ServerStatusMetricField<TimerStats> displayWaitForBatch("repl.apply.stages.waitForBatch",
+                                                        &waitForBatchStats);
+
+// Time spent paging in the documents and index entries of the next batch while the current batch
+// is applied
+TimerStats prefetchNextBatchStats;
+ServerStatusMetricField<TimerStats> displayPrefetchNextBatch("repl.apply.stages.prefetch",
+                                                             &prefetchNextBatchStats);
+
+// Time spent assigning the ops of each batch to writer threads
+TimerStats partitionBatchStats;
+ServerStatusMetricField<TimerStats> displayPartitionBatch("repl.apply.stages.partition",
+                                                          &partitionBatchStats);
+
+// Time spent writing each batch to the local oplog
+TimerStats writeOplogBatchStats;
+ServerStatusMetricField<TimerStats> displayWriteOplogBatch("repl.apply.stages.oplogWrite",
+                                                           &writeOplogBatchStats);
+
+// When true, the batcher pages in the documents and index entries each batch will touch while the
+// previous batch is still being applied. Only has an effect on MMAPv1, which is the only storage
+// engine that prefetches at all.
+MONGO_EXPORT_SERVER_PARAMETER(replPrefetchNextBatch, bool, false);
+
+/**
+ * Shared by the tasks which make up one stage of applying a batch on a thread pool. The last task
+ * to finish records the time since the stage started in 'stats'.
+ */
+class StageProgress {
+public:
+    StageProgress(TimerStats* stats, long long numTasks) : _stats(stats) {
+        _remaining.store(numTasks);
+    }
+
+    void taskDone() {
+        if (_remaining.subtractAndFetch(1) == 0) {
+            _stats->record(_timer);
+        }
+    }
+
+    bool done() const {
+        return _remaining.load() == 0;
+    }
+
+private:
+    TimerStats* const _stats;
+    Timer _timer;
+    AtomicInt64 _remaining;
+};
+
 void initializePrefetchThread() {
     if (!Client::getCurrent()) {
         Client::initThreadIfNotAlready();
@@ -407,8 +460,9 @@ Status SyncTail::syncApply(OperationContext* opCtx,
 
 namespace {
 
-// The pool threads call this to prefetch each op
-void prefetchOp(const BSONObj& op) {
+// The pool threads call this to prefetch each op. Ops of the next batch are prefetched while the
+// current batch is applied, so they must not wait for the ParallelBatchWriterMode lock.
+void prefetchOp(const BSONObj& op, bool conflictWithBatchApplication) {
     initializePrefetchThread();
 
     const char* ns = op.getStringField("ns");
@@ -418,6 +472,8 @@ void prefetchOp(const BSONObj& op) {
             // for multiple prefetches if they are for the same database.
             const ServiceContext::UniqueOperationContext opCtxPtr = cc().makeOperationContext();
             OperationContext& opCtx = *opCtxPtr;
+            opCtx.lockState()->setShouldConflictWithSecondaryBatchApplication(
+                conflictWithBatchApplication);
             AutoGetCollectionForReadCommand ctx(&opCtx, NamespaceString(ns));
             Database* db = ctx.getDb();
             if (db) {
@@ -436,7 +492,7 @@ void prefetchOp(const BSONObj& op) {
 void prefetchOps(const MultiApplier::Operations& ops, OldThreadPool* prefetcherPool) {
     invariant(prefetcherPool);
     for (auto&& op : ops) {
-        prefetcherPool->schedule(&prefetchOp, op.raw);
+        prefetcherPool->schedule(&prefetchOp, op.raw, true);
     }
     prefetcherPool->join();
 }
@@ -471,12 +527,13 @@ void initializeWriterThread() {
 void scheduleWritesToOplog(OperationContext* opCtx,
                            OldThreadPool* threadPool,
                            const MultiApplier::Operations& ops) {
+    std::shared_ptr<StageProgress> progress;
 
-    auto makeOplogWriterForRange = [&ops](size_t begin, size_t end) {
+    auto makeOplogWriterForRange = [&ops, &progress](size_t begin, size_t end) {
         // The returned function will be run in a separate thread after this returns. Therefore all
         // captures other than 'ops' must be by value since they will not be available. The caller
         // guarantees that 'ops' will stay in scope until the spawned threads complete.
-        return [&ops, begin, end] {
+        return [&ops, progress, begin, end] {
             initializeWriterThread();
             const auto opCtxHolder = cc().makeOperationContext();
             const auto opCtx = opCtxHolder.get();
@@ -494,6 +551,7 @@ void scheduleWritesToOplog(OperationContext* opCtx,
             fassertStatusOK(40141,
                             StorageInterface::get(opCtx)->insertDocuments(
                                 opCtx, NamespaceString(rsOplogName), docs));
+            progress->taskDone();
         };
     };
 
@@ -511,12 +569,14 @@ void scheduleWritesToOplog(OperationContext* opCtx,
     if (!enoughToMultiThread ||
         !opCtx->getServiceContext()->getGlobalStorageEngine()->supportsDocLocking()) {
 
+        progress = std::make_shared<StageProgress>(&writeOplogBatchStats, 1);
         threadPool->schedule(makeOplogWriterForRange(0, ops.size()));
         return;
     }
 
 
     const size_t numOplogThreads = threadPool->getNumThreads();
+    progress = std::make_shared<StageProgress>(&writeOplogBatchStats, numOplogThreads);
     const size_t numOpsPerThread = ops.size() / numOplogThreads;
     for (size_t thread = 0; thread < numOplogThreads; thread++) {
         size_t begin = thread * numOpsPerThread;
@@ -620,7 +680,9 @@ void fillWriterVectors(OperationContext* opCtx,
 
 // Applies a batch of oplog entries, by using a set of threads to apply the operations and then
 // writes the oplog entries to the local oplog.
-OpTime SyncTail::multiApply(OperationContext* opCtx, MultiApplier::Operations ops) {
+OpTime SyncTail::multiApply(OperationContext* opCtx,
+                            MultiApplier::Operations ops,
+                            bool opsPrefetched) {
     auto applyOperation = [this](MultiApplier::OperationPtrs* ops) -> Status {
         _applyFunc(ops, this);
         // This function is used by 3.2 initial sync and steady state data replication.
@@ -628,7 +690,9 @@ OpTime SyncTail::multiApply(OperationContext* opCtx, MultiApplier::Operations op
         return Status::OK();
     };
     return fassertStatusOK(
-        34437, repl::multiApply(opCtx, _writerPool.get(), std::move(ops), applyOperation));
+        34437,
+        repl::multiApply(
+            opCtx, _writerPool.get(), std::move(ops), applyOperation, opsPrefetched));
 }
 
 namespace {
@@ -679,6 +743,7 @@ public:
     }
 
     OpQueue getNextBatch(Seconds maxWaitTime) {
+        Timer waitTimer;
         stdx::unique_lock<stdx::mutex> lk(_mutex);
         if (_ops.empty() && !_ops.mustShutdown()) {
             // We intentionally don't care about whether this returns due to signaling or timeout
@@ -690,6 +755,9 @@ public:
         _ops = {};
         _cv.notify_all();
 
+        if (!ops.empty()) {
+            waitForBatchStats.record(waitTimer);
+        }
         return ops;
     }
 
@@ -704,6 +772,8 @@ private:
             40301,
             StorageInterface::get(&opCtx)->getOplogMaxSize(&opCtx, NamespaceString(rsOplogName)));
 
+        const bool isMmapV1 = opCtx.getServiceContext()->getGlobalStorageEngine()->isMmapV1();
+
         // Batches are limited to 10% of the oplog.
         BatchLimits batchLimits;
         batchLimits.bytes = std::min(oplogMaxSize / 10, size_t(replBatchLimitBytes));
@@ -726,6 +796,14 @@ private:
                 continue;  // Don't emit empty batches.
             }
 
+            // At most one batch is prefetched at a time. If the previous batch is still being
+            // prefetched, this one is left for the applier to prefetch, rather than holding up the
+            // batcher.
+            if (!ops.empty() && replPrefetchNextBatch.load() && isMmapV1 &&
+                (!_lastPrefetch || _lastPrefetch->done())) {
+                prefetchBatch(&ops);
+            }
+
             stdx::unique_lock<stdx::mutex> lk(_mutex);
             // Block until the previous batch has been taken.
             _cv.wait(lk, [&] { return _ops.empty(); });
@@ -738,6 +816,30 @@ private:
         }
     }
 
+    /**
+     * Schedules paging in the documents and index entries that the ops in 'ops' will touch, so
+     * that this happens while the previous batch is still being applied rather than when the
+     * writer threads reach each op. Marks 'ops' as prefetched.
+     */
+    void prefetchBatch(OpQueue* ops) {
+        if (!_prefetcherPool) {
+            _prefetcherPool =
+                stdx::make_unique<OldThreadPool>(replWriterThreadCount, "repl prefetch worker ");
+        }
+
+        _lastPrefetch = std::make_shared<StageProgress>(&prefetchNextBatchStats,
+                                                        static_cast<long long>(ops->getCount()));
+        for (auto&& op : ops->getBatch()) {
+            BSONObj raw = op.raw;
+            auto progress = _lastPrefetch;
+            _prefetcherPool->schedule([raw, progress] {
+                prefetchOp(raw, false);
+                progress->taskDone();
+            });
+        }
+        ops->setPrefetched();
+    }
+
     SyncTail* const _syncTail;
 
     stdx::mutex _mutex;  // Guards _ops.
@@ -748,6 +850,10 @@ private:
     // TODO remove once we trust noexcept enough to mark oplogApplication() as noexcept.
     bool _isDead = false;
 
+    // Only used by the batcher thread. Created the first time a batch is prefetched.
+    std::shared_ptr<StageProgress> _lastPrefetch;
+    std::unique_ptr<OldThreadPool> _prefetcherPool;
+
     stdx::thread _thread;  // Must be last so all other members are initialized before starting.
 };
 
@@ -812,7 +918,8 @@ void SyncTail::oplogApplication(ReplicationCoordinator* replCoord) {
         stdx::lock_guard<SimpleMutex> fsynclk(filesLockedFsync);
 
         // Do the work.
-        multiApply(&opCtx, ops.releaseBatch());
+        const bool opsPrefetched = ops.isPrefetched();
+        multiApply(&opCtx, ops.releaseBatch(), opsPrefetched);
 
         // Update various things that care about our last applied optime. Tests rely on 2 happening
         // before 3 even though it isn't strictly necessary. The order of 1 doesn't matter.
@@ -1237,7 +1344,8 @@ Status multiInitialSyncApply_noAbort(OperationContext* opCtx,
 StatusWith<OpTime> multiApply(OperationContext* opCtx,
                               OldThreadPool* workerPool,
                               MultiApplier::Operations ops,
-                              MultiApplier::ApplyOperationFn applyOperation) {
+                              MultiApplier::ApplyOperationFn applyOperation,
+                              bool opsPrefetched) {
     if (!opCtx) {
         return {ErrorCodes::BadValue, "invalid operation context"};
     }
@@ -1254,7 +1362,7 @@ StatusWith<OpTime> multiApply(OperationContext* opCtx,
         return {ErrorCodes::BadValue, "invalid apply operation function"};
     }
 
-    if (getGlobalServiceContext()->getGlobalStorageEngine()->isMmapV1()) {
+    if (!opsPrefetched && getGlobalServiceContext()->getGlobalStorageEngine()->isMmapV1()) {
         // Use a ThreadPool to prefetch all the operations in a batch.
         prefetchOps(ops, workerPool);
     }
@@ -1282,7 +1390,10 @@ StatusWith<OpTime> multiApply(OperationContext* opCtx,
 
         storage->setOplogDeleteFromPoint(opCtx, ops.front().ts.timestamp());
         scheduleWritesToOplog(opCtx, workerPool, ops);
-        fillWriterVectors(opCtx, &ops, &writerVectors);
+        {
+            TimerHolder partitionTimer(&partitionBatchStats);
+            fillWriterVectors(opCtx, &ops, &writerVectors);
+        }
 
         workerPool->join();
 
@@ -167,6 +167,17 @@ public:
             _mustShutdown = true;
         }
 
+        /**
+         * Set once the batcher has started paging in what the ops of this batch will touch, so
+         * that applying them doesn't need to prefetch them again.
+         */
+        bool isPrefetched() const {
+            return _prefetched;
+        }
+        void setPrefetched() {
+            _prefetched = true;
+        }
+
         /**
          * Leaves this object in an unspecified state. Only assignment and destruction are valid.
          */
@@ -178,6 +189,7 @@ public:
         std::vector<OplogEntry> _batch;
         size_t _bytes;
         bool _mustShutdown = false;
+        bool _prefetched = false;
     };
 
     struct BatchLimits {
@@ -224,7 +236,9 @@ protected:
 
     // Apply a batch of operations, using multiple threads.
     // Returns the last OpTime applied during the apply batch, ops.end["ts"] basically.
-    OpTime multiApply(OperationContext* opCtx, MultiApplier::Operations ops);
+    OpTime multiApply(OperationContext* opCtx,
+                      MultiApplier::Operations ops,
+                      bool opsPrefetched = false);
 
 private:
     class OpQueueBatcher;
@@ -247,12 +261,15 @@ private:
  * Returns ErrorCodes::CannotApplyOplogWhilePrimary if the node has become primary, and the OpTime
  * of the final operation applied otherwise.
  *
+ * On MMAPv1, the ops are prefetched first unless 'opsPrefetched' says this already happened.
+ *
  * Shared between here and MultiApplier.
  */
 StatusWith<OpTime> multiApply(OperationContext* opCtx,
                               OldThreadPool* workerPool,
                               MultiApplier::Operations ops,
-                              MultiApplier::ApplyOperationFn applyOperation);
+                              MultiApplier::ApplyOperationFn applyOperation,
+                              bool opsPrefetched = false);
 
 // These free functions are used by the thread pool workers to write ops to the db.
 // They consume the passed in OperationPtrs and callers should not make any assumptions about the
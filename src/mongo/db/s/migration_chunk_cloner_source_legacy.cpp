@@ -453,9 +453,9 @@ Status MigrationChunkClonerSourceLegacy::nextModsBatch(OperationContext* opCtx,
 
     stdx::lock_guard<stdx::mutex> sl(_mutex);
 
-    // All clone data must have been drained before starting to fetch the incremental changes
-    invariant(_cloneLocs.empty());
-
+    // The recipient may fetch the incremental changes while it is still cloning, as long as it
+    // applies them after all of the cloned documents, since each transfer carries the current
+    // version of the modified documents.
     long long docSizeAccumulator = 0;
 
     _xfer(opCtx, db, &_deleted, builder, "deleted", &docSizeAccumulator, false);
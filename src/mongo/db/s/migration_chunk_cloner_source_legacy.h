@@ -114,8 +114,9 @@ public:
 
     /**
      * Called by the recipient shard. Transfers the accummulated local mods from source to
-     * destination. Must not be called before all cloned objects have been fetched through calls to
-     * nextCloneBatch.
+     * destination. May be called before all cloned objects have been fetched through calls to
+     * nextCloneBatch, in which case the recipient must apply the mods only after it has applied
+     * all of the cloned objects.
      *
      * NOTE: Must be called with the collection lock held in at least IS mode.
      */
@@ -39,6 +39,7 @@
 #include "mongo/db/db_raii.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/s/migration_chunk_cloner_source_legacy.h"
+#include "mongo/db/s/migration_clone_fetcher.h"
 #include "mongo/db/s/migration_source_manager.h"
 #include "mongo/db/s/sharding_state.h"
 
@@ -169,6 +170,9 @@ public:
         invariant(arrBuilder);
         result.appendArray("objects", arrBuilder->arr());
 
+        // Lets the recipient know that it can transfer the mods while it is cloning
+        result.append(MigrationCloneFetcher::kTransferModsDuringCloneField, true);
+
         return true;
     }
 
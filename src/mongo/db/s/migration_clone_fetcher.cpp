@@ -0,0 +1,188 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/s/migration_clone_fetcher.h"
+
+#include <algorithm>
+
+#include "mongo/db/client.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/rpc/get_status_from_command_result.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+const char MigrationCloneFetcher::kTransferModsDuringCloneField[] = "transferModsDuringClone";
+
+const long long MigrationCloneFetcher::kMaxBufferedModsBytes = 64 * 1024 * 1024;
+
+MigrationCloneFetcher::MigrationCloneFetcher(RunCommandFn runCommand,
+                                             BSONObj migrateCloneRequest,
+                                             BSONObj transferModsRequest,
+                                             int maxBatchesInFlight)
+    : _runCommandFn(std::move(runCommand)),
+      _migrateCloneRequest(std::move(migrateCloneRequest)),
+      _transferModsRequest(std::move(transferModsRequest)),
+      _maxBatchesInFlight(std::max(maxBatchesInFlight, 1)) {}
+
+MigrationCloneFetcher::~MigrationCloneFetcher() {
+    shutdown();
+}
+
+void MigrationCloneFetcher::start() {
+    invariant(!_thread.joinable());
+    _thread = stdx::thread([this] { _fetchLoop(); });
+}
+
+void MigrationCloneFetcher::shutdown() {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _shutdown = true;
+        _cv.notify_all();
+    }
+
+    if (_thread.joinable()) {
+        _thread.join();
+    }
+}
+
+StatusWith<BSONObj> MigrationCloneFetcher::nextCloneBatch(OperationContext* opCtx) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    opCtx->waitForConditionOrInterrupt(
+        _cv, lk, [this] { return !_cloneBatches.empty() || !_status.isOK() || _shutdown; });
+
+    if (!_cloneBatches.empty()) {
+        BSONObj batch = std::move(_cloneBatches.front());
+        _cloneBatches.pop_front();
+        _cv.notify_all();
+        return batch;
+    }
+
+    if (!_status.isOK()) {
+        return _status;
+    }
+
+    return {ErrorCodes::ShutdownInProgress, "Fetching of the migration clone batches was stopped"};
+}
+
+std::vector<BSONObj> MigrationCloneFetcher::takeTransferredMods() {
+    invariant(!_thread.joinable());
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _modsBytes = 0;
+    return std::move(_mods);
+}
+
+void MigrationCloneFetcher::_fetchLoop() {
+    Client::initThread("migrateCloneFetcher");
+
+    while (true) {
+        {
+            stdx::unique_lock<stdx::mutex> lk(_mutex);
+            _cv.wait(lk,
+                     [this] { return _shutdown || _cloneBatches.size() < _maxBatchesInFlight; });
+            if (_shutdown) {
+                return;
+            }
+        }
+
+        auto swCloneBatch = _runCommand(_migrateCloneRequest);
+        if (swCloneBatch.isOK() && swCloneBatch.getValue()["objects"].type() != Array) {
+            swCloneBatch = {ErrorCodes::FailedToParse, "missing 'objects' array"};
+        }
+        if (!swCloneBatch.isOK()) {
+            _setError("_migrateClone", swCloneBatch.getStatus());
+            return;
+        }
+
+        const BSONObj cloneBatch = std::move(swCloneBatch.getValue());
+        const bool cloneDone = cloneBatch["objects"].Obj().isEmpty();
+
+        bool transferMods = cloneBatch[kTransferModsDuringCloneField].trueValue();
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _cloneBatches.push_back(cloneBatch);
+            _cv.notify_all();
+
+            transferMods = transferMods && _modsBytes < kMaxBufferedModsBytes;
+        }
+
+        // The modifications which are left are transferred by the catch-up phase
+        if (cloneDone) {
+            return;
+        }
+
+        if (!transferMods) {
+            continue;
+        }
+
+        auto swMods = _runCommand(_transferModsRequest);
+        if (!swMods.isOK()) {
+            _setError("_transferMods", swMods.getStatus());
+            return;
+        }
+
+        const BSONObj& mods = swMods.getValue();
+        if (mods["size"].number() > 0) {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _modsBytes += mods.objsize();
+            _mods.push_back(mods);
+        }
+    }
+}
+
+void MigrationCloneFetcher::_setError(StringData commandName, const Status& status) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _status = Status(status.code(),
+                     str::stream() << commandName << " failed: " << status.reason());
+    _cv.notify_all();
+}
+
+StatusWith<BSONObj> MigrationCloneFetcher::_runCommand(const BSONObj& cmdObj) {
+    try {
+        auto swResponse = _runCommandFn(cmdObj);
+        if (!swResponse.isOK()) {
+            return swResponse;
+        }
+
+        const BSONObj response = swResponse.getValue().getOwned();
+        Status commandStatus = getStatusFromCommandResult(response);
+        if (!commandStatus.isOK()) {
+            return commandStatus;
+        }
+
+        return response;
+    } catch (const DBException& ex) {
+        return ex.toStatus();
+    }
+}
+
+}  // namespace mongo
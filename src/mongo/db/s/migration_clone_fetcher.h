@@ -0,0 +1,157 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <deque>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status_with.h"
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/functional.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+
+namespace mongo {
+
+class OperationContext;
+
+/**
+ * Fetches the initial clone batches of a chunk migration from the donor shard on a background
+ * thread, keeping up to a fixed number of batches in flight while the recipient inserts the ones
+ * it already has.
+ *
+ * If the donor allows it, the fetcher also transfers the modifications made to the chunk while
+ * it is being cloned (_transferMods) in between the clone batches, so that fewer of them are left
+ * for the catch-up phase. These modifications must be applied after all of the cloned documents
+ * have been inserted, in the order in which they were fetched.
+ */
+class MigrationCloneFetcher {
+    MONGO_DISALLOW_COPYING(MigrationCloneFetcher);
+
+public:
+    /**
+     * Runs a command against the donor shard and returns its response, which may be the response
+     * of a failed command, or the error which prevented getting a response. Only ever called from
+     * the fetching thread.
+     */
+    using RunCommandFn = stdx::function<StatusWith<BSONObj>(const BSONObj& cmdObj)>;
+
+    /**
+     * Name of the field of the _migrateClone response through which the donor signals that it can
+     * serve _transferMods requests before the clone is complete.
+     */
+    static const char kTransferModsDuringCloneField[];
+
+    /**
+     * Upper bound on the size of the modifications buffered while cloning. Past this, the
+     * modifications are left with the donor until the catch-up phase.
+     */
+    static const long long kMaxBufferedModsBytes;
+
+    MigrationCloneFetcher(RunCommandFn runCommand,
+                          BSONObj migrateCloneRequest,
+                          BSONObj transferModsRequest,
+                          int maxBatchesInFlight);
+
+    /**
+     * Stops fetching and waits for the fetching thread to exit.
+     */
+    ~MigrationCloneFetcher();
+
+    /**
+     * Starts the fetching thread. Must be called at most once.
+     */
+    void start();
+
+    /**
+     * Stops fetching and waits for the fetching thread to exit. It is safe to call more than once.
+     */
+    void shutdown();
+
+    /**
+     * Blocks until the next _migrateClone response is available and returns it. A response with
+     * an empty 'objects' array means that all documents have been cloned and that no more batches
+     * must be requested. Returns the error which stopped the fetching, if any.
+     *
+     * Throws if 'opCtx' is interrupted while waiting.
+     */
+    StatusWith<BSONObj> nextCloneBatch(OperationContext* opCtx);
+
+    /**
+     * Returns the _transferMods responses fetched so far, in the order in which they were fetched,
+     * and forgets about them. Must only be called after shutdown().
+     */
+    std::vector<BSONObj> takeTransferredMods();
+
+private:
+    /**
+     * Body of the fetching thread.
+     */
+    void _fetchLoop();
+
+    /**
+     * Records the error which stopped the fetching and wakes up the consumer.
+     */
+    void _setError(StringData commandName, const Status& status);
+
+    /**
+     * Runs the command on the donor and returns its response if it succeeded.
+     */
+    StatusWith<BSONObj> _runCommand(const BSONObj& cmdObj);
+
+    const RunCommandFn _runCommandFn;
+    const BSONObj _migrateCloneRequest;
+    const BSONObj _transferModsRequest;
+    const size_t _maxBatchesInFlight;
+
+    stdx::thread _thread;
+
+    // Protects the members below
+    stdx::mutex _mutex;
+
+    // Signalled when a batch is fetched or consumed, when fetching fails and on shutdown
+    stdx::condition_variable _cv;
+
+    bool _shutdown{false};
+
+    // Set if fetching stopped because of an error
+    Status _status{Status::OK()};
+
+    // Fetched _migrateClone responses which were not consumed yet
+    std::deque<BSONObj> _cloneBatches;
+
+    // Fetched _transferMods responses, which contained at least one modification
+    std::vector<BSONObj> _mods;
+    long long _modsBytes{0};
+};
+
+}  // namespace mongo
@@ -0,0 +1,223 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/s/migration_clone_fetcher.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/client.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/service_context.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+namespace {
+
+const BSONObj kMigrateCloneRequest = BSON("_migrateClone"
+                                          << "test.foo");
+const BSONObj kTransferModsRequest = BSON("_transferMods"
+                                          << "test.foo");
+
+/**
+ * Stands in for the donor shard, serving a fixed number of clone batches of one document each and
+ * one modification per _transferMods request.
+ */
+class FakeDonor {
+public:
+    FakeDonor(int numBatches, bool transferModsDuringClone)
+        : _numBatches(numBatches), _transferModsDuringClone(transferModsDuringClone) {}
+
+    StatusWith<BSONObj> runCommand(const BSONObj& cmdObj) {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+        if (cmdObj.firstElementFieldName() == StringData("_migrateClone")) {
+            BSONArrayBuilder objects;
+            if (_numCloneRequests < _numBatches) {
+                objects.append(BSON("_id" << _numCloneRequests));
+            }
+            ++_numCloneRequests;
+
+            BSONObjBuilder response;
+            response.append("objects", objects.arr());
+            if (_transferModsDuringClone) {
+                response.append(MigrationCloneFetcher::kTransferModsDuringCloneField, true);
+            }
+            response.append("ok", 1);
+            return response.obj();
+        }
+
+        ASSERT_EQ(StringData("_transferMods"), cmdObj.firstElementFieldName());
+        ASSERT(_transferModsDuringClone);
+        ++_numTransferModsRequests;
+        return BSON("reload" << BSON_ARRAY(BSON("_id" << _numTransferModsRequests)) << "deleted"
+                             << BSONArray()
+                             << "size"
+                             << 1
+                             << "ok"
+                             << 1);
+    }
+
+    MigrationCloneFetcher::RunCommandFn fn() {
+        return [this](const BSONObj& cmdObj) { return runCommand(cmdObj); };
+    }
+
+    int numCloneRequests() {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        return _numCloneRequests;
+    }
+
+private:
+    const int _numBatches;
+    const bool _transferModsDuringClone;
+
+    stdx::mutex _mutex;
+    int _numCloneRequests{0};
+    int _numTransferModsRequests{0};
+};
+
+class MigrationCloneFetcherTest : public unittest::Test {
+protected:
+    MigrationCloneFetcherTest()
+        : _client(getGlobalServiceContext()->makeClient("MigrationCloneFetcherTest")),
+          _opCtx(_client->makeOperationContext()) {}
+
+    OperationContext* opCtx() {
+        return _opCtx.get();
+    }
+
+private:
+    ServiceContext::UniqueClient _client;
+    ServiceContext::UniqueOperationContext _opCtx;
+};
+
+TEST_F(MigrationCloneFetcherTest, ReturnsCloneBatchesInOrder) {
+    FakeDonor donor(5, false);
+    MigrationCloneFetcher fetcher(donor.fn(), kMigrateCloneRequest, kTransferModsRequest, 2);
+    fetcher.start();
+
+    for (int i = 0; i < 5; ++i) {
+        auto swBatch = fetcher.nextCloneBatch(opCtx());
+        ASSERT_OK(swBatch.getStatus());
+        ASSERT_BSONOBJ_EQ(BSON("0" << BSON("_id" << i)), swBatch.getValue()["objects"].Obj());
+    }
+
+    auto swLastBatch = fetcher.nextCloneBatch(opCtx());
+    ASSERT_OK(swLastBatch.getStatus());
+    ASSERT(swLastBatch.getValue()["objects"].Obj().isEmpty());
+
+    fetcher.shutdown();
+    ASSERT_EQ(6, donor.numCloneRequests());
+    ASSERT(fetcher.takeTransferredMods().empty());
+}
+
+TEST_F(MigrationCloneFetcherTest, TransfersModsBetweenCloneBatchesIfDonorAllowsIt) {
+    FakeDonor donor(3, true);
+    MigrationCloneFetcher fetcher(donor.fn(), kMigrateCloneRequest, kTransferModsRequest, 1);
+    fetcher.start();
+
+    while (true) {
+        auto swBatch = fetcher.nextCloneBatch(opCtx());
+        ASSERT_OK(swBatch.getStatus());
+        if (swBatch.getValue()["objects"].Obj().isEmpty()) {
+            break;
+        }
+    }
+
+    fetcher.shutdown();
+
+    // No mods are requested after the last, empty batch
+    auto mods = fetcher.takeTransferredMods();
+    ASSERT_EQ(3U, mods.size());
+    for (size_t i = 0; i < mods.size(); ++i) {
+        ASSERT_BSONOBJ_EQ(BSON("0" << BSON("_id" << static_cast<int>(i + 1))),
+                          mods[i]["reload"].Obj());
+    }
+}
+
+TEST_F(MigrationCloneFetcherTest, KeepsAtMostMaxBatchesInFlight) {
+    FakeDonor donor(10, false);
+    MigrationCloneFetcher fetcher(donor.fn(), kMigrateCloneRequest, kTransferModsRequest, 3);
+    fetcher.start();
+
+    ASSERT_OK(fetcher.nextCloneBatch(opCtx()).getStatus());
+
+    // Once the queue is full again, the fetching thread must stop requesting batches
+    while (donor.numCloneRequests() < 4) {
+        sleepmillis(1);
+    }
+    sleepmillis(100);
+    ASSERT_EQ(4, donor.numCloneRequests());
+
+    fetcher.shutdown();
+}
+
+TEST_F(MigrationCloneFetcherTest, ReturnsCommandErrors) {
+    int numRequests = 0;
+    MigrationCloneFetcher fetcher(
+        [&numRequests](const BSONObj& cmdObj) -> StatusWith<BSONObj> {
+            if (numRequests++ == 0) {
+                return BSON("objects" << BSON_ARRAY(BSON("_id" << 0)) << "ok" << 1);
+            }
+            return BSON("ok" << 0 << "errmsg"
+                             << "session mismatch"
+                             << "code"
+                             << ErrorCodes::IllegalOperation);
+        },
+        kMigrateCloneRequest,
+        kTransferModsRequest,
+        2);
+    fetcher.start();
+
+    // The batch fetched before the error is still returned
+    ASSERT_OK(fetcher.nextCloneBatch(opCtx()).getStatus());
+
+    auto swBatch = fetcher.nextCloneBatch(opCtx());
+    ASSERT_EQ(ErrorCodes::IllegalOperation, swBatch.getStatus());
+    ASSERT_STRING_CONTAINS(swBatch.getStatus().reason(), "_migrateClone failed");
+
+    fetcher.shutdown();
+}
+
+TEST_F(MigrationCloneFetcherTest, ReturnsErrorForMalformedResponse) {
+    MigrationCloneFetcher fetcher(
+        [](const BSONObj& cmdObj) -> StatusWith<BSONObj> { return BSON("ok" << 1); },
+        kMigrateCloneRequest,
+        kTransferModsRequest,
+        2);
+    fetcher.start();
+
+    ASSERT_EQ(ErrorCodes::FailedToParse, fetcher.nextCloneBatch(opCtx()).getStatus());
+    fetcher.shutdown();
+}
+
+}  // namespace
+}  // namespace mongo
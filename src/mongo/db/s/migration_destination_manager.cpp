@@ -46,15 +46,19 @@
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/operation_context.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/ops/delete.h"
+#include "mongo/db/query/query_knobs.h"
 #include "mongo/db/range_deleter_service.h"
 #include "mongo/db/repl/repl_client_info.h"
 #include "mongo/db/repl/replication_coordinator_global.h"
 #include "mongo/db/s/collection_metadata.h"
 #include "mongo/db/s/collection_sharding_state.h"
+#include "mongo/db/s/migration_clone_fetcher.h"
 #include "mongo/db/s/migration_util.h"
 #include "mongo/db/s/move_timing_helper.h"
 #include "mongo/db/s/sharding_state.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/service_context.h"
 #include "mongo/s/catalog/type_chunk.h"
 #include "mongo/s/shard_key_pattern.h"
@@ -70,6 +74,10 @@ using str::stream;
 
 namespace {
 
+// Number of _migrateClone batches which the recipient of a migration fetches ahead of the batch
+// it is inserting
+MONGO_EXPORT_SERVER_PARAMETER(migrateCloneBatchesInFlight, int, 2);
+
 const WriteConcernOptions kMajorityWriteConcern(WriteConcernOptions::kMajority,
                                                 // Note: Even though we're setting UNSET here,
                                                 // kMajority implies JOURNAL if journaling is
@@ -165,6 +173,44 @@ bool opReplicatedEnough(OperationContext* opCtx,
     return true;
 }
 
+/**
+ * Builds the indexes described by 'indexSpecs' on 'collection', which must be empty, and
+ * replicates their creation to the secondaries. Must be called with the database locked in
+ * exclusive mode.
+ */
+Status createIndexes(OperationContext* opCtx,
+                     Database* db,
+                     Collection* collection,
+                     const std::vector<BSONObj>& indexSpecs) {
+    if (indexSpecs.empty()) {
+        return Status::OK();
+    }
+
+    MultiIndexBlock indexer(opCtx, collection);
+
+    auto indexInfoObjs = indexer.init(indexSpecs);
+    if (!indexInfoObjs.isOK()) {
+        return indexInfoObjs.getStatus();
+    }
+
+    auto status = indexer.insertAllDocumentsInCollection();
+    if (!status.isOK()) {
+        return status;
+    }
+
+    WriteUnitOfWork wunit(opCtx);
+    indexer.commit();
+
+    for (auto&& infoObj : indexInfoObjs.getValue()) {
+        // make sure to create index on secondaries as well
+        getGlobalServiceContext()->getOpObserver()->onCreateIndex(
+            opCtx, db->getSystemIndexesName(), infoObj, true /* fromMigrate */);
+    }
+
+    wunit.commit();
+    return Status::OK();
+}
+
 /**
  * Create the migration clone request BSON object to send to the source shard.
  *
@@ -569,16 +615,7 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* opCtx,
                 return;
             }
 
-            auto indexInfoObjs = indexer.init(indexSpecs);
-            if (!indexInfoObjs.isOK()) {
-                _errmsg = str::stream() << "failed to create index before migrating data. "
-                                        << " error: " << redact(indexInfoObjs.getStatus());
-                warning() << _errmsg;
-                setState(FAIL);
-                return;
-            }
-
-            auto status = indexer.insertAllDocumentsInCollection();
+            auto status = createIndexes(opCtx, db, collection, indexSpecs);
             if (!status.isOK()) {
                 _errmsg = str::stream() << "failed to create index before migrating data. "
                                         << " error: " << redact(status);
@@ -586,17 +623,6 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* opCtx,
                 setState(FAIL);
                 return;
             }
-
-            WriteUnitOfWork wunit(opCtx);
-            indexer.commit();
-
-            for (auto&& infoObj : indexInfoObjs.getValue()) {
-                // make sure to create index on secondaries as well
-                getGlobalServiceContext()->getOpObserver()->onCreateIndex(
-                    opCtx, db->getSystemIndexesName(), infoObj, true /* fromMigrate */);
-            }
-
-            wunit.commit();
         }
 
         timing.done(1);
@@ -635,27 +661,52 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* opCtx,
         MONGO_FAIL_POINT_PAUSE_WHILE_SET(migrateThreadHangAtStep2);
     }
 
+    // The mods which were transferred while cloning, in the order in which they were fetched
+    std::vector<BSONObj> transferredMods;
+
     {
         // 3. Initial bulk clone
         setState(CLONE);
 
-        const BSONObj migrateCloneRequest = createMigrateCloneRequest(_nss, *_sessionId);
+        // The batches are fetched on a separate connection by a background thread, so that the
+        // next batches are already in flight while the current one is being inserted
+        ScopedDbConnection fetcherConn(fromShardConnString);
+        MigrationCloneFetcher fetcher(
+            [&fetcherConn](const BSONObj& cmdObj) -> StatusWith<BSONObj> {
+                BSONObj res;
+                fetcherConn->runCommand("admin", cmdObj, res);
+                return res;
+            },
+            createMigrateCloneRequest(_nss, *_sessionId),
+            createTransferModsRequest(_nss, *_sessionId),
+            migrateCloneBatchesInFlight.load());
+        fetcher.start();
+
+        Milliseconds fetchWaitTime(0);
+        Milliseconds insertTime(0);
 
         while (true) {
-            BSONObj res;
-            if (!conn->runCommand("admin",
-                                  migrateCloneRequest,
-                                  res)) {  // gets array of objects to copy, in disk order
+            Timer fetchWaitTimer;
+            auto swRes = fetcher.nextCloneBatch(opCtx);
+            fetchWaitTime += Milliseconds(fetchWaitTimer.millis());
+
+            if (!swRes.isOK()) {
                 setState(FAIL);
-                _errmsg = "_migrateClone failed: ";
-                _errmsg += redact(res.toString());
+                _errmsg = redact(swRes.getStatus());
                 log() << _errmsg;
-                conn.done();
                 return;
             }
 
-            BSONObj arr = res["objects"].Obj();
-            int thisTime = 0;
+            // gets array of objects to copy, in disk order
+            BSONObj arr = swRes.getValue()["objects"].Obj();
+            if (arr.isEmpty()) {
+                break;
+            }
+
+            Timer insertTimer;
+
+            std::vector<BSONObj> docs;
+            long long docsBytes = 0;
 
             BSONObjIterator i(arr);
             while (i.more()) {
@@ -666,38 +717,22 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* opCtx,
                     return;
                 }
 
-                BSONObj docToClone = i.next().Obj();
-                {
-                    OldClientWriteContext cx(opCtx, _nss.ns());
-
-                    BSONObj localDoc;
-                    if (willOverrideLocalId(opCtx,
-                                            _nss,
-                                            min,
-                                            max,
-                                            shardKeyPattern,
-                                            cx.db(),
-                                            docToClone,
-                                            &localDoc)) {
-                        string errMsg = str::stream() << "cannot migrate chunk, local document "
-                                                      << redact(localDoc)
-                                                      << " has same _id as cloned "
-                                                      << "remote document " << redact(docToClone);
-
-                        warning() << errMsg;
-
-                        // Exception will abort migration cleanly
-                        uasserted(16976, errMsg);
-                    }
-
-                    Helpers::upsert(opCtx, _nss.ns(), docToClone, true);
+                // Insert the documents in groups of the same size as the insert command does
+                docs.clear();
+                docsBytes = 0;
+                while (i.more() &&
+                       docs.size() < static_cast<size_t>(internalInsertMaxBatchSize.load()) &&
+                       docsBytes < insertVectorMaxBytes) {
+                    docs.push_back(i.next().Obj());
+                    docsBytes += docs.back().objsize();
                 }
-                thisTime++;
+
+                _insertClonedDocuments(opCtx, min, max, shardKeyPattern, docs);
 
                 {
                     stdx::lock_guard<stdx::mutex> statsLock(_mutex);
-                    _numCloned++;
-                    _clonedBytes += docToClone.objsize();
+                    _numCloned += docs.size();
+                    _clonedBytes += docsBytes;
                 }
 
                 if (writeConcern.shouldWaitForOtherNodes()) {
@@ -715,10 +750,16 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* opCtx,
                 }
             }
 
-            if (thisTime == 0)
-                break;
+            insertTime += Milliseconds(insertTimer.millis());
         }
 
+        fetcher.shutdown();
+        transferredMods = fetcher.takeTransferredMods();
+        fetcherConn.done();
+
+        timing.recordPhase("cloneFetchWait", fetchWaitTime);
+        timing.recordPhase("cloneInsert", insertTime);
+
         timing.done(3);
         MONGO_FAIL_POINT_PAUSE_WHILE_SET(migrateThreadHangAtStep3);
     }
@@ -733,6 +774,22 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* opCtx,
         // 4. Do bulk of mods
         setState(CATCHUP);
 
+        // The mods transferred while cloning must be applied after all of the cloned documents
+        Timer applyTransferredModsTimer;
+        for (const auto& mods : transferredMods) {
+            opCtx->checkForInterrupt();
+
+            if (getState() == ABORT) {
+                log() << "Migration aborted while applying mods transferred during the clone";
+                return;
+            }
+
+            _applyMigrateOp(opCtx, _nss, min, max, shardKeyPattern, mods, &lastOpApplied);
+        }
+        transferredMods.clear();
+        timing.recordPhase("catchupApplyModsTransferredDuringClone",
+                           Milliseconds(applyTransferredModsTimer.millis()));
+
         while (true) {
             BSONObj res;
             if (!conn->runCommand("admin", xferModsRequest, res)) {
@@ -880,6 +937,64 @@ void MigrationDestinationManager::_migrateDriver(OperationContext* opCtx,
     conn.done();
 }
 
+void MigrationDestinationManager::_insertClonedDocuments(OperationContext* opCtx,
+                                                         const BSONObj& min,
+                                                         const BSONObj& max,
+                                                         const BSONObj& shardKeyPattern,
+                                                         const std::vector<BSONObj>& docs) {
+    OldClientWriteContext cx(opCtx, _nss.ns());
+
+    uassert(ErrorCodes::NotMaster,
+            str::stream() << "Not primary during migration: " << _nss.ns(),
+            repl::getGlobalReplicationCoordinator()->canAcceptWritesFor(opCtx, _nss));
+
+    Collection* const collection = cx.getCollection();
+    uassert(ErrorCodes::NamespaceNotFound,
+            str::stream() << "collection dropped during migration: " << _nss.ns(),
+            collection);
+
+    std::vector<BSONObj> docsToInsert;
+    docsToInsert.reserve(docs.size());
+
+    for (const auto& docToClone : docs) {
+        BSONObj localDoc;
+        if (willOverrideLocalId(
+                opCtx, _nss, min, max, shardKeyPattern, cx.db(), docToClone, &localDoc)) {
+            string errMsg = str::stream() << "cannot migrate chunk, local document "
+                                          << redact(localDoc) << " has same _id as cloned "
+                                          << "remote document " << redact(docToClone);
+
+            warning() << errMsg;
+
+            // Exception will abort migration cleanly
+            uasserted(16976, errMsg);
+        }
+
+        if (localDoc.isEmpty()) {
+            docsToInsert.push_back(docToClone);
+        } else {
+            // A copy of the document was left in the range, so it has to be overwritten
+            Helpers::upsert(opCtx, _nss.ns(), docToClone, true);
+        }
+    }
+
+    if (docsToInsert.empty()) {
+        return;
+    }
+
+    MONGO_WRITE_CONFLICT_RETRY_LOOP_BEGIN {
+        WriteUnitOfWork wuow(opCtx);
+        uassertStatusOK(collection->insertDocuments(opCtx,
+                                                    docsToInsert.begin(),
+                                                    docsToInsert.end(),
+                                                    nullptr /* opDebug */,
+                                                    false /* enforceQuota */,
+                                                    true /* fromMigrate */));
+        wuow.commit();
+    }
+    MONGO_WRITE_CONFLICT_RETRY_LOOP_END(opCtx, "migrateCloneInsert", _nss.ns());
+}
+
 bool MigrationDestinationManager::_applyMigrateOp(OperationContext* opCtx,
                                                   const NamespaceString& nss,
                                                   const BSONObj& min,
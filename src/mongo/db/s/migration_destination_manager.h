@@ -133,6 +133,17 @@ private:
                         const OID& epoch,
                         const WriteConcernOptions& writeConcern);
 
+    /**
+     * Inserts a group of documents received from the donor during the initial clone in a single
+     * write unit of work. Throws if a document would override a local document with the same _id,
+     * which does not belong to the range being migrated.
+     */
+    void _insertClonedDocuments(OperationContext* opCtx,
+                                const BSONObj& min,
+                                const BSONObj& max,
+                                const BSONObj& shardKeyPattern,
+                                const std::vector<BSONObj>& docs);
+
     bool _applyMigrateOp(OperationContext* opCtx,
                          const NamespaceString& ns,
                          const BSONObj& min,
@@ -82,6 +82,11 @@ MoveTimingHelper::~MoveTimingHelper() {
             _b.append("errmsg", *_cmdErrmsg);
         }
 
+        BSONObj phases = _phases.obj();
+        if (!phases.isEmpty()) {
+            _b.append("phases", phases);
+        }
+
         grid.catalogClient(_opCtx)->logChange(_opCtx,
                                               str::stream() << "moveChunk." << _where,
                                               _ns,
@@ -110,4 +115,8 @@ void MoveTimingHelper::done(int step) {
     _t.reset();
 }
 
+void MoveTimingHelper::recordPhase(StringData phase, Milliseconds duration) {
+    _phases.appendNumber(phase, static_cast<long long>(durationCount<Milliseconds>(duration)));
+}
+
 }  // namespace mongo
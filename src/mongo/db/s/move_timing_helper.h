@@ -30,8 +30,10 @@
 
 #include <string>
 
+#include "mongo/base/string_data.h"
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/s/shard_id.h"
+#include "mongo/util/time_support.h"
 #include "mongo/util/timer.h"
 
 namespace mongo {
@@ -54,6 +56,13 @@ public:
 
     void done(int step);
 
+    /**
+     * Records how long a phase within one of the steps took, for example the time spent waiting
+     * for data from the other shard. The phases are reported in the change log entry along with
+     * the duration of each step.
+     */
+    void recordPhase(StringData phase, Milliseconds duration);
+
 private:
     // Measures how long the receiving of a chunk takes
     Timer _t;
@@ -68,6 +77,7 @@ private:
 
     int _nextStep;
     BSONObjBuilder _b;
+    BSONObjBuilder _phases;
 };
 
 }  // namespace mongo
@@ -53,6 +53,7 @@ class OpObserver;
 class ServiceEntryPoint;
 
 namespace transport {
+class ServiceExecutor;
 class TransportLayer;
 class TransportLayerManager;
 }  // namespace transport
@@ -332,6 +333,14 @@ public:
      */
     ServiceEntryPoint* getServiceEntryPoint() const;
 
+    /**
+     * Get the service executor for the service context, if one has been set. When this returns
+     * nullptr, the ServiceEntryPoint runs each Session on a thread of its own.
+     *
+     * See ServiceExecutor for more details.
+     */
+    transport::ServiceExecutor* getServiceExecutor() const;
+
     /**
      * Add a new TransportLayer to this service context. The new TransportLayer will
      * be added to the TransportLayerManager accessible via getTransportLayer().
@@ -393,6 +402,12 @@ public:
      */
     void setServiceEntryPoint(std::unique_ptr<ServiceEntryPoint> sep);
 
+    /**
+     * Binds the service executor to the service context. This must be done before the
+     * TransportLayer is started.
+     */
+    void setServiceExecutor(std::unique_ptr<transport::ServiceExecutor> exec);
+
 protected:
     ServiceContext();
 
@@ -428,6 +443,11 @@ private:
      */
     std::unique_ptr<ServiceEntryPoint> _serviceEntryPoint;
 
+    /**
+     * The ServiceExecutor, if Sessions are not run on a thread per connection.
+     */
+    std::unique_ptr<transport::ServiceExecutor> _serviceExecutor;
+
     /**
      * Vector of registered observers.
      */
@@ -94,6 +94,17 @@ using transport::TransportLayer;
 ServiceEntryPointMongod::ServiceEntryPointMongod(TransportLayer* tl) : _tl(tl) {}
 
 void ServiceEntryPointMongod::startSession(transport::SessionHandle session) {
+    if (getGlobalServiceContext()->getServiceExecutor()) {
+        launchServiceExecutorSession(
+            std::move(session), [this](const transport::SessionHandle& session, Message& message) {
+                _nWorkers.fetchAndAdd(1);
+                auto guard = MakeGuard([&] { _nWorkers.fetchAndSubtract(1); });
+
+                _handleMessage(session, message);
+            });
+        return;
+    }
+
     // Pass ownership of the transport::SessionHandle into our worker thread. When this
     // thread exits, the session will end.
     launchWrappedServiceEntryWorkerThread(
@@ -107,32 +118,44 @@ void ServiceEntryPointMongod::startSession(transport::SessionHandle session) {
 
 void ServiceEntryPointMongod::_sessionLoop(const transport::SessionHandle& session) {
     Message inMessage;
-    bool inExhaust = false;
     int64_t counter = 0;
 
     while (true) {
-        // 1. Source a Message from the client (unless we are exhausting)
-        if (!inExhaust) {
-            inMessage.reset();
-            auto status = [&] {
-                MONGO_IDLE_THREAD_BLOCK;
-                return session->sourceMessage(&inMessage).wait();
-            }();
-
-            if (ErrorCodes::isInterruption(status.code()) ||
-                ErrorCodes::isNetworkError(status.code())) {
-                break;
-            }
+        // 1. Source a Message from the client
+        inMessage.reset();
+        auto status = [&] {
+            MONGO_IDLE_THREAD_BLOCK;
+            return session->sourceMessage(&inMessage).wait();
+        }();
+
+        if (ErrorCodes::isInterruption(status.code()) ||
+            ErrorCodes::isNetworkError(status.code())) {
+            break;
+        }
 
-            // Our session may have been closed internally.
-            if (status == TransportLayer::TicketSessionClosedStatus) {
-                break;
-            }
+        // Our session may have been closed internally.
+        if (status == TransportLayer::TicketSessionClosedStatus) {
+            break;
+        }
+
+        uassertStatusOK(status);
 
-            uassertStatusOK(status);
+        // 2. Run it and reply
+        _handleMessage(session, inMessage);
+
+        if ((counter++ & 0xf) == 0) {
+            markThreadIdle();
         }
+    }
+}
+
+void ServiceEntryPointMongod::_handleMessage(const transport::SessionHandle& session,
+                                             Message& inMessage) {
+    bool inExhaust = true;
 
-        // 2. Pass sourced Message up to mongod
+    // An exhaust cursor keeps replying to a synthesized getMore without sourcing more Messages
+    while (inExhaust) {
+        // 1. Pass the Message up to mongod
         DbResponse dbresponse;
         {
             auto opCtx = cc().makeOperationContext();
@@ -142,7 +165,7 @@ void ServiceEntryPointMongod::_sessionLoop(const transport::SessionHandle& sessi
             // up in currentOp results after the response reaches the client
         }
 
-        // 3. Format our response, if we have one
+        // 2. Format our response, if we have one
         Message& toSink = dbresponse.response;
         if (!toSink.empty()) {
             toSink.header().setId(nextMessageId());
@@ -155,15 +178,11 @@ void ServiceEntryPointMongod::_sessionLoop(const transport::SessionHandle& sessi
                 inExhaust = false;
             }
 
-            // 4. Sink our response to the client
+            // 3. Sink our response to the client
             uassertStatusOK(session->sinkMessage(toSink).wait());
         } else {
             inExhaust = false;
         }
-
-        if ((counter++ & 0xf) == 0) {
-            markThreadIdle();
-        }
     }
 }
 
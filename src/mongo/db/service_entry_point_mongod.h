@@ -36,6 +36,8 @@
 
 namespace mongo {
 
+class Message;
+
 namespace transport {
 class Session;
 class TransportLayer;
@@ -43,7 +45,8 @@ class TransportLayer;
 
 /**
  * The entry point from the TransportLayer into Mongod. startSession() spawns and
- * detaches a new thread for each incoming connection (transport::Session).
+ * detaches a new thread for each incoming connection (transport::Session), unless a
+ * ServiceExecutor is in use, in which case each Message is handled as a task on the executor.
  */
 class ServiceEntryPointMongod final : public ServiceEntryPoint {
     MONGO_DISALLOW_COPYING(ServiceEntryPointMongod);
@@ -62,6 +65,12 @@ public:
 private:
     void _sessionLoop(const transport::SessionHandle& session);
 
+    /**
+     * Runs a single Message sourced from 'session' and sinks the response, if any. For exhaust
+     * cursors this keeps replying until the cursor is exhausted.
+     */
+    void _handleMessage(const transport::SessionHandle& session, Message& inMessage);
+
     transport::TransportLayer* _tl;
     AtomicWord<std::size_t> _nWorkers;
 };
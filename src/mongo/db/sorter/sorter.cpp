@@ -48,7 +48,6 @@
 #include "mongo/db/sorter/sorter.h"
 
 #include <boost/filesystem/operations.hpp>
-#include <snappy.h>
 #include <vector>
 
 #include "mongo/base/string_data.h"
@@ -59,6 +58,7 @@
 #include "mongo/db/storage/wiredtiger/wiredtiger_customization_hooks.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/s/is_mongos.h"
+#include "mongo/stdx/memory.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/bufreader.h"
 #include "mongo/util/destructor_guard.h"
@@ -154,12 +154,14 @@ public:
 
     FileIterator(const std::string& fileName,
                  const Settings& settings,
-                 std::shared_ptr<FileDeleter> fileDeleter)
+                 std::shared_ptr<FileDeleter> fileDeleter,
+                 std::unique_ptr<SpillFileCacheAdvisor> cacheAdvisor)
         : _settings(settings),
           _done(false),
           _fileName(fileName),
           _fileDeleter(fileDeleter),
-          _file(_fileName.c_str(), std::ios::in | std::ios::binary) {
+          _file(_fileName.c_str(), std::ios::in | std::ios::binary),
+          _cacheAdvisor(std::move(cacheAdvisor)) {
         massert(16814,
                 str::stream() << "error opening file \"" << _fileName << "\": "
                               << myErrnoWithDescription(),
@@ -195,19 +197,40 @@ private:
     }
 
     void fill() {
-        int32_t rawSize;
-        read(&rawSize, sizeof(rawSize));
+        char headerBuffer[SpillBlockHeader::kSize];
+        read(headerBuffer, sizeof(headerBuffer));
         if (_done)
             return;
 
-        // negative size means compressed
-        const bool compressed = rawSize < 0;
-        int32_t blockSize = std::abs(rawSize);
+        const auto header = SpillBlockHeader::readFrom(headerBuffer);
+        int32_t blockSize = header.diskSize;
 
         _buffer.reset(new char[blockSize]);
         read(_buffer.get(), blockSize);
         massert(16816, "file too short?", !_done);
 
+        const int64_t blockOffset = _fileOffset;
+        const int64_t blockLength = sizeof(headerBuffer) + blockSize;
+        _fileOffset += blockLength;
+        recordSpillBlockRead(blockLength);
+        _cacheAdvisor->dontNeed(blockOffset, blockLength);
+
+        if (header.checksummed) {
+            const uint32_t checksum = spillBlockChecksum(_buffer.get(), blockSize);
+            if (checksum != header.checksum) {
+                recordSpillChecksumFailure();
+                msgasserted(40507,
+                            str::stream() << "checksum mismatch in the block at offset "
+                                          << blockOffset
+                                          << " of file \""
+                                          << _fileName
+                                          << "\": expected "
+                                          << header.checksum
+                                          << " but found "
+                                          << checksum);
+            }
+        }
+
         auto hooks = WiredTigerCustomizationHooks::get(getGlobalServiceContext());
         if (hooks->enabled()) {
             std::unique_ptr<char[]> out(new char[blockSize]);
@@ -224,26 +247,21 @@ private:
             _buffer.swap(out);
         }
 
-        if (!compressed) {
+        if (header.compressor == SpillCompressor::kNone) {
             _reader.reset(new BufReader(_buffer.get(), blockSize));
             return;
         }
 
-        dassert(snappy::IsValidCompressedBuffer(_buffer.get(), blockSize));
-
-        size_t uncompressedSize;
-        massert(17061,
-                "couldn't get uncompressed length",
-                snappy::GetUncompressedLength(_buffer.get(), blockSize, &uncompressedSize));
-
-        std::unique_ptr<char[]> decompressionBuffer(new char[uncompressedSize]);
-        massert(17062,
-                "decompression failed",
-                snappy::RawUncompress(_buffer.get(), blockSize, decompressionBuffer.get()));
+        std::unique_ptr<char[]> decompressionBuffer(new char[header.uncompressedSize]);
+        uncompressSpillBlock(header.compressor,
+                             _buffer.get(),
+                             blockSize,
+                             decompressionBuffer.get(),
+                             header.uncompressedSize);
 
         // hold on to decompressed data and throw out compressed data at block exit
         _buffer.swap(decompressionBuffer);
-        _reader.reset(new BufReader(_buffer.get(), uncompressedSize));
+        _reader.reset(new BufReader(_buffer.get(), header.uncompressedSize));
     }
 
     // sets _done to true on EOF - asserts on any other error
@@ -269,6 +287,8 @@ private:
     std::string _fileName;
     std::shared_ptr<FileDeleter> _fileDeleter;  // Must outlive _file
     std::ifstream _file;
+    std::unique_ptr<SpillFileCacheAdvisor> _cacheAdvisor;  // Handed on by the SortedFileWriter
+    int64_t _fileOffset = 0;
 };
 
 /** Merge-sorts results from 0 or more FileIterators */
@@ -805,7 +825,7 @@ inline unsigned nextFileNumber() {
 
 template <typename Key, typename Value>
 SortedFileWriter<Key, Value>::SortedFileWriter(const SortOptions& opts, const Settings& settings)
-    : _settings(settings) {
+    : _settings(settings), _compressor(opts.spillCompressor), _checksums(opts.spillChecksums) {
     namespace str = mongoutils::str;
 
     // This should be checked by consumers, but if we get here don't allow writes.
@@ -818,7 +838,7 @@ SortedFileWriter<Key, Value>::SortedFileWriter(const SortOptions& opts, const Se
 
     {
         StringBuilder sb;
-        sb << opts.tempDir << "/extsort." << sorter::nextFileNumber();
+        sb << opts.tempDir << "/" << sorter::kSpillFileNamePrefix << sorter::nextFileNumber();
         _fileName = sb.str();
     }
 
@@ -831,6 +851,7 @@ SortedFileWriter<Key, Value>::SortedFileWriter(const SortOptions& opts, const Se
             _file.good());
 
     _fileDeleter = std::make_shared<sorter::FileDeleter>(_fileName);
+    _cacheAdvisor = stdx::make_unique<sorter::SpillFileCacheAdvisor>(_fileName);
 
     // throw on failure
     _file.exceptions(std::ios::failbit | std::ios::badbit | std::ios::eofbit);
@@ -855,12 +876,13 @@ void SortedFileWriter<Key, Value>::spill() {
     if (size == 0)
         return;
 
-    std::string compressed;
-    snappy::Compress(outBuffer, size, &compressed);
-    verify(compressed.size() <= size_t(std::numeric_limits<int32_t>::max()));
+    sorter::SpillBlockHeader header;
+    header.uncompressedSize = size;
 
-    const bool shouldCompress = compressed.size() < size_t(_buffer.len() / 10 * 9);
-    if (shouldCompress) {
+    std::string compressed;
+    header.compressor = sorter::compressSpillBlock(_compressor, outBuffer, size, &compressed);
+    if (header.compressor != sorter::SpillCompressor::kNone) {
+        verify(compressed.size() <= size_t(std::numeric_limits<int32_t>::max()));
         size = compressed.size();
         outBuffer = const_cast<char*>(compressed.data());
     }
@@ -883,18 +905,34 @@ void SortedFileWriter<Key, Value>::spill() {
         size = resultLen;
     }
 
-    // negative size means compressed
-    size = shouldCompress ? -size : size;
+    // The checksum covers the block as it is written, so that it catches corruption on disk
+    // before the block is handed to the customization hooks or the decompressor.
+    header.diskSize = size;
+    header.checksummed = _checksums;
+    if (_checksums) {
+        header.checksum = sorter::spillBlockChecksum(outBuffer, size);
+    }
+
+    char headerBuffer[sorter::SpillBlockHeader::kSize];
+    header.writeTo(headerBuffer);
     try {
-        _file.write(reinterpret_cast<const char*>(&size), sizeof(size));
-        _file.write(outBuffer, std::abs(size));
+        _file.write(headerBuffer, sizeof(headerBuffer));
+        _file.write(outBuffer, size);
 
+        // The kernel can only drop pages that it has been handed.
+        if (_cacheAdvisor->enabled())
+            _file.flush();
     } catch (const std::exception&) {
         msgasserted(16821,
                     str::stream() << "error writing to file \"" << _fileName << "\": "
                                   << sorter::myErrnoWithDescription());
     }
 
+    const int64_t blockLength = sizeof(headerBuffer) + size;
+    sorter::recordSpillBlockWritten(_buffer.len(), blockLength);
+    _cacheAdvisor->dontNeedWritten(_fileOffset, blockLength);
+    _fileOffset += blockLength;
+
     _buffer.reset();
 }
 
@@ -902,7 +940,8 @@ template <typename Key, typename Value>
 SortIteratorInterface<Key, Value>* SortedFileWriter<Key, Value>::done() {
     spill();
     _file.close();
-    return new sorter::FileIterator<Key, Value>(_fileName, _settings, _fileDeleter);
+    return new sorter::FileIterator<Key, Value>(
+        _fileName, _settings, _fileDeleter, std::move(_cacheAdvisor));
 }
 
 //
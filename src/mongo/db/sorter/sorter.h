@@ -37,6 +37,7 @@
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/bson/util/builder.h"
+#include "mongo/db/sorter/sorter_spill.h"
 
 /**
  * This is the public API for the Sorter (both in-memory and external)
@@ -98,8 +99,17 @@ struct SortOptions {
     bool extSortAllowed;         /// If false, uassert if more mem needed than allowed.
     std::string tempDir;         /// Directory to directly place files in.
                                  /// Must be explicitly set if extSortAllowed is true.
-
-    SortOptions() : limit(0), maxMemoryUsageBytes(64 * 1024 * 1024), extSortAllowed(false) {}
+    sorter::SpillCompressor spillCompressor;  /// Codec for blocks of spill files.
+    bool spillChecksums;                      /// Whether to checksum blocks of spill files.
+
+    /// The spill settings default to the sorterSpillCompressor and sorterSpillChecksums
+    /// server parameters.
+    SortOptions()
+        : limit(0),
+          maxMemoryUsageBytes(64 * 1024 * 1024),
+          extSortAllowed(false),
+          spillCompressor(sorter::getDefaultSpillCompressor()),
+          spillChecksums(sorter::getDefaultSpillChecksums()) {}
 
     /// Fluent API to support expressions like SortOptions().Limit(1000).ExtSortAllowed(true)
 
@@ -122,6 +132,16 @@ struct SortOptions {
         tempDir = newTempDir;
         return *this;
     }
+
+    SortOptions& SpillCompression(sorter::SpillCompressor newSpillCompressor) {
+        spillCompressor = newSpillCompressor;
+        return *this;
+    }
+
+    SortOptions& SpillChecksums(bool newSpillChecksums = true) {
+        spillChecksums = newSpillChecksums;
+        return *this;
+    }
 };
 
 /// This is the output from the sorting framework
@@ -200,9 +220,13 @@ private:
     void spill();
 
     const Settings _settings;
+    const sorter::SpillCompressor _compressor;
+    const bool _checksums;
     std::string _fileName;
     std::shared_ptr<sorter::FileDeleter> _fileDeleter;  // Must outlive _file
     std::ofstream _file;
+    std::unique_ptr<sorter::SpillFileCacheAdvisor> _cacheAdvisor;
+    std::int64_t _fileOffset = 0;
     BufBuilder _buffer;
 };
 }
@@ -0,0 +1,351 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/sorter/sorter_spill.h"
+
+#include <snappy.h>
+#include <zlib.h>
+
+#include <boost/filesystem/operations.hpp>
+#include <vector>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "mongo/base/data_view.h"
+#include "mongo/base/counter.h"
+#include "mongo/db/commands/server_status_metric.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/storage/storage_options.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/platform/posix_fadvise.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace sorter {
+namespace {
+
+MONGO_EXPORT_SERVER_PARAMETER(sorterSpillChecksums, bool, true);
+MONGO_EXPORT_SERVER_PARAMETER(sorterSpillAvoidPageCache, bool, false);
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(sorterSpillDirectory, std::string, "");
+
+AtomicWord<std::uint8_t> spillCompressor(static_cast<std::uint8_t>(SpillCompressor::kSnappy));
+
+/**
+ * Selects the codec for newly written spill blocks. Files that were already written record the
+ * codec of each of their blocks, so this may be changed while sorts are running.
+ */
+class SorterSpillCompressorParameter : public ServerParameter {
+public:
+    SorterSpillCompressorParameter()
+        : ServerParameter(ServerParameterSet::getGlobal(), "sorterSpillCompressor", true, true) {}
+
+    void append(OperationContext* opCtx, BSONObjBuilder& b, const std::string& name) override {
+        b.append(name, spillCompressorName(getDefaultSpillCompressor()));
+    }
+
+    Status set(const BSONElement& newValueElement) override {
+        if (newValueElement.type() != String) {
+            return {ErrorCodes::BadValue,
+                    str::stream() << name() << " must be a string, but found "
+                                  << typeName(newValueElement.type())};
+        }
+        return setFromString(newValueElement.String());
+    }
+
+    Status setFromString(const std::string& str) override {
+        auto swCompressor = parseSpillCompressor(str);
+        if (!swCompressor.isOK()) {
+            return swCompressor.getStatus();
+        }
+        spillCompressor.store(static_cast<std::uint8_t>(swCompressor.getValue()));
+        return Status::OK();
+    }
+} sorterSpillCompressorParameter;
+
+Counter64 spilledBytes;
+Counter64 spilledUncompressedBytes;
+Counter64 readBytes;
+Counter64 checksumFailures;
+
+ServerStatusMetricField<Counter64> displaySpilledBytes("sorter.spill.bytesWritten",
+                                                       &spilledBytes);
+ServerStatusMetricField<Counter64> displaySpilledUncompressedBytes(
+    "sorter.spill.uncompressedBytesWritten", &spilledUncompressedBytes);
+ServerStatusMetricField<Counter64> displayReadBytes("sorter.spill.bytesRead", &readBytes);
+ServerStatusMetricField<Counter64> displayChecksumFailures("sorter.spill.checksumFailures",
+                                                           &checksumFailures);
+
+}  // namespace
+
+StringData spillCompressorName(SpillCompressor compressor) {
+    switch (compressor) {
+        case SpillCompressor::kNone:
+            return "none"_sd;
+        case SpillCompressor::kSnappy:
+            return "snappy"_sd;
+        case SpillCompressor::kZlib:
+            return "zlib"_sd;
+    }
+    MONGO_UNREACHABLE;
+}
+
+StatusWith<SpillCompressor> parseSpillCompressor(StringData name) {
+    for (auto compressor : {SpillCompressor::kNone, SpillCompressor::kSnappy,
+                            SpillCompressor::kZlib}) {
+        if (name == spillCompressorName(compressor)) {
+            return compressor;
+        }
+    }
+    return {ErrorCodes::BadValue,
+            str::stream() << "unknown sorter spill compressor '" << name
+                          << "', expected one of 'none', 'snappy' or 'zlib'"};
+}
+
+SpillCompressor getDefaultSpillCompressor() {
+    return static_cast<SpillCompressor>(spillCompressor.load());
+}
+
+bool getDefaultSpillChecksums() {
+    return sorterSpillChecksums.load();
+}
+
+bool spillAvoidsPageCache() {
+    return sorterSpillAvoidPageCache.load();
+}
+
+std::string getSpillDirectory() {
+    if (!sorterSpillDirectory.empty()) {
+        return sorterSpillDirectory;
+    }
+    return storageGlobalParams.dbpath + "/_tmp";
+}
+
+void removeLeftoverSpillFiles() {
+    if (sorterSpillDirectory.empty()) {
+        return;
+    }
+
+    // Errors are ignored, as the directory may not have been created yet.
+    boost::system::error_code ec;
+    std::vector<boost::filesystem::path> spillFiles;
+    for (boost::filesystem::directory_iterator it(sorterSpillDirectory, ec), end; !ec && it != end;
+         it.increment(ec)) {
+        if (str::startsWith(it->path().filename().string(), kSpillFileNamePrefix)) {
+            spillFiles.push_back(it->path());
+        }
+    }
+
+    for (const auto& spillFile : spillFiles) {
+        boost::filesystem::remove(spillFile, ec);
+    }
+}
+
+void SpillBlockHeader::writeTo(char* out) const {
+    DataView view(out);
+    view.write<LittleEndian<std::int32_t>>(diskSize, 0);
+    view.write<LittleEndian<std::int32_t>>(uncompressedSize, 4);
+    view.write<LittleEndian<std::uint8_t>>(static_cast<std::uint8_t>(compressor), 8);
+    view.write<LittleEndian<std::uint8_t>>(checksummed ? 1 : 0, 9);
+    view.write<LittleEndian<std::uint32_t>>(checksum, 10);
+}
+
+SpillBlockHeader SpillBlockHeader::readFrom(const char* in) {
+    ConstDataView view(in);
+    SpillBlockHeader header;
+    header.diskSize = view.read<LittleEndian<std::int32_t>>();
+    header.uncompressedSize = view.read<LittleEndian<std::int32_t>>(4);
+    const std::uint8_t compressor = view.read<LittleEndian<std::uint8_t>>(8);
+    header.checksummed = view.read<LittleEndian<std::uint8_t>>(9) != 0;
+    header.checksum = view.read<LittleEndian<std::uint32_t>>(10);
+
+    massert(40504,
+            str::stream() << "corrupt sorter spill block header: size " << header.diskSize
+                          << ", uncompressed size " << header.uncompressedSize
+                          << ", compressor " << static_cast<int>(compressor),
+            header.diskSize >= 0 && header.uncompressedSize >= 0 &&
+                compressor <= static_cast<std::uint8_t>(SpillCompressor::kZlib));
+    header.compressor = static_cast<SpillCompressor>(compressor);
+    return header;
+}
+
+SpillCompressor compressSpillBlock(SpillCompressor compressor,
+                                   const char* data,
+                                   std::size_t size,
+                                   std::string* out) {
+    // Only keep the compressed block if it saves at least 10% of the space.
+    const std::size_t maxCompressedSize = size / 10 * 9;
+
+    switch (compressor) {
+        case SpillCompressor::kNone:
+            return SpillCompressor::kNone;
+
+        case SpillCompressor::kSnappy: {
+            std::string compressed;
+            snappy::Compress(data, size, &compressed);
+            if (compressed.size() >= maxCompressedSize) {
+                return SpillCompressor::kNone;
+            }
+            out->swap(compressed);
+            return SpillCompressor::kSnappy;
+        }
+
+        case SpillCompressor::kZlib: {
+            std::string compressed(compressBound(size), '\0');
+            uLongf compressedSize = compressed.size();
+            // Spill files are short-lived, so favor speed over the compression ratio.
+            const int err = compress2(reinterpret_cast<Bytef*>(&compressed[0]),
+                                      &compressedSize,
+                                      reinterpret_cast<const Bytef*>(data),
+                                      size,
+                                      Z_BEST_SPEED);
+            massert(40505,
+                    str::stream() << "zlib compression of a sorter spill block failed with "
+                                  << err,
+                    err == Z_OK);
+            if (compressedSize >= maxCompressedSize) {
+                return SpillCompressor::kNone;
+            }
+            compressed.resize(compressedSize);
+            out->swap(compressed);
+            return SpillCompressor::kZlib;
+        }
+    }
+    MONGO_UNREACHABLE;
+}
+
+void uncompressSpillBlock(SpillCompressor compressor,
+                          const char* data,
+                          std::size_t size,
+                          char* out,
+                          std::size_t uncompressedSize) {
+    switch (compressor) {
+        case SpillCompressor::kNone:
+            verify(size == uncompressedSize);
+            memcpy(out, data, size);
+            return;
+
+        case SpillCompressor::kSnappy: {
+            size_t snappySize;
+            massert(17061,
+                    "couldn't get uncompressed length",
+                    snappy::GetUncompressedLength(data, size, &snappySize) &&
+                        snappySize == uncompressedSize);
+            massert(17062, "decompression failed", snappy::RawUncompress(data, size, out));
+            return;
+        }
+
+        case SpillCompressor::kZlib: {
+            uLongf outSize = uncompressedSize;
+            const int err = uncompress(reinterpret_cast<Bytef*>(out),
+                                       &outSize,
+                                       reinterpret_cast<const Bytef*>(data),
+                                       size);
+            massert(40506,
+                    str::stream() << "zlib decompression of a sorter spill block failed with "
+                                  << err,
+                    err == Z_OK && outSize == uncompressedSize);
+            return;
+        }
+    }
+    MONGO_UNREACHABLE;
+}
+
+std::uint32_t spillBlockChecksum(const char* data, std::size_t size) {
+    return crc32(crc32(0L, Z_NULL, 0), reinterpret_cast<const Bytef*>(data), size);
+}
+
+void recordSpillBlockWritten(std::size_t uncompressedSize, std::size_t diskSize) {
+    spilledUncompressedBytes.increment(uncompressedSize);
+    spilledBytes.increment(diskSize);
+}
+
+void recordSpillBlockRead(std::size_t diskSize) {
+    readBytes.increment(diskSize);
+}
+
+void recordSpillChecksumFailure() {
+    checksumFailures.increment();
+}
+
+SpillFileCacheAdvisor::SpillFileCacheAdvisor(const std::string& fileName) {
+#ifdef POSIX_FADV_DONTNEED
+    if (spillAvoidsPageCache()) {
+        // A failure to open the file only means that its pages stay cached.
+        _fd = ::open(fileName.c_str(), O_RDONLY);
+    }
+#endif
+}
+
+SpillFileCacheAdvisor::~SpillFileCacheAdvisor() {
+#ifdef POSIX_FADV_DONTNEED
+    if (_fd >= 0) {
+        ::close(_fd);
+    }
+#endif
+}
+
+void SpillFileCacheAdvisor::dontNeed(std::int64_t offset, std::int64_t length) {
+#ifdef POSIX_FADV_DONTNEED
+    if (_fd >= 0 && length > 0) {
+        posix_fadvise(_fd, offset, length, POSIX_FADV_DONTNEED);
+    }
+#endif
+}
+
+void SpillFileCacheAdvisor::dontNeedWritten(std::int64_t offset, std::int64_t length) {
+#ifdef POSIX_FADV_DONTNEED
+    if (_fd < 0 || length <= 0) {
+        return;
+    }
+
+    // If the writeback fails the pages simply stay cached; a read of the block reports any error.
+    if (
+#if defined(__linux__)
+        sync_file_range(_fd,
+                        offset,
+                        length,
+                        SYNC_FILE_RANGE_WAIT_BEFORE | SYNC_FILE_RANGE_WRITE |
+                            SYNC_FILE_RANGE_WAIT_AFTER) < 0
+#else
+        fsync(_fd) < 0
+#endif
+        ) {
+        return;
+    }
+    posix_fadvise(_fd, offset, length, POSIX_FADV_DONTNEED);
+#endif
+}
+
+}  // namespace sorter
+}  // namespace mongo
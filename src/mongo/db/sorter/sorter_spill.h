@@ -0,0 +1,176 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status_with.h"
+#include "mongo/base/string_data.h"
+
+/**
+ * Non-templated support for the on-disk format of the Sorter's spill files. This lives in its own
+ * library because sorter.cpp is compiled into every translation unit that instantiates a Sorter.
+ */
+
+namespace mongo {
+namespace sorter {
+
+/**
+ * The codec used to compress a block of a spill file. The numeric values are written to disk and
+ * must not be changed.
+ */
+enum class SpillCompressor : std::uint8_t {
+    kNone = 0,
+    kSnappy = 1,
+    kZlib = 2,
+};
+
+StringData spillCompressorName(SpillCompressor compressor);
+StatusWith<SpillCompressor> parseSpillCompressor(StringData name);
+
+/**
+ * The current values of the 'sorterSpillCompressor', 'sorterSpillChecksums' and
+ * 'sorterSpillAvoidPageCache' server parameters.
+ */
+SpillCompressor getDefaultSpillCompressor();
+bool getDefaultSpillChecksums();
+bool spillAvoidsPageCache();
+
+/**
+ * Returns the directory that external sorts should spill to: the 'sorterSpillDirectory' server
+ * parameter if it was set at startup, and <dbpath>/_tmp otherwise.
+ */
+std::string getSpillDirectory();
+
+/**
+ * The names of spill files start with this prefix, followed by a number.
+ */
+const char kSpillFileNamePrefix[] = "extsort.";
+
+/**
+ * Removes the spill files left in the 'sorterSpillDirectory' by a previous run of the server.
+ * Since that directory need not belong to the server, only files named like spill files are
+ * removed, and a server must not share it with another running server. Does nothing if the
+ * parameter was not set, since <dbpath>/_tmp is removed as a whole at startup.
+ */
+void removeLeftoverSpillFiles();
+
+/**
+ * Describes a block of a spill file. The header is written in front of the block's data, which
+ * is 'diskSize' bytes long and decompresses to 'uncompressedSize' bytes with 'compressor'.
+ */
+struct SpillBlockHeader {
+    static const std::size_t kSize = 14;
+
+    void writeTo(char* out) const;
+    static SpillBlockHeader readFrom(const char* in);
+
+    std::int32_t diskSize = 0;
+    std::int32_t uncompressedSize = 0;
+    SpillCompressor compressor = SpillCompressor::kNone;
+    bool checksummed = false;
+    std::uint32_t checksum = 0;
+};
+
+/**
+ * Compresses 'size' bytes at 'data' with 'compressor' into 'out'. Returns the codec that was
+ * actually used, which is kNone if compression would not have saved at least 10% of the space,
+ * in which case 'out' is left untouched.
+ */
+SpillCompressor compressSpillBlock(SpillCompressor compressor,
+                                   const char* data,
+                                   std::size_t size,
+                                   std::string* out);
+
+/**
+ * Decompresses a block written by compressSpillBlock() into 'out', which must have room for
+ * 'uncompressedSize' bytes. Throws on corrupt input.
+ */
+void uncompressSpillBlock(SpillCompressor compressor,
+                          const char* data,
+                          std::size_t size,
+                          char* out,
+                          std::size_t uncompressedSize);
+
+/**
+ * Returns the CRC-32 of 'size' bytes at 'data'.
+ */
+std::uint32_t spillBlockChecksum(const char* data, std::size_t size);
+
+/**
+ * Updates the 'sorter.spill' serverStatus metrics.
+ */
+void recordSpillBlockWritten(std::size_t uncompressedSize, std::size_t diskSize);
+void recordSpillBlockRead(std::size_t diskSize);
+void recordSpillChecksumFailure();
+
+/**
+ * Advises the kernel that ranges of a spill file which have been written or read will not be
+ * needed again, so that spilling a large sort does not evict the storage engine's working set
+ * from the page cache. Does nothing unless the 'sorterSpillAvoidPageCache' server parameter was
+ * enabled when the advisor was constructed, or on platforms without posix_fadvise().
+ *
+ * The advisor holds a file descriptor of its own, since the streams the Sorter reads and writes
+ * with do not expose theirs. The writer of a spill file hands its advisor on to the iterator which
+ * reads the file back, so that each spill file costs at most one extra descriptor.
+ */
+class SpillFileCacheAdvisor {
+    MONGO_DISALLOW_COPYING(SpillFileCacheAdvisor);
+
+public:
+    explicit SpillFileCacheAdvisor(const std::string& fileName);
+    ~SpillFileCacheAdvisor();
+
+    bool enabled() const {
+        return _fd >= 0;
+    }
+
+    /**
+     * Drops the cached pages in ['offset', 'offset' + 'length'). Data written to the file must
+     * have been flushed to the kernel for this to have any effect.
+     */
+    void dontNeed(std::int64_t offset, std::int64_t length);
+
+    /**
+     * Like dontNeed(), but for a range that was just written: the dirty pages are written back
+     * first, since the kernel will not drop them otherwise. The data must already have been
+     * flushed to the kernel.
+     */
+    void dontNeedWritten(std::int64_t offset, std::int64_t length);
+
+private:
+    int _fd = -1;
+};
+
+}  // namespace sorter
+}  // namespace mongo
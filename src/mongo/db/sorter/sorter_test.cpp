@@ -31,6 +31,7 @@
 #include "mongo/db/sorter/sorter.h"
 
 #include <boost/filesystem.hpp>
+#include <fstream>
 
 #include "mongo/base/data_type_endian.h"
 #include "mongo/base/init.h"
@@ -276,6 +277,70 @@ public:
     }
 };
 
+class SpillCompressionTests {
+public:
+    void run() {
+        unittest::TempDir tempDir("spillCompressionTests");
+        for (auto compressor :
+             {SpillCompressor::kNone, SpillCompressor::kSnappy, SpillCompressor::kZlib}) {
+            for (bool checksums : {false, true}) {
+                const SortOptions opts = SortOptions()
+                                             .TempDir(tempDir.path())
+                                             .SpillCompression(compressor)
+                                             .SpillChecksums(checksums);
+                SortedFileWriter<IntWrapper, IntWrapper> sorter(opts);
+                for (int i = 0; i < 100 * 1000; i++)
+                    sorter.addAlreadySorted(i, -i);
+
+                ASSERT_ITERATORS_EQUIVALENT(std::shared_ptr<IWIterator>(sorter.done()),
+                                            make_shared<IntIterator>(0, 100 * 1000));
+            }
+        }
+
+        {  // blocks that don't shrink are written uncompressed
+            const std::string block = "0123456789abcdef";
+            std::string compressed;
+            ASSERT(SpillCompressor::kNone ==
+                   compressSpillBlock(
+                       SpillCompressor::kZlib, block.data(), block.size(), &compressed));
+            ASSERT(compressed.empty());
+        }
+
+        ASSERT(SpillCompressor::kZlib == parseSpillCompressor("zlib").getValue());
+        ASSERT_EQ(ErrorCodes::BadValue, parseSpillCompressor("zstd").getStatus().code());
+        ASSERT(boost::filesystem::is_empty(tempDir.path()));
+    }
+};
+
+class SpillChecksumTests {
+public:
+    void run() {
+        unittest::TempDir tempDir("spillChecksumTests");
+        const SortOptions opts = SortOptions()
+                                     .TempDir(tempDir.path())
+                                     .SpillCompression(SpillCompressor::kSnappy)
+                                     .SpillChecksums(true);
+        SortedFileWriter<IntWrapper, IntWrapper> sorter(opts);
+        for (int i = 0; i < 100 * 1000; i++)
+            sorter.addAlreadySorted(i, -i);
+        std::shared_ptr<IWIterator> iter(sorter.done());
+
+        // Flip a byte of the first block's data, which the iterator has not read yet.
+        const std::string fileName =
+            boost::filesystem::directory_iterator(tempDir.path())->path().string();
+        {
+            std::fstream file(fileName, std::ios::in | std::ios::out | std::ios::binary);
+            file.seekg(SpillBlockHeader::kSize + 10);
+            char byte = file.get();
+            file.seekp(SpillBlockHeader::kSize + 10);
+            file.put(~byte);
+            ASSERT(file.good());
+        }
+
+        ASSERT_THROWS_CODE(iter->more(), MsgAssertionException, 40507);
+    }
+};
+
 
 class MergeIteratorTests {
 public:
@@ -550,6 +615,8 @@ public:
     void setupTests() {
         add<InMemIterTests>();
         add<SortedFileWriterAndFileIteratorTests>();
+        add<SpillCompressionTests>();
+        add<SpillChecksumTests>();
         add<MergeIteratorTests>();
         add<SorterTests::Basic>();
         add<SorterTests::Limit>();
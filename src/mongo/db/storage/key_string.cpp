@@ -1747,12 +1747,18 @@ std::string KeyString::toString() const {
 }
 
 int KeyString::compare(const KeyString& other) const {
-    int a = getSize();
-    int b = other.getSize();
+    return compare(getBuffer(), getSize(), other.getBuffer(), other.getSize());
+}
 
-    int min = std::min(a, b);
+int KeyString::compare(const char* lhs,
+                       size_t lhsSize,
+                       const char* rhs,
+                       size_t rhsSize,
+                       size_t sharedPrefixLength) {
+    const size_t min = std::min(lhsSize, rhsSize);
+    dassert(sharedPrefixLength <= min);
 
-    int cmp = memcmp(getBuffer(), other.getBuffer(), min);
+    int cmp = memcmp(lhs + sharedPrefixLength, rhs + sharedPrefixLength, min - sharedPrefixLength);
 
     if (cmp) {
         if (cmp < 0)
@@ -1762,10 +1768,33 @@ int KeyString::compare(const KeyString& other) const {
 
     // keys match
 
-    if (a == b)
+    if (lhsSize == rhsSize)
         return 0;
 
-    return a < b ? -1 : 1;
+    return lhsSize < rhsSize ? -1 : 1;
+}
+
+size_t KeyString::commonPrefixLength(const char* lhs,
+                                     size_t lhsSize,
+                                     const char* rhs,
+                                     size_t rhsSize,
+                                     size_t knownPrefixLength) {
+    const size_t min = std::min(lhsSize, rhsSize);
+    dassert(knownPrefixLength <= min);
+
+    size_t pos = knownPrefixLength;
+    for (; pos + sizeof(uint64_t) <= min; pos += sizeof(uint64_t)) {
+        // Reading big-endian puts the first differing byte in the highest differing bits.
+        const uint64_t diff = endian::bigToNative(ConstDataView(lhs + pos).read<uint64_t>()) ^
+            endian::bigToNative(ConstDataView(rhs + pos).read<uint64_t>());
+        if (diff)
+            return pos + countLeadingZeros64(diff) / 8;
+    }
+
+    while (pos < min && lhs[pos] == rhs[pos]) {
+        ++pos;
+    }
+    return pos;
 }
 
 void KeyString::TypeBits::resetFromBuffer(BufReader* reader) {
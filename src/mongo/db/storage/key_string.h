@@ -324,6 +324,18 @@ public:
         memcpy(_buffer.skip(size), buffer, size);
     }
 
+    /**
+     * Like resetFromBuffer() above, but only copies the bytes after the first
+     * 'sharedPrefixLength', which the caller knows this key already has in common with 'buffer'.
+     */
+    void resetFromBuffer(const void* buffer, size_t size, size_t sharedPrefixLength) {
+        dassert(sharedPrefixLength <= getSize() && sharedPrefixLength <= size);
+        _buffer.setlen(sharedPrefixLength);
+        memcpy(_buffer.skip(size - sharedPrefixLength),
+               static_cast<const char*>(buffer) + sharedPrefixLength,
+               size - sharedPrefixLength);
+    }
+
     const char* getBuffer() const {
         return _buffer.buf();
     }
@@ -340,6 +352,26 @@ public:
 
     int compare(const KeyString& other) const;
 
+    /**
+     * Compares two encoded keys the way compare() does, skipping the first 'sharedPrefixLength'
+     * bytes, which the caller knows the keys have in common.
+     */
+    static int compare(const char* lhs,
+                       size_t lhsSize,
+                       const char* rhs,
+                       size_t rhsSize,
+                       size_t sharedPrefixLength = 0);
+
+    /**
+     * Returns the number of leading bytes two encoded keys have in common, comparing them a
+     * machine word at a time. The first 'knownPrefixLength' bytes are assumed to be equal.
+     */
+    static size_t commonPrefixLength(const char* lhs,
+                                     size_t lhsSize,
+                                     const char* rhs,
+                                     size_t rhsSize,
+                                     size_t knownPrefixLength = 0);
+
     /**
      * @return a hex encoding of this key
      */
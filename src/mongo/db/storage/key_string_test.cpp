@@ -37,6 +37,7 @@
 #include <limits>
 #include <memory>
 #include <random>
+#include <string>
 #include <typeinfo>
 #include <vector>
 
@@ -1089,6 +1090,48 @@ TEST_F(KeyStringTest, RecordIds) {
     }
 }
 
+TEST_F(KeyStringTest, CommonPrefixLength) {
+    std::mt19937 gen(12345);
+    std::uniform_int_distribution<int> byte(0, 255);
+    std::uniform_int_distribution<size_t> length(0, 40);
+
+    for (int i = 0; i < 10000; ++i) {
+        std::string lhs(length(gen), '\0');
+        for (auto& c : lhs)
+            c = static_cast<char>(byte(gen));
+
+        // Make 'rhs' share a random prefix of 'lhs', then diverge in a random way.
+        std::string rhs = lhs.substr(0, std::uniform_int_distribution<size_t>(0, lhs.size())(gen));
+        const size_t extra = length(gen) % 12;
+        for (size_t j = 0; j < extra; ++j)
+            rhs.push_back(static_cast<char>(byte(gen)));
+
+        size_t expected = 0;
+        while (expected < std::min(lhs.size(), rhs.size()) && lhs[expected] == rhs[expected])
+            ++expected;
+
+        const size_t known = std::uniform_int_distribution<size_t>(0, expected)(gen);
+        ASSERT_EQ(expected,
+                  KeyString::commonPrefixLength(
+                      lhs.data(), lhs.size(), rhs.data(), rhs.size(), known));
+
+        // Comparing after any known shared prefix agrees with comparing the whole keys.
+        KeyString lhsKey(version);
+        KeyString rhsKey(version);
+        lhsKey.resetFromBuffer(lhs.data(), lhs.size());
+        rhsKey.resetFromBuffer(rhs.data(), rhs.size());
+        const int cmp = lhsKey.compare(rhsKey);
+        ASSERT_EQ(cmp,
+                  KeyString::compare(lhs.data(), lhs.size(), rhs.data(), rhs.size(), expected));
+        ASSERT_EQ(cmp, KeyString::compare(lhs.data(), lhs.size(), rhs.data(), rhs.size(), known));
+        ASSERT_EQ(-cmp, rhsKey.compare(lhsKey));
+
+        // Resetting to a key while keeping the shared prefix gives the same key as copying it.
+        lhsKey.resetFromBuffer(rhs.data(), rhs.size(), known);
+        ASSERT_EQ(0, lhsKey.compare(rhsKey));
+    }
+}
+
 namespace {
 const uint64_t kMinPerfMicros = 20 * 1000;
 const uint64_t kMinPerfSamples = 50 * 1000;
@@ -1251,3 +1294,56 @@ TEST_F(KeyStringTest, DecimalFromUniformDoublePerf) {
     }
     perfTest(version, numbers);
 }
+
+TEST_F(KeyStringTest, SortedKeyComparePerf) {
+    // Compound keys with a long common leading field, as consecutive entries of an index scan
+    // would have. Compares each key with the next one and with a fixed end key, once comparing
+    // whole keys and once skipping the prefix known to be shared with the end key.
+    std::vector<std::string> keys;
+    const std::string prefix(48, 'x');
+    for (uint64_t x = 0; x < kMinPerfSamples; x++) {
+        const KeyString ks(
+            version, BSON("" << prefix << "" << static_cast<long long>(x)), ALL_ASCENDING);
+        keys.emplace_back(ks.getBuffer(), ks.getSize());
+    }
+    const KeyString end(version,
+                        BSON("" << prefix << "" << static_cast<long long>(kMinPerfSamples)),
+                        ALL_ASCENDING,
+                        KeyString::kExclusiveBefore);
+
+    for (bool skipSharedPrefix : {false, true}) {
+        uint64_t micros = 0;
+        uint64_t iters;
+        for (iters = 1; iters < (1 << 30) && micros < kMinPerfMicros; iters *= 2) {
+            Timer t;
+            for (uint64_t i = 0; i < iters; i++) {
+                size_t endShared = 0;
+                for (size_t k = 1; k < keys.size(); k++) {
+                    const std::string& prev = keys[k - 1];
+                    const std::string& key = keys[k];
+                    size_t shared = 0;
+                    if (skipSharedPrefix) {
+                        shared = KeyString::commonPrefixLength(
+                            prev.data(), prev.size(), key.data(), key.size());
+                        invariant(shared >= endShared);
+                        endShared = KeyString::commonPrefixLength(
+                            key.data(), key.size(), end.getBuffer(), end.getSize(), endShared);
+                    }
+                    invariant(KeyString::compare(
+                                  prev.data(), prev.size(), key.data(), key.size(), shared) < 0);
+                    invariant(KeyString::compare(key.data(),
+                                                 key.size(),
+                                                 end.getBuffer(),
+                                                 end.getSize(),
+                                                 endShared) < 0);
+                }
+            }
+            micros = t.micros();
+        }
+
+        log() << 1E3 * micros / static_cast<double>(iters * (keys.size() - 1)) << " ns per "
+              << mongo::KeyString::versionToString(version) << " key step"
+              << (skipSharedPrefix ? " skipping the shared prefix" : " comparing whole keys")
+              << (kDebugBuild ? " (DEBUG BUILD!)" : "");
+    }
+}
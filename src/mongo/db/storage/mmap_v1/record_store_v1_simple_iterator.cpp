@@ -84,6 +84,22 @@ boost::optional<Record> SimpleRecordStoreV1Iterator::next() {
     return {{toReturn, _recordStore->RecordStore::dataFor(_opCtx, toReturn)}};
 }
 
+size_t SimpleRecordStoreV1Iterator::nextBatch(std::vector<Record>* batch, size_t maxRecords) {
+    size_t numAppended = 0;
+    while (numAppended < maxRecords && !isEOF()) {
+        // End the batch before a record that is not in memory, so that the caller can yield its
+        // locks while the record is paged in.
+        if (numAppended > 0 && fetcherForNext())
+            break;
+
+        auto id = _curr.toRecordId();
+        advance();
+        batch->push_back({id, _recordStore->RecordStore::dataFor(_opCtx, id).getOwned()});
+        ++numAppended;
+    }
+    return numAppended;
+}
+
 boost::optional<Record> SimpleRecordStoreV1Iterator::seekExact(const RecordId& id) {
     _curr = DiskLoc::fromRecordId(id);
     advance();
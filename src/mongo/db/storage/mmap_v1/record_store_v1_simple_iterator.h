@@ -48,6 +48,7 @@ public:
                                 bool forward);
 
     boost::optional<Record> next() final;
+    size_t nextBatch(std::vector<Record>* batch, size_t maxRecords) final;
     boost::optional<Record> seekExact(const RecordId& id) final;
     void save() final;
     bool restore() final;
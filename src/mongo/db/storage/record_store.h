@@ -31,6 +31,7 @@
 #pragma once
 
 #include <boost/optional.hpp>
+#include <vector>
 
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/bson/mutable/damage_vector.h"
@@ -38,6 +39,7 @@
 #include "mongo/db/record_id.h"
 #include "mongo/db/storage/record_data.h"
 #include "mongo/db/storage/record_fetcher.h"
+#include "mongo/util/assert_util.h"
 
 namespace mongo {
 
@@ -153,6 +155,30 @@ public:
      */
     virtual boost::optional<Record> next() = 0;
 
+    /**
+     * Moves forward as next() would, appending up to 'maxRecords' records to 'batch', and returns
+     * the number of records appended. Returns 0 only at EOF, but a cursor may end a batch early,
+     * for example before a record that would need to be fetched from secondary storage.
+     *
+     * Unlike the data returned by next(), the appended records own their data and so remain valid
+     * across save() and restore(). If this throws, the records appended before the exception
+     * remain in 'batch' and the cursor is positioned after the last of them.
+     *
+     * Storage engines should override this if they can produce records more cheaply in bulk than
+     * through repeated virtual calls to next().
+     */
+    virtual size_t nextBatch(std::vector<Record>* batch, size_t maxRecords) {
+        size_t numAppended = 0;
+        while (numAppended < maxRecords) {
+            auto record = next();
+            if (!record)
+                break;
+            batch->push_back({record->id, record->data.getOwned()});
+            ++numAppended;
+        }
+        return numAppended;
+    }
+
     //
     // Saving and restoring state
     //
@@ -248,6 +274,18 @@ public:
      */
     virtual boost::optional<Record> seekExact(const RecordId& id) = 0;
 
+    /**
+     * Seeks to the first Record at or after the provided id in the direction of the cursor, and
+     * returns it, or boost::none if there is no such Record. The following call to next() returns
+     * the Record after it.
+     *
+     * Only storage engines whose RecordIds do not depend on a record's location, which are those
+     * that support document-level locking, need to implement this.
+     */
+    virtual boost::optional<Record> seekNear(const RecordId& id) {
+        MONGO_UNREACHABLE;
+    }
+
     /**
      * Prepares for state changes in underlying data without necessarily saving the current
      * state.
@@ -0,0 +1,210 @@
+// record_store_test_nextbatch.cpp
+
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/record_store_test_harness.h"
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "mongo/db/record_id.h"
+#include "mongo/db/storage/record_data.h"
+#include "mongo/db/storage/record_store.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+namespace {
+
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+/**
+ * Inserts 'nToInsert' records into 'rs' and returns their RecordIds, sorted, and their data, in
+ * the same order.
+ */
+void insertRecords(RecordStoreHarnessHelper* harnessHelper,
+                   RecordStore* rs,
+                   int nToInsert,
+                   vector<RecordId>* ids,
+                   vector<string>* datas) {
+    vector<std::pair<RecordId, string>> records;
+    ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+    for (int i = 0; i < nToInsert; i++) {
+        string data = str::stream() << "record " << i;
+
+        WriteUnitOfWork uow(opCtx.get());
+        StatusWith<RecordId> res =
+            rs->insertRecord(opCtx.get(), data.c_str(), data.size() + 1, false);
+        ASSERT_OK(res.getStatus());
+        uow.commit();
+        records.emplace_back(res.getValue(), data);
+    }
+
+    // Inserted records may not be in RecordId order.
+    std::sort(records.begin(), records.end());
+    for (auto&& record : records) {
+        ids->push_back(record.first);
+        datas->push_back(record.second);
+    }
+}
+
+// Read all of the records in batches, in both directions. A batch is only short at EOF, and the
+// cursor stays at EOF.
+TEST(RecordStoreTestHarness, NextBatchReturnsAllRecords) {
+    const auto harnessHelper(newRecordStoreHarnessHelper());
+    unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
+
+    const int nToInsert = 100;
+    vector<RecordId> ids;
+    vector<string> datas;
+    insertRecords(harnessHelper.get(), rs.get(), nToInsert, &ids, &datas);
+
+    for (bool forward : {true, false}) {
+        if (!forward) {
+            std::reverse(ids.begin(), ids.end());
+            std::reverse(datas.begin(), datas.end());
+        }
+
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        auto cursor = rs->getCursor(opCtx.get(), forward);
+
+        vector<Record> batch;
+        size_t appended;
+        while ((appended = cursor->nextBatch(&batch, 7)) > 0) {
+            ASSERT_LTE(appended, 7U);
+        }
+        ASSERT_EQUALS(0U, cursor->nextBatch(&batch, 7));
+        ASSERT(!cursor->next());
+
+        ASSERT_EQUALS(static_cast<size_t>(nToInsert), batch.size());
+        for (int i = 0; i < nToInsert; i++) {
+            ASSERT_EQUALS(ids[i], batch[i].id);
+            ASSERT_EQUALS(datas[i], batch[i].data.data());
+            ASSERT(batch[i].data.isOwned());
+        }
+    }
+}
+
+// Calls to next() and nextBatch() can be interleaved, and the records from a batch stay valid
+// after the cursor is saved and restored.
+TEST(RecordStoreTestHarness, NextBatchInterleavedWithNextAndSaveRestore) {
+    const auto harnessHelper(newRecordStoreHarnessHelper());
+    unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
+
+    const int nToInsert = 20;
+    vector<RecordId> ids;
+    vector<string> datas;
+    insertRecords(harnessHelper.get(), rs.get(), nToInsert, &ids, &datas);
+
+    ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+    auto cursor = rs->getCursor(opCtx.get());
+
+    vector<Record> batch;
+    int i = 0;
+    while (i < nToInsert) {
+        const auto record = cursor->next();
+        ASSERT(record);
+        ASSERT_EQUALS(ids[i], record->id);
+        ASSERT_EQUALS(datas[i], record->data.data());
+        i++;
+
+        batch.clear();
+        const size_t appended = cursor->nextBatch(&batch, 3);
+        ASSERT_EQUALS(appended, batch.size());
+
+        cursor->save();
+        opCtx->recoveryUnit()->abandonSnapshot();
+        ASSERT(cursor->restore());
+
+        for (auto&& batchRecord : batch) {
+            ASSERT_EQUALS(ids[i], batchRecord.id);
+            ASSERT_EQUALS(datas[i], batchRecord.data.data());
+            i++;
+        }
+    }
+    ASSERT_EQUALS(nToInsert, i);
+    ASSERT(!cursor->next());
+}
+
+// Compares the throughput of scanning a collection a record at a time with scanning it in
+// batches. This only logs its measurements, as timings are too noisy to assert on.
+TEST(RecordStoreTestHarness, NextBatchScanThroughput) {
+    const auto harnessHelper(newRecordStoreHarnessHelper());
+    unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
+
+    const int nToInsert = 10000;
+    vector<RecordId> ids;
+    vector<string> datas;
+    insertRecords(harnessHelper.get(), rs.get(), nToInsert, &ids, &datas);
+
+    const int kScans = 10;
+    ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+
+    Timer nextTimer;
+    long long nextBytes = 0;
+    for (int scan = 0; scan < kScans; scan++) {
+        auto cursor = rs->getCursor(opCtx.get());
+        while (auto record = cursor->next()) {
+            nextBytes += record->data.size();
+        }
+    }
+    const long long nextMicros = std::max(nextTimer.micros(), 1LL);
+
+    Timer batchTimer;
+    long long batchBytes = 0;
+    vector<Record> batch;
+    for (int scan = 0; scan < kScans; scan++) {
+        auto cursor = rs->getCursor(opCtx.get());
+        do {
+            batch.clear();
+            cursor->nextBatch(&batch, 64);
+            for (auto&& record : batch) {
+                batchBytes += record.data.size();
+            }
+        } while (!batch.empty());
+    }
+    const long long batchMicros = std::max(batchTimer.micros(), 1LL);
+
+    ASSERT_EQUALS(nextBytes, batchBytes);
+    log() << "scanned " << kScans * nToInsert << " records: next() "
+          << kScans * nToInsert * 1000000LL / nextMicros << " records/sec, nextBatch() "
+          << kScans * nToInsert * 1000000LL / batchMicros << " records/sec";
+}
+
+}  // namespace
+}  // namespace mongo
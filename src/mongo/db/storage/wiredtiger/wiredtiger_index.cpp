@@ -685,6 +685,7 @@ public:
         if (key.isEmpty()) {
             // This means scan to end of index.
             _endPosition.reset();
+            _endPositionSharedPrefix = 0;
             return;
         }
 
@@ -694,6 +695,7 @@ public:
             _forward == inclusive ? KeyString::kExclusiveAfter : KeyString::kExclusiveBefore;
         _endPosition = stdx::make_unique<KeyString>(_idx.keyStringVersion());
         _endPosition->resetToKey(stripFieldNames(key), _idx.ordering(), discriminator);
+        _endPositionSharedPrefix = 0;
     }
 
     boost::optional<IndexKeyEntry> seek(const BSONObj& key,
@@ -818,6 +820,42 @@ protected:
         }
     }
 
+    /**
+     * Like atOrPastEndPointAfterSeeking(), but avoids comparing the prefix that _key is known to
+     * share with the end position when the cursor stepped from the previous key in the direction
+     * of the scan, and then shares 'sharedWithPrevious' bytes with that key. Updates
+     * _endPositionSharedPrefix for the next step.
+     */
+    bool atOrPastEndPointAfterStepping(bool movedInScanDirection, size_t sharedWithPrevious) {
+        if (!_endPosition)
+            return false;
+
+        size_t knownPrefix = 0;
+        if (movedInScanDirection) {
+            // The previous key matched the end position for _endPositionSharedPrefix bytes. If
+            // the new key moved away from the previous key within those bytes, it moved past the
+            // end position at the same byte.
+            if (sharedWithPrevious < _endPositionSharedPrefix)
+                return true;
+            knownPrefix = _endPositionSharedPrefix;
+        }
+
+        _endPositionSharedPrefix = KeyString::commonPrefixLength(_key.getBuffer(),
+                                                                 _key.getSize(),
+                                                                 _endPosition->getBuffer(),
+                                                                 _endPosition->getSize(),
+                                                                 knownPrefix);
+        const int cmp = KeyString::compare(_key.getBuffer(),
+                                           _key.getSize(),
+                                           _endPosition->getBuffer(),
+                                           _endPosition->getSize(),
+                                           _endPositionSharedPrefix);
+
+        // See atOrPastEndPointAfterSeeking().
+        dassert(cmp != 0);
+        return _forward ? cmp > 0 : cmp < 0;
+    }
+
     void advanceWTCursor() {
         WT_CURSOR* c = _cursor->get();
         int ret = WT_READ_CHECK(_forward ? c->next(c) : c->prev(c));
@@ -880,35 +918,50 @@ protected:
         WT_ITEM item;
         invariantWTOK(c->get_key(c, &item));
 
-        const auto isForwardNextCall = _forward && inNext && !_key.isEmpty();
-        if (isForwardNextCall) {
-            // Due to a bug in wired tiger (SERVER-21867) sometimes calling next
-            // returns something prev.
-            const int cmp =
-                std::memcmp(_key.getBuffer(), item.data, std::min(_key.getSize(), item.size));
-            bool nextNotIncreasing = cmp > 0 || (cmp == 0 && _key.getSize() > item.size);
-
-            if (MONGO_FAIL_POINT(WTEmulateOutOfOrderNextIndexKey)) {
-                log() << "WTIndex::updatePosition simulating next key not increasing.";
-                nextNotIncreasing = true;
-            }
-
-            if (nextNotIncreasing) {
-                // Our new key is less than the old key which means the next call moved to !next.
-                log() << "WTIndex::updatePosition -- the new key ( "
-                      << redact(toHex(item.data, item.size)) << ") is less than the previous key ("
-                      << redact(_key.toString()) << "), which is a bug.";
-
-                // Force a retry of the operation from our last known position by acting as-if
-                // we received a WT_ROLLBACK error.
-                throw WriteConflictException();
+        // When stepping to the next key, find how much of it is shared with the previous key, so
+        // that only the rest needs to be compared against the previous key and the end position.
+        size_t sharedWithPrevious = 0;
+        bool movedInScanDirection = false;
+        if (inNext && !_key.isEmpty()) {
+            sharedWithPrevious = KeyString::commonPrefixLength(
+                _key.getBuffer(), _key.getSize(), static_cast<const char*>(item.data), item.size);
+            const int cmp = KeyString::compare(_key.getBuffer(),
+                                               _key.getSize(),
+                                               static_cast<const char*>(item.data),
+                                               item.size,
+                                               sharedWithPrevious);
+            movedInScanDirection = _forward ? cmp < 0 : cmp > 0;
+
+            if (_forward) {
+                // Due to a bug in wired tiger (SERVER-21867) sometimes calling next
+                // returns something prev.
+                bool nextNotIncreasing = cmp > 0;
+
+                if (MONGO_FAIL_POINT(WTEmulateOutOfOrderNextIndexKey)) {
+                    log() << "WTIndex::updatePosition simulating next key not increasing.";
+                    nextNotIncreasing = true;
+                }
+
+                if (nextNotIncreasing) {
+                    // Our new key is less than the old key which means the next call moved to
+                    // !next.
+                    log() << "WTIndex::updatePosition -- the new key ( "
+                          << redact(toHex(item.data, item.size))
+                          << ") is less than the previous key (" << redact(_key.toString())
+                          << "), which is a bug.";
+
+                    // Force a retry of the operation from our last known position by acting
+                    // as-if we received a WT_ROLLBACK error.
+                    throw WriteConflictException();
+                }
             }
         }
 
-        // Store (a copy of) the new item data as the current key for this cursor.
-        _key.resetFromBuffer(item.data, item.size);
+        // Store (a copy of) the new item data as the current key for this cursor. Only the bytes
+        // after the prefix shared with the previous key need to be copied.
+        _key.resetFromBuffer(item.data, item.size, sharedWithPrevious);
 
-        if (atOrPastEndPointAfterSeeking()) {
+        if (atOrPastEndPointAfterStepping(movedInScanDirection, sharedWithPrevious)) {
             _eof = true;
             return;
         }
@@ -939,6 +992,10 @@ protected:
     KeyString _query;
 
     std::unique_ptr<KeyString> _endPosition;
+
+    // The number of leading bytes _key has in common with *_endPosition, as of the last call to
+    // updatePosition(). Zero is always a safe value.
+    size_t _endPositionSharedPrefix = 0;
 };
 
 class WiredTigerIndexStandardCursor final : public WiredTigerIndexCursorBase {
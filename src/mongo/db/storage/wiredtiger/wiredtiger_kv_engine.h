@@ -138,6 +138,10 @@ public:
     WT_CONNECTION* getConnection() {
         return _conn;
     }
+
+    WiredTigerSessionCache* getSessionCache() const {
+        return _sessionCache.get();
+    }
     void dropSomeQueuedIdents();
     bool haveDropsQueued() const;
 
@@ -445,67 +445,78 @@ public:
     }
 
     boost::optional<Record> next() final {
-        if (_eof)
+        RecordId id;
+        WT_ITEM value;
+        if (!_advance(&id, &value))
             return {};
 
-        WT_CURSOR* c = _cursor->get();
+        return {{id, {static_cast<const char*>(value.data), static_cast<int>(value.size)}}};
+    }
 
-        if (!_skipNextAdvance) {
-            // Nothing after the next line can throw WCEs.
-            // Note that an unpositioned (or eof) WT_CURSOR returns the first/last entry in the
-            // table when you call next/prev.
-            int advanceRet = WT_READ_CHECK(_forward ? c->next(c) : c->prev(c));
-            if (advanceRet == WT_NOTFOUND) {
-                _eof = true;
-                return {};
-            }
-            invariantWTOK(advanceRet);
+    size_t nextBatch(std::vector<Record>* batch, size_t maxRecords) final {
+        size_t numAppended = 0;
+        RecordId id;
+        WT_ITEM value;
+        while (numAppended < maxRecords && _advance(&id, &value)) {
+            // WiredTiger only guarantees 'value' until the cursor moves again, so copy it out.
+            auto buffer = SharedBuffer::allocate(value.size);
+            memcpy(buffer.get(), value.data, value.size);
+            batch->push_back({id, {std::move(buffer), static_cast<int>(value.size)}});
+            ++numAppended;
         }
+        return numAppended;
+    }
 
+    boost::optional<Record> seekExact(const RecordId& id) final {
         _skipNextAdvance = false;
-        int64_t key;
-        invariantWTOK(c->get_key(c, &key));
-        RecordId id = _fromKey(key);
-
-        if (_forward && _lastReturnedId >= id) {
-            log() << "WTCursor::next -- c->next_key ( " << id
-                  << ") was not greater than _lastReturnedId (" << _lastReturnedId
-                  << ") which is a bug.";
-            // Force a retry of the operation from our last known position by acting as-if
-            // we received a WT_ROLLBACK error.
-            throw WriteConflictException();
-        }
-
-        if (!isVisible(id)) {
+        WT_CURSOR* c = _cursor->get();
+        c->set_key(c, _makeKey(id));
+        // Nothing after the next line can throw WCEs.
+        int seekRet = WT_READ_CHECK(c->search(c));
+        if (seekRet == WT_NOTFOUND) {
             _eof = true;
             return {};
         }
+        invariantWTOK(seekRet);
 
         WT_ITEM value;
         invariantWTOK(c->get_value(c, &value));
 
         _lastReturnedId = id;
+        _eof = false;
         return {{id, {static_cast<const char*>(value.data), static_cast<int>(value.size)}}};
     }
 
-    boost::optional<Record> seekExact(const RecordId& id) final {
+    boost::optional<Record> seekNear(const RecordId& id) final {
         _skipNextAdvance = false;
         WT_CURSOR* c = _cursor->get();
         c->set_key(c, _makeKey(id));
-        // Nothing after the next line can throw WCEs.
-        int seekRet = WT_READ_CHECK(c->search(c));
-        if (seekRet == WT_NOTFOUND) {
+        int cmp;
+        int ret = WT_READ_CHECK(c->search_near(c, &cmp));
+        if (ret == 0 && (_forward ? cmp < 0 : cmp > 0)) {
+            // We landed on the wrong side of 'id', so step onto the first record on the right side.
+            ret = WT_READ_CHECK(_forward ? c->next(c) : c->prev(c));
+        }
+        if (ret == WT_NOTFOUND) {
+            _eof = true;
+            return {};
+        }
+        invariantWTOK(ret);
+
+        int64_t key;
+        invariantWTOK(c->get_key(c, &key));
+        const RecordId foundId = _fromKey(key);
+        if (!isVisible(foundId)) {
             _eof = true;
             return {};
         }
-        invariantWTOK(seekRet);
 
         WT_ITEM value;
         invariantWTOK(c->get_value(c, &value));
 
-        _lastReturnedId = id;
+        _lastReturnedId = foundId;
         _eof = false;
-        return {{id, {static_cast<const char*>(value.data), static_cast<int>(value.size)}}};
+        return {{foundId, {static_cast<const char*>(value.data), static_cast<int>(value.size)}}};
     }
 
     void save() final {
@@ -582,6 +593,53 @@ public:
     }
 
 private:
+    /**
+     * Moves the cursor forward, setting 'id' and 'value' to the new record. Returns false at EOF.
+     * 'value' is only valid until the cursor next moves.
+     */
+    bool _advance(RecordId* id, WT_ITEM* value) {
+        if (_eof)
+            return false;
+
+        WT_CURSOR* c = _cursor->get();
+
+        if (!_skipNextAdvance) {
+            // Nothing after the next line can throw WCEs.
+            // Note that an unpositioned (or eof) WT_CURSOR returns the first/last entry in the
+            // table when you call next/prev.
+            int advanceRet = WT_READ_CHECK(_forward ? c->next(c) : c->prev(c));
+            if (advanceRet == WT_NOTFOUND) {
+                _eof = true;
+                return false;
+            }
+            invariantWTOK(advanceRet);
+        }
+
+        _skipNextAdvance = false;
+        int64_t key;
+        invariantWTOK(c->get_key(c, &key));
+        *id = _fromKey(key);
+
+        if (_forward && _lastReturnedId >= *id) {
+            log() << "WTCursor::next -- c->next_key ( " << *id
+                  << ") was not greater than _lastReturnedId (" << _lastReturnedId
+                  << ") which is a bug.";
+            // Force a retry of the operation from our last known position by acting as-if
+            // we received a WT_ROLLBACK error.
+            throw WriteConflictException();
+        }
+
+        if (!isVisible(*id)) {
+            _eof = true;
+            return false;
+        }
+
+        invariantWTOK(c->get_value(c, value));
+
+        _lastReturnedId = *id;
+        return true;
+    }
+
     bool isVisible(const RecordId& id) {
         if (!_rs._isCapped)
             return true;
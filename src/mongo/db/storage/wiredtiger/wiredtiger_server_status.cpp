@@ -76,6 +76,11 @@ BSONObj WiredTigerServerStatusSection::generateSection(OperationContext* opCtx,
 
     WiredTigerKVEngine::appendGlobalStats(bob);
 
+    {
+        BSONObjBuilder groupCommitBuilder(bob.subobjStart("groupCommit"));
+        _engine->getSessionCache()->appendGroupCommitStats(&groupCommitBuilder);
+    }
+
     return bob.obj();
 }
 
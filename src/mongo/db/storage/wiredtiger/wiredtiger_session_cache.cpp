@@ -36,16 +36,78 @@
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 
 #include "mongo/base/error_codes.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/journal_listener.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/platform/bits.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/thread.h"
+#include "mongo/util/duration.h"
 #include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
 #include "mongo/util/scopeguard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
+namespace {
+
+AtomicInt32 groupCommitMaxWaitMicros(0);
+
+class GroupCommitMaxWaitMicrosParameter
+    : public ExportedServerParameter<int, ServerParameterType::kStartupAndRuntime> {
+public:
+    GroupCommitMaxWaitMicrosParameter()
+        : ExportedServerParameter<int, ServerParameterType::kStartupAndRuntime>(
+              ServerParameterSet::getGlobal(),
+              "wiredTigerGroupCommitMaxWaitMicros",
+              &groupCommitMaxWaitMicros) {}
+
+    Status validate(const int& potentialNewValue) override {
+        if (potentialNewValue < 0 || potentialNewValue > kMaxGroupCommitWaitMicros) {
+            return Status(ErrorCodes::BadValue,
+                          str::stream() << "wiredTigerGroupCommitMaxWaitMicros must be between 0 "
+                                        << "and "
+                                        << kMaxGroupCommitWaitMicros
+                                        << ", but attempted to set to: "
+                                        << potentialNewValue);
+        }
+        return Status::OK();
+    }
+
+private:
+    static const int kMaxGroupCommitWaitMicros = 1000 * 1000;
+} groupCommitMaxWaitMicrosParameter;
+
+// Returns the index of the power of two bucket that 'value' falls in.
+int groupCommitStatsBucket(uint64_t value, int numBuckets) {
+    if (value == 0) {
+        return 0;
+    }
+    return std::min(63 - countLeadingZeros64(value), numBuckets - 1);
+}
+
+template <size_t N>
+void appendGroupCommitHistogram(const std::array<uint64_t, N>& buckets,
+                                StringData name,
+                                StringData lowerBoundName,
+                                BSONObjBuilder* builder) {
+    BSONArrayBuilder arrayBuilder(builder->subarrayStart(name));
+    for (size_t i = 0; i < buckets.size(); ++i) {
+        if (buckets[i] == 0)
+            continue;
+        BSONObjBuilder entryBuilder(arrayBuilder.subobjStart());
+        entryBuilder.append(lowerBoundName, 1LL << i);
+        entryBuilder.append("count", static_cast<long long>(buckets[i]));
+        entryBuilder.doneFast();
+    }
+    arrayBuilder.doneFast();
+}
+
+}  // namespace
+
 WiredTigerSession::WiredTigerSession(WT_CONNECTION* conn, uint64_t epoch, uint64_t cursorEpoch)
     : _epoch(epoch),
       _cursorEpoch(cursorEpoch),
@@ -204,18 +266,64 @@ void WiredTigerSessionCache::waitUntilDurable(bool forceCheckpoint) {
         return;
     }
 
-    uint32_t start = _lastSyncTime.load();
-    // Do the remainder in a critical section that ensures only a single thread at a time
-    // will attempt to synchronize.
-    stdx::unique_lock<stdx::mutex> lk(_lastSyncMutex);
-    uint32_t current = _lastSyncTime.loadRelaxed();  // synchronized with writes through mutex
-    if (current != start) {
-        // Someone else synced already since we read lastSyncTime, so we're done!
-        return;
+    stdx::unique_lock<stdx::mutex> lk(_groupCommitMutex);
+
+    // Any flush that starts from now on covers all of the commits that happened before this call.
+    const uint64_t flushNeeded = _flushesStarted + 1;
+    ++_nextGroupSize;
+
+    while (_flushesCompleted < flushNeeded) {
+        if (_flushInProgress) {
+            _groupCommitCondVar.wait(lk);
+            continue;
+        }
+
+        // Nobody is flushing yet, so lead the group. Callers that arrive while we wait for the
+        // group to fill up share our flush, as no flush can complete before ours does.
+        _flushInProgress = true;
+        const Microseconds maxWait(groupCommitMaxWaitMicros.load());
+        if (maxWait > Microseconds(0)) {
+            _groupCommitCondVar.wait_for(lk, maxWait.toSystemDuration());
+        }
+
+        // A flush which failed leaves '_flushesStarted' ahead of '_flushesCompleted', and callers
+        // that arrived while it ran need the flush after it, so cover everyone waiting so far.
+        const uint64_t flushTarget = _flushesStarted + 1;
+        invariant(flushTarget >= flushNeeded);
+        _flushesStarted = flushTarget;
+        const uint64_t groupSize = _nextGroupSize;
+        _nextGroupSize = 0;
+        lk.unlock();
+
+        Timer timer;
+        try {
+            _flushForDurability();
+        } catch (...) {
+            // Let one of the waiters retry the flush for the whole group.
+            lk.lock();
+            _nextGroupSize += groupSize - 1;
+            _flushInProgress = false;
+            _groupCommitCondVar.notify_all();
+            throw;
+        }
+        const uint64_t flushMicros = timer.micros();
+
+        lk.lock();
+        _flushesCompleted = flushTarget;
+        _flushInProgress = false;
+
+        ++_groupCommitStats.flushes;
+        _groupCommitStats.commits += groupSize;
+        _groupCommitStats.flushMicros += flushMicros;
+        const int kBuckets = GroupCommitStats::kBuckets;
+        ++_groupCommitStats.groupSizes[groupCommitStatsBucket(groupSize, kBuckets)];
+        ++_groupCommitStats.flushLatencies[groupCommitStatsBucket(flushMicros, kBuckets)];
+
+        _groupCommitCondVar.notify_all();
     }
-    _lastSyncTime.store(current + 1);
+}
 
-    // Nobody has synched yet, so we have to sync ourselves.
+void WiredTigerSessionCache::_flushForDurability() {
     auto session = getSession();
     WT_SESSION* s = session->getSession();
 
@@ -235,6 +343,21 @@ void WiredTigerSessionCache::waitUntilDurable(bool forceCheckpoint) {
     _journalListener->onDurable(token);
 }
 
+void WiredTigerSessionCache::appendGroupCommitStats(BSONObjBuilder* builder) const {
+    GroupCommitStats stats;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_groupCommitMutex);
+        stats = _groupCommitStats;
+    }
+
+    builder->append("flushes", static_cast<long long>(stats.flushes));
+    builder->append("commits", static_cast<long long>(stats.commits));
+    builder->append("flushMicros", static_cast<long long>(stats.flushMicros));
+    builder->append("maxWaitMicros", groupCommitMaxWaitMicros.load());
+    appendGroupCommitHistogram(stats.groupSizes, "groupSizes", "size", builder);
+    appendGroupCommitHistogram(stats.flushLatencies, "flushLatencies", "micros", builder);
+}
+
 void WiredTigerSessionCache::closeAllCursors() {
     // Increment the cursor epoch so that all cursors from this epoch are closed.
     _cursorEpoch.fetchAndAdd(1);
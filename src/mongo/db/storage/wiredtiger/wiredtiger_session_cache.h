@@ -31,6 +31,7 @@
 
 #pragma once
 
+#include <array>
 #include <list>
 #include <string>
 
@@ -40,11 +41,13 @@
 #include "mongo/db/storage/journal_listener.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_snapshot_manager.h"
 #include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/spin_lock.h"
 
 namespace mongo {
 
+class BSONObjBuilder;
 class WiredTigerKVEngine;
 class WiredTigerSessionCache;
 
@@ -184,9 +187,19 @@ public:
      * Waits until all commits that happened before this call are durable, either by flushing
      * the log or forcing a checkpoint if forceCheckpoint is true or the journal is disabled.
      * Uses a temporary session. Safe to call without any locks, even during shutdown.
+     *
+     * Concurrent callers are committed as a group: one of them flushes on behalf of all callers
+     * that arrived before its flush started, after waiting up to
+     * wiredTigerGroupCommitMaxWaitMicros for more callers to join.
      */
     void waitUntilDurable(bool forceCheckpoint);
 
+    /**
+     * Appends the number of group commits, the callers they served, and histograms of their
+     * group sizes and flush latencies.
+     */
+    void appendGroupCommitStats(BSONObjBuilder* builder) const;
+
     WT_CONNECTION* conn() const {
         return _conn;
     }
@@ -225,9 +238,31 @@ private:
     // Bumped when all open cursors need to be closed
     AtomicUInt64 _cursorEpoch;  // atomic so we can check it outside of the lock
 
-    // Counter and critical section mutex for waitUntilDurable
-    AtomicUInt32 _lastSyncTime;
-    stdx::mutex _lastSyncMutex;
+    // Group commit state for waitUntilDurable. A caller is covered by any flush that starts
+    // after it arrives, so callers that arrive while a flush is pending wait for the next one.
+    struct GroupCommitStats {
+        static const int kBuckets = 32;  // Powers of two, the last bucket is unbounded.
+
+        uint64_t flushes = 0;
+        uint64_t commits = 0;
+        uint64_t flushMicros = 0;
+        std::array<uint64_t, kBuckets> groupSizes{};
+        std::array<uint64_t, kBuckets> flushLatencies{};
+    };
+
+    mutable stdx::mutex _groupCommitMutex;
+    stdx::condition_variable _groupCommitCondVar;
+    bool _flushInProgress = false;  // A leader has been chosen and has not finished yet.
+    uint64_t _flushesStarted = 0;
+    uint64_t _flushesCompleted = 0;
+    uint64_t _nextGroupSize = 0;  // Callers waiting for flush number _flushesStarted + 1.
+    GroupCommitStats _groupCommitStats;
+
+    /**
+     * Flushes the journal, or takes a checkpoint if there is no journal, and notifies the
+     * journal listener.
+     */
+    void _flushForDurability();
 
     // Notified when we commit to the journal.
     JournalListener* _journalListener = &NoOpJournalListener::instance;
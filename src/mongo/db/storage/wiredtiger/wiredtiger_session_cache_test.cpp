@@ -0,0 +1,121 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <vector>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+class WiredTigerSessionCacheTest : public unittest::Test {
+public:
+    WiredTigerSessionCacheTest() : _dbpath("wt_session_cache_test") {
+        int ret = wiredtiger_open(_dbpath.path().c_str(), NULL, "create", &_conn);
+        ASSERT_OK(wtRCToStatus(ret));
+        _sessionCache = stdx::make_unique<WiredTigerSessionCache>(_conn);
+    }
+
+    ~WiredTigerSessionCacheTest() {
+        setGroupCommitMaxWaitMicros(0);
+        _sessionCache.reset();
+        _conn->close(_conn, NULL);
+    }
+
+protected:
+    WiredTigerSessionCache* getSessionCache() {
+        return _sessionCache.get();
+    }
+
+    BSONObj getGroupCommitStats() {
+        BSONObjBuilder builder;
+        _sessionCache->appendGroupCommitStats(&builder);
+        return builder.obj();
+    }
+
+    void setGroupCommitMaxWaitMicros(int micros) {
+        auto parameter =
+            ServerParameterSet::getGlobal()->getMap().find("wiredTigerGroupCommitMaxWaitMicros");
+        ASSERT(parameter != ServerParameterSet::getGlobal()->getMap().end());
+        ASSERT_OK(parameter->second->setFromString(std::to_string(micros)));
+    }
+
+private:
+    unittest::TempDir _dbpath;
+    WT_CONNECTION* _conn = nullptr;
+    std::unique_ptr<WiredTigerSessionCache> _sessionCache;
+};
+
+TEST_F(WiredTigerSessionCacheTest, SequentialCallersEachFlush) {
+    for (int i = 0; i < 3; ++i) {
+        getSessionCache()->waitUntilDurable(false);
+    }
+
+    BSONObj stats = getGroupCommitStats();
+    ASSERT_EQ(3, stats["flushes"].numberLong());
+    ASSERT_EQ(3, stats["commits"].numberLong());
+    ASSERT_BSONOBJ_EQ(BSON("size" << 1LL << "count" << 3LL), stats["groupSizes"].Obj()["0"].Obj());
+}
+
+TEST_F(WiredTigerSessionCacheTest, ConcurrentCallersShareFlushes) {
+    // Give every caller plenty of time to join the first flush.
+    setGroupCommitMaxWaitMicros(500 * 1000);
+
+    const int kCallers = 8;
+    std::vector<stdx::thread> callers;
+    for (int i = 0; i < kCallers; ++i) {
+        callers.emplace_back([this] { getSessionCache()->waitUntilDurable(false); });
+    }
+    for (auto& caller : callers) {
+        caller.join();
+    }
+
+    BSONObj stats = getGroupCommitStats();
+    ASSERT_EQ(kCallers, stats["commits"].numberLong());
+    ASSERT_LT(stats["flushes"].numberLong(), kCallers);
+    ASSERT_EQ(500 * 1000, stats["maxWaitMicros"].numberInt());
+}
+
+TEST_F(WiredTigerSessionCacheTest, MaxWaitIsValidated) {
+    auto parameter =
+        ServerParameterSet::getGlobal()->getMap().find("wiredTigerGroupCommitMaxWaitMicros");
+    ASSERT_NOT_OK(parameter->second->setFromString("-1"));
+    ASSERT_NOT_OK(parameter->second->setFromString("1000001"));
+}
+
+}  // namespace
+}  // namespace mongo
@@ -266,6 +266,137 @@ public:
     }
 };
 
+/**
+ * Sets indexBuildWorkerThreads for the lifetime of the object.
+ */
+class IndexBuildWorkerThreadsSetting {
+public:
+    explicit IndexBuildWorkerThreadsSetting(int workers)
+        : _oldWorkers(indexBuildWorkerThreads.swap(workers)) {}
+
+    ~IndexBuildWorkerThreadsSetting() {
+        indexBuildWorkerThreads.store(_oldWorkers);
+    }
+
+private:
+    const int _oldWorkers;
+};
+
+/**
+ * Fixture for foreground index builds which generate and sort keys on several worker threads.
+ */
+class ParallelIndexBuild : public IndexBuildBase {
+public:
+    ParallelIndexBuild() : _workers(4) {}
+
+protected:
+    static const int kNumDocs = 10000;
+
+    /**
+     * Recreates the collection with kNumDocs documents, where 'a' repeats every 'aModulus'
+     * documents and 'b' is an array in every tenth document. Returns the number of keys an index
+     * on {a: 1, b: 1} will contain.
+     */
+    int64_t populateCollection(int aModulus) {
+        Database* db = _ctx.db();
+        WriteUnitOfWork wunit(&_opCtx);
+        db->dropCollection(&_opCtx, _ns);
+        _coll = db->createCollection(&_opCtx, _ns);
+
+        int64_t numKeys = 0;
+        OpDebug* const nullOpDebug = nullptr;
+        for (int i = 0; i < kNumDocs; i++) {
+            BSONObj doc = i % 10 == 0
+                ? BSON("_id" << i << "a" << i % aModulus << "b" << BSON_ARRAY(i << i + kNumDocs))
+                : BSON("_id" << i << "a" << i % aModulus << "b" << i);
+            ASSERT_OK(_coll->insertDocument(&_opCtx, doc, nullOpDebug, true));
+            numKeys += i % 10 == 0 ? 2 : 1;
+        }
+        wunit.commit();
+        return numKeys;
+    }
+
+    BSONObj indexSpec(StringData name, const BSONObj& key, bool unique) {
+        return BSON("name" << name << "ns" << _coll->ns().ns() << "key" << key << "v"
+                           << static_cast<int>(kIndexVersion)
+                           << "unique"
+                           << unique);
+    }
+
+    Collection* _coll = nullptr;
+
+private:
+    IndexBuildWorkerThreadsSetting _workers;
+};
+
+/** A parallel build produces every key, in order, and records that the index is multikey. */
+class ParallelBuildProducesSortedIndex : public ParallelIndexBuild {
+public:
+    void run() {
+        const int64_t expectedKeys = populateCollection(97);
+
+        MultiIndexBlock indexer(&_opCtx, _coll);
+        ASSERT_OK(indexer.init(indexSpec("a_1_b_1", BSON("a" << 1 << "b" << 1), false)).getStatus());
+        ASSERT_OK(indexer.insertAllDocumentsInCollection());
+        {
+            WriteUnitOfWork wunit(&_opCtx);
+            indexer.commit();
+            wunit.commit();
+        }
+
+        IndexCatalog* catalog = _coll->getIndexCatalog();
+        IndexDescriptor* desc = catalog->findIndexByName(&_opCtx, "a_1_b_1");
+        ASSERT(desc);
+        ASSERT(catalog->isMultikey(&_opCtx, desc));
+
+        auto cursor = catalog->getIndex(desc)->newCursor(&_opCtx);
+        int64_t numKeys = 0;
+        boost::optional<IndexKeyEntry> previous;
+        for (auto entry = cursor->seek(BSONObj(), true); entry; entry = cursor->next()) {
+            if (previous) {
+                const int cmp = previous->key.woCompare(entry->key, BSONObj(), false);
+                ASSERT_LTE(cmp, 0);
+                if (cmp == 0) {
+                    ASSERT_LT(previous->loc, entry->loc);
+                }
+            }
+            previous = IndexKeyEntry(entry->key.getOwned(), entry->loc);
+            numKeys++;
+        }
+        ASSERT_EQUALS(expectedKeys, numKeys);
+    }
+};
+
+/** A parallel build detects duplicates generated by different workers. */
+class ParallelBuildEnforceUnique : public ParallelIndexBuild {
+public:
+    void run() {
+        // The 'a' values are unique except for the first and last documents, which are scanned
+        // far enough apart to be handed to different workers.
+        populateCollection(kNumDocs - 1);
+
+        MultiIndexBlock indexer(&_opCtx, _coll);
+        ASSERT_OK(indexer.init(indexSpec("a_1", BSON("a" << 1), true)).getStatus());
+        const Status status = indexer.insertAllDocumentsInCollection();
+        ASSERT_EQUALS(status.code(), ErrorCodes::DuplicateKey);
+    }
+};
+
+/** A parallel build fills a passed-in set of dups rather than failing. */
+class ParallelBuildFillDups : public ParallelIndexBuild {
+public:
+    void run() {
+        populateCollection(kNumDocs / 2);
+
+        MultiIndexBlock indexer(&_opCtx, _coll);
+        ASSERT_OK(indexer.init(indexSpec("a_1", BSON("a" << 1), true)).getStatus());
+
+        std::set<RecordId> dups;
+        ASSERT_OK(indexer.insertAllDocumentsInCollection(&dups));
+        ASSERT_EQUALS(dups.size(), static_cast<size_t>(kNumDocs / 2));
+    }
+};
+
 /** Index creation is killed if mayInterrupt is true. */
 class InsertBuildIndexInterrupt : public IndexBuildBase {
 public:
@@ -805,6 +936,9 @@ public:
         add<InsertBuildEnforceUnique<false>>();
         add<InsertBuildFillDups<true>>();
         add<InsertBuildFillDups<false>>();
+        add<ParallelBuildProducesSortedIndex>();
+        add<ParallelBuildEnforceUnique>();
+        add<ParallelBuildFillDups>();
         add<InsertBuildIndexInterrupt>();
         add<InsertBuildIndexInterruptDisallowed>();
         add<InsertBuildIdIndexInterrupt>();
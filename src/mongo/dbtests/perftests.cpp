@@ -44,7 +44,9 @@
 #include <boost/thread/thread.hpp>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <mutex>
+#include <queue>
 
 #include "mongo/config.h"
 #include "mongo/db/bson/dotted_path_support.h"
@@ -52,13 +54,25 @@
 #include "mongo/db/db.h"
 #include "mongo/db/dbdirectclient.h"
 #include "mongo/db/lasterror.h"
+#include "mongo/db/matcher/extensions_callback_disallow_extensions.h"
+#include "mongo/db/query/canonical_query.h"
+#include "mongo/db/query/plan_cache.h"
+#include "mongo/db/query/plan_ranker.h"
+#include "mongo/db/query/query_solution.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/db/storage/mmap_v1/dur_stats.h"
 #include "mongo/db/storage/mmap_v1/mmap.h"
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/dbtests/framework_options.h"
+#include "mongo/platform/random.h"
+#include "mongo/s/catalog/type_chunk.h"
+#include "mongo/s/chunk_map.h"
+#include "mongo/s/query/loser_tree.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/thread.h"
+#include "mongo/transport/message_compressor_snappy.h"
+#include "mongo/transport/message_compressor_zlib.h"
 #include "mongo/util/log.h"
 #include "mongo/util/timer.h"
 #include "mongo/util/version.h"
@@ -450,6 +464,429 @@ public:
     }
 };
 
+/**
+ * Looks up cached plans for a set of query shapes. The threaded phase measures how well plan cache
+ * lookups scale when many operations consult the same collection's cache at once.
+ */
+class PlanCacheGet : public B {
+public:
+    string name() {
+        return "PlanCache::get";
+    }
+    string name2() {
+        return "PlanCache::get-2";
+    }
+    virtual int howLongMillis() {
+        return 500;
+    }
+    virtual bool showDurStats() {
+        return false;
+    }
+    virtual bool testThreaded() {
+        return true;
+    }
+
+    void prep() {
+        for (int i = 0; i < numShapes(); ++i) {
+            auto qr = stdx::make_unique<QueryRequest>(NamespaceString(ns()));
+            qr->setFilter(BSON(std::string(str::stream() << "field" << i) << 1));
+            auto statusWithCQ = CanonicalQuery::canonicalize(
+                opCtx(), std::move(qr), ExtensionsCallbackDisallowExtensions());
+            uassertStatusOK(statusWithCQ.getStatus());
+            _queries.push_back(std::move(statusWithCQ.getValue()));
+
+            QuerySolution qs;
+            qs.cacheData.reset(new SolutionCacheData());
+            qs.cacheData->tree.reset(new PlanCacheIndexTree());
+            std::vector<QuerySolution*> solns{&qs};
+
+            auto decision = stdx::make_unique<PlanRankingDecision>();
+            decision->stats.push_back(stdx::make_unique<PlanStageStats>(CommonStats("COLLSCAN"),
+                                                                        STAGE_COLLSCAN));
+            decision->scores.push_back(0U);
+            decision->candidateOrder.push_back(0U);
+            uassertStatusOK(_planCache.add(*_queries.back(), solns, decision.release()));
+        }
+    }
+
+    void timed() {
+        for (int i = 0; i < kLookupsPerCall; ++i) {
+            CachedSolution* cachedSolution;
+            uassertStatusOK(_planCache.get(*_queries[i % _queries.size()], &cachedSolution));
+            delete cachedSolution;
+        }
+    }
+
+    void timed2(DBClientBase*) {
+        timed();
+    }
+
+protected:
+    virtual int numShapes() {
+        return 32;
+    }
+
+private:
+    static const int kLookupsPerCall = 32;
+
+    PlanCache _planCache;
+    std::vector<std::unique_ptr<CanonicalQuery>> _queries;
+};
+
+/**
+ * As PlanCacheGet, but every lookup is of the same query shape, so that the threaded phase measures
+ * the contention of many operations running one hot query.
+ */
+class PlanCacheGetHotShape : public PlanCacheGet {
+public:
+    string name() {
+        return "PlanCache::get-hot-shape";
+    }
+    string name2() {
+        return "PlanCache::get-hot-shape-2";
+    }
+
+protected:
+    int numShapes() {
+        return 1;
+    }
+};
+
+/**
+ * Compresses and decompresses a batch of insert and update oplog entries, as replication would
+ * send them, and reports the compression ratio achieved.
+ */
+class CompressOplogBatch : public B {
+public:
+    virtual int howLongMillis() {
+        return 500;
+    }
+    virtual bool showDurStats() {
+        return false;
+    }
+
+    void prep() {
+        _compressor = makeCompressor();
+
+        BSONArrayBuilder batch;
+        for (int i = 0; i < 1000; ++i) {
+            BSONObjBuilder entry(batch.subobjStart());
+            entry.append("ts", Timestamp(1497988800 + i / 10, i % 10));
+            entry.append("t", 1LL);
+            entry.append("h", static_cast<long long>(i) * 2654435761LL);
+            entry.append("v", 2);
+            entry.append("op", i % 4 == 0 ? "u" : "i");
+            entry.append("ns", "perftest.oplogBatch");
+            if (i % 4 == 0) {
+                entry.append("o2", BSON("_id" << OID::gen()));
+                entry.append("o", BSON("$set" << BSON("qty" << i)));
+            } else {
+                BSONObjBuilder o(entry.subobjStart("o"));
+                o.append("_id", OID::gen());
+                o.append("customer", std::string(str::stream() << "customer" << i % 97));
+                o.append("qty", i);
+                o.append("status", "pending");
+                o.append("tags", BSON_ARRAY("retail"
+                                            << "priority"));
+                o.doneFast();
+            }
+            entry.doneFast();
+        }
+        _batch = batch.arr();
+
+        _compressed.resize(_compressor->getMaxCompressedSize(_batch.objsize()));
+        _decompressed.resize(_batch.objsize());
+        timed();
+    }
+
+    void timed() {
+        auto sws =
+            _compressor->compressData(ConstDataRange(_batch.objdata(), _batch.objsize()),
+                                      DataRange(_compressed.data(), _compressed.size()));
+        uassertStatusOK(sws.getStatus());
+        _compressedSize = sws.getValue();
+    }
+
+    void timed2(DBClientBase*) {
+        auto sws =
+            _compressor->decompressData(ConstDataRange(_compressed.data(), _compressedSize),
+                                        DataRange(_decompressed.data(), _decompressed.size()));
+        uassertStatusOK(sws.getStatus());
+    }
+
+    void post() {
+        cout << "stats " << setw(42) << left << name() + " ratio:" << ' ' << right << setw(9)
+             << fixed << setprecision(2)
+             << static_cast<double>(_batch.objsize()) / _compressedSize << endl;
+    }
+
+protected:
+    virtual std::unique_ptr<MessageCompressorBase> makeCompressor() = 0;
+
+private:
+    std::unique_ptr<MessageCompressorBase> _compressor;
+    BSONObj _batch;
+    std::vector<char> _compressed;
+    std::vector<char> _decompressed;
+    size_t _compressedSize = 0;
+};
+
+class SnappyCompressOplogBatch : public CompressOplogBatch {
+public:
+    string name() {
+        return "snappy-compress-oplog";
+    }
+    string name2() {
+        return "snappy-decompress-oplog";
+    }
+    std::unique_ptr<MessageCompressorBase> makeCompressor() {
+        return stdx::make_unique<SnappyMessageCompressor>();
+    }
+};
+
+template <int level>
+class ZlibCompressOplogBatch : public CompressOplogBatch {
+public:
+    string name() {
+        return str::stream() << "zlib" << level << "-compress-oplog";
+    }
+    string name2() {
+        return str::stream() << "zlib" << level << "-decompress-oplog";
+    }
+    std::unique_ptr<MessageCompressorBase> makeCompressor() {
+        return stdx::make_unique<ZlibMessageCompressor>(level);
+    }
+};
+
+/**
+ * Targets shard keys against the routing table of a collection with many chunks, as mongos does
+ * for every write and single shard query.
+ */
+class ChunkMapUpperBound : public B {
+public:
+    virtual int howLongMillis() {
+        return 500;
+    }
+    virtual bool showDurStats() {
+        return false;
+    }
+
+    void prep() {
+        const NamespaceString nss("perftest.chunkMap");
+        const OID epoch = OID::gen();
+
+        std::vector<std::shared_ptr<Chunk>> chunks;
+        for (int i = 0; i < kNumChunks; ++i) {
+            ChunkType chunk(nss,
+                            ChunkRange(boundary(i), boundary(i + 1)),
+                            ChunkVersion(1, i, epoch),
+                            ShardId(str::stream() << "shard" << i % 8));
+            chunks.push_back(std::make_shared<Chunk>(chunk));
+        }
+        _chunkMap = ChunkMap().applyChanges(chunks);
+
+        PseudoRandom random(1);
+        for (int i = 0; i < kNumKeys; ++i) {
+            _keys.push_back(randomKey(random));
+        }
+    }
+
+    void timed() {
+        const auto it = _chunkMap.upper_bound(_keys[_next++ % kNumKeys]);
+        invariant(it != _chunkMap.end());
+    }
+
+protected:
+    static const int kNumChunks = 100000;
+
+    /**
+     * Returns the i-th of the kNumChunks + 1 chunk boundaries, starting with MinKey and ending
+     * with MaxKey.
+     */
+    virtual BSONObj boundary(int i) = 0;
+
+    virtual BSONObj randomKey(PseudoRandom& random) = 0;
+
+private:
+    static const int kNumKeys = 1024;
+
+    ChunkMap _chunkMap;
+    std::vector<BSONObj> _keys;
+    size_t _next = 0;
+};
+
+class CompoundChunkMapUpperBound : public ChunkMapUpperBound {
+public:
+    string name() {
+        return "ChunkMap::upper_bound-compound";
+    }
+
+protected:
+    BSONObj boundary(int i) {
+        if (i == 0) {
+            return BSON("customer" << MINKEY << "order" << MINKEY);
+        } else if (i == kNumChunks) {
+            return BSON("customer" << MAXKEY << "order" << MAXKEY);
+        }
+        return BSON("customer" << customer(i / 10) << "order" << i % 10 * 1000);
+    }
+
+    BSONObj randomKey(PseudoRandom& random) {
+        return BSON("customer" << customer(random.nextInt32(kNumChunks / 10)) << "order"
+                               << random.nextInt32(10000));
+    }
+
+private:
+    static std::string customer(int i) {
+        const std::string number = std::to_string(i);
+        return "customer" + std::string(6 - number.size(), '0') + number;
+    }
+};
+
+class HashedChunkMapUpperBound : public ChunkMapUpperBound {
+public:
+    string name() {
+        return "ChunkMap::upper_bound-hashed";
+    }
+
+protected:
+    BSONObj boundary(int i) {
+        if (i == 0) {
+            return BSON("_id" << MINKEY);
+        } else if (i == kNumChunks) {
+            return BSON("_id" << MAXKEY);
+        }
+        return BSON("_id" << std::numeric_limits<long long>::max() / kNumChunks *
+                        (2 * i - kNumChunks));
+    }
+
+    BSONObj randomKey(PseudoRandom& random) {
+        return BSON("_id" << static_cast<long long>(random.nextInt64()));
+    }
+};
+
+/**
+ * Merges the sorted results of many shards by their $sortKey, one result per iteration, as mongos
+ * does for sorted queries. Each shard's results are replayed from the start once it runs out.
+ */
+class SortedMerge : public B {
+public:
+    virtual int howLongMillis() {
+        return 500;
+    }
+    virtual bool showDurStats() {
+        return false;
+    }
+
+    void prep() {
+        PseudoRandom random(1);
+        _sortKeys.resize(kNumShards);
+        for (auto& sortKeys : _sortKeys) {
+            for (int i = 0; i < kKeysPerShard; ++i) {
+                const std::string customer = str::stream() << "customer" << random.nextInt32(100);
+                sortKeys.push_back(BSON("" << random.nextInt32(kKeysPerShard) << "" << customer));
+            }
+            std::sort(sortKeys.begin(), sortKeys.end(), [this](const BSONObj& l, const BSONObj& r) {
+                return l.woCompare(r, _sortPattern, false) < 0;
+            });
+        }
+        _positions.assign(kNumShards, 0);
+    }
+
+protected:
+    static const size_t kNumShards = 60;
+    static const int kKeysPerShard = 1000;
+
+    const BSONObj& front(size_t shard) const {
+        return _sortKeys[shard][_positions[shard]];
+    }
+
+    void advance(size_t shard) {
+        if (++_positions[shard] == _sortKeys[shard].size()) {
+            _positions[shard] = 0;
+        }
+    }
+
+    const BSONObj _sortPattern = BSON("a" << 1 << "b" << -1);
+
+private:
+    std::vector<std::vector<BSONObj>> _sortKeys;
+    std::vector<size_t> _positions;
+};
+
+class BinaryHeapSortedMerge : public SortedMerge {
+public:
+    string name() {
+        return "SortedMerge-binaryHeap-woCompare";
+    }
+
+    void prep() {
+        SortedMerge::prep();
+        for (size_t shard = 0; shard < kNumShards; ++shard) {
+            _heap.push(shard);
+        }
+    }
+
+    void timed() {
+        const size_t shard = _heap.top();
+        _heap.pop();
+        advance(shard);
+        _heap.push(shard);
+    }
+
+private:
+    struct Greater {
+        bool operator()(size_t lhs, size_t rhs) const {
+            return merge->front(lhs).woCompare(merge->front(rhs), merge->_sortPattern, false) > 0;
+        }
+
+        const BinaryHeapSortedMerge* merge;
+    };
+
+    std::priority_queue<size_t, std::vector<size_t>, Greater> _heap{Greater{this}};
+};
+
+class LoserTreeSortedMerge : public SortedMerge {
+public:
+    string name() {
+        return "SortedMerge-loserTree-KeyString";
+    }
+
+    void prep() {
+        SortedMerge::prep();
+        _encodedFronts.resize(kNumShards);
+        for (size_t shard = 0; shard < kNumShards; ++shard) {
+            encodeFront(shard);
+        }
+        _tree.rebuild();
+    }
+
+    void timed() {
+        const size_t shard = _tree.top();
+        advance(shard);
+        encodeFront(shard);
+        _tree.replayTop();
+    }
+
+private:
+    struct Less {
+        bool operator()(size_t lhs, size_t rhs) const {
+            return (*encodedFronts)[lhs] < (*encodedFronts)[rhs];
+        }
+
+        const std::vector<std::string>* encodedFronts;
+    };
+
+    void encodeFront(size_t shard) {
+        _builder.resetToKey(front(shard), _ordering);
+        _encodedFronts[shard].assign(_builder.getBuffer(), _builder.getSize());
+    }
+
+    const Ordering _ordering = Ordering::make(_sortPattern);
+    KeyString _builder{KeyString::Version::V1};
+    std::vector<std::string> _encodedFronts;
+    LoserTree<Less> _tree{kNumShards, Less{&_encodedFronts}};
+};
 
 class All : public Suite {
 public:
@@ -463,6 +900,16 @@ public:
         add<boosttimed_mutexspeed>();
         add<stdmutexspeed>();
         add<stdtimed_mutexspeed>();
+        add<PlanCacheGet>();
+        add<PlanCacheGetHotShape>();
+        add<SnappyCompressOplogBatch>();
+        add<ZlibCompressOplogBatch<1>>();
+        add<ZlibCompressOplogBatch<6>>();
+        add<ZlibCompressOplogBatch<9>>();
+        add<CompoundChunkMapUpperBound>();
+        add<HashedChunkMapUpperBound>();
+        add<BinaryHeapSortedMerge>();
+        add<LoserTreeSortedMerge>();
     }
 } myall;
 }  // namespace PerfTests
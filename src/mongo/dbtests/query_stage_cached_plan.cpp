@@ -249,6 +249,108 @@ public:
     }
 };
 
+/**
+ * Test that when the cached plan hits the trial period's threshold for work cycles, an alternate
+ * plan cached for the shape is tried within its own works budget before replanning from scratch.
+ */
+class QueryStageCachedPlanUsesAlternate : public QueryStageCachedPlanBase {
+public:
+    void run() {
+        // Documents for which the index on "b" is more selective than the index on "a".
+        {
+            OldClientWriteContext writeCtx(&_opCtx, nss.ns());
+            for (int i = 0; i < 10; i++) {
+                insertDocument(writeCtx.getCollection(),
+                               BSON("_id" << 10 + i << "a" << -1 - i << "b" << 2));
+            }
+        }
+
+        AutoGetCollectionForReadCommand ctx(&_opCtx, nss);
+        Collection* collection = ctx.getCollection();
+        ASSERT(collection);
+
+        // Plan a query of the shape from scratch so that the index on "a" is cached for it.
+        ASSERT_OK(getExecutor(&_opCtx,
+                              collection,
+                              canonicalize("{a: {$gte: 8}, b: 1}"),
+                              PlanExecutor::NO_YIELD)
+                      .getStatus());
+
+        // Have the cached plan overrun its budget for a query of the shape which favors the index
+        // on "b". Replanning caches the index on "b", and keeps the index on "a" as an alternate.
+        const std::unique_ptr<CanonicalQuery> replanCq = canonicalize("{a: {$gte: -10}, b: 2}");
+        ASSERT_FALSE(runCachedPlanStage(collection, replanCq.get()).empty());
+
+        PlanCache* cache = collection->infoCache()->getPlanCache();
+        std::vector<std::unique_ptr<CachedSolution>> alternates;
+        ASSERT_OK(cache->getAlternates(*replanCq, &alternates));
+        ASSERT_EQ(alternates.size(), 1U);
+
+        // Once the cached plan overruns its budget for the original query, switching to the
+        // alternate should succeed without replanning, and return the 2 results.
+        const std::unique_ptr<CanonicalQuery> cq = canonicalize("{a: {$gte: 8}, b: 1}");
+        bool replanned = true;
+        ASSERT_EQ(runCachedPlanStage(collection, cq.get(), &replanned).size(), 2U);
+        ASSERT_FALSE(replanned);
+    }
+
+private:
+    std::unique_ptr<CanonicalQuery> canonicalize(const char* filter) {
+        auto qr = stdx::make_unique<QueryRequest>(nss);
+        qr->setFilter(fromjson(filter));
+        auto statusWithCQ = CanonicalQuery::canonicalize(
+            opCtx(), std::move(qr), ExtensionsCallbackDisallowExtensions());
+        ASSERT_OK(statusWithCQ.getStatus());
+        return std::move(statusWithCQ.getValue());
+    }
+
+    /**
+     * Runs 'cq' with a cached plan stage whose cached plan takes long enough to use up its works
+     * budget, and returns the results.
+     */
+    std::vector<BSONObj> runCachedPlanStage(Collection* collection,
+                                            CanonicalQuery* cq,
+                                            bool* replanned = nullptr) {
+        QueryPlannerParams plannerParams;
+        fillOutPlannerParams(&_opCtx, collection, cq, &plannerParams);
+
+        const size_t decisionWorks = 10;
+        const size_t mockWorks =
+            1U + static_cast<size_t>(internalQueryCacheEvictionRatio * decisionWorks);
+        auto mockChild = stdx::make_unique<QueuedDataStage>(&_opCtx, &_ws);
+        for (size_t i = 0; i < mockWorks; i++) {
+            mockChild->pushBack(PlanStage::NEED_TIME);
+        }
+
+        CachedPlanStage cachedPlanStage(
+            &_opCtx, collection, &_ws, cq, plannerParams, decisionWorks, mockChild.release());
+        PlanYieldPolicy yieldPolicy(PlanExecutor::NO_YIELD,
+                                    _opCtx.getServiceContext()->getFastClockSource());
+        ASSERT_OK(cachedPlanStage.pickBestPlan(&yieldPolicy));
+        if (replanned) {
+            *replanned =
+                static_cast<const CachedPlanStats*>(cachedPlanStage.getSpecificStats())->replanned;
+        }
+
+        std::vector<BSONObj> results;
+        PlanStage::StageState state = PlanStage::NEED_TIME;
+        while (state != PlanStage::IS_EOF) {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            state = cachedPlanStage.work(&id);
+
+            ASSERT_NE(state, PlanStage::FAILURE);
+            ASSERT_NE(state, PlanStage::DEAD);
+
+            if (state == PlanStage::ADVANCED) {
+                WorkingSetMember* member = _ws.get(id);
+                ASSERT(cq->root()->matchesBSON(member->obj.value()));
+                results.push_back(member->obj.value().getOwned());
+            }
+        }
+        return results;
+    }
+};
+
 class All : public Suite {
 public:
     All() : Suite("query_stage_cached_plan") {}
@@ -256,6 +358,7 @@ public:
     void setupTests() {
         add<QueryStageCachedPlanFailure>();
         add<QueryStageCachedPlanHitMaxWorks>();
+        add<QueryStageCachedPlanUsesAlternate>();
     }
 };
 
@@ -32,6 +32,8 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
+
 #include "mongo/client/dbclientcursor.h"
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
@@ -39,6 +41,7 @@
 #include "mongo/db/db_raii.h"
 #include "mongo/db/dbdirectclient.h"
 #include "mongo/db/exec/collection_scan.h"
+#include "mongo/db/exec/parallel_collection_scan.h"
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/json.h"
 #include "mongo/db/matcher/expression_parser.h"
@@ -46,6 +49,7 @@
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/query/plan_executor.h"
 #include "mongo/db/storage/record_store.h"
+#include "mongo/db/storage/storage_engine.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/fail_point_service.h"
@@ -83,6 +87,10 @@ public:
         _client.remove(nss.ns(), obj);
     }
 
+    void update(const BSONObj& query, const BSONObj& updateObj) {
+        _client.update(nss.ns(), query, updateObj);
+    }
+
     int countResults(CollectionScanParams::Direction direction, const BSONObj& filterObj) {
         AutoGetCollectionForReadCommand ctx(&_opCtx, nss);
 
@@ -334,6 +342,65 @@ public:
     }
 };
 
+//
+// Scan a few objects, which reads more ahead of the scan, then update and delete upcoming objects
+// while yielded. The update is not reported to the scan. The scan must return the current versions
+// of the objects it read ahead.
+//
+
+class QueryStageCollscanRefetchesBufferedObjectsAfterYield : public QueryStageCollectionScanBase {
+public:
+    void run() {
+        OldClientWriteContext ctx(&_opCtx, nss.ns());
+        Collection* coll = ctx.getCollection();
+
+        vector<RecordId> recordIds;
+        getRecordIds(coll, CollectionScanParams::FORWARD, &recordIds);
+
+        CollectionScanParams params;
+        params.collection = coll;
+        params.direction = CollectionScanParams::FORWARD;
+        params.tailable = false;
+
+        WorkingSet ws;
+        unique_ptr<CollectionScan> scan(new CollectionScan(&_opCtx, params, &ws, NULL));
+
+        int count = 0;
+        while (count < 10) {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            if (PlanStage::ADVANCED == scan->work(&id)) {
+                ++count;
+            }
+        }
+
+        scan->saveState();
+        const int updated = coll->docFor(&_opCtx, recordIds[count]).value()["foo"].numberInt();
+        update(BSON("foo" << updated), BSON("$set" << BSON("foo" << -1)));
+        {
+            // Engines with document-level locking don't deliver this invalidation, but the
+            // record is gone from the new snapshot anyway.
+            WriteUnitOfWork wunit(&_opCtx);
+            scan->invalidate(&_opCtx, recordIds[count + 1], INVALIDATION_DELETION);
+            wunit.commit();
+        }
+        remove(coll->docFor(&_opCtx, recordIds[count + 1]).value());
+        scan->restoreState();
+
+        vector<int> results;
+        while (!scan->isEOF()) {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            if (PlanStage::ADVANCED == scan->work(&id)) {
+                results.push_back(ws.get(id)->obj.value()["foo"].numberInt());
+            }
+        }
+
+        ASSERT_EQUALS(static_cast<size_t>(numObj() - count - 1), results.size());
+        ASSERT_EQUALS(-1, results[0]);
+        ASSERT_EQUALS(coll->docFor(&_opCtx, recordIds[count + 2]).value()["foo"].numberInt(),
+                      results[1]);
+    }
+};
+
 //
 // Scan through half the objects, delete the one we're about to fetch, then expect to get the
 // "next" object we would have gotten after that.  But, do it in reverse!
@@ -399,6 +466,140 @@ public:
     }
 };
 
+//
+// Scan a range of RecordIds.
+//
+
+class QueryStageCollscanMinAndMaxRecord : public QueryStageCollectionScanBase {
+public:
+    void run() {
+        // Only storage engines with document-level locking can seek to the start of a range.
+        if (!getGlobalServiceContext()->getGlobalStorageEngine()->supportsDocLocking()) {
+            return;
+        }
+
+        AutoGetCollectionForReadCommand ctx(&_opCtx, nss);
+        Collection* coll = ctx.getCollection();
+
+        vector<RecordId> recordIds;
+        getRecordIds(coll, CollectionScanParams::FORWARD, &recordIds);
+
+        WorkingSet ws;
+        CollectionScanParams params;
+        params.collection = coll;
+        params.minRecord = recordIds[10];
+        params.maxRecord = recordIds[39];
+
+        unique_ptr<CollectionScan> scan(new CollectionScan(&_opCtx, params, &ws, NULL));
+        size_t count = 10;
+        while (!scan->isEOF()) {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            PlanStage::StageState state = scan->work(&id);
+            if (PlanStage::ADVANCED == state) {
+                ASSERT_EQUALS(recordIds[count], ws.get(id)->recordId);
+                ++count;
+            }
+        }
+        ASSERT_EQUALS(40U, count);
+    }
+};
+
+//
+// Split a scan across worker threads, yielding while it runs.
+//
+
+class QueryStageCollscanParallel : public QueryStageCollectionScanBase {
+public:
+    void run() {
+        if (!getGlobalServiceContext()->getGlobalStorageEngine()->supportsDocLocking()) {
+            return;
+        }
+
+        AutoGetCollectionForReadCommand ctx(&_opCtx, nss);
+
+        CollectionScanParams params;
+        params.collection = ctx.getCollection();
+
+        const CollatorInterface* collator = nullptr;
+        StatusWithMatchExpression statusWithMatcher = MatchExpressionParser::parse(
+            BSON("foo" << BSON("$lt" << 25)), ExtensionsCallbackDisallowExtensions(), collator);
+        ASSERT_OK(statusWithMatcher.getStatus());
+        unique_ptr<MatchExpression> filterExpr = std::move(statusWithMatcher.getValue());
+
+        WorkingSet ws;
+        ParallelCollectionScan scan(&_opCtx, params, &ws, filterExpr.get(), 4);
+        vector<int> found;
+        while (!scan.isEOF()) {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            PlanStage::StageState state = scan.work(&id);
+            ASSERT_NOT_EQUALS(PlanStage::FAILURE, state);
+            if (PlanStage::ADVANCED == state) {
+                found.push_back(ws.get(id)->obj.value()["foo"].numberInt());
+                ws.free(id);
+
+                // Pause and resume the workers, as a yield would.
+                scan.saveState();
+                scan.restoreState();
+            }
+        }
+
+        // The workers return the matching documents in no particular order.
+        std::sort(found.begin(), found.end());
+        ASSERT_EQUALS(25U, found.size());
+        for (int i = 0; i < 25; ++i) {
+            ASSERT_EQUALS(i, found[i]);
+        }
+
+        auto stats = static_cast<const ParallelCollectionScanStats*>(scan.getSpecificStats());
+        ASSERT_EQUALS(static_cast<size_t>(numObj()), stats->docsTested);
+        ASSERT_EQUALS(4U, stats->numWorkers);
+    }
+};
+
+//
+// Stop the workers while the scan is detached, as it is between getMores.
+//
+
+class QueryStageCollscanParallelDetach : public QueryStageCollectionScanBase {
+public:
+    void run() {
+        if (!getGlobalServiceContext()->getGlobalStorageEngine()->supportsDocLocking()) {
+            return;
+        }
+
+        AutoGetCollectionForReadCommand ctx(&_opCtx, nss);
+
+        CollectionScanParams params;
+        params.collection = ctx.getCollection();
+
+        WorkingSet ws;
+        ParallelCollectionScan scan(&_opCtx, params, &ws, nullptr, 4);
+        vector<int> found;
+        while (!scan.isEOF()) {
+            WorkingSetID id = WorkingSet::INVALID_ID;
+            PlanStage::StageState state = scan.work(&id);
+            ASSERT_NOT_EQUALS(PlanStage::FAILURE, state);
+            if (PlanStage::ADVANCED == state) {
+                found.push_back(ws.get(id)->obj.value()["foo"].numberInt());
+                ws.free(id);
+
+                // The workers exit on detach, and carry on where they stopped once worked again.
+                scan.saveState();
+                scan.detachFromOperationContext();
+                scan.reattachToOperationContext(&_opCtx);
+                scan.restoreState();
+            }
+        }
+
+        // Every document is returned exactly once.
+        std::sort(found.begin(), found.end());
+        ASSERT_EQUALS(static_cast<size_t>(numObj()), found.size());
+        for (int i = 0; i < numObj(); ++i) {
+            ASSERT_EQUALS(i, found[i]);
+        }
+    }
+};
+
 class All : public Suite {
 public:
     All() : Suite("QueryStageCollectionScan") {}
@@ -413,6 +614,10 @@ public:
         add<QueryStageCollscanObjectsInOrderBackward>();
         add<QueryStageCollscanInvalidateUpcomingObject>();
         add<QueryStageCollscanInvalidateUpcomingObjectBackward>();
+        add<QueryStageCollscanRefetchesBufferedObjectsAfterYield>();
+        add<QueryStageCollscanMinAndMaxRecord>();
+        add<QueryStageCollscanParallel>();
+        add<QueryStageCollscanParallelDetach>();
     }
 };
 
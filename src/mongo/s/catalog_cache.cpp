@@ -32,8 +32,10 @@
 
 #include "mongo/s/catalog_cache.h"
 
+#include "mongo/base/counter.h"
 #include "mongo/base/status.h"
 #include "mongo/base/status_with.h"
+#include "mongo/db/commands/server_status_metric.h"
 #include "mongo/db/query/collation/collator_factory_interface.h"
 #include "mongo/db/repl/optime_with.h"
 #include "mongo/s/catalog/sharding_catalog_client.h"
@@ -53,6 +55,27 @@ namespace {
 // server is found to be inconsistent.
 const int kMaxInconsistentRoutingInfoRefreshAttempts = 3;
 
+// Statistics about the routing tables built by refreshes
+Counter64 fullRefreshes;
+Counter64 incrementalRefreshes;
+Counter64 refreshMicros;
+Counter64 chunksRefreshed;
+Counter64 chunkMapSegmentsRebuilt;
+Counter64 chunkMapSegmentsShared;
+
+ServerStatusMetricField<Counter64> displayFullRefreshes("catalogCache.fullRefreshes",
+                                                        &fullRefreshes);
+ServerStatusMetricField<Counter64> displayIncrementalRefreshes("catalogCache.incrementalRefreshes",
+                                                               &incrementalRefreshes);
+ServerStatusMetricField<Counter64> displayRefreshMicros("catalogCache.refreshMicros",
+                                                        &refreshMicros);
+ServerStatusMetricField<Counter64> displayChunksRefreshed("catalogCache.chunksRefreshed",
+                                                          &chunksRefreshed);
+ServerStatusMetricField<Counter64> displayChunkMapSegmentsRebuilt(
+    "catalogCache.chunkMapSegmentsRebuilt", &chunkMapSegmentsRebuilt);
+ServerStatusMetricField<Counter64> displayChunkMapSegmentsShared(
+    "catalogCache.chunkMapSegmentsShared", &chunkMapSegmentsShared);
+
 /**
  * Given an (optional) initial routing table and a set of changed chunks returned by the catalog
  * cache loader, produces a new routing table with the changes applied.
@@ -78,10 +101,11 @@ std::shared_ptr<ChunkManager> refreshCollectionRoutingInfo(
 
     const auto collectionAndChunks = uassertStatusOK(std::move(swCollectionAndChangedChunks));
 
+    Timer t;
+
     // Check whether the collection epoch might have changed
     ChunkVersion startingCollectionVersion;
-    ChunkMap chunkMap =
-        SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<std::shared_ptr<Chunk>>();
+    ChunkMap chunkMap;
 
     if (!existingRoutingInfo) {
         // If we don't have a basis chunk manager, do a full refresh
@@ -96,6 +120,9 @@ std::shared_ptr<ChunkManager> refreshCollectionRoutingInfo(
 
     ChunkVersion collectionVersion = startingCollectionVersion;
 
+    std::vector<std::shared_ptr<Chunk>> changedChunks;
+    changedChunks.reserve(collectionAndChunks.changedChunks.size());
+
     for (const auto& chunk : collectionAndChunks.changedChunks) {
         const auto& chunkVersion = chunk.getVersion();
 
@@ -112,19 +139,7 @@ std::shared_ptr<ChunkManager> refreshCollectionRoutingInfo(
         // Ensure chunk references a valid shard and that the shard is available and loaded
         uassertStatusOK(Grid::get(opCtx)->shardRegistry()->getShard(opCtx, chunk.getShard()));
 
-        // Returns the first chunk with a max key that is > min - implies that the chunk overlaps
-        // min
-        const auto low = chunkMap.upper_bound(chunk.getMin());
-
-        // Returns the first chunk with a max key that is > max - implies that the next chunk cannot
-        // not overlap max
-        const auto high = chunkMap.upper_bound(chunk.getMax());
-
-        // Erase all chunks from the map, which overlap the chunk we got from the persistent store
-        chunkMap.erase(low, high);
-
-        // Insert only the chunk itself
-        chunkMap.insert(std::make_pair(chunk.getMax(), std::make_shared<Chunk>(chunk)));
+        changedChunks.push_back(std::make_shared<Chunk>(chunk));
     }
 
     // If at least one diff was applied, the metadata is correct, but it might not have changed so
@@ -138,6 +153,12 @@ std::shared_ptr<ChunkManager> refreshCollectionRoutingInfo(
         return existingRoutingInfo;
     }
 
+    // Only the parts of the existing routing table which the changed chunks overlap are rebuilt,
+    // the rest is shared with the new routing table.
+    const bool fullRefresh = chunkMap.empty();
+    ChunkMap::ApplyStats applyStats;
+    chunkMap = chunkMap.applyChanges(changedChunks, &applyStats);
+
     std::unique_ptr<CollatorInterface> defaultCollator;
     if (!collectionAndChunks.defaultCollation.isEmpty()) {
         // The collation should have been validated upon collection creation
@@ -145,12 +166,26 @@ std::shared_ptr<ChunkManager> refreshCollectionRoutingInfo(
                                               ->makeFromBSON(collectionAndChunks.defaultCollation));
     }
 
-    return stdx::make_unique<ChunkManager>(nss,
-                                           KeyPattern(collectionAndChunks.shardKeyPattern),
-                                           std::move(defaultCollator),
-                                           collectionAndChunks.shardKeyIsUnique,
-                                           std::move(chunkMap),
-                                           collectionVersion);
+    auto newRoutingInfo =
+        stdx::make_unique<ChunkManager>(nss,
+                                        KeyPattern(collectionAndChunks.shardKeyPattern),
+                                        std::move(defaultCollator),
+                                        collectionAndChunks.shardKeyIsUnique,
+                                        std::move(chunkMap),
+                                        collectionVersion);
+
+    (fullRefresh ? fullRefreshes : incrementalRefreshes).increment();
+    refreshMicros.increment(t.micros());
+    chunksRefreshed.increment(changedChunks.size());
+    chunkMapSegmentsRebuilt.increment(applyStats.segmentsRebuilt);
+    chunkMapSegmentsShared.increment(applyStats.segmentsShared);
+
+    LOG(1) << "Built routing table for " << nss << " at version " << collectionVersion << " from "
+           << changedChunks.size() << " changed chunks in " << t.micros() << " micros, rebuilding "
+           << applyStats.segmentsRebuilt << " and sharing " << applyStats.segmentsShared
+           << " chunk map segments";
+
+    return std::move(newRoutingInfo);
 }
 
 }  // namespace
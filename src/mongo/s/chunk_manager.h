@@ -36,6 +36,7 @@
 #include "mongo/db/namespace_string.h"
 #include "mongo/db/query/collation/collator_interface.h"
 #include "mongo/s/chunk.h"
+#include "mongo/s/chunk_map.h"
 #include "mongo/s/chunk_version.h"
 #include "mongo/s/client/shard.h"
 #include "mongo/s/shard_key_pattern.h"
@@ -47,12 +48,6 @@ class CanonicalQuery;
 struct QuerySolutionNode;
 class OperationContext;
 
-// Ordered map from the max for each chunk to an entry describing the chunk
-using ChunkMap = BSONObjIndexedMap<std::shared_ptr<Chunk>>;
-
-// Map from a shard is to the max chunk version on that shard
-using ShardVersionMap = std::map<ShardId, ChunkVersion>;
-
 class ChunkManager {
     MONGO_DISALLOW_COPYING(ChunkManager);
 
@@ -104,7 +99,7 @@ public:
     }
 
     const ShardVersionMap& shardVersions() const {
-        return _chunkMapViews.shardVersions;
+        return _shardVersions;
     }
 
     /**
@@ -179,42 +174,10 @@ private:
     friend class CollectionRoutingDataLoader;
 
     /**
-     * Represents a range of chunk keys [getMin(), getMax()) and the id of the shard on which they
-     * reside according to the metadata.
-     */
-    struct ShardAndChunkRange {
-        const BSONObj& min() const {
-            return range.getMin();
-        }
-
-        const BSONObj& max() const {
-            return range.getMax();
-        }
-
-        ChunkRange range;
-        ShardId shardId;
-    };
-
-    using ChunkRangeMap = BSONObjIndexedMap<ShardAndChunkRange>;
-
-    /**
-     * Contains different transformations of the chunk map for efficient querying
-     */
-    struct ChunkMapViews {
-        // Transformation of the chunk map containing what range of keys reside on which shard. The
-        // index is the max key of the respective range and the union of all ranges in a such
-        // constructed map must cover the complete space from [MinKey, MaxKey).
-        const ChunkRangeMap chunkRangeMap;
-
-        // Map from shard id to the maximum chunk version for that shard. If a shard contains no
-        // chunks, it won't be present in this map.
-        const ShardVersionMap shardVersions;
-    };
-
-    /**
-     * Does a single pass over the chunkMap and constructs the ChunkMapViews object.
+     * Checks that the chunkMap covers the complete key space and returns the max chunk version of
+     * each shard.
      */
-    static ChunkMapViews _constructChunkMapViews(const OID& epoch, const ChunkMap& chunkMap);
+    static ShardVersionMap _constructShardVersionMap(const OID& epoch, const ChunkMap& chunkMap);
 
     // The shard versioning mechanism hinges on keeping track of the number of times we reload
     // ChunkManagers.
@@ -236,8 +199,9 @@ private:
     // ranges must cover the complete space from [MinKey, MaxKey).
     const ChunkMap _chunkMap;
 
-    // Different transformations of the chunk map for efficient querying
-    const ChunkMapViews _chunkMapViews;
+    // Map from shard id to the maximum chunk version for that shard. If a shard contains no
+    // chunks, it won't be present in this map.
+    const ShardVersionMap _shardVersions;
 
     // Max version across all chunks
     const ChunkVersion _collectionVersion;
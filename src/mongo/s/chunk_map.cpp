@@ -0,0 +1,479 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/chunk_map.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "mongo/bson/ordering.h"
+#include "mongo/bson/simple_bsonobj_comparator.h"
+#include "mongo/db/storage/key_string.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace {
+
+bool lessThan(const BSONObj& lhs, const BSONObj& rhs) {
+    return SimpleBSONObjComparator::kInstance.evaluate(lhs < rhs);
+}
+
+void checkContiguous(const Chunk& previous, const Chunk& next) {
+    uassert(ErrorCodes::ConflictingOperationInProgress,
+            str::stream() << "Gap or an overlap between chunks " << previous.toString() << " and "
+                          << next.toString(),
+            SimpleBSONObjComparator::kInstance.evaluate(previous.getMax() == next.getMin()));
+}
+
+// Shard key values are KeyString-encoded so that the byte-wise order of the encodings is the
+// order of the values. All shard key fields sort ascending, including the hashed ones.
+const KeyString::Version kKeyStringVersion = KeyString::Version::V1;
+const Ordering kAllAscending = Ordering::make(BSONObj());
+
+StringData toStringData(const KeyString& encodedKey) {
+    return StringData(encodedKey.getBuffer(), encodedKey.getSize());
+}
+
+int compareEncoded(StringData lhs, StringData rhs) {
+    const size_t minSize = std::min(lhs.size(), rhs.size());
+    const int result = std::memcmp(lhs.rawData(), rhs.rawData(), minSize);
+    if (result != 0) {
+        return result;
+    }
+    return lhs.size() < rhs.size() ? -1 : (lhs.size() > rhs.size() ? 1 : 0);
+}
+
+/**
+ * Returns true and sets 'value' if 'key' consists of a single NumberLong field, or of MaxKey if
+ * 'allowMaxKey' is true, in which case 'value' is the largest long long. Since that value stands
+ * for MaxKey, a NumberLong equal to it is not eligible.
+ */
+bool getNumberLongKey(const BSONObj& key, bool allowMaxKey, long long* value) {
+    BSONObjIterator it(key);
+    if (!it.more()) {
+        return false;
+    }
+
+    const BSONElement elem = it.next();
+    if (it.more()) {
+        return false;
+    }
+
+    if (elem.type() == NumberLong) {
+        *value = elem._numberLong();
+        return *value != std::numeric_limits<long long>::max();
+    }
+
+    if (allowMaxKey && elem.type() == MaxKey) {
+        *value = std::numeric_limits<long long>::max();
+        return true;
+    }
+
+    return false;
+}
+
+}  // namespace
+
+/**
+ * A run of chunks which are contiguous in the key space, along with the ranges of consecutive
+ * chunks that live on the same shard and the max chunk version of each shard.
+ */
+class ChunkMap::Segment {
+public:
+    struct ShardRange {
+        BSONObj max;
+        ShardId shardId;
+    };
+
+    explicit Segment(std::vector<value_type> chunks) : entries(std::move(chunks)) {
+        invariant(!entries.empty());
+
+        for (size_t i = 0; i < entries.size(); ++i) {
+            const auto& chunk = *entries[i].second;
+            if (i > 0) {
+                checkContiguous(*entries[i - 1].second, chunk);
+            }
+
+            if (shardRanges.empty() || shardRanges.back().shardId != chunk.getShardId()) {
+                shardRanges.push_back({chunk.getMax(), chunk.getShardId()});
+            } else {
+                shardRanges.back().max = chunk.getMax();
+            }
+
+            auto it = shardVersions.find(chunk.getShardId());
+            if (it == shardVersions.end()) {
+                shardVersions.emplace(chunk.getShardId(), chunk.getLastmod());
+            } else if (chunk.getLastmod() > it->second) {
+                it->second = chunk.getLastmod();
+            }
+
+            encodedMaxes.push_back(entries[i].first);
+
+            long long numberLongMax;
+            if (numberLongKeys && getNumberLongKey(entries[i].first, true, &numberLongMax)) {
+                numberLongMaxes.push_back(numberLongMax);
+            } else {
+                numberLongKeys = false;
+            }
+        }
+
+        if (!numberLongKeys) {
+            numberLongMaxes.clear();
+        }
+
+        for (const auto& range : shardRanges) {
+            encodedShardRangeMaxes.push_back(range.max);
+        }
+    }
+
+    const BSONObj& min() const {
+        return entries.front().second->getMin();
+    }
+
+    const BSONObj& max() const {
+        return entries.back().first;
+    }
+
+    // The chunks in key order, keyed by their max key.
+    const std::vector<value_type> entries;
+
+    // Ranges of consecutive chunks on the same shard, in key order.
+    std::vector<ShardRange> shardRanges;
+
+    // Max version of the chunks of each shard which owns chunks in this segment.
+    ShardVersionMap shardVersions;
+
+    // Encoded max key of each chunk and of each shard range.
+    EncodedKeys encodedMaxes;
+    EncodedKeys encodedShardRangeMaxes;
+
+    // Max key of each chunk as an integer, if all of them are NumberLongs or MaxKey.
+    bool numberLongKeys = true;
+    std::vector<long long> numberLongMaxes;
+};
+
+void ChunkMap::EncodedKeys::push_back(const BSONObj& key) {
+    const KeyString encodedKey(kKeyStringVersion, key, kAllAscending);
+    push_back(toStringData(encodedKey));
+}
+
+void ChunkMap::EncodedKeys::push_back(StringData encodedKey) {
+    _buffer.append(encodedKey.rawData(), encodedKey.size());
+    _ends.push_back(_buffer.size());
+}
+
+size_t ChunkMap::EncodedKeys::upperBound(StringData encodedKey) const {
+    size_t low = 0;
+    size_t high = _ends.size();
+    while (low < high) {
+        const size_t mid = low + (high - low) / 2;
+        if (compareEncoded(encodedKey, (*this)[mid]) < 0) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+    return low;
+}
+
+ChunkMap::const_iterator::reference ChunkMap::const_iterator::operator*() const {
+    return (*_segments)[_segment]->entries[_pos];
+}
+
+ChunkMap::const_iterator& ChunkMap::const_iterator::operator++() {
+    if (++_pos == (*_segments)[_segment]->entries.size()) {
+        ++_segment;
+        _pos = 0;
+    }
+    return *this;
+}
+
+ChunkMap::const_iterator& ChunkMap::const_iterator::operator--() {
+    if (_pos == 0) {
+        --_segment;
+        _pos = (*_segments)[_segment]->entries.size() - 1;
+    } else {
+        --_pos;
+    }
+    return *this;
+}
+
+ChunkMap::ChunkMap(SegmentVector segments) : _segments(std::move(segments)) {
+    _numberLongKeys = !_segments.empty();
+
+    if (!_segments.empty()) {
+        const KeyString encodedMin(kKeyStringVersion, _segments.front()->min(), kAllAscending);
+        _encodedMinKey = toStringData(encodedMin).toString();
+    }
+
+    for (size_t i = 0; i < _segments.size(); ++i) {
+        const auto& segment = *_segments[i];
+        if (i > 0) {
+            checkContiguous(*_segments[i - 1]->entries.back().second,
+                            *segment.entries.front().second);
+        }
+        _size += segment.entries.size();
+
+        _segmentMaxes.push_back(segment.encodedMaxes[segment.encodedMaxes.size() - 1]);
+
+        if (segment.numberLongKeys) {
+            _segmentNumberLongMaxes.push_back(segment.numberLongMaxes.back());
+        } else {
+            _numberLongKeys = false;
+        }
+    }
+
+    if (!_numberLongKeys) {
+        _segmentNumberLongMaxes.clear();
+    }
+}
+
+ChunkMap ChunkMap::applyChanges(const std::vector<std::shared_ptr<Chunk>>& changedChunks,
+                                ApplyStats* stats) const {
+    // Apply the changed chunks to each other first, in the same way as they will be applied to
+    // the existing chunks below.
+    auto updatesMap =
+        SimpleBSONObjComparator::kInstance.makeBSONObjIndexedMap<std::shared_ptr<Chunk>>();
+    for (const auto& chunk : changedChunks) {
+        updatesMap.erase(updatesMap.upper_bound(chunk->getMin()),
+                         updatesMap.upper_bound(chunk->getMax()));
+        updatesMap.insert(std::make_pair(chunk->getMax(), chunk));
+    }
+
+    std::vector<std::shared_ptr<Chunk>> updates;
+    updates.reserve(updatesMap.size());
+    for (const auto& entry : updatesMap) {
+        updates.push_back(entry.second);
+    }
+
+    ApplyStats applyStats;
+    SegmentVector newSegments;
+    std::vector<value_type> pending;
+
+    // Cuts the chunks collected for rebuilt segments into evenly sized segments.
+    const auto flushPending = [&] {
+        if (pending.empty()) {
+            return;
+        }
+
+        const size_t numSegments = (pending.size() + kTargetSegmentSize - 1) / kTargetSegmentSize;
+        size_t begin = 0;
+        for (size_t i = 1; i <= numSegments; ++i) {
+            const size_t end = pending.size() * i / numSegments;
+            newSegments.push_back(std::make_shared<Segment>(
+                std::vector<value_type>(std::make_move_iterator(pending.begin() + begin),
+                                        std::make_move_iterator(pending.begin() + end))));
+            begin = end;
+        }
+
+        applyStats.segmentsRebuilt += numSegments;
+        pending.clear();
+    };
+
+    const auto pushUpdate = [&](size_t i) {
+        pending.emplace_back(updates[i]->getMax(), updates[i]);
+    };
+
+    // The updates up to 'next' have already been placed. Since both the updates and the existing
+    // chunks are sorted and do not overlap among themselves, a single merge pass suffices. An
+    // existing chunk is dropped if any update overlaps it.
+    size_t next = 0;
+    for (const auto& segment : _segments) {
+        const bool touched =
+            (next < updates.size() && lessThan(updates[next]->getMin(), segment->max())) ||
+            (next > 0 && lessThan(segment->min(), updates[next - 1]->getMax()));
+        if (!touched) {
+            flushPending();
+            newSegments.push_back(segment);
+            ++applyStats.segmentsShared;
+            continue;
+        }
+
+        for (const auto& entry : segment->entries) {
+            const auto& chunk = *entry.second;
+
+            while (next < updates.size() && !lessThan(chunk.getMin(), updates[next]->getMax())) {
+                pushUpdate(next++);
+            }
+
+            bool replaced = next > 0 && lessThan(chunk.getMin(), updates[next - 1]->getMax());
+            while (next < updates.size() && lessThan(updates[next]->getMin(), chunk.getMax())) {
+                pushUpdate(next++);
+                replaced = true;
+            }
+
+            if (!replaced) {
+                pending.push_back(entry);
+            }
+        }
+    }
+
+    while (next < updates.size()) {
+        pushUpdate(next++);
+    }
+    flushPending();
+
+    if (stats) {
+        *stats = applyStats;
+    }
+
+    return ChunkMap(std::move(newSegments));
+}
+
+size_t ChunkMap::_findSegment(StringData encodedKey) const {
+    return _segmentMaxes.upperBound(encodedKey);
+}
+
+ChunkMap::const_iterator ChunkMap::_upperBound(StringData encodedKey) const {
+    const size_t segment = _findSegment(encodedKey);
+    if (segment == _segments.size()) {
+        return end();
+    }
+
+    return const_iterator(
+        &_segments, segment, _segments[segment]->encodedMaxes.upperBound(encodedKey));
+}
+
+ChunkMap::const_iterator ChunkMap::_upperBound(long long numberLongKey) const {
+    const auto segmentIt = std::upper_bound(
+        _segmentNumberLongMaxes.begin(), _segmentNumberLongMaxes.end(), numberLongKey);
+    if (segmentIt == _segmentNumberLongMaxes.end()) {
+        return end();
+    }
+
+    const size_t segment = segmentIt - _segmentNumberLongMaxes.begin();
+    const auto& maxes = _segments[segment]->numberLongMaxes;
+    return const_iterator(&_segments,
+                          segment,
+                          std::upper_bound(maxes.begin(), maxes.end(), numberLongKey) -
+                              maxes.begin());
+}
+
+StringData ChunkMap::_encodedMin(const_iterator it) const {
+    if (it._pos > 0) {
+        return _segments[it._segment]->encodedMaxes[it._pos - 1];
+    }
+    if (it._segment > 0) {
+        return _segmentMaxes[it._segment - 1];
+    }
+    return _encodedMinKey;
+}
+
+ChunkMap::const_iterator ChunkMap::upper_bound(const BSONObj& key) const {
+    // Hashed shard keys can be looked up without encoding them
+    long long numberLongKey;
+    if (_numberLongKeys && getNumberLongKey(key, false, &numberLongKey)) {
+        return _upperBound(numberLongKey);
+    }
+
+    const KeyString encodedKey(kKeyStringVersion, key, kAllAscending);
+    return _upperBound(toStringData(encodedKey));
+}
+
+ChunkMap::const_iterator ChunkMap::findIntersectingChunk(const BSONObj& key) const {
+    // The chunk with the first max key greater than 'key' contains it, unless 'key' is less than
+    // the min key of that chunk, which is the max key of the chunk before it
+    long long numberLongKey;
+    if (_numberLongKeys && getNumberLongKey(key, false, &numberLongKey)) {
+        const auto it = _upperBound(numberLongKey);
+        if (it == end()) {
+            return it;
+        }
+        if (it._pos > 0) {
+            const auto& maxes = _segments[it._segment]->numberLongMaxes;
+            return maxes[it._pos - 1] <= numberLongKey ? it : end();
+        }
+        if (it._segment > 0) {
+            return _segmentNumberLongMaxes[it._segment - 1] <= numberLongKey ? it : end();
+        }
+
+        // The min key of the first chunk need not be a NumberLong
+    }
+
+    const KeyString encodedKey(kKeyStringVersion, key, kAllAscending);
+    const auto it = _upperBound(toStringData(encodedKey));
+    if (it == end() || compareEncoded(toStringData(encodedKey), _encodedMin(it)) < 0) {
+        return end();
+    }
+    return it;
+}
+
+void ChunkMap::getShardIdsForRange(const BSONObj& min,
+                                   const BSONObj& max,
+                                   size_t numShards,
+                                   std::set<ShardId>* shardIds) const {
+    const KeyString encodedMin(kKeyStringVersion, min, kAllAscending);
+    const KeyString encodedMax(kKeyStringVersion, max, kAllAscending);
+
+    size_t segment = _findSegment(toStringData(encodedMin));
+
+    // The chunk map must always cover the entire key space
+    invariant(segment != _segments.size());
+
+    size_t rangeIndex =
+        _segments[segment]->encodedShardRangeMaxes.upperBound(toStringData(encodedMin));
+
+    for (; segment != _segments.size(); ++segment, rangeIndex = 0) {
+        const auto& ranges = _segments[segment]->shardRanges;
+        const auto& rangeMaxes = _segments[segment]->encodedShardRangeMaxes;
+        for (; rangeIndex < ranges.size(); ++rangeIndex) {
+            shardIds->insert(ranges[rangeIndex].shardId);
+
+            // The last range to include is the one which contains 'max', and there is no need
+            // to look further once we know that all shards are needed.
+            if (compareEncoded(toStringData(encodedMax), rangeMaxes[rangeIndex]) < 0 ||
+                shardIds->size() == numShards) {
+                return;
+            }
+        }
+    }
+}
+
+ShardVersionMap ChunkMap::getShardVersions(const OID& epoch) const {
+    ShardVersionMap shardVersions;
+    for (const auto& segment : _segments) {
+        for (const auto& segmentShardVersion : segment->shardVersions) {
+            auto it = shardVersions.find(segmentShardVersion.first);
+            if (it == shardVersions.end()) {
+                it = shardVersions.emplace(segmentShardVersion.first, ChunkVersion(0, 0, epoch))
+                         .first;
+            }
+
+            if (segmentShardVersion.second > it->second) {
+                it->second = segmentShardVersion.second;
+            }
+        }
+    }
+    return shardVersions;
+}
+
+}  // namespace mongo
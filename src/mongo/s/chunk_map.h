@@ -0,0 +1,266 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <iterator>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/s/chunk.h"
+#include "mongo/s/chunk_version.h"
+#include "mongo/s/shard_id.h"
+
+namespace mongo {
+
+// Map from a shard id to the max chunk version on that shard
+using ShardVersionMap = std::map<ShardId, ChunkVersion>;
+
+/**
+ * Immutable ordered map from the max key of each chunk of a collection to the chunk.
+ *
+ * The chunks are stored in segments of a few hundred chunks each, which are shared between a
+ * ChunkMap and the maps derived from it with applyChanges(). Applying the chunks that changed
+ * since a routing table was loaded therefore only copies the segments that the changes touch,
+ * instead of the whole routing table, which matters for collections with hundreds of thousands
+ * of chunks. Each segment also caches the ranges of consecutive chunks that live on the same
+ * shard and the max chunk version of each shard, so that neither needs a pass over all chunks.
+ *
+ * Lookups do not compare BSON. The max keys of the chunks, of the shard ranges and of the segments
+ * are kept KeyString-encoded in contiguous sorted arrays, so that a lookup encodes its key once and
+ * then binary searches with memcmp. When all chunk boundaries are NumberLongs, as for hashed shard
+ * keys, they are also kept as plain integers and lookups of NumberLong keys skip the encoding.
+ */
+class ChunkMap {
+public:
+    using value_type = std::pair<BSONObj, std::shared_ptr<Chunk>>;
+
+    /**
+     * Describes how much of a ChunkMap applyChanges() had to rebuild.
+     */
+    struct ApplyStats {
+        size_t segmentsRebuilt = 0;
+        size_t segmentsShared = 0;
+    };
+
+private:
+    class Segment;
+    using SegmentVector = std::vector<std::shared_ptr<const Segment>>;
+
+    /**
+     * Sorted KeyString encodings of shard key values, stored back to back in a single buffer.
+     */
+    class EncodedKeys {
+    public:
+        void push_back(const BSONObj& key);
+        void push_back(StringData encodedKey);
+
+        /**
+         * Returns the index of the first key greater than 'encodedKey', or size() if there is
+         * none.
+         */
+        size_t upperBound(StringData encodedKey) const;
+
+        StringData operator[](size_t i) const {
+            const size_t begin = i == 0 ? 0 : _ends[i - 1];
+            return StringData(_buffer.data() + begin, _ends[i] - begin);
+        }
+
+        size_t size() const {
+            return _ends.size();
+        }
+
+    private:
+        std::string _buffer;
+        std::vector<uint32_t> _ends;
+    };
+
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = ChunkMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const value_type*;
+        using reference = const value_type&;
+
+        const_iterator() = default;
+
+        reference operator*() const;
+        pointer operator->() const {
+            return &**this;
+        }
+
+        const_iterator& operator++();
+        const_iterator operator++(int) {
+            auto old = *this;
+            ++*this;
+            return old;
+        }
+
+        const_iterator& operator--();
+        const_iterator operator--(int) {
+            auto old = *this;
+            --*this;
+            return old;
+        }
+
+        bool operator==(const const_iterator& other) const {
+            return _segment == other._segment && _pos == other._pos;
+        }
+        bool operator!=(const const_iterator& other) const {
+            return !(*this == other);
+        }
+
+    private:
+        friend class ChunkMap;
+
+        const_iterator(const SegmentVector* segments, size_t segment, size_t pos)
+            : _segments(segments), _segment(segment), _pos(pos) {}
+
+        const SegmentVector* _segments = nullptr;
+        size_t _segment = 0;
+        size_t _pos = 0;
+    };
+
+    using iterator = const_iterator;
+
+    /**
+     * Target and maximum number of chunks in a segment.
+     */
+    static const size_t kTargetSegmentSize = 256;
+
+    ChunkMap() = default;
+
+    /**
+     * Returns a new map in which 'changedChunks', which must be in increasing order of version,
+     * replace the chunks they overlap, in the same way as applying them one by one would. Chunks
+     * later in 'changedChunks' replace earlier ones that they overlap. Segments of this map which
+     * no changed chunk overlaps are shared with the new map.
+     *
+     * Throws ConflictingOperationInProgress if the resulting chunks do not cover a contiguous
+     * range of keys.
+     */
+    ChunkMap applyChanges(const std::vector<std::shared_ptr<Chunk>>& changedChunks,
+                          ApplyStats* stats = nullptr) const;
+
+    const_iterator begin() const {
+        return const_iterator(&_segments, 0, 0);
+    }
+    const_iterator end() const {
+        return const_iterator(&_segments, _segments.size(), 0);
+    }
+    const_iterator cbegin() const {
+        return begin();
+    }
+    const_iterator cend() const {
+        return end();
+    }
+
+    /**
+     * Returns the first chunk whose max key is greater than 'key', which is the chunk that
+     * contains 'key' if any chunk does. The field names of 'key' are not compared.
+     */
+    const_iterator upper_bound(const BSONObj& key) const;
+
+    /**
+     * Returns the chunk that contains 'key', or end() if no chunk does. Like upper_bound(), this
+     * compares the encoded keys and does not compare field names.
+     */
+    const_iterator findIntersectingChunk(const BSONObj& key) const;
+
+    size_t size() const {
+        return _size;
+    }
+
+    bool empty() const {
+        return _size == 0;
+    }
+
+    size_t numSegments() const {
+        return _segments.size();
+    }
+
+    /**
+     * Adds the ids of the shards owning chunks that overlap [min, max] to 'shardIds', stopping
+     * early once 'shardIds' has 'numShards' entries.
+     */
+    void getShardIdsForRange(const BSONObj& min,
+                             const BSONObj& max,
+                             size_t numShards,
+                             std::set<ShardId>* shardIds) const;
+
+    /**
+     * Returns the max chunk version of each shard that owns chunks.
+     */
+    ShardVersionMap getShardVersions(const OID& epoch) const;
+
+private:
+    explicit ChunkMap(SegmentVector segments);
+
+    /**
+     * Returns the index of the segment which contains the encoded key, or the number of segments
+     * if 'encodedKey' is not less than the max key of the last chunk.
+     */
+    size_t _findSegment(StringData encodedKey) const;
+
+    /**
+     * Implement upper_bound() for an encoded key, and for the value of a NumberLong key when
+     * '_numberLongKeys' is true.
+     */
+    const_iterator _upperBound(StringData encodedKey) const;
+    const_iterator _upperBound(long long numberLongKey) const;
+
+    /**
+     * Returns the encoded min key of the chunk at 'it', which is the max key of the chunk before
+     * it, if any.
+     */
+    StringData _encodedMin(const_iterator it) const;
+
+    SegmentVector _segments;
+    size_t _size = 0;
+
+    // Encoded min key of the first chunk
+    std::string _encodedMinKey;
+
+    // Max key of each segment
+    EncodedKeys _segmentMaxes;
+
+    // Whether all chunk boundaries are NumberLongs, in which case the max key of each segment is
+    // also stored as an integer, with MaxKey standing as the largest long long
+    bool _numberLongKeys = false;
+    std::vector<long long> _segmentNumberLongMaxes;
+};
+
+}  // namespace mongo
@@ -0,0 +1,411 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <limits>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/bson/simple_bsonobj_comparator.h"
+#include "mongo/s/catalog/type_chunk.h"
+#include "mongo/s/chunk_map.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const NamespaceString kNss("TestDB", "TestColl");
+const OID kEpoch = OID::gen();
+
+/**
+ * Returns the i-th of the boundaries MinKey, 1, 2, ..., numChunks - 1, MaxKey.
+ */
+BSONObj boundary(int i, int numChunks) {
+    BSONObjBuilder builder;
+    if (i == 0) {
+        builder.appendMinKey("x");
+    } else if (i == numChunks) {
+        builder.appendMaxKey("x");
+    } else {
+        builder.append("x", i);
+    }
+    return builder.obj();
+}
+
+std::shared_ptr<Chunk> makeChunk(const BSONObj& min,
+                                 const BSONObj& max,
+                                 ChunkVersion version,
+                                 const std::string& shard) {
+    return std::make_shared<Chunk>(ChunkType(kNss, ChunkRange(min, max), version, ShardId(shard)));
+}
+
+/**
+ * Builds a map of 'numChunks' chunks, alternating between shards "0" and "1" every 100 chunks.
+ */
+ChunkMap makeChunkMap(int numChunks, ChunkMap::ApplyStats* stats = nullptr) {
+    std::vector<std::shared_ptr<Chunk>> chunks;
+    for (int i = 0; i < numChunks; ++i) {
+        chunks.push_back(makeChunk(boundary(i, numChunks),
+                                   boundary(i + 1, numChunks),
+                                   ChunkVersion(1, i, kEpoch),
+                                   (i / 100) % 2 ? "1" : "0"));
+    }
+    return ChunkMap().applyChanges(chunks, stats);
+}
+
+/**
+ * Checks that the chunks of 'chunkMap' are keyed by their max and cover the entire key space
+ * contiguously.
+ */
+void assertContiguous(const ChunkMap& chunkMap) {
+    const auto& comparator = SimpleBSONObjComparator::kInstance;
+
+    ASSERT(!chunkMap.empty());
+    ASSERT_BSONOBJ_EQ(BSON("x" << MINKEY), chunkMap.begin()->second->getMin());
+
+    size_t count = 0;
+    for (auto it = chunkMap.begin(); it != chunkMap.end(); ++it, ++count) {
+        ASSERT_BSONOBJ_EQ(it->first, it->second->getMax());
+        if (it != chunkMap.begin()) {
+            ASSERT(comparator.evaluate(std::prev(it)->first == it->second->getMin()));
+        }
+    }
+
+    ASSERT_EQ(chunkMap.size(), count);
+    ASSERT_BSONOBJ_EQ(BSON("x" << MAXKEY), std::prev(chunkMap.end())->first);
+}
+
+TEST(ChunkMapTest, BuildFromEmpty) {
+    ChunkMap::ApplyStats stats;
+    const auto chunkMap = makeChunkMap(1000, &stats);
+
+    ASSERT_EQ(1000U, chunkMap.size());
+    ASSERT_EQ(4U, chunkMap.numSegments());
+    ASSERT_EQ(4U, stats.segmentsRebuilt);
+    ASSERT_EQ(0U, stats.segmentsShared);
+    assertContiguous(chunkMap);
+
+    const auto shardVersions = chunkMap.getShardVersions(kEpoch);
+    ASSERT_EQ(2U, shardVersions.size());
+    ASSERT_EQ(ChunkVersion(1, 999, kEpoch), shardVersions.at(ShardId("1")));
+    ASSERT_EQ(ChunkVersion(1, 899, kEpoch), shardVersions.at(ShardId("0")));
+}
+
+TEST(ChunkMapTest, EmptyChangesShareAllSegments) {
+    const auto chunkMap = makeChunkMap(1000);
+
+    ChunkMap::ApplyStats stats;
+    const auto newChunkMap = chunkMap.applyChanges({}, &stats);
+    ASSERT_EQ(0U, stats.segmentsRebuilt);
+    ASSERT_EQ(4U, stats.segmentsShared);
+    ASSERT_EQ(1000U, newChunkMap.size());
+}
+
+TEST(ChunkMapTest, SplitRebuildsOnlyTouchedSegments) {
+    const auto chunkMap = makeChunkMap(1000);
+
+    // Split chunk [10, 11) at 10.5
+    const auto splitPoint = BSON("x" << 10.5);
+    ChunkMap::ApplyStats stats;
+    const auto newChunkMap = chunkMap.applyChanges(
+        {makeChunk(boundary(10, 1000), splitPoint, ChunkVersion(2, 0, kEpoch), "0"),
+         makeChunk(splitPoint, boundary(11, 1000), ChunkVersion(2, 1, kEpoch), "0")},
+        &stats);
+
+    // The first segment grows past the target size, so it gets split in two
+    ASSERT_EQ(2U, stats.segmentsRebuilt);
+    ASSERT_EQ(3U, stats.segmentsShared);
+    ASSERT_EQ(5U, newChunkMap.numSegments());
+    ASSERT_EQ(1001U, newChunkMap.size());
+    assertContiguous(newChunkMap);
+
+    auto it = newChunkMap.upper_bound(BSON("x" << 10));
+    ASSERT_BSONOBJ_EQ(splitPoint, it->first);
+    ASSERT_BSONOBJ_EQ(boundary(11, 1000), (++it)->first);
+
+    // The original map is left unchanged
+    ASSERT_EQ(1000U, chunkMap.size());
+    assertContiguous(chunkMap);
+    ASSERT_BSONOBJ_EQ(boundary(11, 1000), chunkMap.upper_bound(BSON("x" << 10))->first);
+}
+
+TEST(ChunkMapTest, MergeAcrossSegments) {
+    const auto chunkMap = makeChunkMap(1000);
+
+    // Merge the chunks from 200 to 300, which span the first and second segments
+    ChunkMap::ApplyStats stats;
+    const auto newChunkMap = chunkMap.applyChanges(
+        {makeChunk(boundary(200, 1000), boundary(300, 1000), ChunkVersion(2, 0, kEpoch), "0")},
+        &stats);
+
+    ASSERT_EQ(2U, stats.segmentsRebuilt);
+    ASSERT_EQ(2U, stats.segmentsShared);
+    ASSERT_EQ(901U, newChunkMap.size());
+    assertContiguous(newChunkMap);
+
+    const auto it = newChunkMap.upper_bound(BSON("x" << 250));
+    ASSERT_BSONOBJ_EQ(boundary(200, 1000), it->second->getMin());
+    ASSERT_BSONOBJ_EQ(boundary(300, 1000), it->second->getMax());
+}
+
+TEST(ChunkMapTest, MoveUpdatesShardVersions) {
+    const auto chunkMap = makeChunkMap(1000);
+
+    // Move the first chunk to a new shard, which bumps the version of the donor's remaining chunk
+    const auto newChunkMap = chunkMap.applyChanges(
+        {makeChunk(boundary(0, 1000), boundary(1, 1000), ChunkVersion(2, 0, kEpoch), "2"),
+         makeChunk(boundary(1, 1000), boundary(2, 1000), ChunkVersion(2, 1, kEpoch), "0")});
+    assertContiguous(newChunkMap);
+
+    const auto shardVersions = newChunkMap.getShardVersions(kEpoch);
+    ASSERT_EQ(3U, shardVersions.size());
+    ASSERT_EQ(ChunkVersion(2, 1, kEpoch), shardVersions.at(ShardId("0")));
+    ASSERT_EQ(ChunkVersion(1, 999, kEpoch), shardVersions.at(ShardId("1")));
+    ASSERT_EQ(ChunkVersion(2, 0, kEpoch), shardVersions.at(ShardId("2")));
+}
+
+TEST(ChunkMapTest, LaterChangesReplaceEarlierOnes) {
+    const auto chunkMap = makeChunkMap(10);
+
+    // Split a chunk and then merge it back again in the same batch of changes
+    const auto splitPoint = BSON("x" << 5.5);
+    const auto newChunkMap = chunkMap.applyChanges(
+        {makeChunk(boundary(5, 10), splitPoint, ChunkVersion(2, 0, kEpoch), "0"),
+         makeChunk(splitPoint, boundary(6, 10), ChunkVersion(2, 1, kEpoch), "0"),
+         makeChunk(boundary(5, 10), boundary(6, 10), ChunkVersion(3, 0, kEpoch), "1")});
+
+    ASSERT_EQ(10U, newChunkMap.size());
+    assertContiguous(newChunkMap);
+    ASSERT_EQ(ShardId("1"), newChunkMap.upper_bound(splitPoint)->second->getShardId());
+}
+
+TEST(ChunkMapTest, UpperBound) {
+    const auto chunkMap = makeChunkMap(1000);
+
+    ASSERT_BSONOBJ_EQ(boundary(1, 1000), chunkMap.upper_bound(BSON("x" << MINKEY))->first);
+    ASSERT_BSONOBJ_EQ(boundary(256, 1000), chunkMap.upper_bound(BSON("x" << 255))->first);
+    ASSERT_BSONOBJ_EQ(boundary(256, 1000), chunkMap.upper_bound(BSON("x" << 255.5))->first);
+    ASSERT_BSONOBJ_EQ(boundary(1000, 1000), chunkMap.upper_bound(BSON("x" << 999))->first);
+    ASSERT(chunkMap.upper_bound(BSON("x" << MAXKEY)) == chunkMap.end());
+}
+
+/**
+ * Builds a map of 'numChunks' chunks of a hashed shard key, with boundaries spread evenly over
+ * the range of long long.
+ */
+ChunkMap makeHashedChunkMap(int numChunks) {
+    const long long step = std::numeric_limits<long long>::max() / numChunks;
+    auto hashedBoundary = [&](int i) {
+        if (i == 0) {
+            return BSON("x" << MINKEY);
+        } else if (i == numChunks) {
+            return BSON("x" << MAXKEY);
+        }
+        return BSON("x" << step * (2 * i - numChunks));
+    };
+
+    std::vector<std::shared_ptr<Chunk>> chunks;
+    for (int i = 0; i < numChunks; ++i) {
+        chunks.push_back(makeChunk(
+            hashedBoundary(i), hashedBoundary(i + 1), ChunkVersion(1, i, kEpoch), "0"));
+    }
+    return ChunkMap().applyChanges(chunks);
+}
+
+TEST(ChunkMapTest, UpperBoundHashedKeys) {
+    const auto chunkMap = makeHashedChunkMap(1000);
+    assertContiguous(chunkMap);
+
+    const auto& comparator = SimpleBSONObjComparator::kInstance;
+    for (auto it = chunkMap.begin(); it != chunkMap.end(); ++it) {
+        const auto& min = it->second->getMin();
+        if (min.firstElementType() == NumberLong) {
+            ASSERT(chunkMap.upper_bound(min) == it);
+            ASSERT(chunkMap.upper_bound(BSON("x" << min.firstElement().numberLong() + 1)) == it);
+            ASSERT(chunkMap.upper_bound(BSON("x" << min.firstElement().numberLong() - 1)) ==
+                   std::prev(it));
+        }
+    }
+
+    // Keys of other types or at the edges of the range of long long use the encoded keys
+    ASSERT(chunkMap.upper_bound(BSON("x" << MINKEY)) == chunkMap.begin());
+    ASSERT(chunkMap.upper_bound(BSON("x" << std::numeric_limits<long long>::min())) ==
+           chunkMap.begin());
+    ASSERT(chunkMap.upper_bound(BSON("x" << std::numeric_limits<long long>::max())) ==
+           std::prev(chunkMap.end()));
+    ASSERT(chunkMap.upper_bound(BSON("x" << 0)) ==
+           chunkMap.upper_bound(BSON("x" << static_cast<long long>(0))));
+    ASSERT(chunkMap.upper_bound(BSON("x" << 0.5)) ==
+           chunkMap.upper_bound(BSON("x" << static_cast<long long>(0))));
+    ASSERT(chunkMap.upper_bound(BSON("x"
+                                     << "a")) == std::prev(chunkMap.end()));
+    ASSERT(chunkMap.upper_bound(BSON("x" << MAXKEY)) == chunkMap.end());
+    ASSERT(comparator.evaluate(chunkMap.upper_bound(BSON("x" << 0))->second->getMin() <=
+                               BSON("x" << 0)));
+}
+
+TEST(ChunkMapTest, FindIntersectingChunk) {
+    const auto chunkMap = makeChunkMap(1000);
+
+    ASSERT(chunkMap.findIntersectingChunk(BSON("x" << MINKEY)) == chunkMap.begin());
+    ASSERT(chunkMap.findIntersectingChunk(BSON("x" << 255)) ==
+           chunkMap.upper_bound(BSON("x" << 255)));
+    ASSERT(chunkMap.findIntersectingChunk(BSON("x" << 255.5)) ==
+           chunkMap.upper_bound(BSON("x" << 255.5)));
+    ASSERT(chunkMap.findIntersectingChunk(BSON("x" << MAXKEY)) == chunkMap.end());
+
+    // Keys below the min key of the first chunk are in no chunk
+    const auto partialMap = ChunkMap().applyChanges(
+        {makeChunk(BSON("x" << 10), BSON("x" << 20), ChunkVersion(1, 0, kEpoch), "0"),
+         makeChunk(BSON("x" << 20), BSON("x" << 30), ChunkVersion(1, 1, kEpoch), "1")});
+    ASSERT(partialMap.findIntersectingChunk(BSON("x" << 5)) == partialMap.end());
+    ASSERT(partialMap.findIntersectingChunk(BSON("x" << 10)) == partialMap.begin());
+    ASSERT(partialMap.findIntersectingChunk(BSON("x" << 20)) == std::next(partialMap.begin()));
+    ASSERT(partialMap.findIntersectingChunk(BSON("x" << 30)) == partialMap.end());
+}
+
+TEST(ChunkMapTest, FindIntersectingChunkHashedKeys) {
+    const auto chunkMap = makeHashedChunkMap(1000);
+
+    for (auto it = chunkMap.begin(); it != chunkMap.end(); ++it) {
+        const auto& min = it->second->getMin();
+        if (min.firstElementType() == NumberLong) {
+            ASSERT(chunkMap.findIntersectingChunk(min) == it);
+            ASSERT(chunkMap.findIntersectingChunk(
+                       BSON("x" << min.firstElement().numberLong() - 1)) == std::prev(it));
+        }
+    }
+    ASSERT(chunkMap.findIntersectingChunk(BSON("x" << std::numeric_limits<long long>::min())) ==
+           chunkMap.begin());
+
+    // The min key of the first chunk is a NumberLong too
+    const auto partialMap = ChunkMap().applyChanges(
+        {makeChunk(BSON("x" << 10LL), BSON("x" << 20LL), ChunkVersion(1, 0, kEpoch), "0"),
+         makeChunk(BSON("x" << 20LL), BSON("x" << MAXKEY), ChunkVersion(1, 1, kEpoch), "1")});
+    ASSERT(partialMap.findIntersectingChunk(BSON("x" << 5LL)) == partialMap.end());
+    ASSERT(partialMap.findIntersectingChunk(BSON("x" << 10LL)) == partialMap.begin());
+    ASSERT(partialMap.findIntersectingChunk(BSON("x" << 25LL)) == std::next(partialMap.begin()));
+}
+
+TEST(ChunkMapTest, UpperBoundMatchesBSONOrder) {
+    // Compound boundaries of mixed types
+    const std::vector<BSONObj> boundaries{BSON("a" << MINKEY << "b" << MINKEY),
+                                          BSON("a" << -5 << "b" << 2.5),
+                                          BSON("a" << 0 << "b"
+                                                   << "abc"),
+                                          BSON("a" << 0 << "b"
+                                                   << "abd"),
+                                          BSON("a" << 7.5 << "b" << BSONNULL),
+                                          BSON("a"
+                                               << "x"
+                                               << "b"
+                                               << 1),
+                                          BSON("a"
+                                               << "xy"
+                                               << "b"
+                                               << MINKEY),
+                                          BSON("a" << BSON("c" << 1) << "b" << 1),
+                                          BSON("a" << OID() << "b" << 1),
+                                          BSON("a" << MAXKEY << "b" << MAXKEY)};
+
+    std::vector<std::shared_ptr<Chunk>> chunks;
+    for (size_t i = 0; i + 1 < boundaries.size(); ++i) {
+        chunks.push_back(makeChunk(
+            boundaries[i], boundaries[i + 1], ChunkVersion(1, i, kEpoch), i % 2 ? "1" : "0"));
+    }
+    const auto chunkMap = ChunkMap().applyChanges(chunks);
+
+    const std::vector<BSONObj> keys{BSON("a" << -10 << "b" << 1),
+                                    BSON("a" << -5 << "b" << 2.5),
+                                    BSON("a" << -5LL << "b" << 3),
+                                    BSON("a" << 0 << "b"
+                                             << "abcd"),
+                                    BSON("a" << 0 << "b"
+                                             << "abd"),
+                                    BSON("a" << 7.5 << "b" << MINKEY),
+                                    BSON("a"
+                                         << "x"
+                                         << "b"
+                                         << 0),
+                                    BSON("a"
+                                         << "xyz"
+                                         << "b"
+                                         << 1),
+                                    BSON("a" << BSON("c" << 0) << "b" << 1),
+                                    BSON("a" << OID::gen() << "b" << 1)};
+
+    const auto& comparator = SimpleBSONObjComparator::kInstance;
+    for (const auto& key : keys) {
+        auto expected = chunkMap.begin();
+        while (expected != chunkMap.end() && !comparator.evaluate(key < expected->first)) {
+            ++expected;
+        }
+        ASSERT(chunkMap.upper_bound(key) == expected);
+    }
+}
+
+TEST(ChunkMapTest, GetShardIdsForRange) {
+    const auto chunkMap = makeChunkMap(1000);
+
+    std::set<ShardId> shardIds;
+    chunkMap.getShardIdsForRange(BSON("x" << 10), BSON("x" << 20), 2, &shardIds);
+    ASSERT_EQ(1U, shardIds.size());
+    ASSERT_EQ(1U, shardIds.count(ShardId("0")));
+
+    // The range ends exactly at the min of the first chunk on the other shard
+    shardIds.clear();
+    chunkMap.getShardIdsForRange(BSON("x" << 10), BSON("x" << 100), 2, &shardIds);
+    ASSERT_EQ(2U, shardIds.size());
+
+    // Spans several segments on the same shard
+    shardIds.clear();
+    chunkMap.getShardIdsForRange(BSON("x" << 200), BSON("x" << 299.5), 2, &shardIds);
+    ASSERT_EQ(1U, shardIds.size());
+    ASSERT_EQ(1U, shardIds.count(ShardId("0")));
+
+    shardIds.clear();
+    chunkMap.getShardIdsForRange(BSON("x" << MINKEY), BSON("x" << MAXKEY), 2, &shardIds);
+    ASSERT_EQ(2U, shardIds.size());
+}
+
+TEST(ChunkMapTest, GapBetweenChunksFails) {
+    const auto chunkMap = makeChunkMap(1000);
+
+    // Replace [500, 501) with a chunk which covers only half of it
+    ASSERT_THROWS_CODE(
+        chunkMap.applyChanges({makeChunk(
+            boundary(500, 1000), BSON("x" << 500.5), ChunkVersion(2, 0, kEpoch), "0")}),
+        UserException,
+        ErrorCodes::ConflictingOperationInProgress);
+}
+
+}  // namespace
+}  // namespace mongo
@@ -36,6 +36,7 @@
 #include "mongo/db/query/cursor_response.h"
 #include "mongo/db/query/getmore_request.h"
 #include "mongo/db/query/killcursors_request.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/executor/remote_command_request.h"
 #include "mongo/executor/remote_command_response.h"
 #include "mongo/rpc/metadata/server_selection_metadata.h"
@@ -51,13 +52,33 @@ namespace {
 // Maximum number of retries for network and replication notMaster errors (per host).
 const int kMaxNumFailedHostRetryAttempts = 3;
 
+// Maximum number of fields of a sort whose sort keys can be encoded into KeyStrings, which is the
+// number of fields an Ordering can describe.
+const int kMaxEncodedSortKeyFields = 32;
+
+// If true, prefetchNextBatch() asks the remotes for their next batch before their buffered
+// results run out.
+MONGO_EXPORT_SERVER_PARAMETER(internalQueryMongosPrefetchNextBatches, bool, true);
+
+/**
+ * Returns the ordering with which to encode the sort keys of a merge on 'sort', if they can be.
+ */
+boost::optional<Ordering> makeSortKeyOrdering(const BSONObj& sort) {
+    if (sort.isEmpty() || sort.nFields() > kMaxEncodedSortKeyFields) {
+        return boost::none;
+    }
+    return Ordering::make(sort);
+}
+
 }  // namespace
 
 AsyncResultsMerger::AsyncResultsMerger(executor::TaskExecutor* executor,
                                        ClusterClientCursorParams* params)
     : _executor(executor),
       _params(params),
-      _mergeQueue(MergingComparator(_remotes, _params->sort)) {
+      _sortKeyOrdering(makeSortKeyOrdering(_params->sort)),
+      _mergeTree(_params->remotes.size(),
+                 MergingComparator(_remotes, _params->sort, static_cast<bool>(_sortKeyOrdering))) {
     size_t remoteIndex = 0;
     for (const auto& remote : _params->remotes) {
         _remotes.emplace_back(remote.hostAndPort, remote.cursorResponse.getCursorId());
@@ -192,24 +213,34 @@ ClusterQueryResult AsyncResultsMerger::nextReadySorted() {
     // Tailable cursors cannot have a sort.
     invariant(!_params->isTailable);
 
-    if (_mergeQueue.empty()) {
+    if (_remotes.empty()) {
         return {};
     }
 
-    size_t smallestRemote = _mergeQueue.top();
-    _mergeQueue.pop();
+    if (_mergeTreeNeedsRebuild) {
+        _mergeTree.rebuild();
+        _mergeTreeNeedsRebuild = false;
+    }
 
-    invariant(!_remotes[smallestRemote].docBuffer.empty());
-    invariant(_remotes[smallestRemote].status.isOK());
+    // Remotes without buffered results sort last, so if the smallest one has none, all of the
+    // remotes are exhausted.
+    auto& smallestRemote = _remotes[_mergeTree.top()];
+    if (!smallestRemote.hasNext()) {
+        return {};
+    }
 
-    ClusterQueryResult front = _remotes[smallestRemote].docBuffer.front();
-    _remotes[smallestRemote].docBuffer.pop();
+    invariant(smallestRemote.status.isOK());
 
-    // Re-populate the merging queue with the next result from 'smallestRemote', if it has a
-    // next result.
-    if (!_remotes[smallestRemote].docBuffer.empty()) {
-        _mergeQueue.push(smallestRemote);
+    ClusterQueryResult front = smallestRemote.docBuffer.front();
+    smallestRemote.docBuffer.pop();
+    if (_sortKeyOrdering) {
+        smallestRemote.sortKeyBuffer.pop();
     }
+    _lastReturnedFromRemote = _mergeTree.top();
+    ++_numReturned;
+
+    // Re-play the merge with the next result from 'smallestRemote', if it has a next result.
+    _mergeTree.replayTop();
 
     return front;
 }
@@ -223,6 +254,8 @@ ClusterQueryResult AsyncResultsMerger::nextReadyUnsorted() {
         if (_remotes[_gettingFromRemote].hasNext()) {
             ClusterQueryResult front = _remotes[_gettingFromRemote].docBuffer.front();
             _remotes[_gettingFromRemote].docBuffer.pop();
+            _lastReturnedFromRemote = _gettingFromRemote;
+            ++_numReturned;
 
             if (_params->isTailable && !_remotes[_gettingFromRemote].hasNext()) {
                 // The cursor is tailable and we're about to return the last buffered result. This
@@ -343,6 +376,41 @@ StatusWith<executor::TaskExecutor::EventHandle> AsyncResultsMerger::nextEvent(
     return eventToReturn;
 }
 
+void AsyncResultsMerger::prefetchNextBatch(OperationContext* opCtx) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+
+    if (_lifecycleState != kAlive || _params->isTailable || !_lastReturnedFromRemote ||
+        !internalQueryMongosPrefetchNextBatches.load()) {
+        return;
+    }
+
+    // Only the remote which the last result came from can have run low on results since the
+    // previous call.
+    const size_t remoteIndex = *_lastReturnedFromRemote;
+    _lastReturnedFromRemote = boost::none;
+
+    auto& remote = _remotes[remoteIndex];
+    if (!remote.status.isOK() || remote.exhausted() || remote.cbHandle.isValid()) {
+        return;
+    }
+
+    if (remote.docBuffer.size() * 2 > remote.lastBatchSize) {
+        return;
+    }
+
+    // No more results are needed from this remote if it has already buffered all of the results
+    // that the limit still allows for.
+    if (_params->limit) {
+        const long long resultsNeeded =
+            _params->skip.value_or(0) + *_params->limit - _numReturned;
+        if (resultsNeeded <= static_cast<long long>(remote.docBuffer.size())) {
+            return;
+        }
+    }
+
+    remote.status = askForNextBatch_inlock(opCtx, remoteIndex);
+}
+
 StatusWith<CursorResponse> AsyncResultsMerger::parseCursorResponse(const BSONObj& responseObj,
                                                                    const RemoteCursorData& remote) {
     auto getMoreParseStatus = CursorResponse::parseFromBSON(responseObj);
@@ -427,7 +495,10 @@ void AsyncResultsMerger::handleBatchResponse(
             // Clear the results buffer and cursor id.
             std::queue<ClusterQueryResult> emptyBuffer;
             std::swap(remote.docBuffer, emptyBuffer);
+            std::queue<std::string> emptySortKeyBuffer;
+            std::swap(remote.sortKeyBuffer, emptySortKeyBuffer);
             remote.cursorId = 0;
+            _mergeTreeNeedsRebuild = true;
         }
 
         return;
@@ -473,6 +544,12 @@ void AsyncResultsMerger::handleBatchResponse(
 
 bool AsyncResultsMerger::addBatchToBuffer(size_t remoteIndex, const std::vector<BSONObj>& batch) {
     auto& remote = _remotes[remoteIndex];
+
+    // The next result of the remote only changes if it had none buffered.
+    if (!_params->sort.isEmpty() && !batch.empty() && !remote.hasNext()) {
+        _mergeTreeNeedsRebuild = true;
+    }
+
     for (const auto& obj : batch) {
         // If there's a sort, we're expecting the remote node to have given us back a sort key.
         if (!_params->sort.isEmpty() &&
@@ -485,16 +562,20 @@ bool AsyncResultsMerger::addBatchToBuffer(size_t remoteIndex, const std::vector<
             return false;
         }
 
+        // This does not need to encode with a collator, since mongod has already mapped strings to
+        // their ICU comparison keys as part of the $sortKey meta projection.
+        if (_sortKeyOrdering) {
+            _sortKeyBuilder.resetToKey(obj[ClusterClientCursorParams::kSortKeyField].Obj(),
+                                       *_sortKeyOrdering);
+            remote.sortKeyBuffer.emplace(_sortKeyBuilder.getBuffer(), _sortKeyBuilder.getSize());
+        }
+
         ClusterQueryResult result(obj);
         remote.docBuffer.push(result);
         ++remote.fetchedCount;
     }
 
-    // If we're doing a sorted merge, then we have to make sure to put this remote onto the
-    // merge queue.
-    if (!_params->sort.isEmpty() && !batch.empty()) {
-        _mergeQueue.push(remoteIndex);
-    }
+    remote.lastBatchSize = batch.size();
     return true;
 }
 
@@ -610,7 +691,18 @@ std::shared_ptr<Shard> AsyncResultsMerger::RemoteCursorData::getShard() {
 // AsyncResultsMerger::MergingComparator
 //
 
-bool AsyncResultsMerger::MergingComparator::operator()(const size_t& lhs, const size_t& rhs) {
+bool AsyncResultsMerger::MergingComparator::operator()(size_t lhs, size_t rhs) const {
+    if (!_remotes[lhs].hasNext()) {
+        return false;
+    }
+    if (!_remotes[rhs].hasNext()) {
+        return true;
+    }
+
+    if (_compareEncodedSortKeys) {
+        return _remotes[lhs].sortKeyBuffer.front() < _remotes[rhs].sortKeyBuffer.front();
+    }
+
     const ClusterQueryResult& leftDoc = _remotes[lhs].docBuffer.front();
     const ClusterQueryResult& rightDoc = _remotes[rhs].docBuffer.front();
 
@@ -619,7 +711,7 @@ bool AsyncResultsMerger::MergingComparator::operator()(const size_t& lhs, const
 
     // This does not need to sort with a collator, since mongod has already mapped strings to their
     // ICU comparison keys as part of the $sortKey meta projection.
-    return leftDocKey.woCompare(rightDocKey, _sort, false /*considerFieldName*/) > 0;
+    return leftDocKey.woCompare(rightDocKey, _sort, false /*considerFieldName*/) < 0;
 }
 
 }  // namespace mongo
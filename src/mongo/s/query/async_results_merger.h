@@ -30,15 +30,19 @@
 
 #include <boost/optional.hpp>
 #include <queue>
+#include <string>
 #include <vector>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/base/status_with.h"
 #include "mongo/bson/bsonobj.h"
+#include "mongo/bson/ordering.h"
 #include "mongo/db/cursor_id.h"
+#include "mongo/db/storage/key_string.h"
 #include "mongo/executor/task_executor.h"
 #include "mongo/s/query/cluster_client_cursor_params.h"
 #include "mongo/s/query/cluster_query_result.h"
+#include "mongo/s/query/loser_tree.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/net/hostandport.h"
 #include "mongo/util/time_support.h"
@@ -66,6 +70,10 @@ class CursorResponse;
  * This requires waiting until we have a response from every remote before returning results.
  * Without a sort, we are ready to return results as soon as we have *any* response from a remote.
  *
+ * The sorted streams are merged through a tournament tree. Where possible, the sort key of each
+ * result is encoded into a KeyString once, when its batch is received, so that merging only takes
+ * byte-wise comparisons.
+ *
  * On any error, the caller is responsible for shutting down the ARM using the kill() method.
  *
  * Does not throw exceptions.
@@ -79,8 +87,8 @@ public:
      * the hosts on which they exist in _remotes.
      *
      * Additionally copies each remote's first batch of results, if one exists, into that remote's
-     * docBuffer. If a sort is specified in the ClusterClientCursorParams, places the remotes with
-     * buffered results onto _mergeQueue.
+     * docBuffer. If a sort is specified in the ClusterClientCursorParams, the remotes are merged
+     * through _mergeTree.
      *
      * The TaskExecutor* must remain valid for the lifetime of the ARM.
      */
@@ -159,6 +167,19 @@ public:
      */
     StatusWith<executor::TaskExecutor::EventHandle> nextEvent(OperationContext* opCtx);
 
+    /**
+     * Asks the remote which the last result returned by nextReady() came from for its next batch,
+     * if it has used up at least half of its last batch, so that the batch arrives before its
+     * buffered results run out. Does nothing if the remote is exhausted or already has a request
+     * outstanding, if it has buffered all the results the limit still allows for, or if the
+     * cursor is tailable.
+     *
+     * Unlike nextEvent(), may be called whether or not ready() is true. If the remote work could
+     * not be scheduled, the error is recorded against the remote, as for a failed getMore, and is
+     * returned by the next call to nextReady() or nextEvent().
+     */
+    void prefetchNextBatch(OperationContext* opCtx);
+
     /**
      * Starts shutting down this ARM by canceling all pending requests. Returns a handle to an event
      * that is signaled when this ARM is safe to destroy.
@@ -214,6 +235,14 @@ private:
         // The buffer of results that have been retrieved but not yet returned to the caller.
         std::queue<ClusterQueryResult> docBuffer;
 
+        // The KeyString-encoded sort keys of the results in 'docBuffer', in the same order. Only
+        // populated if the sort keys are merged in their encoded form.
+        std::queue<std::string> sortKeyBuffer;
+
+        // Number of results in the last batch received from this remote. Used to decide when to
+        // prefetch the next batch.
+        size_t lastBatchSize = 0;
+
         // Is valid if there is currently a pending request to this remote.
         executor::TaskExecutor::CallbackHandle cbHandle;
 
@@ -226,17 +255,26 @@ private:
         long long fetchedCount = 0;
     };
 
+    /**
+     * Returns true if the next result of remote 'lhs' sorts before the next result of remote
+     * 'rhs'. Remotes without buffered results sort after all others.
+     */
     class MergingComparator {
     public:
-        MergingComparator(const std::vector<RemoteCursorData>& remotes, const BSONObj& sort)
-            : _remotes(remotes), _sort(sort) {}
+        MergingComparator(const std::vector<RemoteCursorData>& remotes,
+                          const BSONObj& sort,
+                          bool compareEncodedSortKeys)
+            : _remotes(remotes), _sort(sort), _compareEncodedSortKeys(compareEncodedSortKeys) {}
 
-        bool operator()(const size_t& lhs, const size_t& rhs);
+        bool operator()(size_t lhs, size_t rhs) const;
 
     private:
         const std::vector<RemoteCursorData>& _remotes;
 
         const BSONObj& _sort;
+
+        // Whether to compare the encoded sort keys rather than the $sortKey objects.
+        const bool _compareEncodedSortKeys;
     };
 
     enum LifecycleState { kAlive, kKillStarted, kKillComplete };
@@ -338,14 +376,30 @@ private:
     // Data tracking the state of our communication with each of the remote nodes.
     std::vector<RemoteCursorData> _remotes;
 
-    // The top of this priority queue is the index into '_remotes' for the remote host that has the
-    // next document to return, according to the sort order. Used only if there is a sort.
-    std::priority_queue<size_t, std::vector<size_t>, MergingComparator> _mergeQueue;
+    // The ordering used to encode the sort keys into '_sortKeyBuilder'. Not set if there is no
+    // sort, or if the sort has too many fields for an Ordering, in which case the $sortKey objects
+    // are compared directly.
+    boost::optional<Ordering> _sortKeyOrdering;
+    KeyString _sortKeyBuilder{KeyString::Version::V1};
+
+    // The top of this tree is the index into '_remotes' for the remote host that has the next
+    // document to return, according to the sort order. Used only if there is a sort.
+    LoserTree<MergingComparator> _mergeTree;
+
+    // Set when the next result of a remote other than the top of '_mergeTree' changes.
+    bool _mergeTreeNeedsRebuild = true;
 
     // The index into '_remotes' for the remote from which we are currently retrieving results.
     // Used only if there is *not* a sort.
     size_t _gettingFromRemote = 0;
 
+    // The index into '_remotes' of the remote which the last result returned by nextReady() came
+    // from, until prefetchNextBatch() has checked it.
+    boost::optional<size_t> _lastReturnedFromRemote;
+
+    // The number of results returned by nextReady() so far.
+    long long _numReturned = 0;
+
     Status _status = Status::OK();
 
     executor::TaskExecutor::EventHandle _currentEvent;
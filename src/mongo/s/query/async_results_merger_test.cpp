@@ -598,6 +598,180 @@ TEST_F(AsyncResultsMergerTest, CompoundSortKey) {
     ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
 }
 
+TEST_F(AsyncResultsMergerTest, SortKeysOfMixedTypes) {
+    BSONObj findCmd = fromjson("{find: 'testcoll', sort: {a: 1, b: -1}}");
+    std::vector<BSONObj> batch1 = {fromjson("{$sortKey: {'': null, '': 'z'}}"),
+                                   fromjson("{$sortKey: {'': 1.5, '': 2}}"),
+                                   fromjson("{$sortKey: {'': 'abd', '': {$minKey: 1}}}")};
+    std::vector<BSONObj> batch2 = {fromjson("{$sortKey: {'': null, '': 'a'}}"),
+                                   fromjson("{$sortKey: {'': NumberLong(2), '': {x: 1}}}"),
+                                   fromjson("{$sortKey: {'': {y: 1}, '': 0}}")};
+    std::vector<BSONObj> batch3 = {fromjson("{$sortKey: {'': 1, '': 5}}"),
+                                   fromjson("{$sortKey: {'': 2.0, '': 1}}"),
+                                   fromjson("{$sortKey: {'': 'abc', '': 3}}")};
+    std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
+    cursors.emplace_back(kTestShardHosts[0], CursorResponse(_nss, 0, std::move(batch1)));
+    cursors.emplace_back(kTestShardHosts[1], CursorResponse(_nss, 0, std::move(batch2)));
+    cursors.emplace_back(kTestShardHosts[2], CursorResponse(_nss, 0, std::move(batch3)));
+    makeCursorFromExistingCursors(std::move(cursors), findCmd);
+
+    // ARM returns all results in the order of BSONObj::woCompare().
+    std::vector<BSONObj> expected = {fromjson("{$sortKey: {'': null, '': 'z'}}"),
+                                     fromjson("{$sortKey: {'': null, '': 'a'}}"),
+                                     fromjson("{$sortKey: {'': 1, '': 5}}"),
+                                     fromjson("{$sortKey: {'': 1.5, '': 2}}"),
+                                     fromjson("{$sortKey: {'': NumberLong(2), '': {x: 1}}}"),
+                                     fromjson("{$sortKey: {'': 2.0, '': 1}}"),
+                                     fromjson("{$sortKey: {'': 'abc', '': 3}}"),
+                                     fromjson("{$sortKey: {'': 'abd', '': {$minKey: 1}}}"),
+                                     fromjson("{$sortKey: {'': {y: 1}, '': 0}}")};
+    for (const auto& obj : expected) {
+        ASSERT_TRUE(arm->ready());
+        ASSERT_BSONOBJ_EQ(obj, *unittest::assertGet(arm->nextReady()).getResult());
+    }
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
+TEST_F(AsyncResultsMergerTest, SortedMergeAfterRemoteRefilled) {
+    BSONObj findCmd = fromjson("{find: 'testcoll', sort: {_id: 1}}");
+    std::vector<BSONObj> batch1 = {fromjson("{$sortKey: {'': 1}}")};
+    std::vector<BSONObj> batch2 = {fromjson("{$sortKey: {'': 2}}"),
+                                   fromjson("{$sortKey: {'': 6}}")};
+    std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
+    cursors.emplace_back(kTestShardHosts[0], CursorResponse(_nss, 5, std::move(batch1)));
+    cursors.emplace_back(kTestShardHosts[1], CursorResponse(_nss, 0, std::move(batch2)));
+    makeCursorFromExistingCursors(std::move(cursors), findCmd);
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{$sortKey: {'': 1}}"),
+                      *unittest::assertGet(arm->nextReady()).getResult());
+
+    // The first shard must be heard from before merging any further.
+    ASSERT_FALSE(arm->ready());
+    auto readyEvent = unittest::assertGet(arm->nextEvent(nullptr));
+
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch3 = {fromjson("{$sortKey: {'': 3}}"),
+                                   fromjson("{$sortKey: {'': 7}}")};
+    responses.emplace_back(_nss, CursorId(0), batch3);
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+    executor()->waitForEvent(readyEvent);
+
+    for (int i : {2, 3, 6, 7}) {
+        ASSERT_TRUE(arm->ready());
+        ASSERT_BSONOBJ_EQ(BSON("$sortKey" << BSON("" << i)),
+                          *unittest::assertGet(arm->nextReady()).getResult());
+    }
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
+TEST_F(AsyncResultsMergerTest, PrefetchesNextBatchOnceHalfOfBatchIsReturned) {
+    std::vector<BSONObj> firstBatch = {
+        fromjson("{_id: 1}"), fromjson("{_id: 2}"), fromjson("{_id: 3}"), fromjson("{_id: 4}")};
+    std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
+    cursors.emplace_back(kTestShardHosts[0], CursorResponse(_nss, 5, std::move(firstBatch)));
+    makeCursorFromExistingCursors(std::move(cursors));
+
+    auto hasReadyRequests = [this] {
+        executor::NetworkInterfaceMock* net = network();
+        net->enterNetwork();
+        const bool hasReadyRequests = net->hasReadyRequests();
+        net->exitNetwork();
+        return hasReadyRequests;
+    };
+
+    // Three of the four results are still buffered, so there is no need for the next batch yet.
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 1}"), *unittest::assertGet(arm->nextReady()).getResult());
+    arm->prefetchNextBatch(nullptr);
+    ASSERT_FALSE(hasReadyRequests());
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 2}"), *unittest::assertGet(arm->nextReady()).getResult());
+    arm->prefetchNextBatch(nullptr);
+
+    auto request = GetMoreRequest::parseFromBSON("anydbname", getFirstPendingRequest().cmdObj);
+    ASSERT_OK(request.getStatus());
+    ASSERT_EQ(5LL, request.getValue().cursorid);
+
+    // There is already a request outstanding for the remote.
+    arm->prefetchNextBatch(nullptr);
+
+    // The buffered results are still returned while the request is outstanding.
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 3}"), *unittest::assertGet(arm->nextReady()).getResult());
+
+    std::vector<CursorResponse> responses;
+    std::vector<BSONObj> batch = {fromjson("{_id: 5}")};
+    responses.emplace_back(_nss, CursorId(0), batch);
+    scheduleNetworkResponses(std::move(responses),
+                             CursorResponse::ResponseType::SubsequentResponse);
+    ASSERT_FALSE(hasReadyRequests());
+    ASSERT_TRUE(arm->remotesExhausted());
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 4}"), *unittest::assertGet(arm->nextReady()).getResult());
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 5}"), *unittest::assertGet(arm->nextReady()).getResult());
+
+    // The remote is exhausted, so there is nothing left to prefetch.
+    arm->prefetchNextBatch(nullptr);
+    ASSERT_FALSE(hasReadyRequests());
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_TRUE(unittest::assertGet(arm->nextReady()).isEOF());
+}
+
+TEST_F(AsyncResultsMergerTest, DoesNotPrefetchBeyondLimit) {
+    BSONObj findCmd = fromjson("{find: 'testcoll', skip: 1, limit: 3}");
+    std::vector<BSONObj> firstBatch = {
+        fromjson("{_id: 1}"), fromjson("{_id: 2}"), fromjson("{_id: 3}"), fromjson("{_id: 4}")};
+    std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
+    cursors.emplace_back(kTestShardHosts[0], CursorResponse(_nss, 5, std::move(firstBatch)));
+    makeCursorFromExistingCursors(std::move(cursors), findCmd);
+
+    // Half of the batch has been returned, but the two buffered results are all that the skip
+    // and the limit still allow for.
+    for (int i : {1, 2}) {
+        ASSERT_TRUE(arm->ready());
+        ASSERT_BSONOBJ_EQ(BSON("_id" << i), *unittest::assertGet(arm->nextReady()).getResult());
+        arm->prefetchNextBatch(nullptr);
+    }
+
+    executor::NetworkInterfaceMock* net = network();
+    net->enterNetwork();
+    ASSERT_FALSE(net->hasReadyRequests());
+    net->exitNetwork();
+
+    // Kill cursor before deleting it, as the remote cursor has not been exhausted.
+    auto killEvent = arm->kill(nullptr);
+    executor()->waitForEvent(killEvent);
+}
+
+TEST_F(AsyncResultsMergerTest, PrefetchFailureIsReturnedAfterTheBufferedResult) {
+    std::vector<BSONObj> firstBatch = {fromjson("{_id: 1}"), fromjson("{_id: 2}")};
+    std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
+    cursors.emplace_back(kTestShardHosts[0], CursorResponse(_nss, 5, std::move(firstBatch)));
+    makeCursorFromExistingCursors(std::move(cursors));
+
+    // The result that used up half of the batch is returned even though the request for the next
+    // batch cannot be scheduled.
+    ASSERT_TRUE(arm->ready());
+    ASSERT_BSONOBJ_EQ(fromjson("{_id: 1}"), *unittest::assertGet(arm->nextReady()).getResult());
+    executor()->shutdown();
+    arm->prefetchNextBatch(nullptr);
+
+    ASSERT_TRUE(arm->ready());
+    ASSERT_EQ(ErrorCodes::ShutdownInProgress, arm->nextReady().getStatus());
+    auto killEvent = arm->kill(nullptr);
+    ASSERT_FALSE(killEvent.isValid());
+}
+
 TEST_F(AsyncResultsMergerTest, SortedButNoSortKey) {
     BSONObj findCmd = fromjson("{find: 'testcoll', sort: {a: -1, b: 1}}");
     std::vector<ClusterClientCursorParams::RemoteCursor> cursors;
@@ -0,0 +1,125 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+/**
+ * A tournament tree of losers over a fixed number of sorted sources, used to merge them into a
+ * single sorted stream. The sources are identified by their index in [0, numSources) and are
+ * ordered by the 'Less' functor, which is called with two source indexes and must return true if
+ * the next element of the first source sorts before the next element of the second. Sources which
+ * have no next element should sort after all others.
+ *
+ * Unlike a binary heap, which needs about 2 * log(n) comparisons to remove its top and push it
+ * back, replacing the winner only takes one comparison per level of the tree.
+ *
+ * The tree does not look at the elements itself, so it must be told when they change:
+ *  - replayTop() after the next element of the winning source changes, usually because it was
+ *    consumed.
+ *  - rebuild() after the next element of any other source changes.
+ */
+template <typename Less>
+class LoserTree {
+public:
+    LoserTree(size_t numSources, Less less)
+        : _numSources(numSources), _less(std::move(less)), _nodes(numSources) {}
+
+    size_t size() const {
+        return _numSources;
+    }
+
+    /**
+     * Plays the whole tournament again, in linear time.
+     */
+    void rebuild() {
+        if (_numSources == 0) {
+            return;
+        }
+
+        // The winners of the matches, laid out like '_nodes', followed by the sources themselves
+        _winners.resize(2 * _numSources);
+        for (size_t source = 0; source < _numSources; ++source) {
+            _winners[_numSources + source] = source;
+        }
+
+        for (size_t node = _numSources - 1; node > 0; --node) {
+            size_t left = _winners[2 * node];
+            size_t right = _winners[2 * node + 1];
+            if (_less(right, left)) {
+                std::swap(left, right);
+            }
+            _winners[node] = left;
+            _nodes[node] = right;
+        }
+
+        _nodes[0] = _numSources == 1 ? 0 : _winners[1];
+    }
+
+    /**
+     * Returns the source with the smallest next element.
+     */
+    size_t top() const {
+        invariant(_numSources > 0);
+        return _nodes[0];
+    }
+
+    /**
+     * Replays the matches of the winning source on its way to the root, in logarithmic time.
+     */
+    void replayTop() {
+        invariant(_numSources > 0);
+
+        size_t winner = _nodes[0];
+        for (size_t node = (_numSources + winner) / 2; node > 0; node /= 2) {
+            if (_less(_nodes[node], winner)) {
+                std::swap(_nodes[node], winner);
+            }
+        }
+        _nodes[0] = winner;
+    }
+
+private:
+    const size_t _numSources;
+    Less _less;
+
+    // The overall winner in the first slot, followed by the loser of each match of the tournament.
+    // The children of match i are at 2i and 2i + 1, where numSources + j stands for source j.
+    std::vector<size_t> _nodes;
+
+    // Scratch space for rebuild()
+    std::vector<size_t> _winners;
+};
+
+}  // namespace mongo
@@ -0,0 +1,166 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/s/query/loser_tree.h"
+
+#include <algorithm>
+#include <deque>
+#include <limits>
+#include <vector>
+
+#include "mongo/platform/random.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+/**
+ * Sorted sources of integers, where an exhausted source sorts after all others.
+ */
+class Sources {
+public:
+    explicit Sources(std::vector<std::deque<int>> sources) : _sources(std::move(sources)) {}
+
+    int next(size_t source) const {
+        return _sources[source].empty() ? std::numeric_limits<int>::max()
+                                        : _sources[source].front();
+    }
+
+    bool hasNext(size_t source) const {
+        return !_sources[source].empty();
+    }
+
+    int pop(size_t source) {
+        const int value = _sources[source].front();
+        _sources[source].pop_front();
+        return value;
+    }
+
+    void push(size_t source, int value) {
+        _sources[source].push_back(value);
+    }
+
+    size_t size() const {
+        return _sources.size();
+    }
+
+private:
+    std::vector<std::deque<int>> _sources;
+};
+
+struct SourcesLess {
+    bool operator()(size_t lhs, size_t rhs) const {
+        return sources->next(lhs) < sources->next(rhs);
+    }
+
+    const Sources* sources;
+};
+
+/**
+ * Merges 'sources' through a LoserTree and returns the merged values.
+ */
+std::vector<int> merge(Sources* sources) {
+    LoserTree<SourcesLess> tree(sources->size(), SourcesLess{sources});
+    tree.rebuild();
+
+    std::vector<int> merged;
+    while (tree.size() > 0 && sources->hasNext(tree.top())) {
+        merged.push_back(sources->pop(tree.top()));
+        tree.replayTop();
+    }
+    return merged;
+}
+
+TEST(LoserTreeTest, NoSources) {
+    Sources sources({});
+    ASSERT(std::vector<int>() == merge(&sources));
+}
+
+TEST(LoserTreeTest, SingleSource) {
+    Sources sources({{1, 2, 3}});
+    ASSERT(std::vector<int>({1, 2, 3}) == merge(&sources));
+}
+
+TEST(LoserTreeTest, SomeSourcesEmpty) {
+    Sources sources({{}, {2, 5}, {}, {1, 3, 4}, {}});
+    ASSERT(std::vector<int>({1, 2, 3, 4, 5}) == merge(&sources));
+}
+
+TEST(LoserTreeTest, DuplicateValues) {
+    Sources sources({{1, 1, 2}, {1, 2, 2}, {2}});
+    ASSERT(std::vector<int>({1, 1, 1, 2, 2, 2, 2}) == merge(&sources));
+}
+
+TEST(LoserTreeTest, MatchesSortForAnyNumberOfSources) {
+    PseudoRandom random(1);
+
+    for (size_t numSources = 1; numSources <= 70; ++numSources) {
+        std::vector<std::deque<int>> values(numSources);
+        std::vector<int> all;
+        for (auto& source : values) {
+            const int count = random.nextInt32(20);
+            for (int i = 0; i < count; ++i) {
+                source.push_back(random.nextInt32(1000));
+                all.push_back(source.back());
+            }
+            std::sort(source.begin(), source.end());
+        }
+        std::sort(all.begin(), all.end());
+
+        Sources sources(std::move(values));
+        ASSERT(all == merge(&sources));
+    }
+}
+
+TEST(LoserTreeTest, RebuildAfterSourceRefilled) {
+    Sources sources({{1, 4}, {2}, {3, 6}});
+    LoserTree<SourcesLess> tree(sources.size(), SourcesLess{&sources});
+    tree.rebuild();
+
+    std::vector<int> merged;
+    for (int i = 0; i < 3; ++i) {
+        merged.push_back(sources.pop(tree.top()));
+        tree.replayTop();
+    }
+    ASSERT(std::vector<int>({1, 2, 3}) == merged);
+
+    // The drained source gets more values, so its next value changed without being the top
+    sources.push(1, 5);
+    tree.rebuild();
+
+    while (sources.hasNext(tree.top())) {
+        merged.push_back(sources.pop(tree.top()));
+        tree.replayTop();
+    }
+    ASSERT(std::vector<int>({1, 2, 3, 4, 5, 6}) == merged);
+}
+
+}  // namespace
+}  // namespace mongo
@@ -52,7 +52,18 @@ StatusWith<ClusterQueryResult> RouterStageMerge::next(OperationContext* opCtx) {
         _executor->waitForEvent(event);
     }
 
-    return _arm.nextReady();
+    auto result = _arm.nextReady();
+    if (!result.isOK()) {
+        return result;
+    }
+
+    // Ask for the next batch of the remote the result came from if it is running low on results,
+    // while the merge goes on with the results already buffered.
+    // A failure to schedule the request is reported by the next call, so that this result is not
+    // lost.
+    _arm.prefetchNextBatch(opCtx);
+
+    return result;
 }
 
 void RouterStageMerge::kill(OperationContext* opCtx) {
@@ -86,6 +86,7 @@
 #include "mongo/s/version_mongos.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/thread.h"
+#include "mongo/transport/service_executor_fixed.h"
 #include "mongo/transport/transport_layer_legacy.h"
 #include "mongo/util/admin_access.h"
 #include "mongo/util/cmdline_utils/censor_cmdline.h"
@@ -252,6 +253,17 @@ static ExitCode runMongosServer() {
 
     getGlobalServiceContext()->setServiceEntryPoint(std::move(sep));
 
+    if (transport::isServiceExecutorFixedEnabled()) {
+        auto executor = stdx::make_unique<transport::ServiceExecutorFixed>(
+            transport::serviceExecutorFixedOptionsFromParameters());
+        auto res = executor->start();
+        if (!res.isOK()) {
+            error() << "Failed to start the service executor: " << res;
+            return EXIT_NET_ERROR;
+        }
+        getGlobalServiceContext()->setServiceExecutor(std::move(executor));
+    }
+
     auto transportLayer = stdx::make_unique<transport::TransportLayerLegacy>(opts, sepPtr);
     auto res = transportLayer->setup();
     if (!res.isOK()) {
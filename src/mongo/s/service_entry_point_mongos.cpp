@@ -70,6 +70,14 @@ BSONObj buildErrReply(const DBException& ex) {
 ServiceEntryPointMongos::ServiceEntryPointMongos(TransportLayer* tl) : _tl(tl) {}
 
 void ServiceEntryPointMongos::startSession(transport::SessionHandle session) {
+    if (getGlobalServiceContext()->getServiceExecutor()) {
+        launchServiceExecutorSession(
+            std::move(session), [this](const transport::SessionHandle& session, Message& message) {
+                _handleMessage(session, message);
+            });
+        return;
+    }
+
     launchWrappedServiceEntryWorkerThread(
         std::move(session),
         [this](const transport::SessionHandle& session) { _sessionLoop(session); });
@@ -79,9 +87,6 @@ void ServiceEntryPointMongos::_sessionLoop(const transport::SessionHandle& sessi
     int64_t counter = 0;
 
     while (true) {
-        // Release any cached egress connections for client back to pool before destroying
-        auto guard = MakeGuard(ShardConnection::releaseMyConnections);
-
         Message message;
 
         // Source a Message from the client
@@ -104,88 +109,96 @@ void ServiceEntryPointMongos::_sessionLoop(const transport::SessionHandle& sessi
             uassertStatusOK(status);
         }
 
-        auto opCtx = cc().makeOperationContext();
+        _handleMessage(session, message);
 
-        const int32_t msgId = message.header().getId();
+        if ((counter++ & 0xf) == 0) {
+            markThreadIdle();
+        }
+    }
+}
 
-        const NetworkOp op = message.operation();
+void ServiceEntryPointMongos::_handleMessage(const transport::SessionHandle& session,
+                                             Message& message) {
+    // Release any cached egress connections for client back to pool before destroying
+    auto guard = MakeGuard(ShardConnection::releaseMyConnections);
 
-        // This exception will not be returned to the caller, but will be logged and will close the
-        // connection
-        uassert(ErrorCodes::IllegalOperation,
-                str::stream() << "Message type " << op << " is not supported.",
-                isSupportedNetworkOp(op));
+    auto opCtx = cc().makeOperationContext();
 
-        // Start a new LastError session. Any exceptions thrown from here onwards will be returned
-        // to the caller (if the type of the message permits it).
-        auto client = opCtx->getClient();
-        if (!ClusterLastErrorInfo::get(client)) {
-            ClusterLastErrorInfo::get(client) = std::make_shared<ClusterLastErrorInfo>();
-        }
-        ClusterLastErrorInfo::get(client)->newRequest();
-        LastError::get(client).startRequest();
+    const int32_t msgId = message.header().getId();
 
-        DbMessage dbm(message);
+    const NetworkOp op = message.operation();
 
-        NamespaceString nss;
+    // This exception will not be returned to the caller, but will be logged and will close the
+    // connection
+    uassert(ErrorCodes::IllegalOperation,
+            str::stream() << "Message type " << op << " is not supported.",
+            isSupportedNetworkOp(op));
 
-        try {
+    // Start a new LastError session. Any exceptions thrown from here onwards will be returned
+    // to the caller (if the type of the message permits it).
+    auto client = opCtx->getClient();
+    if (!ClusterLastErrorInfo::get(client)) {
+        ClusterLastErrorInfo::get(client) = std::make_shared<ClusterLastErrorInfo>();
+    }
+    ClusterLastErrorInfo::get(client)->newRequest();
+    LastError::get(client).startRequest();
 
-            if (dbm.messageShouldHaveNs()) {
-                nss = NamespaceString(StringData(dbm.getns()));
+    DbMessage dbm(message);
 
-                uassert(ErrorCodes::InvalidNamespace,
-                        str::stream() << "Invalid ns [" << nss.ns() << "]",
-                        nss.isValid());
+    NamespaceString nss;
 
-                uassert(ErrorCodes::IllegalOperation,
-                        "Can't use 'local' database through mongos",
-                        nss.db() != NamespaceString::kLocalDb);
-            }
+    try {
 
-            AuthorizationSession::get(opCtx->getClient())->startRequest(opCtx.get());
-
-            LOG(3) << "Request::process begin ns: " << nss << " msg id: " << msgId
-                   << " op: " << networkOpToString(op);
-
-            switch (op) {
-                case dbQuery:
-                    if (nss.isCommand() || nss.isSpecialCommand()) {
-                        Strategy::clientCommandOp(opCtx.get(), nss, &dbm);
-                    } else {
-                        Strategy::queryOp(opCtx.get(), nss, &dbm);
-                    }
-                    break;
-                case dbGetMore:
-                    Strategy::getMore(opCtx.get(), nss, &dbm);
-                    break;
-                case dbKillCursors:
-                    Strategy::killCursors(opCtx.get(), &dbm);
-                    break;
-                default:
-                    Strategy::writeOp(opCtx.get(), &dbm);
-                    break;
-            }
+        if (dbm.messageShouldHaveNs()) {
+            nss = NamespaceString(StringData(dbm.getns()));
 
-            LOG(3) << "Request::process end ns: " << nss << " msg id: " << msgId
-                   << " op: " << networkOpToString(op);
+            uassert(ErrorCodes::InvalidNamespace,
+                    str::stream() << "Invalid ns [" << nss.ns() << "]",
+                    nss.isValid());
 
-        } catch (const DBException& ex) {
-            LOG(1) << "Exception thrown"
-                   << " while processing " << networkOpToString(op) << " op"
-                   << " for " << nss.ns() << causedBy(ex);
+            uassert(ErrorCodes::IllegalOperation,
+                    "Can't use 'local' database through mongos",
+                    nss.db() != NamespaceString::kLocalDb);
+        }
 
-            if (op == dbQuery || op == dbGetMore) {
-                replyToQuery(ResultFlag_ErrSet, session, message, buildErrReply(ex));
-            }
+        AuthorizationSession::get(opCtx->getClient())->startRequest(opCtx.get());
+
+        LOG(3) << "Request::process begin ns: " << nss << " msg id: " << msgId
+               << " op: " << networkOpToString(op);
 
-            // We *always* populate the last error for now
-            LastError::get(opCtx->getClient()).setLastError(ex.getCode(), ex.what());
+        switch (op) {
+            case dbQuery:
+                if (nss.isCommand() || nss.isSpecialCommand()) {
+                    Strategy::clientCommandOp(opCtx.get(), nss, &dbm);
+                } else {
+                    Strategy::queryOp(opCtx.get(), nss, &dbm);
+                }
+                break;
+            case dbGetMore:
+                Strategy::getMore(opCtx.get(), nss, &dbm);
+                break;
+            case dbKillCursors:
+                Strategy::killCursors(opCtx.get(), &dbm);
+                break;
+            default:
+                Strategy::writeOp(opCtx.get(), &dbm);
+                break;
         }
 
-        if ((counter++ & 0xf) == 0) {
-            markThreadIdle();
+        LOG(3) << "Request::process end ns: " << nss << " msg id: " << msgId
+               << " op: " << networkOpToString(op);
+
+    } catch (const DBException& ex) {
+        LOG(1) << "Exception thrown"
+               << " while processing " << networkOpToString(op) << " op"
+               << " for " << nss.ns() << causedBy(ex);
+
+        if (op == dbQuery || op == dbGetMore) {
+            replyToQuery(ResultFlag_ErrSet, session, message, buildErrReply(ex));
         }
+
+        // We *always* populate the last error for now
+        LastError::get(opCtx->getClient()).setLastError(ex.getCode(), ex.what());
     }
 }
 
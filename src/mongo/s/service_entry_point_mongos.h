@@ -35,6 +35,8 @@
 
 namespace mongo {
 
+class Message;
+
 namespace transport {
 class Session;
 class TransportLayer;
@@ -57,6 +59,11 @@ public:
 private:
     void _sessionLoop(const transport::SessionHandle& session);
 
+    /**
+     * Runs a single Message sourced from 'session', replying to the client as required.
+     */
+    void _handleMessage(const transport::SessionHandle& session, Message& message);
+
     transport::TransportLayer* _tl;
 };
 
@@ -33,6 +33,7 @@
 #include "mongo/transport/message_compressor_manager.h"
 #include "mongo/transport/message_compressor_noop.h"
 #include "mongo/transport/message_compressor_registry.h"
+#include "mongo/transport/message_compressor_zlib.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/net/message.h"
 
@@ -182,5 +183,51 @@ TEST(SnappyMessageCompressor, Fidelity) {
     checkFidelity(testMessage, stdx::make_unique<NoopMessageCompressor>());
 }
 
+TEST(ZlibMessageCompressor, Fidelity) {
+    auto testMessage = buildMessage();
+    for (int level : {-1, 0, 1, 9}) {
+        checkFidelity(testMessage, stdx::make_unique<ZlibMessageCompressor>(level));
+    }
+}
+
+TEST(ZlibMessageCompressor, CountsBytesAndTime) {
+    std::string data;
+    while (data.size() < 64 * 1024) {
+        data += "{ts: Timestamp(1497988800, 1), op: 'i', ns: 'test.coll', o: {_id: 1}} ";
+    }
+
+    ZlibMessageCompressor compressor(-1);
+    std::vector<char> compressed(compressor.getMaxCompressedSize(data.size()));
+    auto sws = compressor.compressData(ConstDataRange(data.data(), data.size()),
+                                       DataRange(compressed.data(), compressed.size()));
+    ASSERT_OK(sws.getStatus());
+    ASSERT_LT(sws.getValue(), data.size() / 10);
+    ASSERT_EQ(compressor.getCompressedBytesIn(), static_cast<int64_t>(data.size()));
+    ASSERT_EQ(compressor.getCompressedBytesOut(), static_cast<int64_t>(sws.getValue()));
+
+    std::vector<char> decompressed(data.size());
+    auto compressedSize = sws.getValue();
+    sws = compressor.decompressData(ConstDataRange(compressed.data(), compressedSize),
+                                    DataRange(decompressed.data(), decompressed.size()));
+    ASSERT_OK(sws.getStatus());
+    ASSERT_EQ(sws.getValue(), data.size());
+    ASSERT_EQ(memcmp(decompressed.data(), data.data(), data.size()), 0);
+    ASSERT_EQ(compressor.getDecompressedBytesIn(), static_cast<int64_t>(compressedSize));
+    ASSERT_EQ(compressor.getDecompressedBytesOut(), static_cast<int64_t>(data.size()));
+
+    compressor.counterHitCompressTime(Microseconds(5));
+    ASSERT_EQ(compressor.getCompressTime(), Microseconds(5));
+}
+
+TEST(ZlibMessageCompressor, RejectsCorruptData) {
+    const std::string garbage = "this is not a zlib stream";
+    std::vector<char> output(1024);
+
+    ZlibMessageCompressor compressor(-1);
+    auto sws = compressor.decompressData(ConstDataRange(garbage.data(), garbage.size()),
+                                         DataRange(output.data(), output.size()));
+    ASSERT_NOT_OK(sws.getStatus());
+}
+
 }  // namespace mongo
 }  // namespace
@@ -47,6 +47,8 @@ StringData getMessageCompressorName(MessageCompressor id) {
             return "noop"_sd;
         case MessageCompressor::kSnappy:
             return "snappy"_sd;
+        case MessageCompressor::kZlib:
+            return "zlib"_sd;
         default:
             fassert(40269, "Invalid message compressor ID");
     }
@@ -104,6 +106,14 @@ void MessageCompressorRegistry::setSupportedCompressors(std::vector<std::string>
     _compressorNames = std::move(names);
 }
 
+void MessageCompressorRegistry::setZlibCompressionLevel(int level) {
+    _zlibCompressionLevel = level;
+}
+
+int MessageCompressorRegistry::getZlibCompressionLevel() const {
+    return _zlibCompressionLevel;
+}
+
 Status addMessageCompressionOptions(moe::OptionSection* options, bool forShell) {
     auto ret =
         options
@@ -115,6 +125,15 @@ Status addMessageCompressionOptions(moe::OptionSection* options, bool forShell)
     if (forShell)
         ret.hidden();
 
+    auto& level = options->addOptionChaining("net.compression.zlibCompressionLevel",
+                                             "zlibNetworkCompressionLevel",
+                                             moe::Int,
+                                             "Compression level of the zlib network message "
+                                             "compressor, from 0 (fastest) to 9 (smallest), or -1 "
+                                             "for zlib's default");
+    if (forShell)
+        level.hidden();
+
     return Status::OK();
 }
 
@@ -128,6 +147,15 @@ Status storeMessageCompressionOptions(const moe::Environment& params) {
     auto& compressorFactory = MessageCompressorRegistry::get();
     compressorFactory.setSupportedCompressors(std::move(restrict));
 
+    if (params.count("net.compression.zlibCompressionLevel")) {
+        auto level = params["net.compression.zlibCompressionLevel"].as<int>();
+        if (level < -1 || level > 9) {
+            return {ErrorCodes::BadValue,
+                    "net.compression.zlibCompressionLevel must be between -1 and 9"};
+        }
+        compressorFactory.setZlibCompressionLevel(level);
+    }
+
     return Status::OK();
 }
 
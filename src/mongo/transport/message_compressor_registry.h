@@ -109,12 +109,25 @@ public:
      */
     Status finalizeSupportedCompressors();
 
+    /*
+     * Sets the compression level the "zlib" compressor is registered with. Should be called
+     * during option parsing, before the compressors register themselves.
+     */
+    void setZlibCompressionLevel(int level);
+
+    /*
+     * Returns the configured compression level for the "zlib" compressor. Defaults to zlib's
+     * Z_DEFAULT_COMPRESSION (-1).
+     */
+    int getZlibCompressionLevel() const;
+
 private:
     StringMap<MessageCompressorBase*> _compressorsByName;
     std::array<std::unique_ptr<MessageCompressorBase>,
                std::numeric_limits<MessageCompressorId>::max() + 1>
         _compressorsByIds;
     std::vector<std::string> _compressorNames;
+    int _zlibCompressionLevel = -1;
 };
 
 Status addMessageCompressionOptions(moe::OptionSection* options, bool forShell);
@@ -0,0 +1,114 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/message_compressor_zlib.h"
+
+#include <zlib.h>
+
+#include "mongo/base/init.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/transport/message_compressor_registry.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+ZlibMessageCompressor::ZlibMessageCompressor(int compressionLevel)
+    : MessageCompressorBase(MessageCompressor::kZlib), _compressionLevel(compressionLevel) {}
+
+std::size_t ZlibMessageCompressor::getMaxCompressedSize(size_t inputSize) {
+    // Without a stream deflateBound() returns a bound that holds for any compression level.
+    return deflateBound(nullptr, inputSize);
+}
+
+StatusWith<std::size_t> ZlibMessageCompressor::compressData(ConstDataRange input,
+                                                            DataRange output) {
+    z_stream stream;
+    stream.next_in = reinterpret_cast<unsigned char*>(const_cast<char*>(input.data()));
+    stream.avail_in = input.length();
+    stream.next_out = reinterpret_cast<unsigned char*>(const_cast<char*>(output.data()));
+    stream.avail_out = output.length();
+    stream.zalloc = nullptr;
+    stream.zfree = nullptr;
+    stream.opaque = nullptr;
+
+    int err = deflateInit(&stream, _compressionLevel);
+    if (err != Z_OK) {
+        return {ErrorCodes::ZLibError, str::stream() << "deflateInit failed with " << err};
+    }
+
+    err = deflate(&stream, Z_FINISH);
+    (void)deflateEnd(&stream);
+    if (err != Z_STREAM_END) {
+        return {ErrorCodes::ZLibError, str::stream() << "deflate failed with " << err};
+    }
+
+    counterHitCompress(input.length(), stream.total_out);
+    return {stream.total_out};
+}
+
+StatusWith<std::size_t> ZlibMessageCompressor::decompressData(ConstDataRange input,
+                                                              DataRange output) {
+    z_stream stream;
+    stream.next_in = reinterpret_cast<unsigned char*>(const_cast<char*>(input.data()));
+    stream.avail_in = input.length();
+    stream.next_out = reinterpret_cast<unsigned char*>(const_cast<char*>(output.data()));
+    stream.avail_out = output.length();
+    stream.zalloc = nullptr;
+    stream.zfree = nullptr;
+    stream.opaque = nullptr;
+
+    int err = inflateInit(&stream);
+    if (err != Z_OK) {
+        return {ErrorCodes::ZLibError, str::stream() << "inflateInit failed with " << err};
+    }
+
+    err = inflate(&stream, Z_FINISH);
+    (void)inflateEnd(&stream);
+    if (err != Z_STREAM_END) {
+        return Status{ErrorCodes::BadValue, "Compressed message was invalid or corrupted"};
+    }
+
+    counterHitDecompress(input.length(), stream.total_out);
+    return {stream.total_out};
+}
+
+
+MONGO_INITIALIZER_GENERAL(ZlibMessageCompressorInit,
+                          ("EndStartupOptionHandling"),
+                          ("AllCompressorsRegistered"))
+(InitializerContext* context) {
+    auto& compressorRegistry = MessageCompressorRegistry::get();
+    compressorRegistry.registerImplementation(
+        stdx::make_unique<ZlibMessageCompressor>(compressorRegistry.getZlibCompressionLevel()));
+    return Status::OK();
+}
+}  // namespace mongo
@@ -36,10 +36,13 @@
 #include "mongo/db/server_options.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/transport/session.h"
+#include "mongo/transport/ticket.h"
 #include "mongo/transport/transport_layer.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_name.h"
 #include "mongo/util/debug_util.h"
 #include "mongo/util/log.h"
+#include "mongo/util/net/message.h"
 #include "mongo/util/net/socket_exception.h"
 #include "mongo/util/quick_exit.h"
 
@@ -67,15 +70,14 @@ struct Context {
     stdx::function<void(const transport::SessionHandle&)> task;
 };
 
-void* runFunc(void* ptr) {
-    std::unique_ptr<Context> ctx(static_cast<Context*>(ptr));
-
-    auto tl = ctx->session->getTransportLayer();
-    Client::initThread("conn", ctx->session);
-    setThreadName(str::stream() << "conn" << ctx->session->id());
-
+/**
+ * Runs 'task', logging any exception it throws. Returns false if the client connection should be
+ * closed as a result.
+ */
+bool runServiceEntryTask(const stdx::function<void()>& task) {
     try {
-        ctx->task(ctx->session);
+        task();
+        return true;
     } catch (const AssertionException& e) {
         log() << "AssertionException handling request, closing client connection: " << e;
     } catch (const SocketException& e) {
@@ -87,20 +89,99 @@ void* runFunc(void* ptr) {
         error() << "Uncaught std::exception: " << e.what() << ", terminating";
         quickExit(EXIT_UNCAUGHT);
     }
+    return false;
+}
 
-    tl->end(ctx->session);
+void endSession(const transport::SessionHandle& session) {
+    auto tl = session->getTransportLayer();
+    tl->end(session);
 
     if (!serverGlobalParams.quiet.load()) {
         auto conns = tl->sessionStats().numOpenSessions;
         const char* word = (conns == 1 ? " connection" : " connections");
-        log() << "end connection " << ctx->session->remote() << " (" << conns << word
-              << " now open)";
+        log() << "end connection " << session->remote() << " (" << conns << word << " now open)";
     }
+}
+
+void* runFunc(void* ptr) {
+    std::unique_ptr<Context> ctx(static_cast<Context*>(ptr));
+
+    Client::initThread("conn", ctx->session);
+    setThreadName(str::stream() << "conn" << ctx->session->id());
+
+    runServiceEntryTask([&] { ctx->task(ctx->session); });
+
+    endSession(ctx->session);
 
     Client::destroy();
 
     return nullptr;
 }
+
+/**
+ * The state of a Session run on a ServiceExecutor. Between Messages, the Session's Client is
+ * parked here rather than attached to any thread, and the only reference to this object is held
+ * by the pending asyncWait() callback.
+ */
+class ExecutorSessionState : public std::enable_shared_from_this<ExecutorSessionState> {
+    MONGO_DISALLOW_COPYING(ExecutorSessionState);
+
+public:
+    using HandleMessageFn = stdx::function<void(const transport::SessionHandle&, Message&)>;
+
+    ExecutorSessionState(transport::SessionHandle session, HandleMessageFn handleMessage)
+        : _session(std::move(session)),
+          _handleMessage(std::move(handleMessage)),
+          _client(getGlobalServiceContext()->makeClient(str::stream() << "conn" << _session->id(),
+                                                        _session)) {}
+
+    /**
+     * Waits for the next Message from the client without holding a thread.
+     */
+    void sourceMessage() {
+        _inMessage.reset();
+        auto self = shared_from_this();
+        _session->sourceMessage(&_inMessage).asyncWait([self](Status status) {
+            self->_onMessageSourced(std::move(status));
+        });
+    }
+
+private:
+    void _onMessageSourced(Status status) {
+        if (!status.isOK()) {
+            if (!ErrorCodes::isInterruption(status.code()) &&
+                !ErrorCodes::isNetworkError(status.code()) &&
+                status != transport::TransportLayer::TicketSessionClosedStatus) {
+                log() << "Error receiving request from client, closing client connection: "
+                      << status;
+            }
+            endSession(_session);
+            return;
+        }
+
+        const std::string workerName = getThreadName().toString();
+        Client::setCurrent(std::move(_client));
+
+        const bool keepOpen = runServiceEntryTask([&] { _handleMessage(_session, _inMessage); });
+
+        _client = Client::releaseCurrent();
+        setThreadName(workerName);
+
+        if (!keepOpen) {
+            endSession(_session);
+            return;
+        }
+
+        sourceMessage();
+    }
+
+    const transport::SessionHandle _session;
+    const HandleMessageFn _handleMessage;
+
+    ServiceContext::UniqueClient _client;
+    Message _inMessage;
+};
+
 }  // namespace
 
 void launchWrappedServiceEntryWorkerThread(
@@ -155,4 +236,11 @@ void launchWrappedServiceEntryWorkerThread(
     }
 }
 
+void launchServiceExecutorSession(
+    transport::SessionHandle session,
+    stdx::function<void(const transport::SessionHandle&, Message&)> handleMessage) {
+    std::make_shared<ExecutorSessionState>(std::move(session), std::move(handleMessage))
+        ->sourceMessage();
+}
+
 }  // namespace mongo
@@ -33,7 +33,21 @@
 
 namespace mongo {
 
+class Message;
+
 void launchWrappedServiceEntryWorkerThread(
     transport::SessionHandle session, stdx::function<void(const transport::SessionHandle&)> task);
 
+/**
+ * Runs 'session' on the global ServiceContext's ServiceExecutor instead of on a dedicated thread.
+ *
+ * Each time a Message has been sourced from the session, 'handleMessage' is invoked on an executor
+ * worker with the session's Client attached to that thread. It must fully process the Message,
+ * including sinking any response. The session ends once sourcing a Message fails or
+ * 'handleMessage' throws.
+ */
+void launchServiceExecutorSession(
+    transport::SessionHandle session,
+    stdx::function<void(const transport::SessionHandle&, Message&)> handleMessage);
+
 }  // namespace mongo
@@ -0,0 +1,271 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kNetwork
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/service_executor_fixed.h"
+
+#include <algorithm>
+#include <asio.hpp>
+
+#include "mongo/base/init.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_name.h"
+#include "mongo/util/log.h"
+#include "mongo/util/processinfo.h"
+#include "mongo/util/scopeguard.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+namespace transport {
+namespace {
+
+const char kServiceExecutorSynchronous[] = "synchronous";
+const char kServiceExecutorFixedThreadPool[] = "fixedThreadPool";
+
+// Selects how Sessions are run: "synchronous" dedicates a thread to every connection, while
+// "fixedThreadPool" multiplexes all connections onto a ServiceExecutorFixed.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(serviceExecutor, std::string, kServiceExecutorSynchronous);
+
+// The number of worker threads used by the fixedThreadPool service executor. If less than or equal
+// to 0, one worker is started per core.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(serviceExecutorNumThreads, int, 0);
+
+// The most worker threads the fixedThreadPool service executor runs when all of them are busy. If
+// less than or equal to 0, it is ServiceExecutorFixed::kDefaultMaxThreadsFactor times the number
+// of workers.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(serviceExecutorMaxThreads, int, 0);
+
+MONGO_INITIALIZER(serviceExecutor)(InitializerContext*) {
+    if (serviceExecutor != kServiceExecutorSynchronous &&
+        serviceExecutor != kServiceExecutorFixedThreadPool) {
+        return Status(ErrorCodes::BadValue, "unsupported service executor: " + serviceExecutor);
+    }
+#ifdef _WIN32
+    if (serviceExecutor == kServiceExecutorFixedThreadPool) {
+        return Status(ErrorCodes::BadValue,
+                      "the fixedThreadPool service executor is not supported on Windows");
+    }
+#endif
+    return Status::OK();
+}
+
+}  // namespace
+
+bool isServiceExecutorFixedEnabled() {
+    return serviceExecutor == kServiceExecutorFixedThreadPool;
+}
+
+ServiceExecutorFixed::Options serviceExecutorFixedOptionsFromParameters() {
+    ServiceExecutorFixed::Options options;
+    if (serviceExecutorNumThreads > 0) {
+        options.numThreads = static_cast<size_t>(serviceExecutorNumThreads);
+    }
+    if (serviceExecutorMaxThreads > 0) {
+        options.maxThreads = static_cast<size_t>(serviceExecutorMaxThreads);
+    }
+    return options;
+}
+
+constexpr size_t ServiceExecutorFixed::kDefaultMaxThreadsFactor;
+
+ServiceExecutorFixed::ServiceExecutorFixed(Options options)
+    : _numThreads(options.numThreads ? options.numThreads
+                                     : std::max(1U, ProcessInfo().getNumCores())),
+      _maxThreads(std::max(_numThreads,
+                           options.maxThreads ? options.maxThreads
+                                              : kDefaultMaxThreadsFactor * _numThreads)),
+      _ioService(stdx::make_unique<asio::io_service>()) {}
+
+ServiceExecutorFixed::~ServiceExecutorFixed() {
+    shutdown();
+}
+
+Status ServiceExecutorFixed::start() {
+    if (_isRunning.swap(true)) {
+        return {ErrorCodes::InternalError, "ServiceExecutor is already running"};
+    }
+
+    log() << "Starting fixed service executor with " << _numThreads << " worker threads, and up to "
+          << _maxThreads << " when they are all busy";
+
+    _threads.reserve(_numThreads);
+    for (size_t i = 0; i < _numThreads; ++i) {
+        _threadsRunning.addAndFetch(1);
+        _threads.emplace_back([this, i] { _workerThreadRoutine(i); });
+    }
+
+    return Status::OK();
+}
+
+void ServiceExecutorFixed::_workerThreadRoutine(size_t threadId) {
+    setThreadName(str::stream() << "worker-" << threadId);
+
+    ON_BLOCK_EXIT([&] { _threadsRunning.subtractAndFetch(1); });
+
+    try {
+        asio::io_service::work work(*_ioService);
+        std::error_code ec;
+        _ioService->run(ec);
+        if (ec) {
+            severe() << "Failure in service executor worker thread: " << ec.message();
+            fassertFailed(40500);
+        }
+    } catch (...) {
+        severe() << "Uncaught exception in service executor worker thread: "
+                 << exceptionToStatus();
+        fassertFailed(40501);
+    }
+}
+
+void ServiceExecutorFixed::_extraWorkerThreadRoutine(size_t threadId) {
+    setThreadName(str::stream() << "worker-extra-" << threadId);
+
+    ON_BLOCK_EXIT([&] { _extraThreadsAlive.subtractAndFetch(1); });
+
+    try {
+        // The core workers keep the io_service from running out of work, so this only returns
+        // zero once the executor is shut down.
+        std::error_code ec;
+        while (_ioService->run_one(ec) > 0) {
+            if (_tasksQueued.load() > 0) {
+                continue;
+            }
+
+            // Stop counting this worker before checking for queued tasks one last time, so that a
+            // task scheduled concurrently is noticed either here or by schedule().
+            _threadsRunning.subtractAndFetch(1);
+            if (_tasksQueued.load() == 0) {
+                return;
+            }
+            _threadsRunning.addAndFetch(1);
+        }
+        _threadsRunning.subtractAndFetch(1);
+
+        if (ec) {
+            severe() << "Failure in service executor worker thread: " << ec.message();
+            fassertFailed(40512);
+        }
+    } catch (...) {
+        severe() << "Uncaught exception in service executor worker thread: "
+                 << exceptionToStatus();
+        fassertFailed(40513);
+    }
+}
+
+void ServiceExecutorFixed::_startExtraWorkerIfNeeded() {
+    const auto needsWorker = [&] {
+        return _tasksQueued.load() > _threadsRunning.load() - _threadsInUse.load();
+    };
+    if (!needsWorker()) {
+        return;
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(_extraThreadsMutex);
+    if (!_isRunning.load() || !needsWorker() ||
+        static_cast<size_t>(_threadsRunning.load()) >= _maxThreads) {
+        return;
+    }
+
+    _threadsRunning.addAndFetch(1);
+    _extraThreadsAlive.addAndFetch(1);
+    const size_t threadId = _extraThreadsStarted++;
+    stdx::thread([this, threadId] { _extraWorkerThreadRoutine(threadId); }).detach();
+}
+
+Status ServiceExecutorFixed::schedule(Task task) {
+    if (!_isRunning.load()) {
+        return {ErrorCodes::ShutdownInProgress, "ServiceExecutor is not running"};
+    }
+
+    _tasksQueued.addAndFetch(1);
+    _totalScheduled.addAndFetch(1);
+
+    const auto scheduledMicros = curTimeMicros64();
+    _ioService->post([ this, task = std::move(task), scheduledMicros ] {
+        const auto startMicros = curTimeMicros64();
+
+        // Count the task as in use before it stops being queued, so that a concurrent schedule()
+        // never undercounts the tasks which are waiting for or holding a worker.
+        _threadsInUse.addAndFetch(1);
+        _tasksQueued.subtractAndFetch(1);
+        _totalTimeQueuedMicros.addAndFetch(startMicros - scheduledMicros);
+
+        ON_BLOCK_EXIT([&] {
+            _threadsInUse.subtractAndFetch(1);
+            _totalExecuted.addAndFetch(1);
+            _totalTimeExecutingMicros.addAndFetch(curTimeMicros64() - startMicros);
+        });
+
+        task();
+    });
+
+    _startExtraWorkerIfNeeded();
+    return Status::OK();
+}
+
+Status ServiceExecutorFixed::shutdown() {
+    if (!_isRunning.swap(false)) {
+        return Status::OK();
+    }
+
+    _ioService->stop();
+    for (auto&& thread : _threads) {
+        thread.join();
+    }
+    _threads.clear();
+
+    // Extra workers are detached, so wait for them to exit. Taking the mutex makes sure that any
+    // which was being started is counted.
+    {
+        stdx::lock_guard<stdx::mutex> lk(_extraThreadsMutex);
+    }
+    while (_extraThreadsAlive.load() > 0) {
+        sleepmillis(1);
+    }
+
+    return Status::OK();
+}
+
+void ServiceExecutorFixed::appendStats(BSONObjBuilder* bob) const {
+    BSONObjBuilder section(bob->subobjStart("serviceExecutorTaskStats"));
+    section << "executor" << kServiceExecutorFixedThreadPool << "threadsRunning"
+            << _threadsRunning.load() << "threadsMax" << static_cast<int>(_maxThreads)
+            << "threadsInUse" << _threadsInUse.load() << "tasksQueued" << _tasksQueued.load()
+            << "totalScheduled" << _totalScheduled.load() << "totalExecuted"
+            << _totalExecuted.load() << "totalTimeQueuedMicros" << _totalTimeQueuedMicros.load()
+            << "totalTimeExecutingMicros" << _totalTimeExecutingMicros.load();
+}
+
+}  // namespace transport
+}  // namespace mongo
@@ -0,0 +1,142 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "mongo/platform/atomic_word.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/transport/service_executor.h"
+
+namespace asio {
+class io_service;
+}  // namespace asio
+
+namespace mongo {
+namespace transport {
+
+/**
+ * A ServiceExecutor which runs tasks on a pool of worker threads sized independently of how many
+ * Sessions are open. Tasks are queued on an ASIO io_service and are picked up by whichever worker
+ * becomes free first.
+ *
+ * The pool keeps a fixed number of core workers. Tasks may still block, on the rest of a message
+ * or on a long running operation, so when a task is scheduled while every worker is busy, an
+ * extra worker is started, up to a maximum. Extra workers exit once they find no queued task.
+ */
+class ServiceExecutorFixed final : public ServiceExecutor {
+public:
+    struct Options {
+        // The number of worker threads to run. Zero means one thread per available core.
+        size_t numThreads = 0;
+
+        // The most worker threads to run when all of them are busy. Zero means
+        // kDefaultMaxThreadsFactor times 'numThreads'.
+        size_t maxThreads = 0;
+    };
+
+    static constexpr size_t kDefaultMaxThreadsFactor = 10;
+
+    explicit ServiceExecutorFixed(Options options);
+    ~ServiceExecutorFixed() override;
+
+    Status start() override;
+    Status schedule(Task task) override;
+    Status shutdown() override;
+
+    void appendStats(BSONObjBuilder* bob) const override;
+
+    /**
+     * Returns the number of worker threads this executor runs once started.
+     */
+    size_t numThreads() const {
+        return _numThreads;
+    }
+
+    /**
+     * Returns the most worker threads this executor runs when all of them are busy.
+     */
+    size_t maxThreads() const {
+        return _maxThreads;
+    }
+
+private:
+    void _workerThreadRoutine(size_t threadId);
+
+    /**
+     * Runs queued tasks on an extra worker until none is queued.
+     */
+    void _extraWorkerThreadRoutine(size_t threadId);
+
+    /**
+     * Starts an extra worker if there are more queued tasks than idle workers.
+     */
+    void _startExtraWorkerIfNeeded();
+
+    const size_t _numThreads;
+    const size_t _maxThreads;
+
+    std::unique_ptr<asio::io_service> _ioService;
+    std::vector<stdx::thread> _threads;
+
+    AtomicWord<bool> _isRunning{false};
+
+    // Held to start extra workers, so that no more than '_maxThreads' run.
+    stdx::mutex _extraThreadsMutex;
+    size_t _extraThreadsStarted = 0;
+
+    // Extra workers are detached, so shutdown() waits for this to drop to zero. It only does once
+    // they no longer touch the executor.
+    AtomicWord<int> _extraThreadsAlive{0};
+
+    // Counts both core and extra workers which may run tasks. Incremented before a worker starts.
+    AtomicWord<int> _threadsRunning{0};
+    AtomicWord<int> _threadsInUse{0};
+    AtomicWord<int> _tasksQueued{0};
+    AtomicWord<long long> _totalScheduled{0};
+    AtomicWord<long long> _totalExecuted{0};
+    AtomicWord<long long> _totalTimeQueuedMicros{0};
+    AtomicWord<long long> _totalTimeExecutingMicros{0};
+};
+
+/**
+ * Returns true if the server was started with --setParameter serviceExecutor=fixedThreadPool, in
+ * which case Sessions should be run on a ServiceExecutorFixed instead of a thread per connection.
+ */
+bool isServiceExecutorFixedEnabled();
+
+/**
+ * Returns the Options for a ServiceExecutorFixed as configured by startup server parameters.
+ */
+ServiceExecutorFixed::Options serviceExecutorFixedOptionsFromParameters();
+
+}  // namespace transport
+}  // namespace mongo
@@ -0,0 +1,163 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/transport/service_executor_fixed.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/unittest/barrier.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+using transport::ServiceExecutorFixed;
+
+BSONObj getStats(const ServiceExecutorFixed& executor) {
+    BSONObjBuilder bob;
+    executor.appendStats(&bob);
+    return bob.obj()["serviceExecutorTaskStats"].Obj().getOwned();
+}
+
+TEST(ServiceExecutorFixed, ScheduleFailsBeforeStart) {
+    ServiceExecutorFixed executor(ServiceExecutorFixed::Options{});
+    ASSERT_EQ(ErrorCodes::ShutdownInProgress, executor.schedule([] {}).code());
+}
+
+TEST(ServiceExecutorFixed, DefaultsToOneThreadPerCore) {
+    ServiceExecutorFixed executor(ServiceExecutorFixed::Options{});
+    ASSERT_GREATER_THAN_OR_EQUALS(executor.numThreads(), 1U);
+}
+
+TEST(ServiceExecutorFixed, DefaultsToMaxThreadsFactor) {
+    ServiceExecutorFixed::Options options;
+    options.numThreads = 2;
+    ServiceExecutorFixed executor(options);
+    ASSERT_EQ(2U * ServiceExecutorFixed::kDefaultMaxThreadsFactor, executor.maxThreads());
+}
+
+TEST(ServiceExecutorFixed, RunsTasksOnAllWorkers) {
+    ServiceExecutorFixed::Options options;
+    options.numThreads = 4;
+    ServiceExecutorFixed executor(options);
+    ASSERT_OK(executor.start());
+
+    // Every task waits for all of the others, so this only completes if each of them is running
+    // on a different worker at the same time.
+    unittest::Barrier barrier(options.numThreads + 1);
+    for (size_t i = 0; i < options.numThreads; ++i) {
+        ASSERT_OK(executor.schedule([&] { barrier.countDownAndWait(); }));
+    }
+    barrier.countDownAndWait();
+
+    ASSERT_OK(executor.shutdown());
+    ASSERT_EQ(ErrorCodes::ShutdownInProgress, executor.schedule([] {}).code());
+}
+
+TEST(ServiceExecutorFixed, ReportsQueuedAndInUseTasks) {
+    ServiceExecutorFixed::Options options;
+    options.numThreads = 1;
+    options.maxThreads = 1;
+    ServiceExecutorFixed executor(options);
+    ASSERT_OK(executor.start());
+
+    stdx::mutex mutex;
+    stdx::condition_variable cv;
+    bool started = false;
+    bool release = false;
+    int ran = 0;
+
+    ASSERT_OK(executor.schedule([&] {
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        started = true;
+        cv.notify_all();
+        cv.wait(lk, [&] { return release; });
+        ++ran;
+    }));
+    ASSERT_OK(executor.schedule([&] {
+        stdx::lock_guard<stdx::mutex> lk(mutex);
+        ++ran;
+        cv.notify_all();
+    }));
+
+    {
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        cv.wait(lk, [&] { return started; });
+    }
+
+    // The only worker is blocked in the first task, so the second one must still be queued.
+    auto stats = getStats(executor);
+    ASSERT_EQ(1, stats["threadsRunning"].numberInt());
+    ASSERT_EQ(1, stats["threadsInUse"].numberInt());
+    ASSERT_EQ(1, stats["tasksQueued"].numberInt());
+    ASSERT_EQ(2, stats["totalScheduled"].numberLong());
+
+    {
+        stdx::unique_lock<stdx::mutex> lk(mutex);
+        release = true;
+        cv.notify_all();
+        cv.wait(lk, [&] { return ran == 2; });
+    }
+
+    ASSERT_OK(executor.shutdown());
+
+    stats = getStats(executor);
+    ASSERT_EQ(0, stats["threadsRunning"].numberInt());
+    ASSERT_EQ(0, stats["threadsInUse"].numberInt());
+    ASSERT_EQ(0, stats["tasksQueued"].numberInt());
+    ASSERT_EQ(2, stats["totalExecuted"].numberLong());
+}
+
+TEST(ServiceExecutorFixed, StartsExtraWorkersWhenAllAreBusy) {
+    ServiceExecutorFixed::Options options;
+    options.numThreads = 1;
+    options.maxThreads = 3;
+    ServiceExecutorFixed executor(options);
+    ASSERT_OK(executor.start());
+
+    // As in RunsTasksOnAllWorkers, this only completes if the tasks run at the same time, which
+    // takes more workers than the core one.
+    unittest::Barrier barrier(options.maxThreads + 1);
+    for (size_t i = 0; i < options.maxThreads; ++i) {
+        ASSERT_OK(executor.schedule([&] { barrier.countDownAndWait(); }));
+    }
+    barrier.countDownAndWait();
+
+    auto stats = getStats(executor);
+    ASSERT_LTE(stats["threadsRunning"].numberInt(), 3);
+    ASSERT_EQ(3, stats["threadsMax"].numberInt());
+
+    ASSERT_OK(executor.shutdown());
+    ASSERT_EQ(0, getStats(executor)["threadsRunning"].numberInt());
+}
+
+}  // namespace
+}  // namespace mongo
@@ -31,6 +31,7 @@
 #include "mongo/platform/basic.h"
 
 #include <algorithm>
+#include <asio.hpp>
 #include <iterator>
 #include <memory>
 
@@ -43,10 +44,13 @@
 #include "mongo/stdx/functional.h"
 #include "mongo/transport/message_compressor_manager.h"
 #include "mongo/transport/service_entry_point.h"
+#include "mongo/transport/service_executor.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_name.h"
 #include "mongo/util/log.h"
 #include "mongo/util/net/abstract_message_port.h"
 #include "mongo/util/net/socket_exception.h"
+#include "mongo/util/net/ssl_options.h"
 #include "mongo/util/net/ssl_types.h"
 
 namespace mongo {
@@ -75,6 +79,7 @@ TransportLayerLegacy::TransportLayerLegacy(const TransportLayerLegacy::Options&
       _listener(stdx::make_unique<ListenerLegacy>(
           opts,
           stdx::bind(&TransportLayerLegacy::_handleNewConnection, this, stdx::placeholders::_1))),
+      _reactor(stdx::make_unique<asio::io_service>()),
       _running(false),
       _options(opts) {}
 
@@ -92,17 +97,50 @@ TransportLayerLegacy::LegacySession::LegacySession(std::unique_ptr<AbstractMessa
       _tags(kEmptyTagMask),
       _connection(stdx::make_unique<Connection>(std::move(amp))) {}
 
+struct TransportLayerLegacy::LegacySession::ReadinessDescriptor {
+#ifndef _WIN32
+    ReadinessDescriptor(asio::io_service& reactor, int fd) : descriptor(reactor, fd) {}
+
+    ~ReadinessDescriptor() {
+        // The descriptor belongs to the AbstractMessagingPort, so make sure ASIO doesn't close it.
+        descriptor.release();
+    }
+
+    asio::posix::stream_descriptor descriptor;
+#endif
+};
+
 TransportLayerLegacy::LegacySession::~LegacySession() {
+    _readiness.reset();
     _tl->_destroy(*this);
 }
 
+void TransportLayerLegacy::LegacySession::asyncWaitReadable(asio::io_service& reactor,
+                                                            stdx::function<void()> onReadable) {
+#ifndef _WIN32
+    if (!_readiness) {
+        _readiness = stdx::make_unique<ReadinessDescriptor>(reactor, _connection->amp->rawFD());
+    }
+
+    // Errors, including cancellation and the peer hanging up, are deliberately ignored here. They
+    // surface when the caller tries to receive from the socket.
+    _readiness->descriptor.async_wait(
+        asio::posix::stream_descriptor::wait_read,
+        [onReadable](const std::error_code&) { onReadable(); });
+#else
+    MONGO_UNREACHABLE;
+#endif
+}
+
 TransportLayerLegacy::LegacyTicket::LegacyTicket(const LegacySessionHandle& session,
                                                  Date_t expiration,
-                                                 WorkHandle work)
+                                                 WorkHandle work,
+                                                 bool isSource)
     : _session(session),
       _sessionId(session->id()),
       _expiration(expiration),
-      _fill(std::move(work)) {}
+      _fill(std::move(work)),
+      _isSource(isSource) {}
 
 TransportLayerLegacy::LegacySessionHandle TransportLayerLegacy::LegacyTicket::getSession() {
     return _session.lock();
@@ -121,6 +159,16 @@ Status TransportLayerLegacy::LegacyTicket::fill(AbstractMessagingPort* amp) {
 }
 
 Status TransportLayerLegacy::setup() {
+#ifdef MONGO_CONFIG_SSL
+    // Encrypted bytes may be buffered by the SSL library, so socket readiness says nothing about
+    // whether a Message is available.
+    if (getGlobalServiceContext()->getServiceExecutor() &&
+        sslGlobalParams.sslMode.load() != SSLParams::SSLMode_disabled) {
+        return {ErrorCodes::InvalidOptions,
+                "SSL connections are not supported with a fixed-size service executor"};
+    }
+#endif
+
     if (!_listener->setupSockets()) {
         error() << "Failed to set up sockets during startup.";
         return {ErrorCodes::InternalError, "Failed to set up sockets"};
@@ -136,9 +184,29 @@ Status TransportLayerLegacy::start() {
 
     _listenerThread = stdx::thread([this]() { _listener->initAndListen(); });
 
+    if (getGlobalServiceContext()->getServiceExecutor()) {
+        _reactorThread = stdx::thread([this]() { _runReactor(); });
+    }
+
     return Status::OK();
 }
 
+void TransportLayerLegacy::_runReactor() {
+    setThreadName("transport-reactor");
+    try {
+        asio::io_service::work work(*_reactor);
+        std::error_code ec;
+        _reactor->run(ec);
+        if (ec) {
+            severe() << "Failure in transport reactor thread: " << ec.message();
+            fassertFailed(40502);
+        }
+    } catch (...) {
+        severe() << "Uncaught exception in transport reactor thread: " << exceptionToStatus();
+        fassertFailed(40503);
+    }
+}
+
 TransportLayerLegacy::~TransportLayerLegacy() = default;
 
 Ticket TransportLayerLegacy::sourceMessage(const SessionHandle& session,
@@ -162,9 +230,9 @@ Ticket TransportLayerLegacy::sourceMessage(const SessionHandle& session,
     };
 
     auto legacySession = checked_pointer_cast<LegacySession>(session);
-    return Ticket(
-        this,
-        stdx::make_unique<LegacyTicket>(std::move(legacySession), expiration, std::move(sourceCb)));
+    return Ticket(this,
+                  stdx::make_unique<LegacyTicket>(
+                      std::move(legacySession), expiration, std::move(sourceCb), true));
 }
 
 TransportLayer::Stats TransportLayerLegacy::sessionStats() {
@@ -201,9 +269,9 @@ Ticket TransportLayerLegacy::sinkMessage(const SessionHandle& session,
     };
 
     auto legacySession = checked_pointer_cast<LegacySession>(session);
-    return Ticket(
-        this,
-        stdx::make_unique<LegacyTicket>(std::move(legacySession), expiration, std::move(sinkCb)));
+    return Ticket(this,
+                  stdx::make_unique<LegacyTicket>(
+                      std::move(legacySession), expiration, std::move(sinkCb), false));
 }
 
 Status TransportLayerLegacy::wait(Ticket&& ticket) {
@@ -211,10 +279,30 @@ Status TransportLayerLegacy::wait(Ticket&& ticket) {
 }
 
 void TransportLayerLegacy::asyncWait(Ticket&& ticket, TicketCallback callback) {
-    // Left unimplemented because there is no reasonable way to offer general async waiting besides
-    // offering a background thread that can handle waits for multiple tickets. We may never
-    // implement this for the legacy TL.
-    MONGO_UNREACHABLE;
+    // Tickets are always filled on the ServiceExecutor, so there is no way to offer async waiting
+    // without one.
+    auto executor = getGlobalServiceContext()->getServiceExecutor();
+    invariant(executor);
+
+    // Tickets are move-only, but the work we hand to ASIO and the executor must be copyable.
+    auto sharedTicket = std::make_shared<Ticket>(std::move(ticket));
+    auto fillTicket = [this, executor, sharedTicket, callback] {
+        auto status = executor->schedule(
+            [this, sharedTicket, callback] { callback(_runTicket(std::move(*sharedTicket))); });
+        if (!status.isOK()) {
+            callback(status);
+        }
+    };
+
+    auto legacyTicket = checked_cast<LegacyTicket*>(getTicketImpl(*sharedTicket));
+    auto session = legacyTicket->getSession();
+    if (!session || !legacyTicket->isSource()) {
+        // Sinks don't need to wait for anything, and closed sessions fail in _runTicket().
+        fillTicket();
+        return;
+    }
+
+    session->asyncWaitReadable(*_reactor, std::move(fillTicket));
 }
 
 void TransportLayerLegacy::end(const SessionHandle& session) {
@@ -276,6 +364,11 @@ void TransportLayerLegacy::shutdown() {
     _listener->shutdown();
     _listenerThread.join();
     endAllSessions(Session::kEmptyTagMask);
+
+    if (_reactorThread.joinable()) {
+        _reactor->stop();
+        _reactorThread.join();
+    }
 }
 
 void TransportLayerLegacy::_destroy(LegacySession& session) {
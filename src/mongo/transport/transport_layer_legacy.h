@@ -39,6 +39,10 @@
 #include "mongo/util/net/listen.h"
 #include "mongo/util/net/sock.h"
 
+namespace asio {
+class io_service;
+}  // namespace asio
+
 namespace mongo {
 
 class AbstractMessagingPort;
@@ -49,6 +53,11 @@ namespace transport {
 /**
  * A TransportLayer implementation based on legacy networking primitives (the Listener,
  * AbstractMessagingPort).
+ *
+ * When the ServiceContext has a ServiceExecutor, asyncWait() is supported as well: source Tickets
+ * are parked on an epoll-driven ASIO reactor until their socket becomes readable, and are then
+ * filled on the ServiceExecutor. This lets a small pool of threads serve a large number of mostly
+ * idle connections.
  */
 class TransportLayerLegacy final : public TransportLayer {
     MONGO_DISALLOW_COPYING(TransportLayerLegacy);
@@ -96,6 +105,8 @@ private:
 
     void _handleNewConnection(std::unique_ptr<AbstractMessagingPort> amp);
 
+    void _runReactor();
+
     Status _runTicket(Ticket ticket);
 
     using NewConnectionCb = stdx::function<void(std::unique_ptr<AbstractMessagingPort>)>;
@@ -158,6 +169,12 @@ private:
             return _entry;
         }
 
+        /**
+         * Invokes 'onReadable' from 'reactor' once this session's socket becomes readable, or
+         * once the wait fails. Only one wait may be outstanding at a time.
+         */
+        void asyncWaitReadable(asio::io_service& reactor, stdx::function<void()> onReadable);
+
     private:
         explicit LegacySession(std::unique_ptr<AbstractMessagingPort> amp,
                                TransportLayerLegacy* tl);
@@ -173,6 +190,11 @@ private:
 
         // A handle to this session's entry in the TL's session list
         SessionEntry _entry;
+
+        // Created lazily by the first asyncWaitReadable() on this session. It is registered with
+        // the reactor but does not own the socket.
+        struct ReadinessDescriptor;
+        std::unique_ptr<ReadinessDescriptor> _readiness;
     };
 
     /**
@@ -183,11 +205,22 @@ private:
         MONGO_DISALLOW_COPYING(LegacyTicket);
 
     public:
-        LegacyTicket(const LegacySessionHandle& session, Date_t expiration, WorkHandle work);
+        LegacyTicket(const LegacySessionHandle& session,
+                     Date_t expiration,
+                     WorkHandle work,
+                     bool isSource);
 
         SessionId sessionId() const override;
         Date_t expiration() const override;
 
+        /**
+         * Returns true if this ticket receives a Message, and so cannot be filled before data
+         * arrives on the session's socket.
+         */
+        bool isSource() const {
+            return _isSource;
+        }
+
         /**
          * If this ticket's session is still alive, return a shared_ptr. Otherwise,
          * return nullptr.
@@ -206,6 +239,8 @@ private:
         Date_t _expiration;
 
         WorkHandle _fill;
+
+        bool _isSource;
     };
 
     /**
@@ -235,6 +270,10 @@ private:
     std::unique_ptr<Listener> _listener;
     stdx::thread _listenerThread;
 
+    // Readiness notification for asyncWait(), only run when a ServiceExecutor is in use.
+    std::unique_ptr<asio::io_service> _reactor;
+    stdx::thread _reactorThread;
+
     // TransportLayerLegacy holds non-owning pointers to all of its sessions.
     mutable stdx::mutex _sessionsMutex;
     stdx::list<std::weak_ptr<LegacySession>> _sessions;
@@ -25,65 +25,64 @@
  *    then also delete it in the license file.
  */
 
-#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kDefault
-
 #include "mongo/platform/basic.h"
 
 #include "mongo/util/concurrency/ticketholder.h"
 
-#include <iostream>
-
-#include "mongo/util/log.h"
+#include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
-#if defined(__linux__)
 namespace {
-void _check(int ret) {
-    if (ret == 0)
-        return;
-    int err = errno;
-    severe() << "error in Ticketholder: " << errnoWithDescription(err);
-    fassertFailed(28604);
-}
-}
+const char* const kPriorityNames[] = {"high", "normal", "low"};
+const char* const kWaitBucketNames[] = {"lt1ms", "lt10ms", "lt100ms", "lt1s", "ge1s"};
+}  // namespace
 
-TicketHolder::TicketHolder(int num) : _outof(num) {
-    _check(sem_init(&_sem, 0, num));
-}
+TicketHolder::TicketHolder(int num) : _available(num), _outof(num) {}
 
-TicketHolder::~TicketHolder() {
-    _check(sem_destroy(&_sem));
-}
+TicketHolder::~TicketHolder() = default;
 
 bool TicketHolder::tryAcquire() {
-    while (0 != sem_trywait(&_sem)) {
-        switch (errno) {
-            case EAGAIN:
-                return false;
-            case EINTR:
-                break;
-            default:
-                _check(-1);
-        }
+    // Leave released tickets to the operations already queued.
+    if (_numQueued.load() > 0) {
+        return false;
     }
-    return true;
+    return _tryAcquireAvailable();
 }
 
-void TicketHolder::waitForTicket() {
-    while (0 != sem_wait(&_sem)) {
-        switch (errno) {
-            case EINTR:
-                break;
-            default:
-                _check(-1);
-        }
+void TicketHolder::waitForTicket(AdmissionPriority priority) {
+    auto& stats = _stats[static_cast<int>(priority)];
+    if (tryAcquire()) {
+        stats.admitted.fetchAndAdd(1);
+        return;
     }
+
+    Timer timer;
+    _waitInQueue(priority);
+    stats.admitted.fetchAndAdd(1);
+    _recordQueueWait(priority, timer.micros());
 }
 
 void TicketHolder::release() {
-    _check(sem_post(&_sem));
+    if (_numQueued.load() == 0) {
+        _available.fetchAndAdd(1);
+        if (_numQueued.load() == 0) {
+            return;
+        }
+
+        // An operation queued concurrently. It either took the ticket we made available, or is
+        // waiting for one.
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        if (_tryAcquireAvailable()) {
+            _grantTicket_inlock();
+        }
+        return;
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _grantTicket_inlock();
 }
 
 Status TicketHolder::resize(int newSize) {
@@ -91,21 +90,19 @@ Status TicketHolder::resize(int newSize) {
 
     if (newSize < 5)
         return Status(ErrorCodes::BadValue,
-                      str::stream() << "Minimum value for semaphore is 5; given " << newSize);
-
-    if (newSize > SEM_VALUE_MAX)
-        return Status(ErrorCodes::BadValue,
-                      str::stream() << "Maximum value for semaphore is " << SEM_VALUE_MAX
-                                    << "; given "
-                                    << newSize);
+                      str::stream() << "Minimum value for tickets is 5; given " << newSize);
 
     while (_outof.load() < newSize) {
         release();
         _outof.fetchAndAdd(1);
     }
 
+    // Take tickets out of circulation ahead of any queued operation. These are not admissions, so
+    // they are left out of the statistics.
     while (_outof.load() > newSize) {
-        waitForTicket();
+        if (!tryAcquire()) {
+            _waitInQueue(AdmissionPriority::kHigh);
+        }
         _outof.subtractAndFetch(1);
     }
 
@@ -114,9 +111,7 @@ Status TicketHolder::resize(int newSize) {
 }
 
 int TicketHolder::available() const {
-    int val = 0;
-    _check(sem_getvalue(&_sem, &val));
-    return val;
+    return _available.load();
 }
 
 int TicketHolder::used() const {
@@ -127,76 +122,102 @@ int TicketHolder::outof() const {
     return _outof.load();
 }
 
-#else
-
-TicketHolder::TicketHolder(int num) : _outof(num), _num(num) {}
+void TicketHolder::appendStats(BSONObjBuilder* builder) const {
+    std::array<size_t, kNumPriorities> queueLengths;
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        for (int i = 0; i < kNumPriorities; ++i) {
+            queueLengths[i] = _queues[i].size();
+        }
+    }
 
-TicketHolder::~TicketHolder() = default;
+    BSONObjBuilder prioritiesBuilder(builder->subobjStart("priorities"));
+    for (int i = 0; i < kNumPriorities; ++i) {
+        const auto& stats = _stats[i];
+        BSONObjBuilder priorityBuilder(prioritiesBuilder.subobjStart(kPriorityNames[i]));
+        priorityBuilder.append("queueLength", static_cast<long long>(queueLengths[i]));
+        priorityBuilder.append("admitted", stats.admitted.load());
+        priorityBuilder.append("queued", stats.queued.load());
+        priorityBuilder.append("queuedMicros", stats.queuedMicros.load());
+
+        BSONObjBuilder histogramBuilder(priorityBuilder.subobjStart("queueWaits"));
+        for (int bucket = 0; bucket < kNumWaitBuckets; ++bucket) {
+            histogramBuilder.append(kWaitBucketNames[bucket], stats.waitHistogram[bucket].load());
+        }
+    }
+}
 
-bool TicketHolder::tryAcquire() {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
-    return _tryAcquire();
+bool TicketHolder::_tryAcquireAvailable() {
+    int available = _available.load();
+    while (available > 0) {
+        const int seen = _available.compareAndSwap(available, available - 1);
+        if (seen == available) {
+            return true;
+        }
+        available = seen;
+    }
+    return false;
 }
 
-void TicketHolder::waitForTicket() {
+void TicketHolder::_waitInQueue(AdmissionPriority priority) {
     stdx::unique_lock<stdx::mutex> lk(_mutex);
+    _numQueued.fetchAndAdd(1);
 
-    while (!_tryAcquire()) {
-        _newTicket.wait(lk);
+    // A ticket may have been released before we were counted as queued.
+    if (!_tryAcquireAvailable()) {
+        Waiter waiter;
+        _queues[static_cast<int>(priority)].push_back(&waiter);
+        waiter.granted.wait(lk, [&] { return waiter.hasTicket; });
     }
-}
 
-void TicketHolder::release() {
-    {
-        stdx::lock_guard<stdx::mutex> lk(_mutex);
-        _num++;
-    }
-    _newTicket.notify_one();
+    _numQueued.subtractAndFetch(1);
 }
 
-Status TicketHolder::resize(int newSize) {
-    stdx::lock_guard<stdx::mutex> lk(_mutex);
-
-    int used = _outof.load() - _num;
-    if (used > newSize) {
-        std::stringstream ss;
-        ss << "can't resize since we're using (" << used << ") "
-           << "more than newSize(" << newSize << ")";
-
-        std::string errmsg = ss.str();
-        log() << errmsg;
-        return Status(ErrorCodes::BadValue, errmsg);
+void TicketHolder::_grantTicket_inlock() {
+    // The ticket goes to the highest priority queued, unless a lower priority has been passed over
+    // too many times in a row.
+    int next = -1;
+    for (int i = 0; i < kNumPriorities; ++i) {
+        if (_queues[i].empty()) {
+            continue;
+        }
+        if (next == -1) {
+            next = i;
+        } else if (_bypasses[i] >= kMaxBypasses) {
+            next = i;
+            break;
+        }
     }
 
-    _outof.store(newSize);
-    _num = _outof.load() - used;
-
-    // Potentially wasteful, but easier to see is correct
-    _newTicket.notify_all();
-    return Status::OK();
-}
+    if (next == -1) {
+        _available.fetchAndAdd(1);
+        return;
+    }
 
-int TicketHolder::available() const {
-    return _num;
-}
+    for (int i = next + 1; i < kNumPriorities; ++i) {
+        if (!_queues[i].empty()) {
+            ++_bypasses[i];
+        }
+    }
+    _bypasses[next] = 0;
 
-int TicketHolder::used() const {
-    return outof() - _num;
+    auto& queue = _queues[next];
+    Waiter* waiter = queue.front();
+    queue.pop_front();
+    waiter->hasTicket = true;
+    waiter->granted.notify_one();
 }
 
-int TicketHolder::outof() const {
-    return _outof.load();
-}
+void TicketHolder::_recordQueueWait(AdmissionPriority priority, long long micros) {
+    auto& stats = _stats[static_cast<int>(priority)];
+    stats.queued.fetchAndAdd(1);
+    stats.queuedMicros.fetchAndAdd(micros);
 
-bool TicketHolder::_tryAcquire() {
-    if (_num <= 0) {
-        if (_num < 0) {
-            std::cerr << "DISASTER! in TicketHolder" << std::endl;
-        }
-        return false;
+    int bucket = 0;
+    for (long long bound = 1000; bucket < kNumWaitBuckets - 1 && micros >= bound; bound *= 10) {
+        ++bucket;
     }
-    _num--;
-    return true;
-}
-#endif
+    stats.waitHistogram[bucket].fetchAndAdd(1);
 }
+
+}  // namespace mongo
@@ -26,17 +26,37 @@
  */
 #pragma once
 
-#if defined(__linux__)
-#include <semaphore.h>
-#endif
+#include <array>
+#include <deque>
 
 #include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/util/concurrency/mutex.h"
 
 namespace mongo {
 
+class BSONObjBuilder;
+
+/**
+ * The order in which operations waiting for a ticket are admitted. While any operation is queued,
+ * every released ticket goes to the first operation queued with the highest priority, unless an
+ * operation of lower priority has been passed over for TicketHolder::kMaxBypasses tickets in a
+ * row, in which case it gets the ticket. This keeps lower priorities from starving.
+ */
+enum class AdmissionPriority {
+    // Replication and other internal operations.
+    kHigh,
+
+    // Operations from user connections.
+    kNormal,
+
+    // User operations resuming after a yield, which are likely to be long running.
+    kLow,
+};
+
 class TicketHolder {
     MONGO_DISALLOW_COPYING(TicketHolder);
 
@@ -44,9 +64,12 @@ public:
     explicit TicketHolder(int num);
     ~TicketHolder();
 
+    /**
+     * Takes a ticket if one is available and no operation is queued for one.
+     */
     bool tryAcquire();
 
-    void waitForTicket();
+    void waitForTicket(AdmissionPriority priority = AdmissionPriority::kNormal);
 
     void release();
 
@@ -58,21 +81,68 @@ public:
 
     int outof() const;
 
+    // How many tickets in a row may go to higher priorities while an operation is queued.
+    static constexpr int kMaxBypasses = 8;
+
+    /**
+     * Appends, for each priority, how many operations are queued, how many have been admitted and
+     * a histogram of how long queued operations waited.
+     */
+    void appendStats(BSONObjBuilder* builder) const;
+
 private:
-#if defined(__linux__)
-    mutable sem_t _sem;
+    static constexpr int kNumPriorities = 3;
+
+    // Queue waits are bucketed by order of magnitude, from under 1ms to 1s and over.
+    static constexpr int kNumWaitBuckets = 5;
+
+    struct Waiter {
+        stdx::condition_variable granted;
+        bool hasTicket = false;
+    };
+
+    struct PriorityStats {
+        AtomicInt64 admitted;
+        AtomicInt64 queued;
+        AtomicInt64 queuedMicros;
+        std::array<AtomicInt64, kNumWaitBuckets> waitHistogram;
+    };
+
+    bool _tryAcquireAvailable();
+
+    /**
+     * Queues for a ticket with the given priority until one is granted, unless one becomes
+     * available first.
+     */
+    void _waitInQueue(AdmissionPriority priority);
+
+    /**
+     * Gives a ticket owned by the caller to the next queued operation, or makes it available if
+     * none is queued.
+     */
+    void _grantTicket_inlock();
+
+    void _recordQueueWait(AdmissionPriority priority, long long micros);
+
+    // Tickets that can be taken without queuing. Only changes outside of '_mutex' when no
+    // operation is queued.
+    AtomicInt32 _available;
 
     // You can read _outof without a lock, but have to hold _resizeMutex to change.
     AtomicInt32 _outof;
     stdx::mutex _resizeMutex;
-#else
-    bool _tryAcquire();
 
-    AtomicInt32 _outof;
-    int _num;
-    stdx::mutex _mutex;
-    stdx::condition_variable _newTicket;
-#endif
+    // The number of operations that have entered the queueing path of waitForTicket(). Only
+    // changes under '_mutex'.
+    AtomicInt32 _numQueued;
+
+    mutable stdx::mutex _mutex;
+    std::array<std::deque<Waiter*>, kNumPriorities> _queues;
+
+    // For each queue, how many tickets in a row went to higher priorities while it was not empty.
+    std::array<int, kNumPriorities> _bypasses{};
+
+    std::array<PriorityStats, kNumPriorities> _stats;
 };
 
 class ScopedTicket {
@@ -0,0 +1,200 @@
+/**
+ *    Copyright (C) 2017 MongoDB Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include <string>
+#include <vector>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/concurrency/ticketholder.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+namespace {
+
+BSONObj getPriorityStats(const TicketHolder& holder, StringData priority) {
+    BSONObjBuilder builder;
+    holder.appendStats(&builder);
+    return builder.obj()["priorities"].Obj()[priority].Obj().getOwned();
+}
+
+void waitForQueueLength(const TicketHolder& holder, StringData priority, long long length) {
+    while (getPriorityStats(holder, priority)["queueLength"].numberLong() != length) {
+        sleepmillis(1);
+    }
+}
+
+TEST(TicketHolderTest, AcquireAndRelease) {
+    TicketHolder holder(2);
+    ASSERT_EQ(2, holder.available());
+    ASSERT_EQ(0, holder.used());
+
+    ASSERT_TRUE(holder.tryAcquire());
+    holder.waitForTicket();
+    ASSERT_FALSE(holder.tryAcquire());
+    ASSERT_EQ(0, holder.available());
+    ASSERT_EQ(2, holder.used());
+    ASSERT_EQ(2, holder.outof());
+
+    holder.release();
+    holder.release();
+    ASSERT_EQ(2, holder.available());
+    ASSERT_EQ(0, holder.used());
+}
+
+TEST(TicketHolderTest, QueuedOperationsAreAdmittedInPriorityOrder) {
+    TicketHolder holder(1);
+    holder.waitForTicket();
+
+    stdx::mutex mutex;
+    std::vector<std::string> admitted;
+    auto waitForTicket = [&](AdmissionPriority priority, std::string name) {
+        return stdx::thread([&holder, &mutex, &admitted, priority, name] {
+            holder.waitForTicket(priority);
+            {
+                stdx::lock_guard<stdx::mutex> lk(mutex);
+                admitted.push_back(name);
+            }
+            holder.release();
+        });
+    };
+
+    auto low = waitForTicket(AdmissionPriority::kLow, "low");
+    waitForQueueLength(holder, "low", 1);
+    auto normal = waitForTicket(AdmissionPriority::kNormal, "normal");
+    waitForQueueLength(holder, "normal", 1);
+    auto high = waitForTicket(AdmissionPriority::kHigh, "high");
+    waitForQueueLength(holder, "high", 1);
+
+    // An operation arriving while others are queued does not take the released ticket first.
+    ASSERT_FALSE(holder.tryAcquire());
+
+    holder.release();
+    low.join();
+    normal.join();
+    high.join();
+
+    ASSERT_EQ(3U, admitted.size());
+    ASSERT_EQ("high", admitted[0]);
+    ASSERT_EQ("normal", admitted[1]);
+    ASSERT_EQ("low", admitted[2]);
+    ASSERT_EQ(1, holder.available());
+
+    for (auto priority : {"high"_sd, "normal"_sd, "low"_sd}) {
+        auto stats = getPriorityStats(holder, priority);
+        ASSERT_EQ(0, stats["queueLength"].numberLong());
+        ASSERT_EQ(1, stats["queued"].numberLong());
+
+        long long waits = 0;
+        for (auto&& bucket : stats["queueWaits"].Obj()) {
+            waits += bucket.numberLong();
+        }
+        ASSERT_EQ(1, waits);
+    }
+    ASSERT_EQ(2, getPriorityStats(holder, "normal")["admitted"].numberLong());
+}
+
+TEST(TicketHolderTest, ResizeHandsNewTicketsToQueuedOperations) {
+    TicketHolder holder(5);
+    for (int i = 0; i < 5; ++i) {
+        holder.waitForTicket();
+    }
+
+    stdx::thread waiter([&holder] {
+        holder.waitForTicket();
+        holder.release();
+    });
+    waitForQueueLength(holder, "normal", 1);
+
+    ASSERT_OK(holder.resize(6));
+    waiter.join();
+    ASSERT_EQ(6, holder.outof());
+    ASSERT_EQ(1, holder.available());
+
+    for (int i = 0; i < 5; ++i) {
+        holder.release();
+    }
+    ASSERT_OK(holder.resize(5));
+    ASSERT_EQ(5, holder.outof());
+    ASSERT_EQ(5, holder.available());
+
+    // Tickets taken out of circulation are not admissions.
+    ASSERT_EQ(0, getPriorityStats(holder, "high")["admitted"].numberLong());
+
+    ASSERT_NOT_OK(holder.resize(4));
+}
+
+TEST(TicketHolderTest, LowerPriorityIsAdmittedAfterMaxBypasses) {
+    TicketHolder holder(1);
+    holder.waitForTicket();
+
+    stdx::mutex mutex;
+    std::vector<std::string> admitted;
+    auto waitForTicket = [&](AdmissionPriority priority, std::string name) {
+        return stdx::thread([&holder, &mutex, &admitted, priority, name] {
+            holder.waitForTicket(priority);
+            {
+                stdx::lock_guard<stdx::mutex> lk(mutex);
+                admitted.push_back(name);
+            }
+            holder.release();
+        });
+    };
+
+    auto low = waitForTicket(AdmissionPriority::kLow, "low");
+    waitForQueueLength(holder, "low", 1);
+
+    const int numHigh = TicketHolder::kMaxBypasses + 2;
+    std::vector<stdx::thread> high;
+    for (int i = 0; i < numHigh; ++i) {
+        high.push_back(waitForTicket(AdmissionPriority::kHigh, "high"));
+    }
+    waitForQueueLength(holder, "high", numHigh);
+
+    holder.release();
+    low.join();
+    for (auto&& thread : high) {
+        thread.join();
+    }
+
+    // The low priority operation is passed over kMaxBypasses times, and then admitted ahead of the
+    // remaining high priority operations.
+    ASSERT_EQ(static_cast<size_t>(numHigh + 1), admitted.size());
+    for (int i = 0; i <= numHigh; ++i) {
+        ASSERT_EQ(i == TicketHolder::kMaxBypasses ? "low" : "high", admitted[i]);
+    }
+    ASSERT_EQ(1, holder.available());
+}
+
+}  // namespace
+}  // namespace mongo
@@ -135,6 +135,12 @@ public:
      */
     virtual uint64_t getSockCreationMicroSec() const = 0;
 
+    /**
+     * Returns the native socket descriptor backing this port, for use in readiness notification.
+     * The port retains ownership of the descriptor.
+     */
+    virtual int rawFD() = 0;
+
     /**
      * Sets the severity level for all logging.
      */
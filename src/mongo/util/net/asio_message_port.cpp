@@ -613,6 +613,10 @@ uint64_t ASIOMessagingPort::getSockCreationMicroSec() const {
     return _creationTime;
 }
 
+int ASIOMessagingPort::rawFD() {
+    return static_cast<int>(_getSocket().native_handle());
+}
+
 void ASIOMessagingPort::setLogLevel(logger::LogSeverity logLevel) {
     _logLevel = logLevel;
 }
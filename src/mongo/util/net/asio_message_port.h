@@ -97,6 +97,8 @@ public:
 
     uint64_t getSockCreationMicroSec() const override;
 
+    int rawFD() override;
+
     void setLogLevel(logger::LogSeverity logLevel) override;
 
     void clearCounters() override;
@@ -136,6 +136,10 @@ public:
         return _psock->getSockCreationMicroSec();
     }
 
+    int rawFD() override {
+        return _psock->rawFD();
+    }
+
 private:
     // this is the parsed version of remote
     HostAndPort _remoteParsed;
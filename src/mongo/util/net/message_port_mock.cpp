@@ -101,6 +101,10 @@ uint64_t MessagingPortMock::getSockCreationMicroSec() const {
     return 0;
 }
 
+int MessagingPortMock::rawFD() {
+    return -1;
+}
+
 void MessagingPortMock::setX509PeerInfo(SSLPeerInfo x509PeerInfo) {}
 
 const SSLPeerInfo& MessagingPortMock::getX509PeerInfo() const {
@@ -79,6 +79,8 @@ public:
 
     uint64_t getSockCreationMicroSec() const override;
 
+    int rawFD() override;
+
     void setX509PeerInfo(SSLPeerInfo x509PeerInfo) override;
 
     const SSLPeerInfo& getX509PeerInfo() const override;